@@ -0,0 +1,145 @@
+#include "benchHarness.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QRegularExpression>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @file benchHarness.cpp
+ * @brief Timing loop, statistics and JSON output for monitor_bench.
+ */
+
+#ifndef MONITOR_VERSION
+#define MONITOR_VERSION "unknown"
+#endif
+
+void BenchRunner::add(BenchCase benchCase) {
+    if (!m_options.filter.isEmpty()
+        && !QRegularExpression(m_options.filter).match(benchCase.name).hasMatch()) {
+        return;
+    }
+    m_cases.append(std::move(benchCase));
+}
+
+void BenchRunner::skip(const QString &name, const QString &reason) {
+    if (!m_options.filter.isEmpty()
+        && !QRegularExpression(m_options.filter).match(name).hasMatch()) {
+        return;
+    }
+    m_skipped.append({name, reason});
+}
+
+QStringList BenchRunner::names() const {
+    QStringList list;
+    for (const BenchCase &c : m_cases) {
+        list << c.name;
+    }
+    return list;
+}
+
+/**
+ * @brief Run all cases; progress goes to stderr so stdout can carry the JSON.
+ */
+QJsonObject BenchRunner::run() {
+    QTextStream err(stderr);
+    QJsonArray results;
+    for (const BenchCase &c : m_cases) {
+        err << "[BENCH] " << c.name << " ..." << Qt::flush;
+        const QJsonObject result = runCase(c);
+        err << " median " << result["nsPerOp"].toObject()["median"].toDouble() << " ns/op\n" << Qt::flush;
+        results.append(result);
+    }
+
+    QJsonArray skipped;
+    for (const auto &entry : m_skipped) {
+        err << "[BENCH] " << entry.first << " skipped: " << entry.second << "\n";
+        skipped.append(QJsonObject{{"name", entry.first}, {"reason", entry.second}});
+    }
+
+    QJsonObject host{
+        {"os",      QSysInfo::prettyProductName()},
+        {"kernel",  QSysInfo::kernelVersion()},
+        {"cpuArch", QSysInfo::currentCpuArchitecture()},
+        {"threads", QThread::idealThreadCount()},
+        {"hostName", QSysInfo::machineHostName()},
+    };
+    QJsonObject config{
+        {"samples", m_options.samples},
+        {"warmup",  m_options.warmup},
+        {"filter",  m_options.filter},
+        {"seed",    qint64(m_options.seed)},
+    };
+    return QJsonObject{
+        {"schema",    1},
+        {"suite",     "monitor_bench"},
+        {"version",   MONITOR_VERSION},
+        {"qt",        qVersion()},
+        {"startedAt", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+        {"host",      host},
+        {"config",    config},
+        {"results",   results},
+        {"skipped",   skipped},
+    };
+}
+
+/**
+ * @brief Warm up, take the timed samples and summarise them.
+ */
+QJsonObject BenchRunner::runCase(const BenchCase &c) const {
+    const int batch = std::max(1, c.batch);
+    QVector<double> nsPerOp;
+    nsPerOp.reserve(m_options.samples);
+
+    QElapsedTimer timer;
+    for (int i = 0; i < m_options.warmup + m_options.samples; ++i) {
+        if (c.setup) {
+            c.setup();
+        }
+        timer.start();
+        c.body();
+        const qint64 ns = timer.nsecsElapsed();
+        if (i >= m_options.warmup) {
+            nsPerOp.append(double(ns) / batch);
+        }
+    }
+    if (c.teardown) {
+        c.teardown();
+    }
+
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+    const int n = nsPerOp.size();
+    double mean = 0.0;
+    for (double v : nsPerOp) {
+        mean += v;
+    }
+    mean /= std::max(1, n);
+    double variance = 0.0;
+    for (double v : nsPerOp) {
+        variance += (v - mean) * (v - mean);
+    }
+    const double stddev = n > 1 ? std::sqrt(variance / (n - 1)) : 0.0;
+    auto at = [&](double p) {
+        return n == 0 ? 0.0 : nsPerOp[std::clamp(int(std::ceil(p * n)) - 1, 0, n - 1)];
+    };
+    const double median = at(0.5);
+
+    return QJsonObject{
+        {"name",      c.name},
+        {"params",    QJsonObject::fromVariantMap(c.params)},
+        {"batch",     batch},
+        {"samples",   n},
+        {"nsPerOp",   QJsonObject{
+            {"min",    n ? nsPerOp.first() : 0.0},
+            {"median", median},
+            {"p95",    at(0.95)},
+            {"mean",   mean},
+            {"stddev", stddev},
+        }},
+        {"opsPerSec", median > 0.0 ? 1e9 / median : 0.0},
+    };
+}
@@ -0,0 +1,72 @@
+#ifndef BENCHHARNESS_H
+#define BENCHHARNESS_H
+
+#include <QJsonObject>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+#include <functional>
+
+/**
+ * @brief One benchmark: an untimed setup step and a timed body.
+ *
+ * The body performs @c batch operations per call; results are reported per
+ * operation. Names are slash-separated ("crypto/encrypt/1024") so runs can
+ * be filtered by prefix or regular expression.
+ */
+struct BenchCase {
+    QString                name;
+    QVariantMap            params;         ///< Echoed into the JSON result
+    int                    batch = 1;      ///< Operations per body call
+    std::function<void()>  setup;          ///< Runs before every sample, untimed (optional)
+    std::function<void()>  body;           ///< Timed
+    std::function<void()>  teardown;       ///< Runs once after the last sample (optional)
+};
+
+/**
+ * @brief Runs BenchCases and writes the results as one JSON document.
+ *
+ * Every case gets @c warmup untimed samples, then @c samples timed ones;
+ * per-operation nanoseconds are summarised as min/median/p95/mean/stddev.
+ * The document also records the build, host and options, so two runs can
+ * be compared across versions.
+ */
+class BenchRunner {
+public:
+    struct Options {
+        int      samples = 30;
+        int      warmup  = 3;
+        QString  filter;            ///< Regular expression on case names; empty = all
+        quint32  seed    = 1;       ///< Seed the cases use for synthetic data
+    };
+
+    explicit BenchRunner(const Options &options) : m_options(options) {}
+
+    const Options &options() const { return m_options; }
+
+    /// Queue a case (ignored if it does not match the filter).
+    void add(BenchCase benchCase);
+
+    /// Record a case that cannot run in this environment.
+    void skip(const QString &name, const QString &reason);
+
+    /// @return Names of the queued cases.
+    QStringList names() const;
+
+    /**
+     * @brief Run every queued case in order.
+     * @return The result document.
+     */
+    QJsonObject run();
+
+private:
+    QJsonObject runCase(const BenchCase &benchCase) const;
+
+    Options            m_options;
+    QVector<BenchCase> m_cases;
+    QVector<QPair<QString, QString>> m_skipped;
+};
+
+#endif // BENCHHARNESS_H
@@ -0,0 +1,77 @@
+#include "latencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @file latencyHistogram.cpp
+ * @brief Log-linear bucketing for LatencyHistogram.
+ */
+
+int LatencyHistogram::bucketFor(qint64 us) {
+    const quint64 v = quint64(std::clamp<qint64>(us, 0, (qint64(1) << kMaxBits) - 1));
+    if (v < quint64(kSubBuckets)) {
+        return int(v);
+    }
+    int msb = 63;
+    while (!(v & (quint64(1) << msb))) {
+        --msb;
+    }
+    const int shift = msb - kSubBits;
+    return (msb - kSubBits + 1) * kSubBuckets + int((v >> shift) & (kSubBuckets - 1));
+}
+
+qint64 LatencyHistogram::upperBound(int bucket) {
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+    const int group = bucket / kSubBuckets;
+    const int sub = bucket % kSubBuckets;
+    const int shift = group - 1;
+    return ((qint64(kSubBuckets + sub) << shift) + (qint64(1) << shift)) - 1;
+}
+
+void LatencyHistogram::record(qint64 us) {
+    ++m_counts[bucketFor(us)];
+    ++m_count;
+    m_max = std::max(m_max, us);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+    for (int i = 0; i < kBuckets; ++i) {
+        m_counts[i] += other.m_counts[i];
+    }
+    m_count += other.m_count;
+    m_max = std::max(m_max, other.m_max);
+}
+
+void LatencyHistogram::reset() {
+    m_counts.fill(0);
+    m_count = 0;
+    m_max = 0;
+}
+
+qint64 LatencyHistogram::percentile(double p) const {
+    if (m_count == 0) {
+        return 0;
+    }
+    const qint64 rank = std::max<qint64>(1, qint64(std::ceil(p / 100.0 * m_count)));
+    qint64 seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += m_counts[i];
+        if (seen >= rank) {
+            return std::min(upperBound(i), m_max);
+        }
+    }
+    return m_max;
+}
+
+QJsonObject LatencyHistogram::toJson() const {
+    return QJsonObject{
+        {"count",  m_count},
+        {"p50Ms",  percentile(50.0) / 1000.0},
+        {"p90Ms",  percentile(90.0) / 1000.0},
+        {"p99Ms",  percentile(99.0) / 1000.0},
+        {"p999Ms", percentile(99.9) / 1000.0},
+        {"maxMs",  m_max / 1000.0},
+    };
+}
@@ -0,0 +1,49 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QJsonObject>
+#include <QtGlobal>
+#include <array>
+
+/**
+ * @brief Fixed-size log-linear histogram of latencies in microseconds.
+ *
+ * Each power-of-two range is split into 16 linear sub-buckets, so any
+ * recorded value is reported within ~6% while the whole range up to
+ * ~2^40 us fits in a few hundred counters. Recording is O(1) and never
+ * allocates, which keeps it usable for hours-long runs. Not thread-safe.
+ */
+class LatencyHistogram {
+public:
+    /// Record one latency.
+    void record(qint64 us);
+
+    /// Add every sample of @p other.
+    void merge(const LatencyHistogram &other);
+
+    void reset();
+
+    qint64 count() const { return m_count; }
+    qint64 maximum() const { return m_max; }
+
+    /// @return Upper bound of the bucket holding the @p p-th percentile (0-100).
+    qint64 percentile(double p) const;
+
+    /// @return {count, p50Ms, p90Ms, p99Ms, p999Ms, maxMs}.
+    QJsonObject toJson() const;
+
+private:
+    static constexpr int kSubBits = 4;
+    static constexpr int kSubBuckets = 1 << kSubBits;
+    static constexpr int kMaxBits = 41;    ///< Values are clamped below 2^kMaxBits us
+    static constexpr int kBuckets = (kMaxBits - kSubBits + 1) * kSubBuckets;
+
+    static int bucketFor(qint64 us);
+    static qint64 upperBound(int bucket);
+
+    std::array<qint64, kBuckets> m_counts{};
+    qint64 m_count = 0;
+    qint64 m_max = 0;
+};
+
+#endif // LATENCYHISTOGRAM_H
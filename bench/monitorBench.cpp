@@ -0,0 +1,776 @@
+/**
+ * @file monitorBench.cpp
+ * @brief monitor_bench: micro- and macro-benchmarks of the monitoring hot paths.
+ *
+ * Usage:
+ *     monitor_bench [--output results.json] [--filter REGEX] [--samples N]
+ *                   [--warmup N] [--seed N] [--items 100,1000] [--rates 0,1,10,100]
+ *                   [--alert-latency-ms N] [--trace trace.json] [--list]
+ *
+ * Cases:
+ *   crypto/...    EncryptionUtils encrypt/decrypt/decryptBatch by payload size
+ *   values/...    Stored-value encoding (compression + encryption) of plist
+ *                 documents and registry exports, raw vs compressed; the
+ *                 params report the bytes each variant stores
+ *   check/...     The check loop's detection pass over N synthetic items at a
+ *                 given change rate, with and without staged persistence
+ *   db/...        Database inserts, group commit and range search
+ *   alert/...     Alert::sendAlert against a local stub AWS endpoint
+ *   model/...     LogModel, ChangeChartModel and item-model updates
+ *   items/...     Loading a monitored-items list: QJsonDocument, the
+ *                 streaming reader and the compiled cache
+ *   trace/...     Cost of one MON_SPAN with tracing off and on
+ *
+ * --trace records spans in every case and writes them as Chrome trace
+ * JSON; comparing a run with and without it gives the tracing overhead
+ * on each hot path. The trace/ cases are skipped then, since they restart
+ * the recording.
+ *
+ * Database cases run against MONITOR_DB_NAME (default "MonitorBench") on the
+ * server named by MONITOR_DB_HOST/PORT/USER/PASSWORD, and are skipped when
+ * it is unreachable. The bench truncates that schema's Changes table, so it
+ * refuses to run them against the production schema.
+ */
+
+#include "benchHarness.h"
+#include "stubAwsEndpoint.h"
+
+#include "alert.h"
+#include "changeChartModel.h"
+#include "changeDispatcher.h"
+#include "configSource.h"
+#include "Database.h"
+#include "databaseRows.h"
+#include "encryptionUtils.h"
+#include "itemListCache.h"
+#include "logger.h"
+#include "logModel.h"
+#include "monitoredItemsProxyModel.h"
+#include "plistTree.h"
+#include "settings.h"
+#include "trace.h"
+#include "valueEnvelope.h"
+#ifdef Q_OS_MAC
+#include "plistFile.h"
+#include "plistFileModel.h"
+#elif defined(Q_OS_WIN)
+#include "registryKey.h"
+#include "registryKeyModel.h"
+#endif
+
+#include <aws/core/Aws.h>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSemaphore>
+#include <QSettings>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThreadPool>
+#include <memory>
+#include <random>
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+// Synthetic data
+////////////////////////////////////////////////////////////////////////////////
+
+QString randomText(std::mt19937 &rng, int length) {
+    static const char kAlphabet[] =
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 _-./";
+    std::uniform_int_distribution<int> pick(0, int(sizeof(kAlphabet)) - 2);
+    QString text(length, Qt::Uninitialized);
+    for (int i = 0; i < length; ++i) {
+        text[i] = QLatin1Char(kAlphabet[pick(rng)]);
+    }
+    return text;
+}
+
+QByteArray randomBytes(std::mt19937 &rng, int length) {
+    QByteArray bytes(length, Qt::Uninitialized);
+    for (int i = 0; i < length; ++i) {
+        bytes[i] = char(rng() & 0xff);
+    }
+    return bytes;
+}
+
+/**
+ * @brief A preferences document of about @p bytes, rendered the way
+ *        whole-document plist watches store it.
+ *
+ * Recent-folder bookmarks (mostly fixed structure around a few random
+ * bytes), window frames and document paths, as in Finder or an editor.
+ */
+QString plistPayload(std::mt19937 &rng, int bytes) {
+    std::uniform_int_distribution<int> coord(0, 2560);
+    QVariantMap root;
+    QVariantList recents;
+    QVariantList documents;
+    QString rendered;
+    for (int i = 0; rendered.size() < bytes; ++i) {
+        QByteArray bookmark = QByteArray("book\0\0\0\0mark\0\0\0\0", 16).repeated(6);
+        bookmark.append(randomBytes(rng, 16));
+        recents.append(QVariantMap{
+            {"name", QStringLiteral("Project %1").arg(i)},
+            {"file-bookmark", bookmark},
+        });
+        documents.append(QStringLiteral("/Users/bench/Documents/Project %1/Notes %2.md").arg(i / 4).arg(i));
+        root.insert(QStringLiteral("NSWindow Frame BrowserWindow%1").arg(i),
+                    QStringLiteral("%1 %2 1024 768 0 0 2560 1440 ").arg(coord(rng)).arg(coord(rng)));
+        root.insert("FXRecentFolders", recents);
+        root.insert("NSRecentDocuments", documents);
+        root.insert("ShowStatusBar", i % 2 == 0);
+        if (i % 16 == 0) {
+            rendered = PlistTree(root).render();
+        }
+    }
+    return PlistTree(root).render();
+}
+
+/**
+ * @brief A registry export of about @p bytes: paths, version strings and
+ *        REG_BINARY values in hex.
+ */
+QString registryPayload(std::mt19937 &rng, int bytes) {
+    QString text = QStringLiteral("[HKEY_LOCAL_MACHINE\\SOFTWARE\\Vendor\\Product\\Settings]\n");
+    for (int i = 0; text.size() < bytes; ++i) {
+        switch (i % 3) {
+        case 0:
+            text += QStringLiteral("\"InstallPath%1\"=\"C:\\\\Program Files\\\\Vendor\\\\Product\\\\module%1\"\n").arg(i);
+            break;
+        case 1:
+            text += QStringLiteral("\"Version%1\"=\"10.0.%2.%3\"\n").arg(i).arg(rng() % 20000).arg(rng() % 100);
+            break;
+        default:
+            text += QStringLiteral("\"State%1\"=hex:%2\n")
+                        .arg(i).arg(QString::fromLatin1(randomBytes(rng, 24).toHex(',')));
+            break;
+        }
+    }
+    return text;
+}
+
+/// Write a throwaway AES key file and load it.
+bool loadBenchKeys(const QTemporaryDir &dir, std::mt19937 &rng) {
+    const QString path = dir.filePath("encryptionKeys.json");
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(QJsonObject{
+        {"key", QString::fromLatin1(randomBytes(rng, 32).toBase64())},
+        {"iv",  QString::fromLatin1(randomBytes(rng, 16).toBase64())},
+    }).toJson());
+    file.close();
+    qputenv("MONITOR_ENCRYPTION_KEYS", path.toUtf8());
+    EncryptionUtils::loadEncryptionKeys(path);
+    return true;
+}
+
+#if defined(Q_OS_MAC)
+using BenchItem = PlistFile;
+using BenchItemModel = PlistFileModel;
+#elif defined(Q_OS_WIN)
+using BenchItem = RegistryKey;
+using BenchItemModel = RegistryKeyModel;
+#endif
+
+#if defined(Q_OS_MAC) || defined(Q_OS_WIN)
+/**
+ * @brief N monitored items backed by real platform storage.
+ *
+ * macOS: one plist file per item in a temporary directory.
+ * Windows: one key per item under HKCU\\Software\\MonitorBench.
+ * Items are read through the same classes the monitors use, so the check
+ * loop pays the real per-item read cost.
+ */
+class SyntheticItems {
+public:
+    explicit SyntheticItems(int count) {
+        for (int i = 0; i < count; ++i) {
+            const QString name = QStringLiteral("bench_%1").arg(i);
+            write(i, name, QStringLiteral("v0"));
+#if defined(Q_OS_MAC)
+            m_items.append(new BenchItem(path(i), name, false));
+#else
+            m_items.append(new BenchItem("HKEY_CURRENT_USER", keyPath(i), name, false));
+#endif
+            m_items.last()->loadBaseline();
+        }
+    }
+
+    ~SyntheticItems() {
+        qDeleteAll(m_items);
+#if defined(Q_OS_WIN)
+        QSettings("HKEY_CURRENT_USER\\Software\\MonitorBench", QSettings::NativeFormat).remove("");
+#endif
+    }
+
+    const QList<BenchItem *> &items() const { return m_items; }
+
+    /// Give round(rate * N) randomly chosen items a new stored value.
+    void mutate(double rate, std::mt19937 &rng) {
+        const int n = m_items.size();
+        const int count = int(rate * n + 0.5);
+        std::uniform_int_distribution<int> pick(0, n - 1);
+        ++m_generation;
+        for (int k = 0; k < count; ++k) {
+            const int i = count == n ? k : pick(rng);
+            write(i, m_items[i]->valueName(), QStringLiteral("v%1").arg(m_generation));
+        }
+    }
+
+private:
+#if defined(Q_OS_MAC)
+    QString path(int i) const { return m_dir.filePath(QStringLiteral("item%1.plist").arg(i)); }
+
+    void write(int i, const QString &name, const QString &value) {
+        QSettings store(path(i), QSettings::NativeFormat);
+        store.setValue(name, value);
+        store.sync();
+    }
+
+    QTemporaryDir m_dir;
+#else
+    static QString keyPath(int i) { return QStringLiteral("Software\\MonitorBench\\item%1").arg(i); }
+
+    void write(int i, const QString &name, const QString &value) {
+        QSettings store("HKEY_CURRENT_USER\\" + keyPath(i), QSettings::NativeFormat);
+        store.setValue(name, value);
+    }
+#endif
+
+    QList<BenchItem *> m_items;
+    int                m_generation = 0;
+};
+#endif
+
+QList<int> parseIntList(const QString &text) {
+    QList<int> values;
+    for (const QString &part : text.split(',', Qt::SkipEmptyParts)) {
+        values << part.trimmed().toInt();
+    }
+    return values;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Cases
+////////////////////////////////////////////////////////////////////////////////
+
+struct BenchContext {
+    std::mt19937       rng;
+    QTemporaryDir      tempDir;
+    QList<int>         itemCounts;
+    QList<int>         ratesPercent;
+    int                alertLatencyMs = 0;
+    bool               dbAvailable = false;
+};
+
+void addCryptoCases(BenchRunner &runner, BenchContext &ctx) {
+    for (int size : {64, 1024, 16384}) {
+        const QString plain = randomText(ctx.rng, size);
+        const QByteArray cipher = EncryptionUtils::encrypt(plain);
+        const QVariantMap params{{"payloadBytes", size}};
+
+        runner.add({QStringLiteral("crypto/encrypt/%1").arg(size), params, 64, {}, [plain]() {
+            for (int i = 0; i < 64; ++i) {
+                QByteArray out = EncryptionUtils::encrypt(plain);
+                Q_UNUSED(out);
+            }
+        }, {}});
+
+        runner.add({QStringLiteral("crypto/decrypt/%1").arg(size), params, 64, {}, [cipher]() {
+            for (int i = 0; i < 64; ++i) {
+                QString out = EncryptionUtils::decrypt(cipher);
+                Q_UNUSED(out);
+            }
+        }, {}});
+
+        const QList<QByteArray> batch(256, cipher);
+        runner.add({QStringLiteral("crypto/decryptBatch/%1").arg(size), params, 256, {}, [batch]() {
+            QStringList out = EncryptionUtils::decryptBatch(batch);
+            Q_UNUSED(out);
+        }, {}});
+    }
+}
+
+/**
+ * @brief Encoding a value for storage (envelope + AES) and decoding it back.
+ *
+ * "raw" stores the UTF-8 as before compression existed; "compressed" uses
+ * the default threshold. storedBytes is the Changes column size (base64
+ * of the cipher); payloadBytes / ns per op gives throughput.
+ */
+void addValueCases(BenchRunner &runner, BenchContext &ctx) {
+    const int defaultThreshold = ValueEnvelope::compressThreshold();
+    const int kValues = 16;
+
+    for (const char *kind : {"plist", "registry"}) {
+        for (int size : {1024, 16384, 262144}) {
+            const QString value = qstrcmp(kind, "plist") == 0 ? plistPayload(ctx.rng, size)
+                                                              : registryPayload(ctx.rng, size);
+            for (const char *variant : {"raw", "compressed"}) {
+                const int threshold = qstrcmp(variant, "raw") == 0 ? 0 : defaultThreshold;
+                ValueEnvelope::setCompressThreshold(threshold);
+                const QByteArray cipher = EncryptionUtils::encryptBytes(ValueEnvelope::encode(value));
+                ValueEnvelope::setCompressThreshold(defaultThreshold);
+
+                const QVariantMap params{
+                    {"payloadBytes", value.toUtf8().size()},
+                    {"storedBytes", cipher.toBase64().size()},
+                    {"compressThreshold", threshold},
+                };
+                const QString suffix = QStringLiteral("%1/%2/%3").arg(QLatin1String(kind)).arg(size)
+                                           .arg(QLatin1String(variant));
+                auto restore = [defaultThreshold]() { ValueEnvelope::setCompressThreshold(defaultThreshold); };
+
+                runner.add({"values/encode/" + suffix, params, kValues,
+                            [threshold]() { ValueEnvelope::setCompressThreshold(threshold); },
+                            [value]() {
+                                for (int i = 0; i < kValues; ++i) {
+                                    QByteArray out = EncryptionUtils::encryptBytes(ValueEnvelope::encode(value));
+                                    Q_UNUSED(out);
+                                }
+                            }, restore});
+
+                const QList<QByteArray> batch(kValues, cipher);
+                runner.add({"values/decode/" + suffix, params, kValues, {}, [batch]() {
+                    for (const QByteArray &plain : EncryptionUtils::decryptBatchBytes(batch)) {
+                        QString out = ValueEnvelope::decode(plain);
+                        Q_UNUSED(out);
+                    }
+                }, {}});
+            }
+        }
+    }
+}
+
+/**
+ * @brief One MON_SPAN per operation; "on" starts a fresh recording per
+ *        sample so the buffer never fills and the drop path is not measured.
+ */
+void addTraceCases(BenchRunner &runner, bool tracing) {
+    if (tracing) {
+        runner.skip("trace", "--trace is recording");
+        return;
+    }
+    const int kSpans = 1024;
+    runner.add({"trace/span/off", {{"spans", kSpans}}, kSpans,
+                []() { Tracer::setEnabled(false); },
+                [kSpans]() {
+                    for (int i = 0; i < kSpans; ++i) {
+                        MON_SPAN(LogCategory::General, "bench.span");
+                    }
+                }, {}});
+    runner.add({"trace/span/on", {{"spans", kSpans}}, kSpans,
+                []() { Tracer::setEnabled(true); },
+                [kSpans]() {
+                    for (int i = 0; i < kSpans; ++i) {
+                        MON_SPAN(LogCategory::General, "bench.span");
+                    }
+                },
+                []() { Tracer::setEnabled(false); }});
+}
+
+#if defined(Q_OS_MAC) || defined(Q_OS_WIN)
+/**
+ * @brief The monitors' detection pass, optionally staging one insert per change.
+ *
+ * Mirrors checkForChanges(): read every item, compare with the stored value
+ * and, with @p dispatcher, stage the Changes row inside a tick and wait for
+ * the group commit to land.
+ */
+void runCheckPass(const QList<BenchItem *> &items, ChangeDispatcher *dispatcher) {
+    if (dispatcher) {
+        dispatcher->beginTick();
+    }
+    for (BenchItem *item : items) {
+        const QString current = item->getCurrentValue();
+        const QString previous = item->value();
+        if (current == previous) {
+            continue;
+        }
+        if (dispatcher) {
+            const QString name = item->valueName();
+            dispatcher->stage(ChangeLane::Persist, [name, previous, current](Database &db) {
+                return db.insertChange(name, previous, current, false);
+            });
+        }
+        item->setValue(current);
+    }
+    if (dispatcher) {
+        dispatcher->commitTick();
+        // Persist jobs run in order, so this one finishes after the batch
+        QSemaphore drained;
+        dispatcher->post(ChangeLane::Persist, [&drained]() { drained.release(); });
+        drained.acquire();
+    }
+}
+#endif
+
+void addCheckLoopCases(BenchRunner &runner, BenchContext &ctx) {
+#if defined(Q_OS_MAC) || defined(Q_OS_WIN)
+    // One dispatcher for every persist case, like the running app
+    std::shared_ptr<ChangeDispatcher> dispatcher;
+    if (ctx.dbAvailable) {
+        dispatcher = std::make_shared<ChangeDispatcher>();
+    }
+    for (int count : ctx.itemCounts) {
+        auto items = std::make_shared<SyntheticItems>(count);
+        for (int rate : ctx.ratesPercent) {
+            const QVariantMap params{{"items", count}, {"changeRatePercent", rate}};
+            BenchContext *c = &ctx;
+            runner.add({QStringLiteral("check/detect/%1/%2").arg(count).arg(rate), params, count,
+                        [items, rate, c]() { items->mutate(rate / 100.0, c->rng); },
+                        [items]() { runCheckPass(items->items(), nullptr); },
+                        {}});
+
+            if (!dispatcher) {
+                runner.skip(QStringLiteral("check/persist/%1/%2").arg(count).arg(rate), "database unavailable");
+                continue;
+            }
+            runner.add({QStringLiteral("check/persist/%1/%2").arg(count).arg(rate), params, count,
+                        [items, rate, c]() { items->mutate(rate / 100.0, c->rng); },
+                        [items, dispatcher]() { runCheckPass(items->items(), dispatcher.get()); },
+                        {}});
+        }
+    }
+#else
+    Q_UNUSED(ctx);
+    runner.skip("check", "no monitored-item backend on this platform");
+#endif
+}
+
+void addDatabaseCases(BenchRunner &runner, BenchContext &ctx) {
+    if (!ctx.dbAvailable) {
+        runner.skip("db", "database unavailable");
+        return;
+    }
+    const QString oldValue = randomText(ctx.rng, 64);
+    const QString newValue = randomText(ctx.rng, 64);
+
+    runner.add({"db/insertChange", {{"rowsPerSample", 64}}, 64, {}, [oldValue, newValue]() {
+        Database db;
+        for (int i = 0; i < 64; ++i) {
+            db.insertChange(QStringLiteral("bench_insert_%1").arg(i % 8), oldValue, newValue, false);
+        }
+    }, {}});
+
+    for (int rows : {16, 256}) {
+        std::vector<Database::Write> writes;
+        for (int i = 0; i < rows; ++i) {
+            const QString name = QStringLiteral("bench_batch_%1").arg(i % 8);
+            writes.push_back([name, oldValue, newValue](Database &db) {
+                return db.insertChange(name, oldValue, newValue, false);
+            });
+        }
+        runner.add({QStringLiteral("db/applyBatch/%1").arg(rows), {{"rowsPerTransaction", rows}}, rows, {},
+                    [writes]() {
+            Database db;
+            db.applyBatch(writes);
+        }, {}});
+    }
+
+    // A fixed set of rows for the search cases
+    const int kSearchRows = 5000;
+    {
+        std::vector<Database::Write> writes;
+        for (int i = 0; i < kSearchRows; ++i) {
+            writes.push_back([oldValue, newValue](Database &db) {
+                return db.insertChange("bench_search", oldValue, newValue, false);
+            });
+        }
+        Database db;
+        db.applyBatch(writes);
+    }
+
+    runner.add({"db/searchRange", {{"rows", kSearchRows}}, kSearchRows, {}, []() {
+        Database db;
+        int visited = 0;
+        db.forEachChangeInRange(QString(), QString(), "bench_search", QVariant(), QVariant(),
+                                [&visited](ChangeRow &&) { ++visited; return true; });
+    }, {}});
+
+    auto pool = std::make_shared<QThreadPool>();
+    runner.add({"db/searchRangeDecrypt", {{"rows", kSearchRows}}, kSearchRows, {}, [pool]() {
+        Database db;
+        QVector<ChangeRow> rows;
+        rows.reserve(kSearchRows);
+        db.forEachChangeInRange(QString(), QString(), "bench_search", QVariant(), QVariant(),
+                                [&rows](ChangeRow &&row) { rows.append(std::move(row)); return true; });
+        ChangeRow *first = rows.data();
+        DatabaseRows::decryptValuesParallel(*pool, first, first + rows.size());
+    }, {}});
+
+    runner.add({"db/changeCountRows", {}, 1, {}, []() {
+        Database db;
+        QVector<ChangeCountRow> rows = db.changeCountRows();
+        Q_UNUSED(rows);
+    }, {}});
+}
+
+void addAlertCases(BenchRunner &runner, BenchContext &ctx, Settings &settings) {
+    if (!ctx.dbAvailable) {
+        runner.skip("alert", "database unavailable (recipients are read from UserSettings)");
+        return;
+    }
+
+    auto stub = std::make_shared<StubAwsEndpoint>(ctx.alertLatencyMs);
+    if (!stub->start()) {
+        runner.skip("alert", "cannot listen on loopback");
+        return;
+    }
+    const QString configPath = ctx.tempDir.filePath("awsconfig.json");
+    QFile config(configPath);
+    if (!config.open(QIODevice::WriteOnly)) {
+        runner.skip("alert", "cannot write stub AWS config");
+        return;
+    }
+    config.write(QJsonDocument(QJsonObject{
+        {"accessKeyId", "BENCHKEY"},
+        {"secretAccessKey", "BENCHSECRET"},
+        {"region", "us-east-1"},
+        {"endpoint", stub->url()},
+    }).toJson());
+    config.close();
+    qputenv("MONITOR_AWS_CONFIG", configPath.toUtf8());
+
+    // One recipient with both channels; the rate limit must not interfere
+    settings.setNotificationFrequency("1000000");
+    {
+        Database db;
+        db.insertOrUpdateUserSettings("bench@example.com", "+15550100000", 0, "1000000");
+    }
+    auto alert = std::make_shared<Alert>(&settings);
+
+    runner.add({"alert/sendAlert", {{"latencyMs", ctx.alertLatencyMs}, {"channels", 2}}, 1, {},
+                [stub, alert]() { alert->sendAlert("monitor_bench alert"); }, {}});
+}
+
+void addModelCases(BenchRunner &runner, BenchContext &ctx) {
+    auto log = std::make_shared<LogModel>(2000);
+    runner.add({"model/logAppend/1000", {{"lines", 1000}}, 1000,
+                [log]() { log->clear(); },
+                [log]() {
+        for (int i = 0; i < 1000; ++i) {
+            log->append(QStringLiteral("[BENCH] line %1").arg(i));
+        }
+        log->flushPending();
+    }, {}});
+
+    auto chart = std::make_shared<ChangeChartModel>(7);
+    runner.add({"model/chartRecord/1000", {{"changes", 1000}, {"configs", 50}}, 1000, {}, [chart]() {
+        const QDateTime now = QDateTime::currentDateTime();
+        for (int i = 0; i < 1000; ++i) {
+            chart->recordChange(QStringLiteral("bench_%1").arg(i % 50), now);
+        }
+        chart->flushPending();
+    }, {}});
+
+    QVector<ChangeCountRow> counts;
+    const QDate today = QDate::currentDate();
+    std::uniform_int_distribution<int> countDist(1, 500);
+    for (int day = 0; day < 7; ++day) {
+        for (int config = 0; config < 200; ++config) {
+            ChangeCountRow row;
+            row.date       = today.addDays(-day).toString(Qt::ISODate);
+            row.configName = QStringLiteral("bench_%1").arg(config);
+            row.count      = countDist(ctx.rng);
+            counts.append(row);
+        }
+    }
+    runner.add({"model/chartLoad", {{"days", 7}, {"configs", 200}}, 1, {},
+                [chart, counts]() { chart->loadRows(counts); }, {}});
+
+#if defined(Q_OS_MAC) || defined(Q_OS_WIN)
+    for (int count : ctx.itemCounts) {
+        auto items = std::make_shared<SyntheticItems>(count);
+        auto model = std::make_shared<BenchItemModel>();
+        auto proxy = std::make_shared<MonitoredItemsProxyModel>();
+        proxy->setSourceModel(model.get());
+#if defined(Q_OS_MAC)
+        auto reset = [model](const QList<BenchItem *> &list) { model->setPlistFiles(list); };
+#else
+        auto reset = [model](const QList<BenchItem *> &list) { model->setRegistryKeys(list); };
+#endif
+        runner.add({QStringLiteral("model/itemsReload/%1").arg(count), {{"items", count}}, count,
+                    [reset]() { reset({}); },
+                    [reset, items, proxy]() { reset(items->items()); }, {}});
+    }
+#endif
+}
+
+/**
+ * @brief Startup/reload cost of the item list: the old DOM parse, the
+ *        streaming parse on a cache miss, and a warm cache hit.
+ */
+void addItemListCases(BenchRunner &runner, BenchContext &ctx) {
+    const ItemListFormat format{"plistPath", false};
+    qputenv("MONITOR_ITEM_CACHE", ctx.tempDir.filePath("itemCache").toUtf8());
+
+    for (int count : {1000, 100000}) {
+        QJsonArray entries;
+        for (int i = 0; i < count; ++i) {
+            entries.append(QJsonObject{
+                {"plistPath",  QStringLiteral("/Library/Preferences/bench.%1.plist").arg(i)},
+                {"valueName",  QStringLiteral("Setting%1").arg(i)},
+                {"isCritical", i % 10 == 0},
+            });
+        }
+        const QString path = ctx.tempDir.filePath(QStringLiteral("items%1.json").arg(count));
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            runner.skip(QStringLiteral("items/%1").arg(count), "cannot write the item list");
+            continue;
+        }
+        file.write(QJsonDocument(entries).toJson(QJsonDocument::Compact));
+        file.close();
+        const QVariantMap params{{"items", count}, {"bytes", QFileInfo(path).size()}};
+
+        runner.add({QStringLiteral("items/parse/dom/%1").arg(count), params, 1, {}, [path]() {
+            QFile in(path);
+            in.open(QIODevice::ReadOnly);
+            const QJsonArray array = QJsonDocument::fromJson(in.readAll()).array();
+            QVector<ItemSpec> items;
+            items.reserve(array.size());
+            for (const QJsonValue &value : array) {
+                const QJsonObject obj = value.toObject();
+                items.append({QString(), obj.value("plistPath").toString(),
+                              obj.value("valueName").toString(), obj.value("isCritical").toBool(false)});
+            }
+        }, {}});
+
+        runner.add({QStringLiteral("items/parse/stream/%1").arg(count), params, 1, {}, [path, format]() {
+            QFile in(path);
+            in.open(QIODevice::ReadOnly);
+            ItemListResult result = ItemListCache::parse(&in, format);
+            Q_UNUSED(result);
+        }, {}});
+
+        auto source = std::make_shared<FileConfigSource>(path);
+        runner.add({QStringLiteral("items/load/cached/%1").arg(count), params, 1,
+                    [source, format]() { ItemListCache::load(*source, format); },   // warm the cache
+                    [source, format]() {
+                        ItemListResult result = ItemListCache::load(*source, format);
+                        Q_UNUSED(result);
+                    }, {}});
+    }
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// main
+////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char *argv[]) {
+    // A bench never touches the production schema or the user's settings
+    if (!qEnvironmentVariableIsSet("MONITOR_DB_NAME")) {
+        qputenv("MONITOR_DB_NAME", "MonitorBench");
+    }
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("MonitorBench");
+    QCoreApplication::setApplicationName("monitor_bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks of the monitoring hot paths; results are JSON.");
+    parser.addHelpOption();
+    QCommandLineOption outputOpt({"o", "output"}, "Write results to <file> (default: stdout).", "file");
+    QCommandLineOption filterOpt({"f", "filter"}, "Only run cases matching <regex>.", "regex");
+    QCommandLineOption samplesOpt("samples", "Timed samples per case.", "n", "30");
+    QCommandLineOption warmupOpt("warmup", "Untimed warm-up samples per case.", "n", "3");
+    QCommandLineOption seedOpt("seed", "Seed for synthetic data.", "n", "1");
+    QCommandLineOption itemsOpt("items", "Item counts for check/model cases.", "list", "100,1000");
+    QCommandLineOption ratesOpt("rates", "Change rates (%) for check cases.", "list", "0,1,10,100");
+    QCommandLineOption latencyOpt("alert-latency-ms", "Stub AWS endpoint latency.", "ms", "0");
+    QCommandLineOption traceOpt("trace", "Record spans in every case and write a Chrome trace to <file>.", "file");
+    QCommandLineOption listOpt("list", "List the cases that would run and exit.");
+    parser.addOptions({outputOpt, filterOpt, samplesOpt, warmupOpt, seedOpt,
+                       itemsOpt, ratesOpt, latencyOpt, traceOpt, listOpt});
+    parser.process(app);
+
+    // Keep the benchmark's own output readable
+    LoggerConfig logConfig;
+    logConfig.levelSpec = qEnvironmentVariable("MONITOR_LOG", "*=warning");
+    Logger::start(logConfig);
+
+    Aws::SDKOptions awsOptions;
+    Aws::InitAPI(awsOptions);
+
+    BenchRunner::Options options;
+    options.samples = std::max(1, parser.value(samplesOpt).toInt());
+    options.warmup  = std::max(0, parser.value(warmupOpt).toInt());
+    options.filter  = parser.value(filterOpt);
+    options.seed    = parser.value(seedOpt).toUInt();
+
+    BenchContext ctx;
+    ctx.rng.seed(options.seed);
+    ctx.itemCounts     = parseIntList(parser.value(itemsOpt));
+    ctx.ratesPercent   = parseIntList(parser.value(ratesOpt));
+    ctx.alertLatencyMs = parser.value(latencyOpt).toInt();
+    loadBenchKeys(ctx.tempDir, ctx.rng);
+
+    // Database cases need a reachable, disposable schema
+    if (qEnvironmentVariable("MONITOR_DB_NAME") == "MonitorDB") {
+        QTextStream(stderr) << "[BENCH] Refusing to run database cases against MonitorDB.\n";
+    } else if (!parser.isSet(listOpt)) {
+        Database db;
+        ctx.dbAvailable = db.isOpen();
+        if (ctx.dbAvailable) {
+            QSqlQuery(QSqlDatabase::database(Database::connectionNameForCurrentThread()))
+                .exec("TRUNCATE TABLE Changes");
+        }
+    }
+
+    int exitCode = 0;
+    {
+        // Cases own AWS clients and worker threads; release them before shutdown
+        Settings settings;
+        BenchRunner runner(options);
+        addCryptoCases(runner, ctx);
+        addValueCases(runner, ctx);
+        addCheckLoopCases(runner, ctx);
+        addDatabaseCases(runner, ctx);
+        addAlertCases(runner, ctx, settings);
+        addModelCases(runner, ctx);
+        addItemListCases(runner, ctx);
+        addTraceCases(runner, parser.isSet(traceOpt));
+
+        if (parser.isSet(listOpt)) {
+            QTextStream(stdout) << runner.names().join('\n') << '\n';
+        } else {
+            Tracer::setEnabled(parser.isSet(traceOpt));
+            const QByteArray json = QJsonDocument(runner.run()).toJson();
+            if (parser.isSet(traceOpt)) {
+                Tracer::setEnabled(false);
+                QString error;
+                if (!Tracer::exportChromeTrace(parser.value(traceOpt), &error)) {
+                    QTextStream(stderr) << "[BENCH] Cannot write trace: " << error << '\n';
+                    exitCode = 1;
+                }
+            }
+            if (parser.isSet(outputOpt)) {
+                QFile out(parser.value(outputOpt));
+                if (out.open(QIODevice::WriteOnly)) {
+                    out.write(json);
+                } else {
+                    QTextStream(stderr) << "[BENCH] Cannot write " << out.fileName() << '\n';
+                    exitCode = 1;
+                }
+            } else {
+                QTextStream(stdout) << json;
+            }
+        }
+    }
+    Database::releaseThreadConnection();
+
+    Aws::ShutdownAPI(awsOptions);
+    Logger::stop();
+    return exitCode;
+}
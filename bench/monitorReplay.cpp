@@ -0,0 +1,467 @@
+/**
+ * @file monitorReplay.cpp
+ * @brief monitor_replay: feeds recorded change history back through the
+ *        monitoring engine and profiles how the build handles it.
+ *
+ * Usage:
+ *     monitor_replay [--source-schema MonitorDB | --input changes.jsonl[.gz]]
+ *                    [--start 2024-05-01T00:00:00] [--end 2024-05-02T00:00:00]
+ *                    [--config name] [--speed 60] [--max-gap 5m]
+ *                    [--output replay.json] [--baseline previous.json]
+ *                    [--max-regression-percent 20]
+ *
+ * Events come from the Changes table of --source-schema (read over the
+ * scratch connection, so archived rows need an export) or from a
+ * ChangeExport CSV / JSON Lines file. Each event's new value is written
+ * into a MemoryValueStore at its recorded time on a VirtualClock, so the
+ * real engine detects, applies policy and rolls back against memory only.
+ * Rows go to the scratch schema MONITOR_DB_NAME (default "MonitorReplay")
+ * and alerts to a local stub AWS endpoint.
+ *
+ * --speed divides the gaps between events (60 = one hour of history per
+ * virtual minute) and --max-gap caps them; both change how events
+ * coalesce into checks, as a faster storm would. Virtual time costs only
+ * the callbacks it runs, so a day of history replays in seconds.
+ *
+ * The report is one JSON object: detection latency in virtual time
+ * (deterministic), dispatcher lane latency and throughput in wall time,
+ * alert and database volume, and with --baseline a per-metric diff. The
+ * exit code is 3 when a gated metric regressed by more than
+ * --max-regression-percent.
+ */
+
+#include "latencyHistogram.h"
+#include "replaySource.h"
+#include "stubAwsEndpoint.h"
+
+#include "Database.h"
+#include "clock.h"
+#include "configSource.h"
+#include "logger.h"
+#include "settings.h"
+#include "valueStore.h"
+#if defined(Q_OS_MAC)
+#include "MacOSMonitoring.h"
+#elif defined(Q_OS_WIN)
+#include "WindowsMonitoring.h"
+#endif
+
+#include <aws/core/Aws.h>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+#if defined(Q_OS_MAC)
+using Monitor = MacOSMonitoring;
+#elif defined(Q_OS_WIN)
+using Monitor = WindowsMonitoring;
+#endif
+
+// Virtual time after the last event: the 10 s delayed alert plus a few checks
+const qint64 kSettleMs = 15000;
+
+// Wall-time bound on waiting for the dispatcher lanes to drain
+const qint64 kDrainTimeoutMs = 60000;
+
+/**
+ * @brief How a metric is compared against the baseline.
+ *
+ * Virtual-time and volume metrics are deterministic for a given build and
+ * input, so any difference is a behaviour change worth reading; only the
+ * wall-time ones are noisy enough to need a tolerance.
+ */
+enum class Gate { None, HigherIsBetter, LowerIsBetter };
+
+/// "90", "90s", "30m", "4h" -> milliseconds; -1 if malformed.
+qint64 parseDuration(const QString &text) {
+    static const QRegularExpression pattern("^(\\d+)([smh]?)$");
+    const QRegularExpressionMatch match = pattern.match(text.trimmed());
+    if (!match.hasMatch()) {
+        return -1;
+    }
+    const qint64 value = match.captured(1).toLongLong();
+    const QString unit = match.captured(2);
+    return value * (unit == "h" ? 3600000 : unit == "m" ? 60000 : 1000);
+}
+
+/**
+ * @brief Where a config lives in the ValueStore.
+ *
+ * Must match PlistFile::expandedPath() / RegistryKey::fullKey() for the
+ * entries written by itemList().
+ */
+QString locationFor(int index) {
+#if defined(Q_OS_WIN)
+    return QStringLiteral("HKEY_CURRENT_USER\\Software\\MonitorReplay\\item%1").arg(index);
+#else
+    return QStringLiteral("/MonitorReplay/item%1.plist").arg(index);
+#endif
+}
+
+/// Monitored-items JSON for @p configs, critical if any of their events was.
+QByteArray itemList(const QStringList &configs, const QHash<QString, bool> &critical) {
+    QJsonArray list;
+    for (int i = 0; i < configs.size(); ++i) {
+#if defined(Q_OS_WIN)
+        list.append(QJsonObject{
+            {"hive", "HKEY_CURRENT_USER"},
+            {"keyPath", QStringLiteral("Software\\MonitorReplay\\item%1").arg(i)},
+            {"valueName", configs[i]},
+            {"isCritical", critical.value(configs[i])},
+        });
+#else
+        list.append(QJsonObject{
+            {"plistPath", locationFor(i)},
+            {"valueName", configs[i]},
+            {"isCritical", critical.value(configs[i])},
+        });
+#endif
+    }
+    return QJsonDocument(list).toJson(QJsonDocument::Compact);
+}
+
+/// Rows in the scratch schema's Changes table; -1 on error.
+qint64 changeRowCount() {
+    QSqlQuery query(QSqlDatabase::database(Database::connectionNameForCurrentThread()));
+    if (query.exec("SELECT COUNT(*) FROM Changes") && query.next()) {
+        return query.value(0).toLongLong();
+    }
+    return -1;
+}
+
+/// @return Sum of "pending" over all lanes of @p stats.
+int pendingWork(const QVariantMap &stats) {
+    int pending = 0;
+    for (const QVariant &lane : stats) {
+        pending += lane.toMap().value("pending").toInt();
+    }
+    return pending;
+}
+
+/**
+ * @brief Compare @p current with @p baseline metric by metric.
+ * @param regressionPercent Tolerance for gated metrics (<= 0 disables the gate).
+ * @param regressions       Names of gated metrics beyond the tolerance.
+ */
+QJsonObject diffMetrics(const QJsonObject &baseline, const QJsonObject &current,
+                        const QHash<QString, Gate> &gates, double regressionPercent,
+                        QStringList *regressions) {
+    QJsonObject diff;
+    for (auto it = current.begin(); it != current.end(); ++it) {
+        if (!baseline.contains(it.key())) {
+            continue;
+        }
+        const double before = baseline.value(it.key()).toDouble();
+        const double after = it.value().toDouble();
+        const double percent = before != 0.0 ? (after - before) / std::abs(before) * 100.0 : 0.0;
+        diff[it.key()] = QJsonObject{
+            {"baseline", before},
+            {"current", after},
+            {"delta", after - before},
+            {"percent", percent},
+        };
+
+        const Gate gate = gates.value(it.key(), Gate::None);
+        const bool worse = (gate == Gate::HigherIsBetter && percent < -regressionPercent)
+                        || (gate == Gate::LowerIsBetter && percent > regressionPercent);
+        if (regressionPercent > 0.0 && worse) {
+            *regressions << it.key();
+        }
+    }
+    return diff;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    // Replays write rows and send alerts; never into the production schema
+    if (!qEnvironmentVariableIsSet("MONITOR_DB_NAME")) {
+        qputenv("MONITOR_DB_NAME", "MonitorReplay");
+    }
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("MonitorReplay");
+    QCoreApplication::setApplicationName("monitor_replay");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replay recorded changes through the monitoring engine.");
+    parser.addHelpOption();
+    QCommandLineOption schemaOpt("source-schema", "Schema whose Changes table is replayed.", "name", "MonitorDB");
+    QCommandLineOption inputOpt({"i", "input"}, "ChangeExport file (.csv/.jsonl, optionally .gz) instead of a schema.", "file");
+    QCommandLineOption startOpt("start", "First timestamp (ISO 8601).", "time");
+    QCommandLineOption endOpt("end", "Last timestamp (ISO 8601).", "time");
+    QCommandLineOption configOpt("config", "Only this config_name.", "name");
+    QCommandLineOption speedOpt("speed", "Divide gaps between events by this factor.", "x", "1");
+    QCommandLineOption maxGapOpt("max-gap", "Cap gaps between events, e.g. 30s, 5m (0 = off).", "time", "0");
+    QCommandLineOption outputOpt({"o", "output"}, "JSON report (default: stdout).", "file");
+    QCommandLineOption baselineOpt("baseline", "Earlier report to diff against.", "file");
+    QCommandLineOption regressionOpt("max-regression-percent",
+                                     "Fail when a wall-time metric is this much worse than the baseline (0 = off).",
+                                     "pct", "0");
+    QCommandLineOption latencyOpt("alert-latency-ms", "Stub AWS endpoint latency.", "ms", "0");
+    parser.addOptions({schemaOpt, inputOpt, startOpt, endOpt, configOpt, speedOpt, maxGapOpt,
+                       outputOpt, baselineOpt, regressionOpt, latencyOpt});
+    parser.process(app);
+
+#if !defined(Q_OS_MAC) && !defined(Q_OS_WIN)
+    QTextStream(stderr) << "[REPLAY] No monitoring engine on this platform.\n";
+    return 2;
+#else
+    if (qEnvironmentVariable("MONITOR_DB_NAME") == "MonitorDB") {
+        QTextStream(stderr) << "[REPLAY] Refusing to replay into MonitorDB; set MONITOR_DB_NAME.\n";
+        return 2;
+    }
+    const double speed = parser.value(speedOpt).toDouble();
+    const qint64 maxGapMs = parseDuration(parser.value(maxGapOpt));
+    if (speed <= 0.0 || maxGapMs < 0) {
+        QTextStream(stderr) << "[REPLAY] Invalid --speed or --max-gap.\n";
+        return 2;
+    }
+
+    ReplayFilter filter;
+    filter.start      = QDateTime::fromString(parser.value(startOpt), Qt::ISODate);
+    filter.end        = QDateTime::fromString(parser.value(endOpt), Qt::ISODate);
+    filter.configName = parser.value(configOpt);
+
+    QJsonObject baseline;
+    if (parser.isSet(baselineOpt)) {
+        QFile file(parser.value(baselineOpt));
+        if (!file.open(QIODevice::ReadOnly)) {
+            QTextStream(stderr) << "[REPLAY] Cannot read " << file.fileName() << '\n';
+            return 2;
+        }
+        baseline = QJsonDocument::fromJson(file.readAll()).object().value("metrics").toObject();
+    }
+
+    QTemporaryDir workDir;
+    if (!workDir.isValid()) {
+        QTextStream(stderr) << "[REPLAY] Cannot create a work directory.\n";
+        return 2;
+    }
+
+    LoggerConfig logConfig;
+    logConfig.filePath  = workDir.filePath("monitor.log");
+    logConfig.levelSpec = qEnvironmentVariable("MONITOR_LOG", "*=warning");
+    Logger::start(logConfig);
+
+    Aws::SDKOptions awsOptions;
+    Aws::InitAPI(awsOptions);
+
+    int exitCode = 0;
+    {
+        // Load the history before anything runs on the virtual clock
+        QString error;
+        QVector<ChangeRow> events;
+        Database db;
+        if (!db.isOpen()) {
+            QTextStream(stderr) << "[REPLAY] Database unavailable.\n";
+            exitCode = 2;
+        } else if (parser.isSet(inputOpt)) {
+            events = ReplaySource::fromFile(parser.value(inputOpt), filter, &error);
+        } else {
+            events = ReplaySource::fromDatabase(parser.value(schemaOpt), filter, &error);
+        }
+        if (exitCode == 0 && (!error.isEmpty() || events.isEmpty())) {
+            QTextStream(stderr) << "[REPLAY] No events to replay" << (error.isEmpty() ? "" : ": ")
+                                << error << '\n';
+            exitCode = 2;
+        }
+
+        StubAwsEndpoint stub(parser.value(latencyOpt).toInt());
+        if (exitCode == 0 && !stub.start()) {
+            QTextStream(stderr) << "[REPLAY] Cannot start the stub AWS endpoint.\n";
+            exitCode = 2;
+        }
+        QFile aws(workDir.filePath("awsconfig.json"));
+        aws.open(QIODevice::WriteOnly);
+        aws.write(QJsonDocument(QJsonObject{
+            {"accessKeyId", "REPLAYKEY"},
+            {"secretAccessKey", "REPLAYSECRET"},
+            {"region", "us-east-1"},
+            {"endpoint", stub.url()},
+        }).toJson());
+        aws.close();
+        qputenv("MONITOR_AWS_CONFIG", aws.fileName().toUtf8());
+
+        QFile outFile;
+        if (parser.isSet(outputOpt)) {
+            outFile.setFileName(parser.value(outputOpt));
+            if (!outFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                QTextStream(stderr) << "[REPLAY] Cannot write " << outFile.fileName() << '\n';
+                exitCode = 2;
+            }
+        } else {
+            outFile.open(stdout, QIODevice::WriteOnly);
+        }
+
+        if (exitCode == 0) {
+            // One item per config, starting at the value its first event replaced
+            QStringList configs;
+            QHash<QString, int> indexOf;
+            QHash<QString, bool> critical;
+            MemoryValueStore store;
+            for (const ChangeRow &event : std::as_const(events)) {
+                if (!indexOf.contains(event.configName)) {
+                    indexOf.insert(event.configName, configs.size());
+                    store.put(locationFor(configs.size()), event.configName, event.oldValue);
+                    configs << event.configName;
+                }
+                critical[event.configName] = critical.value(event.configName) || event.critical;
+            }
+
+            // Virtual time starts at the first event so rows keep their dates
+            const QDateTime firstAt = events.first().timestamp;
+            VirtualClock clock(firstAt);
+            Clock::setInstance(&clock);
+            ValueStore::setInstance(&store);
+
+            Settings settings;
+            db.insertOrUpdateUserSettings("replay@example.com", "+15550100000", 0,
+                                          settings.getNotificationFrequency());
+            const qint64 rowsBefore = changeRowCount();
+
+            MemoryConfigSource source(itemList(configs, critical));
+            LatencyHistogram detection;
+            QHash<QString, qint64> pendingSince;   ///< config → virtual ms of the first unseen write
+            qint64 changesRecorded = 0;
+            qint64 unmatched = 0;
+            qint64 criticalDetections = 0;
+            {
+                Monitor monitor(&settings, &source);
+                // Baselines are read in the background; replay starts from all of them
+                monitor.waitForBaselines();
+                QObject::connect(&monitor, &MonitoringBase::changeRecorded, &monitor,
+                                 [&](const QString &configName, const QDateTime &at) {
+                                     ++changesRecorded;
+                                     const auto it = pendingSince.find(configName);
+                                     if (it == pendingSince.end()) {
+                                         ++unmatched;
+                                         return;
+                                     }
+                                     detection.record((at.toMSecsSinceEpoch() - *it) * 1000);
+                                     pendingSince.erase(it);
+                                 });
+                QObject::connect(&monitor, &Monitor::criticalChangeDetected, &monitor,
+                                 [&criticalDetections]() { ++criticalDetections; });
+
+                QElapsedTimer wall;
+                wall.start();
+                monitor.startMonitoring();
+
+                qint64 virtualMs = firstAt.toMSecsSinceEpoch();
+                QDateTime previousAt = firstAt;
+                for (const ChangeRow &event : std::as_const(events)) {
+                    qint64 gapMs = previousAt.msecsTo(event.timestamp);
+                    if (maxGapMs > 0) {
+                        gapMs = std::min(gapMs, maxGapMs);
+                    }
+                    virtualMs += qint64(std::llround(gapMs / speed));
+                    previousAt = event.timestamp;
+
+                    clock.advanceTo(QDateTime::fromMSecsSinceEpoch(virtualMs));
+                    store.put(locationFor(indexOf.value(event.configName)), event.configName, event.newValue);
+                    if (!pendingSince.contains(event.configName)) {
+                        pendingSince.insert(event.configName, virtualMs);
+                    }
+                    QCoreApplication::processEvents();
+                }
+                clock.advance(kSettleMs);
+
+                // Let persistence and alerts finish in wall time
+                QElapsedTimer drain;
+                drain.start();
+                while (pendingWork(monitor.laneStats()) > 0 && drain.elapsed() < kDrainTimeoutMs) {
+                    QCoreApplication::processEvents();
+                    QThread::msleep(5);
+                }
+                QCoreApplication::processEvents();
+                const qint64 wallMs = std::max<qint64>(1, wall.elapsed());
+                monitor.stopMonitoring();
+
+                const QVariantMap lanes = monitor.laneStats();
+                const qint64 rowsAfter = changeRowCount();
+
+                QJsonObject metrics{
+                    {"events",             qint64(events.size())},
+                    {"items",              qint64(configs.size())},
+                    {"wallSec",            wallMs / 1000.0},
+                    {"eventsPerSec",       events.size() * 1000.0 / wallMs},
+                    {"changesRecorded",    changesRecorded},
+                    {"coalescedEvents",    qint64(events.size()) - changesRecorded + unmatched},
+                    {"criticalDetections", criticalDetections},
+                    {"alertsSent",         stub.requestCount()},
+                    {"changeRowsWritten",  rowsBefore >= 0 && rowsAfter >= 0 ? rowsAfter - rowsBefore : -1},
+                    {"itemWrites",         store.engineWrites()},
+                    {"detectP50Ms",        detection.percentile(50.0) / 1000.0},
+                    {"detectP99Ms",        detection.percentile(99.0) / 1000.0},
+                };
+                QHash<QString, Gate> gates{
+                    {"wallSec",      Gate::LowerIsBetter},
+                    {"eventsPerSec", Gate::HigherIsBetter},
+                };
+                for (auto it = lanes.begin(); it != lanes.end(); ++it) {
+                    const QString name = QStringLiteral("lane.%1.p99Ms").arg(it.key());
+                    metrics[name] = it.value().toMap().value("p99Ms").toDouble();
+                    gates.insert(name, Gate::LowerIsBetter);
+                }
+
+                QJsonObject report{
+                    {"type",               "replay"},
+                    {"source",             parser.isSet(inputOpt) ? parser.value(inputOpt)
+                                                                  : parser.value(schemaOpt)},
+                    {"firstEvent",         firstAt.toString(Qt::ISODate)},
+                    {"lastEvent",          events.last().timestamp.toString(Qt::ISODate)},
+                    {"speed",              speed},
+                    {"maxGapSec",          maxGapMs / 1000.0},
+                    {"virtualDurationSec", (virtualMs - firstAt.toMSecsSinceEpoch() + kSettleMs) / 1000.0},
+                    {"undetected",         qint64(pendingSince.size())},
+                    {"detectionLatency",   detection.toJson()},
+                    {"lanes",              QJsonObject::fromVariantMap(lanes)},
+                    {"metrics",            metrics},
+                };
+                if (!baseline.isEmpty()) {
+                    QStringList regressions;
+                    report["diff"] = diffMetrics(baseline, metrics, gates,
+                                                 parser.value(regressionOpt).toDouble(), &regressions);
+                    report["regressions"] = QJsonArray::fromStringList(regressions);
+                    if (!regressions.isEmpty()) {
+                        QTextStream(stderr) << "[REPLAY] Regressed: " << regressions.join(", ") << '\n';
+                        exitCode = 3;
+                    }
+                }
+
+                outFile.write(QJsonDocument(report).toJson());
+                outFile.flush();
+                QTextStream(stderr) << QStringLiteral("[REPLAY] %1 events in %2s (%3/s), %4 changes, %5 alerts\n")
+                                       .arg(events.size())
+                                       .arg(wallMs / 1000.0, 0, 'f', 2)
+                                       .arg(events.size() * 1000.0 / wallMs, 0, 'f', 1)
+                                       .arg(changesRecorded)
+                                       .arg(stub.requestCount());
+            }
+
+            ValueStore::setInstance(nullptr);
+            Clock::setInstance(nullptr);
+        }
+    }
+    Database::releaseThreadConnection();
+
+    Aws::ShutdownAPI(awsOptions);
+    Logger::stop();
+    return exitCode;
+#endif
+}
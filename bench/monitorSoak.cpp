@@ -0,0 +1,512 @@
+/**
+ * @file monitorSoak.cpp
+ * @brief monitor_soak: drives the monitoring engine with synthetic change
+ *        storms for hours and records how it holds up.
+ *
+ * Usage:
+ *     monitor_soak [--duration 4h] [--items 5000] [--rate 200]
+ *                  [--distribution uniform|zipf] [--zipf-exponent 1.1]
+ *                  [--storm-every 600] [--storm-percent 80]
+ *                  [--flap-items 5] [--flap-period-ms 200]
+ *                  [--critical-percent 1] [--critical-rate 0] [--sample-interval 10]
+ *                  [--output soak.jsonl] [--max-rss-growth-mb-per-hour N]
+ *                  [--max-handle-growth-per-hour N] [--max-rollback-p99-ms N]
+ *                  [--scenario rollback-under-load]
+ *
+ * The real engine (MacOSMonitoring / WindowsMonitoring) monitors items the
+ * WorkloadGenerator creates; alerts go to a local stub AWS endpoint and
+ * rows to MONITOR_DB_NAME (default "MonitorSoak"). Every sample interval
+ * one JSON line is written with throughput, write-to-detection latency
+ * percentiles, RSS, open handles, threads, dispatcher lane stats, the
+ * check-cycle watchdog's overrun counters, resource-governor usage and
+ * budget compliance, and database size; a final "summary" line adds growth slopes over the run.
+ * The exit code is 3 when a growth limit was exceeded. MONITOR_CPU_CAP_PERCENT
+ * and MONITOR_IOPS_CAP apply the same resource budget as the application.
+ *
+ * The "rollback-under-load" scenario checks that critical rollbacks are
+ * not held up by non-critical work: 100k non-critical changes per minute,
+ * 1% of the items critical and tampered with 5 times per second, and a
+ * rollback lane p99 bound of kRollbackP99BoundMs. Options given explicitly
+ * override the scenario's values. The worst rollback p99 of any sample
+ * after warm-up is compared with --max-rollback-p99-ms; exceeding it, or
+ * running no rollback at all, exits with 3.
+ */
+
+#include "latencyHistogram.h"
+#include "processStats.h"
+#include "stubAwsEndpoint.h"
+#include "workloadGenerator.h"
+
+#include "changeDispatcher.h"
+#include "Database.h"
+#include "logger.h"
+#include "resourceGovernor.h"
+#include "settings.h"
+#if defined(Q_OS_MAC)
+#include "MacOSMonitoring.h"
+#elif defined(Q_OS_WIN)
+#include "WindowsMonitoring.h"
+#endif
+
+#include <aws/core/Aws.h>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimer>
+#include <algorithm>
+#include <memory>
+#include <random>
+
+namespace {
+
+/// Rollback lane p99 the rollback-under-load scenario must stay within.
+const double kRollbackP99BoundMs = 250.0;
+
+#if defined(Q_OS_MAC)
+using Monitor = MacOSMonitoring;
+#elif defined(Q_OS_WIN)
+using Monitor = WindowsMonitoring;
+#endif
+
+/// "90", "90s", "30m", "4h" -> milliseconds; -1 if malformed.
+qint64 parseDuration(const QString &text) {
+    static const QRegularExpression pattern("^(\\d+)([smh]?)$");
+    const QRegularExpressionMatch match = pattern.match(text.trimmed());
+    if (!match.hasMatch()) {
+        return -1;
+    }
+    const qint64 value = match.captured(1).toLongLong();
+    const QString unit = match.captured(2);
+    return value * (unit == "h" ? 3600000 : unit == "m" ? 60000 : 1000);
+}
+
+/**
+ * @brief Size of the soak schema's tables.
+ *
+ * information_schema statistics are cached for a day by default; expiry 0
+ * makes every sample current.
+ */
+QJsonObject databaseSize() {
+    QSqlQuery query(QSqlDatabase::database(Database::connectionNameForCurrentThread()));
+    query.exec("SET SESSION information_schema_stats_expiry = 0");
+    QJsonObject tables;
+    qint64 totalBytes = 0;
+    if (query.exec("SELECT TABLE_NAME, TABLE_ROWS, DATA_LENGTH + INDEX_LENGTH "
+                   "FROM information_schema.TABLES WHERE TABLE_SCHEMA = DATABASE()")) {
+        while (query.next()) {
+            const qint64 bytes = query.value(2).toLongLong();
+            totalBytes += bytes;
+            tables[query.value(0).toString()] = QJsonObject{
+                {"rows", query.value(1).toLongLong()},
+                {"bytes", bytes},
+            };
+        }
+    }
+    return QJsonObject{{"bytes", totalBytes}, {"tables", tables}};
+}
+
+/// Least-squares slope of @p ys over @p xs; 0 with fewer than two points.
+double slope(const QVector<double> &xs, const QVector<double> &ys) {
+    const int n = xs.size();
+    if (n < 2) {
+        return 0.0;
+    }
+    double mx = 0.0, my = 0.0;
+    for (int i = 0; i < n; ++i) {
+        mx += xs[i];
+        my += ys[i];
+    }
+    mx /= n;
+    my /= n;
+    double num = 0.0, den = 0.0;
+    for (int i = 0; i < n; ++i) {
+        num += (xs[i] - mx) * (ys[i] - my);
+        den += (xs[i] - mx) * (xs[i] - mx);
+    }
+    return den > 0.0 ? num / den : 0.0;
+}
+
+/**
+ * @brief Collects samples while the run is in progress.
+ */
+class SoakRecorder {
+public:
+    SoakRecorder(WorkloadGenerator &generator, Monitor &monitor, QTextStream &out)
+        : m_generator(generator), m_monitor(monitor), m_out(out) {
+        m_clock.start();
+    }
+
+    /// The monitor queued a Changes row for @p valueName.
+    void onChange(const QString &valueName) {
+        ++m_changes;
+        const qint64 us = m_generator.observe(valueName);
+        if (us >= 0) {
+            m_interval.record(us);
+        } else {
+            ++m_unmatched;
+        }
+    }
+
+    /// Emit one sample line covering the time since the previous one.
+    void sample() {
+        const qint64 nowMs = m_clock.elapsed();
+        const double seconds = std::max<qint64>(1, nowMs - m_lastMs) / 1000.0;
+        const qint64 writes = m_generator.writes();
+        const qint64 rss = ProcessStats::residentBytes();
+        const int handles = ProcessStats::openHandles();
+        const QJsonObject db = databaseSize();
+
+        m_total.merge(m_interval);
+        const double hours = nowMs / 3600000.0;
+        m_hours << hours;
+        m_rssMb << rss / 1048576.0;
+        m_handles << handles;
+        m_dbMb << db["bytes"].toDouble() / 1048576.0;
+
+        const QVariantMap lanes = m_monitor.laneStats();
+        const QVariantMap rollback = lanes.value(ChangeDispatcher::laneName(ChangeLane::Rollback)).toMap();
+        m_rollbackP99Ms << rollback.value("p99Ms").toDouble();
+        m_rollbacks = rollback.value("completed").toLongLong();
+
+        const QJsonObject line{
+            {"type",           "sample"},
+            {"time",           QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs)},
+            {"elapsedSec",     nowMs / 1000.0},
+            {"writesPerSec",   (writes - m_lastWrites) / seconds},
+            {"changesPerSec",  (m_changes - m_lastChanges) / seconds},
+            {"unobserved",     m_generator.unobserved()},
+            {"unmatched",      m_unmatched},
+            {"storms",         m_generator.storms()},
+            {"tampers",        m_generator.tampers()},
+            {"latency",        m_interval.toJson()},
+            {"rssBytes",       rss},
+            {"openHandles",    handles},
+            {"threads",        ProcessStats::threadCount()},
+            {"lanes",          QJsonObject::fromVariantMap(lanes)},
+            {"watchdog",       QJsonObject::fromVariantMap(m_monitor.watchdog()->stats())},
+            {"governor",       QJsonObject::fromVariantMap(ResourceGovernor::instance()->stats())},
+            {"database",       db},
+        };
+        m_out << QJsonDocument(line).toJson(QJsonDocument::Compact) << '\n';
+        m_out.flush();
+
+        QTextStream(stderr) << QStringLiteral("[SOAK] %1s writes/s=%2 changes/s=%3 p99=%4ms rollback p99=%5ms rss=%6MB handles=%7\n")
+                               .arg(nowMs / 1000)
+                               .arg((writes - m_lastWrites) / seconds, 0, 'f', 1)
+                               .arg((m_changes - m_lastChanges) / seconds, 0, 'f', 1)
+                               .arg(m_interval.percentile(99.0) / 1000.0, 0, 'f', 1)
+                               .arg(m_rollbackP99Ms.last(), 0, 'f', 1)
+                               .arg(rss / 1048576.0, 0, 'f', 1)
+                               .arg(handles);
+
+        m_interval.reset();
+        m_lastMs = nowMs;
+        m_lastWrites = writes;
+        m_lastChanges = m_changes;
+    }
+
+    /**
+     * @brief Write the summary line.
+     * @param warmupFraction Leading share of samples left out of the slopes
+     *                       (caches, pools and connections fill up first).
+     * @return The summary, including growth per hour of RSS, handles and
+     *         database size, and the worst rollback lane p99 of any sample.
+     */
+    QJsonObject summarize(double warmupFraction) {
+        const int skip = int(m_hours.size() * warmupFraction);
+        auto tail = [skip](const QVector<double> &v) { return v.mid(skip); };
+        const QVector<double> hours = tail(m_hours);
+        const QVector<double> rollbackP99 = tail(m_rollbackP99Ms);
+
+        const QJsonObject summary{
+            {"type",                    "summary"},
+            {"durationSec",             m_clock.elapsed() / 1000.0},
+            {"writes",                  m_generator.writes()},
+            {"changes",                 m_changes},
+            {"unmatched",               m_unmatched},
+            {"storms",                  m_generator.storms()},
+            {"flaps",                   m_generator.flaps()},
+            {"tampers",                 m_generator.tampers()},
+            {"rollbacks",               m_rollbacks},
+            {"rollbackP99Ms",           rollbackP99.isEmpty() ? 0.0
+                                        : *std::max_element(rollbackP99.begin(), rollbackP99.end())},
+            {"latency",                 m_total.toJson()},
+            {"rssGrowthMbPerHour",      slope(hours, tail(m_rssMb))},
+            {"handleGrowthPerHour",     slope(hours, tail(m_handles))},
+            {"databaseGrowthMbPerHour", slope(hours, tail(m_dbMb))},
+            {"peakRssBytes",            m_rssMb.isEmpty() ? 0.0
+                                        : *std::max_element(m_rssMb.begin(), m_rssMb.end()) * 1048576.0},
+        };
+        m_out << QJsonDocument(summary).toJson(QJsonDocument::Compact) << '\n';
+        m_out.flush();
+        return summary;
+    }
+
+private:
+    WorkloadGenerator &m_generator;
+    Monitor           &m_monitor;
+    QTextStream       &m_out;
+    QElapsedTimer      m_clock;
+    LatencyHistogram   m_interval;
+    LatencyHistogram   m_total;
+    qint64             m_changes = 0;
+    qint64             m_unmatched = 0;
+    qint64             m_lastMs = 0;
+    qint64             m_lastWrites = 0;
+    qint64             m_lastChanges = 0;
+    qint64             m_rollbacks = 0;
+    QVector<double>    m_hours, m_rssMb, m_handles, m_dbMb;
+    QVector<double>    m_rollbackP99Ms;   ///< Rollback lane p99 at each sample
+};
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    // Never soak the production schema or the user's settings
+    if (!qEnvironmentVariableIsSet("MONITOR_DB_NAME")) {
+        qputenv("MONITOR_DB_NAME", "MonitorSoak");
+    }
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("MonitorSoak");
+    QCoreApplication::setApplicationName("monitor_soak");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Soak test: synthetic change storms against the monitoring engine.");
+    parser.addHelpOption();
+    QCommandLineOption durationOpt("duration", "Run time, e.g. 600s, 30m, 4h.", "time", "1h");
+    QCommandLineOption itemsOpt("items", "Synthetic items.", "n", "1000");
+    QCommandLineOption criticalOpt("critical-percent", "Items marked critical.", "pct", "0");
+    QCommandLineOption rateOpt("rate", "Background mutations per second.", "n", "50");
+    QCommandLineOption distOpt("distribution", "Background item choice: uniform or zipf.", "name", "uniform");
+    QCommandLineOption zipfOpt("zipf-exponent", "Zipf skew.", "s", "1.1");
+    QCommandLineOption stormEveryOpt("storm-every", "Seconds between storms (0 = none).", "sec", "0");
+    QCommandLineOption stormPctOpt("storm-percent", "Items changed per storm.", "pct", "50");
+    QCommandLineOption flapItemsOpt("flap-items", "Items flapping between two values.", "n", "0");
+    QCommandLineOption flapPeriodOpt("flap-period-ms", "Flap period.", "ms", "250");
+    QCommandLineOption intervalOpt("sample-interval", "Seconds between samples.", "sec", "10");
+    QCommandLineOption outputOpt({"o", "output"}, "JSON Lines output (default: stdout).", "file");
+    QCommandLineOption latencyOpt("alert-latency-ms", "Stub AWS endpoint latency.", "ms", "50");
+    QCommandLineOption seedOpt("seed", "Seed for the workload.", "n", "1");
+    QCommandLineOption maxRssOpt("max-rss-growth-mb-per-hour", "Fail above this RSS slope (0 = off).", "mb", "0");
+    QCommandLineOption maxHandlesOpt("max-handle-growth-per-hour", "Fail above this handle slope (0 = off).", "n", "0");
+    QCommandLineOption criticalRateOpt("critical-rate", "Writes per second to critical items (0 = none).", "n", "0");
+    QCommandLineOption maxRollbackOpt("max-rollback-p99-ms", "Fail above this rollback lane p99 (0 = off).", "ms", "0");
+    QCommandLineOption scenarioOpt("scenario", "Preset: rollback-under-load.", "name");
+    parser.addOptions({durationOpt, itemsOpt, criticalOpt, rateOpt, distOpt, zipfOpt,
+                       stormEveryOpt, stormPctOpt, flapItemsOpt, flapPeriodOpt, intervalOpt,
+                       outputOpt, latencyOpt, seedOpt, maxRssOpt, maxHandlesOpt,
+                       criticalRateOpt, maxRollbackOpt, scenarioOpt});
+    parser.process(app);
+
+#if !defined(Q_OS_MAC) && !defined(Q_OS_WIN)
+    QTextStream(stderr) << "[SOAK] No monitoring engine on this platform.\n";
+    return 2;
+#else
+    const qint64 durationMs = parseDuration(parser.value(durationOpt));
+    if (durationMs <= 0) {
+        QTextStream(stderr) << "[SOAK] Invalid --duration.\n";
+        return 2;
+    }
+    if (qEnvironmentVariable("MONITOR_DB_NAME") == "MonitorDB") {
+        QTextStream(stderr) << "[SOAK] Refusing to soak MonitorDB; set MONITOR_DB_NAME.\n";
+        return 2;
+    }
+
+    // Scenario presets fill in what the command line leaves unset
+    auto option = [&parser](const QCommandLineOption &opt, const QString &preset) {
+        return parser.isSet(opt) ? parser.value(opt) : preset;
+    };
+    const QString scenario = parser.value(scenarioOpt);
+    const bool rollbackUnderLoad = scenario == "rollback-under-load";
+    if (!scenario.isEmpty() && !rollbackUnderLoad) {
+        QTextStream(stderr) << "[SOAK] Unknown --scenario " << scenario << ".\n";
+        return 2;
+    }
+
+    WorkloadOptions workload;
+    workload.items           = std::max(1, parser.value(itemsOpt).toInt());
+    workload.criticalPercent = std::clamp(option(criticalOpt, rollbackUnderLoad ? "1" : "0").toInt(), 0, 100);
+    workload.rate            = std::max(0.0, option(rateOpt, rollbackUnderLoad ? "1667" : "50").toDouble());
+    workload.criticalRate    = std::max(0.0, option(criticalRateOpt, rollbackUnderLoad ? "5" : "0").toDouble());
+    workload.distribution    = parser.value(distOpt) == "zipf" ? WorkloadOptions::Zipf : WorkloadOptions::Uniform;
+    workload.zipfExponent    = parser.value(zipfOpt).toDouble();
+    workload.stormEverySec   = std::max(0, parser.value(stormEveryOpt).toInt());
+    workload.stormPercent    = std::clamp(parser.value(stormPctOpt).toInt(), 0, 100);
+    workload.flapItems       = std::max(0, parser.value(flapItemsOpt).toInt());
+    workload.flapPeriodMs    = std::max(1, parser.value(flapPeriodOpt).toInt());
+    workload.seed            = parser.value(seedOpt).toUInt();
+    const double maxRollbackP99 = option(maxRollbackOpt, rollbackUnderLoad ? QString::number(kRollbackP99BoundMs)
+                                                                           : "0").toDouble();
+    if (maxRollbackP99 > 0.0 && (workload.criticalPercent == 0 || workload.criticalRate <= 0.0)) {
+        QTextStream(stderr) << "[SOAK] --max-rollback-p99-ms needs --critical-percent and --critical-rate.\n";
+        return 2;
+    }
+
+    QTemporaryDir workDir;
+    if (!workDir.isValid()) {
+        QTextStream(stderr) << "[SOAK] Cannot create a work directory.\n";
+        return 2;
+    }
+
+    LoggerConfig logConfig;
+    logConfig.filePath  = workDir.filePath("monitor.log");
+    logConfig.levelSpec = qEnvironmentVariable("MONITOR_LOG", "*=warning");
+    Logger::start(logConfig);
+
+    Aws::SDKOptions awsOptions;
+    Aws::InitAPI(awsOptions);
+
+    int exitCode = 0;
+    {
+        // Throwaway keys, stub AWS endpoint and synthetic items
+        std::mt19937 rng(workload.seed);
+        QByteArray key(32, Qt::Uninitialized), iv(16, Qt::Uninitialized);
+        for (char &c : key) c = char(rng() & 0xff);
+        for (char &c : iv) c = char(rng() & 0xff);
+        QFile keys(workDir.filePath("encryptionKeys.json"));
+        keys.open(QIODevice::WriteOnly);
+        keys.write(QJsonDocument(QJsonObject{
+            {"key", QString::fromLatin1(key.toBase64())},
+            {"iv",  QString::fromLatin1(iv.toBase64())},
+        }).toJson());
+        keys.close();
+        qputenv("MONITOR_ENCRYPTION_KEYS", keys.fileName().toUtf8());
+
+        StubAwsEndpoint stub(parser.value(latencyOpt).toInt());
+        if (!stub.start()) {
+            QTextStream(stderr) << "[SOAK] Cannot start the stub AWS endpoint.\n";
+            exitCode = 2;
+        }
+        QFile aws(workDir.filePath("awsconfig.json"));
+        aws.open(QIODevice::WriteOnly);
+        aws.write(QJsonDocument(QJsonObject{
+            {"accessKeyId", "SOAKKEY"},
+            {"secretAccessKey", "SOAKSECRET"},
+            {"region", "us-east-1"},
+            {"endpoint", stub.url()},
+        }).toJson());
+        aws.close();
+        qputenv("MONITOR_AWS_CONFIG", aws.fileName().toUtf8());
+
+        WorkloadGenerator generator(workload, workDir.path());
+        const QString itemList = generator.prepare();
+        if (itemList.isEmpty()) {
+            QTextStream(stderr) << "[SOAK] Cannot create synthetic items.\n";
+            exitCode = 2;
+        }
+        qputenv("MONITOR_ITEMS_CONFIG", itemList.toUtf8());
+
+        QFile outFile;
+        if (parser.isSet(outputOpt)) {
+            outFile.setFileName(parser.value(outputOpt));
+            if (!outFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                QTextStream(stderr) << "[SOAK] Cannot write " << outFile.fileName() << '\n';
+                exitCode = 2;
+            }
+        } else {
+            outFile.open(stdout, QIODevice::WriteOnly);
+        }
+
+        // Alert recipients come from UserSettings
+        Settings settings;
+        if (exitCode == 0) {
+            Database db;
+            if (db.isOpen()) {
+                db.insertOrUpdateUserSettings("soak@example.com", "+15550100000", 0,
+                                              settings.getNotificationFrequency());
+            } else {
+                QTextStream(stderr) << "[SOAK] Database unavailable.\n";
+                exitCode = 2;
+            }
+        }
+
+        if (exitCode == 0) {
+            ResourceGovernor governor(ResourceBudget::fromEnvironment());
+            ResourceGovernor::setInstance(&governor);
+            governor.start();
+
+            Monitor monitor(&settings);
+            monitor.waitForBaselines();
+            QTextStream out(&outFile);
+            SoakRecorder recorder(generator, monitor, out);
+            QObject::connect(&monitor, &MonitoringBase::changeRecorded, &monitor,
+                             [&recorder](const QString &configName, const QDateTime &) {
+                                 recorder.onChange(configName);
+                             });
+
+            out << QJsonDocument(QJsonObject{
+                {"type", "start"},
+                {"time", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+                {"durationSec", durationMs / 1000.0},
+                {"items", workload.items},
+                {"scenario", scenario},
+                {"criticalPercent", workload.criticalPercent},
+                {"criticalRate", workload.criticalRate},
+                {"maxRollbackP99Ms", maxRollbackP99},
+                {"rate", workload.rate},
+                {"distribution", parser.value(distOpt)},
+                {"stormEverySec", workload.stormEverySec},
+                {"stormPercent", workload.stormPercent},
+                {"flapItems", workload.flapItems},
+                {"flapPeriodMs", workload.flapPeriodMs},
+                {"seed", qint64(workload.seed)},
+            }).toJson(QJsonDocument::Compact) << '\n';
+
+            QTimer sampler;
+            sampler.setInterval(std::max(1, parser.value(intervalOpt).toInt()) * 1000);
+            QObject::connect(&sampler, &QTimer::timeout, [&recorder]() { recorder.sample(); });
+
+            monitor.startMonitoring();
+            generator.start();
+            sampler.start();
+
+            // Stop writing, give the monitor a few cycles to catch up, then report
+            QTimer::singleShot(durationMs, &app, [&generator]() { generator.stop(); });
+            QTimer::singleShot(durationMs + 5000, &app, [&app]() { app.quit(); });
+            app.exec();
+
+            sampler.stop();
+            monitor.stopMonitoring();
+            recorder.sample();
+            const QJsonObject summary = recorder.summarize(0.1);
+
+            const double maxRss = parser.value(maxRssOpt).toDouble();
+            const double maxHandles = parser.value(maxHandlesOpt).toDouble();
+            if (maxRss > 0.0 && summary["rssGrowthMbPerHour"].toDouble() > maxRss) {
+                QTextStream(stderr) << "[SOAK] RSS grows faster than " << maxRss << " MB/h.\n";
+                exitCode = 3;
+            }
+            if (maxHandles > 0.0 && summary["handleGrowthPerHour"].toDouble() > maxHandles) {
+                QTextStream(stderr) << "[SOAK] Handles grow faster than " << maxHandles << "/h.\n";
+                exitCode = 3;
+            }
+            if (maxRollbackP99 > 0.0) {
+                const double rollbackP99 = summary["rollbackP99Ms"].toDouble();
+                if (summary["rollbacks"].toInteger() == 0) {
+                    QTextStream(stderr) << "[SOAK] No rollback ran; the rollback p99 was not measured.\n";
+                    exitCode = 3;
+                } else if (rollbackP99 > maxRollbackP99) {
+                    QTextStream(stderr) << "[SOAK] Rollback p99 " << rollbackP99 << " ms exceeds "
+                                        << maxRollbackP99 << " ms.\n";
+                    exitCode = 3;
+                }
+            }
+            ResourceGovernor::setInstance(nullptr);
+        }
+    }
+    Database::releaseThreadConnection();
+
+    Aws::ShutdownAPI(awsOptions);
+    Logger::stop();
+    return exitCode;
+#endif
+}
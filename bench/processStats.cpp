@@ -0,0 +1,110 @@
+#include "processStats.h"
+
+#if defined(Q_OS_WIN)
+#  include <windows.h>
+#  include <psapi.h>
+#  include <tlhelp32.h>
+#elif defined(Q_OS_MAC)
+#  include <libproc.h>
+#  include <mach/mach.h>
+#  include <unistd.h>
+#else
+#  include <QDir>
+#  include <QFile>
+#  include <unistd.h>
+#endif
+
+/**
+ * @file processStats.cpp
+ * @brief Per-platform RSS, handle and thread counts.
+ */
+
+namespace ProcessStats {
+
+#if defined(Q_OS_WIN)
+
+qint64 residentBytes() {
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return -1;
+    }
+    return qint64(counters.WorkingSetSize);
+}
+
+int openHandles() {
+    DWORD count = 0;
+    return GetProcessHandleCount(GetCurrentProcess(), &count) ? int(count) : -1;
+}
+
+int threadCount() {
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot == INVALID_HANDLE_VALUE) {
+        return -1;
+    }
+    const DWORD pid = GetCurrentProcessId();
+    int count = 0;
+    THREADENTRY32 entry;
+    entry.dwSize = sizeof(entry);
+    for (BOOL ok = Thread32First(snapshot, &entry); ok; ok = Thread32Next(snapshot, &entry)) {
+        if (entry.th32OwnerProcessID == pid) {
+            ++count;
+        }
+    }
+    CloseHandle(snapshot);
+    return count;
+}
+
+#elif defined(Q_OS_MAC)
+
+qint64 residentBytes() {
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t size = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                  reinterpret_cast<task_info_t>(&info), &size) != KERN_SUCCESS) {
+        return -1;
+    }
+    return qint64(info.resident_size);
+}
+
+int openHandles() {
+    const int bytes = proc_pidinfo(getpid(), PROC_PIDLISTFDS, 0, nullptr, 0);
+    return bytes < 0 ? -1 : bytes / int(sizeof(proc_fdinfo));
+}
+
+int threadCount() {
+    thread_act_array_t threads = nullptr;
+    mach_msg_type_number_t count = 0;
+    if (task_threads(mach_task_self(), &threads, &count) != KERN_SUCCESS) {
+        return -1;
+    }
+    for (mach_msg_type_number_t i = 0; i < count; ++i) {
+        mach_port_deallocate(mach_task_self(), threads[i]);
+    }
+    vm_deallocate(mach_task_self(), vm_address_t(threads), count * sizeof(thread_act_t));
+    return int(count);
+}
+
+#else
+
+qint64 residentBytes() {
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    return fields.size() > 1 ? fields[1].toLongLong() * sysconf(_SC_PAGESIZE) : -1;
+}
+
+int openHandles() {
+    const QDir fds("/proc/self/fd");
+    return fds.exists() ? int(fds.entryList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::System).size()) : -1;
+}
+
+int threadCount() {
+    const QDir tasks("/proc/self/task");
+    return tasks.exists() ? int(tasks.entryList(QDir::Dirs | QDir::NoDotAndDotDot).size()) : -1;
+}
+
+#endif
+
+} // namespace ProcessStats
@@ -0,0 +1,24 @@
+#ifndef PROCESSSTATS_H
+#define PROCESSSTATS_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Resource usage of the current process, sampled by the soak harness.
+ *
+ * Values are -1 where the platform offers no cheap way to read them.
+ */
+namespace ProcessStats {
+
+/// @return Resident set size in bytes.
+qint64 residentBytes();
+
+/// @return Open file descriptors (POSIX) or kernel handles (Windows).
+int openHandles();
+
+/// @return Threads in this process.
+int threadCount();
+
+} // namespace ProcessStats
+
+#endif // PROCESSSTATS_H
@@ -0,0 +1,274 @@
+#include "replaySource.h"
+#include "Database.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <algorithm>
+#include <zlib.h>
+
+/**
+ * @file replaySource.cpp
+ * @brief Recorded-change loading for monitor_replay: the Changes table or
+ *        a ChangeExport CSV / JSON Lines file.
+ */
+
+bool ReplayFilter::accepts(const ChangeRow &row) const {
+    if (start.isValid() && row.timestamp < start) {
+        return false;
+    }
+    if (end.isValid() && row.timestamp > end) {
+        return false;
+    }
+    return configName.isEmpty() || row.configName == configName;
+}
+
+namespace {
+
+/// Stable timestamp order; ties keep their id order, as in the table.
+void sortByTime(QVector<ChangeRow> &rows) {
+    std::stable_sort(rows.begin(), rows.end(), [](const ChangeRow &a, const ChangeRow &b) {
+        return a.timestamp != b.timestamp ? a.timestamp < b.timestamp : a.id < b.id;
+    });
+}
+
+/// Whole file, inflated when it ends in ".gz"; empty with @p error set on failure.
+QByteArray readContent(const QString &path, QString *error) {
+    if (!path.endsWith(QLatin1String(".gz"))) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            *error = QStringLiteral("Cannot open %1: %2").arg(path, file.errorString());
+            return QByteArray();
+        }
+        return file.readAll();
+    }
+
+    gzFile gz = gzopen(QFile::encodeName(path).constData(), "rb");
+    if (!gz) {
+        *error = QStringLiteral("Cannot open %1").arg(path);
+        return QByteArray();
+    }
+    QByteArray content;
+    char buffer[64 * 1024];
+    int n = 0;
+    while ((n = gzread(gz, buffer, sizeof(buffer))) > 0) {
+        content.append(buffer, n);
+    }
+    if (n < 0) {
+        int code = 0;
+        *error = QStringLiteral("Cannot inflate %1: %2").arg(path, QString::fromLatin1(gzerror(gz, &code)));
+        content.clear();
+    }
+    gzclose(gz);
+    return content;
+}
+
+/**
+ * @brief Split RFC 4180 CSV into records of fields.
+ *
+ * Quoted fields may hold separators, doubled quotes and line breaks, as
+ * ChangeExport writes them.
+ */
+QVector<QStringList> parseCsv(const QByteArray &content) {
+    QVector<QStringList> records;
+    QStringList fields;
+    QByteArray field;
+    bool quoted = false;
+    bool fieldStarted = false;
+
+    auto endField = [&]() {
+        fields << QString::fromUtf8(field);
+        field.clear();
+        fieldStarted = false;
+    };
+    auto endRecord = [&]() {
+        endField();
+        records << fields;
+        fields.clear();
+    };
+
+    for (qsizetype i = 0; i < content.size(); ++i) {
+        const char c = content[i];
+        if (quoted) {
+            if (c == '"') {
+                if (i + 1 < content.size() && content[i + 1] == '"') {
+                    field.append('"');
+                    ++i;
+                } else {
+                    quoted = false;
+                }
+            } else {
+                field.append(c);
+            }
+        } else if (c == '"' && !fieldStarted) {
+            quoted = true;
+            fieldStarted = true;
+        } else if (c == ',') {
+            endField();
+        } else if (c == '\n') {
+            endRecord();
+        } else if (c != '\r') {
+            field.append(c);
+            fieldStarted = true;
+        }
+    }
+    if (fieldStarted || !fields.isEmpty()) {
+        endRecord();
+    }
+    return records;
+}
+
+QVector<ChangeRow> fromCsv(const QByteArray &content, const ReplayFilter &filter, QString *error) {
+    QVector<ChangeRow> rows;
+    const QVector<QStringList> records = parseCsv(content);
+    if (records.isEmpty()) {
+        return rows;
+    }
+
+    // Columns by header name, so reordered or trimmed exports still load
+    const QStringList header = records.first();
+    const int id       = header.indexOf("id");
+    const int name     = header.indexOf("config_name");
+    const int oldValue = header.indexOf("old_value");
+    const int newValue = header.indexOf("new_value");
+    const int ack      = header.indexOf("acknowledged");
+    const int critical = header.indexOf("critical");
+    const int time     = header.indexOf("timestamp");
+    if (name < 0 || newValue < 0 || time < 0) {
+        *error = QStringLiteral("CSV header lacks config_name, new_value or timestamp");
+        return rows;
+    }
+
+    auto field = [](const QStringList &record, int column) {
+        return column >= 0 && column < record.size() ? record[column] : QString();
+    };
+    for (int i = 1; i < records.size(); ++i) {
+        const QStringList &record = records[i];
+        ChangeRow row;
+        row.id           = field(record, id).toLongLong();
+        row.configName   = field(record, name);
+        row.oldValue     = field(record, oldValue);
+        row.newValue     = field(record, newValue);
+        row.acknowledged = field(record, ack) == QLatin1String("1");
+        row.critical     = field(record, critical) == QLatin1String("1");
+        row.timestamp    = QDateTime::fromString(field(record, time), Qt::ISODate);
+        if (!row.configName.isEmpty() && row.timestamp.isValid() && filter.accepts(row)) {
+            rows << std::move(row);
+        }
+    }
+    return rows;
+}
+
+QVector<ChangeRow> fromJsonLines(const QByteArray &content, const ReplayFilter &filter, QString *error) {
+    QVector<ChangeRow> rows;
+    qsizetype lineStart = 0;
+    int lineNumber = 0;
+    while (lineStart < content.size()) {
+        qsizetype lineEnd = content.indexOf('\n', lineStart);
+        if (lineEnd < 0) {
+            lineEnd = content.size();
+        }
+        const QByteArray line = content.mid(lineStart, lineEnd - lineStart).trimmed();
+        lineStart = lineEnd + 1;
+        ++lineNumber;
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        QJsonParseError parseError;
+        const QJsonObject obj = QJsonDocument::fromJson(line, &parseError).object();
+        if (parseError.error != QJsonParseError::NoError) {
+            *error = QStringLiteral("Line %1: %2").arg(lineNumber).arg(parseError.errorString());
+            return QVector<ChangeRow>();
+        }
+
+        ChangeRow row;
+        row.id           = obj.value("id").toVariant().toLongLong();
+        row.configName   = obj.value("config_name").toString();
+        row.oldValue     = obj.value("old_value").toString();
+        row.newValue     = obj.value("new_value").toString();
+        row.acknowledged = obj.value("acknowledged").toBool();
+        row.critical     = obj.value("critical").toBool();
+        row.timestamp    = QDateTime::fromString(obj.value("timestamp").toString(), Qt::ISODate);
+        if (!row.configName.isEmpty() && row.timestamp.isValid() && filter.accepts(row)) {
+            rows << std::move(row);
+        }
+    }
+    return rows;
+}
+
+} // namespace
+
+namespace ReplaySource {
+
+QVector<ChangeRow> fromDatabase(const QString &schema, const ReplayFilter &filter, QString *error) {
+    QVector<ChangeRow> rows;
+
+    // The schema name is spliced into the statement; identifiers only
+    static const QRegularExpression identifier("^[A-Za-z0-9_]+$");
+    if (!identifier.match(schema).hasMatch()) {
+        *error = QStringLiteral("Invalid schema name: %1").arg(schema);
+        return rows;
+    }
+
+    QString sql = QStringLiteral("SELECT %1 FROM %2.Changes WHERE 1 = 1")
+                      .arg(QLatin1String(ChangeRow::kColumns), schema);
+    if (filter.start.isValid()) {
+        sql += QStringLiteral(" AND timestamp >= :start");
+    }
+    if (filter.end.isValid()) {
+        sql += QStringLiteral(" AND timestamp <= :end");
+    }
+    if (!filter.configName.isEmpty()) {
+        sql += QStringLiteral(" AND config_name = :configName");
+    }
+    sql += QStringLiteral(" ORDER BY timestamp, id");
+
+    QSqlQuery query(QSqlDatabase::database(Database::connectionNameForCurrentThread()));
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    if (filter.start.isValid()) {
+        query.bindValue(":start", filter.start);
+    }
+    if (filter.end.isValid()) {
+        query.bindValue(":end", filter.end);
+    }
+    if (!filter.configName.isEmpty()) {
+        query.bindValue(":configName", filter.configName);
+    }
+    if (!query.exec()) {
+        *error = query.lastError().text();
+        return rows;
+    }
+    while (query.next()) {
+        rows << ChangeRow::decode(query);
+    }
+    DatabaseRows::decryptValues(rows.data(), rows.data() + rows.size());
+    return rows;
+}
+
+QVector<ChangeRow> fromFile(const QString &path, const ReplayFilter &filter, QString *error) {
+    const QString format = path.endsWith(QLatin1String(".gz")) ? path.chopped(3) : path;
+    const bool csv = format.endsWith(QLatin1String(".csv"), Qt::CaseInsensitive);
+    if (!csv && !format.endsWith(QLatin1String(".jsonl"), Qt::CaseInsensitive)) {
+        *error = QStringLiteral("Unknown export format (expected .csv or .jsonl): %1").arg(path);
+        return QVector<ChangeRow>();
+    }
+
+    QString readError;
+    const QByteArray content = readContent(path, &readError);
+    if (!readError.isEmpty()) {
+        *error = readError;
+        return QVector<ChangeRow>();
+    }
+    QVector<ChangeRow> rows = csv ? fromCsv(content, filter, error)
+                                  : fromJsonLines(content, filter, error);
+    sortByTime(rows);
+    return rows;
+}
+
+} // namespace ReplaySource
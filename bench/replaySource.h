@@ -0,0 +1,51 @@
+#ifndef REPLAYSOURCE_H
+#define REPLAYSOURCE_H
+
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+#include "databaseRows.h"
+
+/**
+ * @brief Which recorded changes a replay covers.
+ *
+ * Invalid @c start / @c end leave that side open; an empty @c configName
+ * keeps every config.
+ */
+struct ReplayFilter {
+    QDateTime start;
+    QDateTime end;
+    QString   configName;
+
+    bool accepts(const ChangeRow &row) const;
+};
+
+/**
+ * @brief Loads recorded changes for monitor_replay, plaintext and in
+ *        timestamp order.
+ */
+namespace ReplaySource {
+
+/**
+ * @brief Read the Changes table of @p schema on the current thread's connection.
+ *
+ * The schema may differ from the one the connection is bound to, so a
+ * replay can read production history while writing to its scratch schema.
+ * Archived rows are not included; export the range first to replay those.
+ *
+ * @param error Set to a message on failure.
+ */
+QVector<ChangeRow> fromDatabase(const QString &schema, const ReplayFilter &filter, QString *error);
+
+/**
+ * @brief Read a ChangeExport file: CSV or JSON Lines, optionally gzip-compressed.
+ *
+ * The format is taken from the extension (".csv", ".jsonl", plus ".gz").
+ *
+ * @param error Set to a message on failure.
+ */
+QVector<ChangeRow> fromFile(const QString &path, const ReplayFilter &filter, QString *error);
+
+} // namespace ReplaySource
+
+#endif // REPLAYSOURCE_H
@@ -0,0 +1,114 @@
+#include "stubAwsEndpoint.h"
+#include <QHostAddress>
+#include <QMetaObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <memory>
+
+/**
+ * @file stubAwsEndpoint.cpp
+ * @brief Canned HTTP responses for the AWS calls made by Alert.
+ */
+
+namespace {
+
+// SESv2 is REST/JSON; SNS uses the query protocol with XML responses
+const QByteArray kSesPath = "/v2/email/outbound-emails";
+const QByteArray kSesBody = R"({"MessageId":"bench-message"})";
+const QByteArray kSnsBody =
+    "<PublishResponse xmlns=\"http://sns.amazonaws.com/doc/2010-03-31/\">"
+    "<PublishResult><MessageId>bench-message</MessageId></PublishResult>"
+    "<ResponseMetadata><RequestId>bench-request</RequestId></ResponseMetadata>"
+    "</PublishResponse>";
+
+QByteArray response(const QByteArray &path) {
+    const bool ses = path.startsWith(kSesPath);
+    const QByteArray &body = ses ? kSesBody : kSnsBody;
+    return "HTTP/1.1 200 OK\r\n"
+           "Content-Type: " + QByteArray(ses ? "application/json" : "text/xml") + "\r\n"
+           "x-amzn-RequestId: bench-request\r\n"
+           "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+           "Connection: keep-alive\r\n\r\n" + body;
+}
+
+/**
+ * @brief Consume complete requests from @p buffer and answer each one.
+ */
+void serve(QTcpSocket *socket, QByteArray &buffer, int latencyMs, std::atomic<int> &requests) {
+    for (;;) {
+        const int headerEnd = buffer.indexOf("\r\n\r\n");
+        if (headerEnd < 0) {
+            return;
+        }
+        const QByteArray header = buffer.left(headerEnd);
+        qint64 contentLength = 0;
+        for (const QByteArray &line : header.split('\n')) {
+            if (line.toLower().startsWith("content-length:")) {
+                contentLength = line.mid(15).trimmed().toLongLong();
+            }
+        }
+        const qint64 total = headerEnd + 4 + contentLength;
+        if (buffer.size() < total) {
+            return;
+        }
+        const QByteArray path = header.split(' ').value(1);
+        buffer.remove(0, int(total));
+        ++requests;
+
+        const QByteArray reply = response(path);
+        if (latencyMs > 0) {
+            QTimer::singleShot(latencyMs, socket, [socket, reply]() { socket->write(reply); });
+        } else {
+            socket->write(reply);
+        }
+    }
+}
+
+} // namespace
+
+StubAwsEndpoint::StubAwsEndpoint(int latencyMs, QObject *parent)
+    : QObject(parent)
+    , m_latencyMs(latencyMs)
+{
+    m_thread.setObjectName("StubAwsEndpoint");
+}
+
+StubAwsEndpoint::~StubAwsEndpoint() {
+    if (m_server) {
+        QMetaObject::invokeMethod(m_server, [server = m_server]() { delete server; },
+                                  Qt::BlockingQueuedConnection);
+    }
+    m_thread.quit();
+    m_thread.wait();
+}
+
+/**
+ * @brief Start the thread and listen on a random loopback port.
+ */
+bool StubAwsEndpoint::start() {
+    m_server = new QTcpServer();
+    m_server->moveToThread(&m_thread);
+    m_thread.start();
+
+    bool ok = false;
+    QMetaObject::invokeMethod(m_server, [this, &ok]() {
+        ok = m_server->listen(QHostAddress::LocalHost, 0);
+        m_port = m_server->serverPort();
+        QObject::connect(m_server, &QTcpServer::newConnection, m_server, [this]() {
+            while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+                auto buffer = std::make_shared<QByteArray>();
+                QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket, buffer]() {
+                    buffer->append(socket->readAll());
+                    serve(socket, *buffer, m_latencyMs, m_requests);
+                });
+                QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            }
+        });
+    }, Qt::BlockingQueuedConnection);
+    return ok;
+}
+
+QString StubAwsEndpoint::url() const {
+    return QStringLiteral("http://127.0.0.1:%1").arg(m_port);
+}
@@ -0,0 +1,47 @@
+#ifndef STUBAWSENDPOINT_H
+#define STUBAWSENDPOINT_H
+
+#include <QObject>
+#include <QThread>
+#include <atomic>
+
+class QTcpServer;
+
+/**
+ * @brief Minimal local HTTP endpoint answering SNS Publish and SESv2 SendEmail.
+ *
+ * Lets Alert run its real AWS SDK code path without network access or
+ * credentials: point the client's endpoint override at url(). Each
+ * request gets a canned success response after an optional delay that
+ * stands in for service latency. The server runs on its own thread so the
+ * caller can block in the SDK.
+ */
+class StubAwsEndpoint : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @param latencyMs Delay before each response.
+     * @param parent    Optional QObject parent.
+     */
+    explicit StubAwsEndpoint(int latencyMs = 0, QObject *parent = nullptr);
+    ~StubAwsEndpoint() override;
+
+    /// Listen on 127.0.0.1 (random port); @return True on success.
+    bool start();
+
+    /// @return Base URL, e.g. "http://127.0.0.1:50123".
+    QString url() const;
+
+    /// @return Requests answered so far.
+    int requestCount() const { return m_requests.load(); }
+
+private:
+    QThread          m_thread;
+    QTcpServer      *m_server = nullptr;   ///< Lives on m_thread
+    quint16          m_port = 0;
+    int              m_latencyMs = 0;
+    std::atomic<int> m_requests{0};
+};
+
+#endif // STUBAWSENDPOINT_H
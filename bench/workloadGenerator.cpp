@@ -0,0 +1,287 @@
+#include "workloadGenerator.h"
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @file workloadGenerator.cpp
+ * @brief Synthetic item storage and the mutation schedule for monitor_soak.
+ */
+
+namespace {
+
+// Generator granularity; rates are paced against the wall clock, not ticks
+const int kTickMs = 10;
+
+// Bound catch-up after a stall so one tick cannot turn into a storm
+const int kMaxBackgroundPerTick = 10000;
+
+#ifdef Q_OS_WIN
+const QString kRegistryRoot = "HKEY_CURRENT_USER\\Software\\MonitorSoak";
+#endif
+
+} // namespace
+
+WorkloadGenerator::WorkloadGenerator(const WorkloadOptions &options, const QString &dir, QObject *parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_dir(dir)
+    , m_rng(options.seed)
+{
+    m_thread.setObjectName("WorkloadGenerator");
+
+    const int n = std::max(1, m_options.items);
+    m_criticalCount = std::clamp(int(std::lround(n * m_options.criticalPercent / 100.0)), 0, n);
+    m_order.resize(n);
+    for (int i = 0; i < n; ++i) {
+        m_order[i] = i;
+    }
+    std::shuffle(m_order.begin(), m_order.end(), m_rng);
+    m_stormOrder = m_order;
+
+    if (m_options.distribution == WorkloadOptions::Zipf) {
+        m_zipfCdf.resize(n);
+        double sum = 0.0;
+        for (int k = 0; k < n; ++k) {
+            sum += 1.0 / std::pow(k + 1, m_options.zipfExponent);
+            m_zipfCdf[k] = sum;
+        }
+        for (double &c : m_zipfCdf) {
+            c /= sum;
+        }
+    }
+
+    m_stores.resize(n);
+    m_generation.assign(n, 0);
+    m_pendingSinceUs.assign(n, 0);
+}
+
+WorkloadGenerator::~WorkloadGenerator() {
+    stop();
+    m_stores.clear();
+#ifdef Q_OS_WIN
+    QSettings(kRegistryRoot, QSettings::NativeFormat).remove("");
+#endif
+}
+
+QString WorkloadGenerator::itemName(int index) {
+    return QStringLiteral("soak_%1").arg(index);
+}
+
+/**
+ * @brief Open the native store holding item @p index.
+ */
+std::unique_ptr<QSettings> WorkloadGenerator::openStore(int index) const {
+#if defined(Q_OS_WIN)
+    return std::make_unique<QSettings>(kRegistryRoot + QStringLiteral("\\item%1").arg(index),
+                                       QSettings::NativeFormat);
+#elif defined(Q_OS_MAC)
+    return std::make_unique<QSettings>(QDir(m_dir).filePath(QStringLiteral("item%1.plist").arg(index)),
+                                       QSettings::NativeFormat);
+#else
+    return std::make_unique<QSettings>(QDir(m_dir).filePath(QStringLiteral("item%1.ini").arg(index)),
+                                       QSettings::IniFormat);
+#endif
+}
+
+/**
+ * @brief Cached store for the generator thread.
+ *
+ * Created on first use so each QSettings belongs to the thread writing it.
+ */
+QSettings *WorkloadGenerator::storeFor(int index) {
+    std::unique_ptr<QSettings> &store = m_stores[index];
+    if (!store) {
+        store = openStore(index);
+    }
+    return store.get();
+}
+
+QString WorkloadGenerator::prepare() {
+    const int n = int(m_stores.size());
+
+    QJsonArray list;
+    for (int i = 0; i < n; ++i) {
+        const std::unique_ptr<QSettings> store = openStore(i);
+        store->setValue(itemName(i), QStringLiteral("g0"));
+        store->sync();
+        if (store->status() != QSettings::NoError) {
+            return QString();
+        }
+
+        // Critical items are the last ones, so flappers (the first) stay non-critical
+        const bool isCritical = i >= n - m_criticalCount;
+#if defined(Q_OS_WIN)
+        list.append(QJsonObject{
+            {"hive", "HKEY_CURRENT_USER"},
+            {"keyPath", QStringLiteral("Software\\MonitorSoak\\item%1").arg(i)},
+            {"valueName", itemName(i)},
+            {"isCritical", isCritical},
+        });
+#else
+        list.append(QJsonObject{
+            {"plistPath", store->fileName()},
+            {"valueName", itemName(i)},
+            {"isCritical", isCritical},
+        });
+#endif
+    }
+
+    const QString path = QDir(m_dir).filePath("monitoredItems.json");
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return QString();
+    }
+    file.write(QJsonDocument(list).toJson());
+    return file.commit() ? path : QString();
+}
+
+void WorkloadGenerator::start() {
+    if (m_timer) {
+        return;
+    }
+    m_clock.start();
+    m_backgroundDone = 0;
+    m_criticalDone = 0;
+    m_nextStormMs = m_options.stormEverySec * 1000LL;
+    m_nextFlapMs = m_options.flapPeriodMs;
+
+    m_timer = new QTimer();
+    m_timer->setTimerType(Qt::PreciseTimer);
+    m_timer->setInterval(kTickMs);
+    m_timer->moveToThread(&m_thread);
+    connect(m_timer, &QTimer::timeout, m_timer, [this]() { tick(); });
+    m_thread.start();
+    QMetaObject::invokeMethod(m_timer, qOverload<>(&QTimer::start), Qt::QueuedConnection);
+}
+
+void WorkloadGenerator::stop() {
+    if (!m_timer) {
+        return;
+    }
+    QMetaObject::invokeMethod(m_timer, [timer = m_timer]() { delete timer; },
+                              Qt::BlockingQueuedConnection);
+    m_timer = nullptr;
+    m_thread.quit();
+    m_thread.wait();
+}
+
+/**
+ * @brief Item for the next background write.
+ * @return An item index, or -1 if every item is reserved for tampering.
+ */
+int WorkloadGenerator::pickBackgroundItem() {
+    const int n = int(m_order.size());
+    // Critical items are the last ones; tampering owns them when enabled
+    const int eligible = m_options.criticalRate > 0.0 ? n - m_criticalCount : n;
+    if (eligible <= 0) {
+        return -1;
+    }
+    if (m_options.distribution == WorkloadOptions::Zipf) {
+        for (;;) {
+            const double u = std::uniform_real_distribution<double>(0.0, 1.0)(m_rng);
+            const int rank = int(std::lower_bound(m_zipfCdf.begin(), m_zipfCdf.end(), u) - m_zipfCdf.begin());
+            const int index = m_order[std::min(rank, n - 1)];
+            if (index < eligible) {
+                return index;
+            }
+        }
+    }
+    return std::uniform_int_distribution<int>(0, eligible - 1)(m_rng);
+}
+
+/**
+ * @brief Write @p value to item @p index and start its latency clock.
+ */
+void WorkloadGenerator::mutate(int index, const QString &value) {
+    QSettings *store = storeFor(index);
+    store->setValue(itemName(index), value);
+    store->sync();
+    ++m_writes;
+
+    QMutexLocker locker(&m_pendingMutex);
+    if (m_pendingSinceUs[index] == 0) {
+        m_pendingSinceUs[index] = std::max<qint64>(1, m_clock.nsecsElapsed() / 1000);
+    }
+}
+
+/**
+ * @brief One generator step: due background and critical writes, then storms and flaps.
+ */
+void WorkloadGenerator::tick() {
+    const qint64 nowMs = m_clock.elapsed();
+    const int n = int(m_order.size());
+
+    // Writes owed by now; a backlog beyond one tick's cap is dropped
+    const qint64 target = qint64(m_options.rate * nowMs / 1000.0);
+    m_backgroundDone = std::max(m_backgroundDone, target - kMaxBackgroundPerTick);
+    for (; m_backgroundDone < target; ++m_backgroundDone) {
+        const int index = pickBackgroundItem();
+        if (index < 0) {
+            m_backgroundDone = target;
+            break;
+        }
+        mutate(index, QStringLiteral("g%1").arg(++m_generation[index]));
+    }
+
+    // Tampering: critical items in turn, each write to be rolled back
+    if (m_options.criticalRate > 0.0 && m_criticalCount > 0) {
+        const qint64 due = qint64(m_options.criticalRate * nowMs / 1000.0);
+        m_criticalDone = std::max(m_criticalDone, due - kMaxBackgroundPerTick);
+        for (; m_criticalDone < due; ++m_criticalDone) {
+            const int index = n - m_criticalCount + int(m_criticalDone % m_criticalCount);
+            mutate(index, QStringLiteral("t%1").arg(++m_generation[index]));
+            ++m_tampers;
+        }
+    }
+
+    if (m_options.stormEverySec > 0 && nowMs >= m_nextStormMs) {
+        // A fresh random subset each storm
+        const int count = std::clamp(int(std::lround(n * m_options.stormPercent / 100.0)), 0, n);
+        for (int k = 0; k < count; ++k) {
+            std::swap(m_stormOrder[k], m_stormOrder[std::uniform_int_distribution<int>(k, n - 1)(m_rng)]);
+            const int index = m_stormOrder[k];
+            mutate(index, QStringLiteral("g%1").arg(++m_generation[index]));
+        }
+        ++m_storms;
+        m_nextStormMs += m_options.stormEverySec * 1000LL;
+    }
+
+    if (m_options.flapItems > 0 && nowMs >= m_nextFlapMs) {
+        m_flapPhase = !m_flapPhase;
+        const QString value = m_flapPhase ? QStringLiteral("flapB") : QStringLiteral("flapA");
+        for (int index = 0; index < std::min(m_options.flapItems, n); ++index) {
+            mutate(index, value);
+        }
+        ++m_flaps;
+        m_nextFlapMs += m_options.flapPeriodMs;
+    }
+}
+
+qint64 WorkloadGenerator::observe(const QString &valueName) {
+    bool ok = false;
+    const int index = valueName.mid(5).toInt(&ok);
+    if (!ok || !valueName.startsWith(QLatin1String("soak_")) || index < 0 || index >= int(m_pendingSinceUs.size())) {
+        return -1;
+    }
+    QMutexLocker locker(&m_pendingMutex);
+    const qint64 since = m_pendingSinceUs[index];
+    if (since == 0) {
+        return -1;
+    }
+    m_pendingSinceUs[index] = 0;
+    return m_clock.nsecsElapsed() / 1000 - since;
+}
+
+int WorkloadGenerator::unobserved() const {
+    QMutexLocker locker(&m_pendingMutex);
+    return int(std::count_if(m_pendingSinceUs.begin(), m_pendingSinceUs.end(),
+                             [](qint64 since) { return since != 0; }));
+}
@@ -0,0 +1,137 @@
+#ifndef WORKLOADGENERATOR_H
+#define WORKLOADGENERATOR_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+#include <QSettings>
+#include <QString>
+#include <QThread>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <vector>
+
+class QTimer;
+
+/**
+ * @brief Shape of a synthetic change workload.
+ *
+ * Four independent sources can be combined:
+ *  - background mutations at @c rate per second, picking items uniformly
+ *    or Zipf-distributed (a few hot items take most writes);
+ *  - storms every @c stormEverySec seconds that change @c stormPercent of
+ *    all items at once, like a GPO push or an MDM sync;
+ *  - @c flapItems items toggled between two values every @c flapPeriodMs,
+ *    like a rogue process fighting the monitor;
+ *  - tampering with the critical items at @c criticalRate per second, in
+ *    turn, so rollbacks run under the other load. While it is enabled the
+ *    background mutations leave critical items alone.
+ */
+struct WorkloadOptions {
+    enum Distribution { Uniform, Zipf };
+
+    int          items = 1000;
+    int          criticalPercent = 0;     ///< Share of items marked critical (rolled back)
+    double       rate = 50.0;             ///< Background mutations per second
+    Distribution distribution = Uniform;
+    double       zipfExponent = 1.1;
+    int          stormEverySec = 0;       ///< 0 disables storms
+    int          stormPercent = 50;
+    int          flapItems = 0;
+    int          flapPeriodMs = 250;
+    double       criticalRate = 0.0;      ///< Writes per second to critical items; 0 disables
+    quint32      seed = 1;
+};
+
+/**
+ * @brief Creates synthetic monitored items and mutates them on a schedule.
+ *
+ * Items live in the platform's native store, the same one the monitors
+ * read: one plist file per item on macOS, one key per item under
+ * HKEY_CURRENT_USER\\Software\\MonitorSoak on Windows. prepare() also writes
+ * the monitored-items JSON list for MONITOR_ITEMS_CONFIG.
+ *
+ * Mutations run on a private thread so they never share the monitor's
+ * event loop. For latency, the generator remembers when each item was
+ * first written since the monitor last reported it; observe() turns the
+ * monitor's changeRecorded() into a write-to-detection latency.
+ */
+class WorkloadGenerator : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @param options Workload shape.
+     * @param dir     Directory for item files and the item list.
+     * @param parent  Optional QObject parent.
+     */
+    WorkloadGenerator(const WorkloadOptions &options, const QString &dir, QObject *parent = nullptr);
+    ~WorkloadGenerator() override;
+
+    /**
+     * @brief Create every item with an initial value and write the item list.
+     * @return Path of the monitored-items JSON, or an empty string on failure.
+     */
+    QString prepare();
+
+    /// Begin mutating on the generator thread.
+    void start();
+
+    /// Stop mutating; returns once the generator thread is idle.
+    void stop();
+
+    /**
+     * @brief Account for the monitor reporting a change of @p valueName.
+     * @return Microseconds since the first unreported write, or -1 if the
+     *         item had none (e.g. a rollback the monitor itself made).
+     */
+    qint64 observe(const QString &valueName);
+
+    /// @return Value name of item @p index ("soak_<index>").
+    static QString itemName(int index);
+
+    qint64 writes() const { return m_writes.load(); }
+    qint64 storms() const { return m_storms.load(); }
+    qint64 flaps() const { return m_flaps.load(); }
+    qint64 tampers() const { return m_tampers.load(); }
+
+    /// @return Writes not yet reported by the monitor.
+    int unobserved() const;
+
+private:
+    void tick();
+    void mutate(int index, const QString &value);
+    int pickBackgroundItem();
+    std::unique_ptr<QSettings> openStore(int index) const;
+    QSettings *storeFor(int index);
+
+    WorkloadOptions   m_options;
+    QString           m_dir;
+    int               m_criticalCount = 0;   ///< Critical items are the last ones
+    QThread           m_thread;
+    QTimer           *m_timer = nullptr;     ///< Lives on m_thread
+    std::mt19937      m_rng;
+    std::vector<int>  m_order;               ///< Item for each Zipf rank
+    std::vector<int>  m_stormOrder;          ///< Partially reshuffled by every storm
+    std::vector<double> m_zipfCdf;
+    std::vector<std::unique_ptr<QSettings>> m_stores;
+    std::vector<quint64> m_generation;       ///< Per-item write counter
+
+    QElapsedTimer     m_clock;
+    qint64            m_backgroundDone = 0;
+    qint64            m_criticalDone = 0;
+    qint64            m_nextStormMs = 0;
+    qint64            m_nextFlapMs = 0;
+    bool              m_flapPhase = false;
+
+    mutable QMutex    m_pendingMutex;
+    std::vector<qint64> m_pendingSinceUs;    ///< 0 = nothing unreported
+
+    std::atomic<qint64> m_writes{0};
+    std::atomic<qint64> m_storms{0};
+    std::atomic<qint64> m_flaps{0};
+    std::atomic<qint64> m_tampers{0};
+};
+
+#endif // WORKLOADGENERATOR_H
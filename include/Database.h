@@ -3,8 +3,25 @@
 
 #include <QObject>
 #include <QVariantList>
+#include <QDateTime>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+#include <vector>
+#include "databaseRows.h"
 #include <QtSql/QSqlDatabase>
 
+/**
+ * @brief Selects Changes rows removed by one retention rule.
+ */
+struct ChangePurgeRule {
+    QDateTime   cutoff;           ///< Rows with timestamp < cutoff expire
+    QVariant    critical;         ///< true/false restricts by critical flag; null matches both
+    QString     configName;       ///< Non-empty: only this config and its leaf rows
+    QStringList excludeConfigs;   ///< Configs governed by their own rule, leaf rows included
+};
+
 /**
  * @brief The Database class handles all interactions with the SQL database,
  * including schema creation, connection management, and CRUD operations for
@@ -13,6 +30,9 @@
 class Database : public QObject {
     Q_OBJECT
 public:
+    /// One database side effect, e.g. an insertChange() call; returns success.
+    using Write = std::function<bool(Database &)>;
+
     /**
      * @brief Constructs the Database object and initializes the database connection.
      * @param parent Optional parent QObject.
@@ -20,10 +40,34 @@ public:
     explicit Database(QObject *parent = nullptr);
 
     /**
-     * @brief Destructor closes the database connection if it's open.
+     * @brief Destructor; the per-thread connection stays open for reuse.
      */
     ~Database();
 
+    /**
+     * @brief Name of the Qt SQL connection owned by the calling thread.
+     * @return The default connection name on the GUI thread, a per-thread name otherwise.
+     */
+    static QString connectionNameForCurrentThread();
+
+    /**
+     * @brief Close and remove the calling worker thread's connection.
+     *
+     * Worker threads call this before exiting; it is a no-op on the GUI thread.
+     */
+    static void releaseThreadConnection();
+
+    /**
+     * @brief Apply several writes as a single transaction.
+     *
+     * If the transaction cannot be started or committed, the writes are
+     * replayed one by one in autocommit mode so none is lost.
+     *
+     * @param writes Writes in the order they must be applied.
+     * @return True if every write succeeded.
+     */
+    bool applyBatch(const std::vector<Write> &writes);
+
     /**
      * @brief Creates the necessary database schema (tables, indices, etc.).
      * @return true if schema creation succeeds; false otherwise.
@@ -35,6 +79,9 @@ public:
      */
     Q_INVOKABLE void ensureConnection();
 
+    /// @return True if this thread's connection is open.
+    bool isOpen() const { return db.isOpen(); }
+
     // User settings methods
 
     /**
@@ -69,6 +116,12 @@ public:
      */
     Q_INVOKABLE QVariantList getAllUserSettings();
 
+    /**
+     * @brief Typed variant of getAllUserSettings() for C++ callers.
+     * @return Decrypted user settings rows.
+     */
+    QVector<UserRow> userSettingsRows();
+
     // Configuration settings methods
 
     /**
@@ -90,6 +143,12 @@ public:
      */
     Q_INVOKABLE QVariantList getAllConfigurations();
 
+    /**
+     * @brief Typed variant of getAllConfigurations() for C++ callers.
+     * @return Configuration rows (values still encrypted).
+     */
+    QVector<ConfigRow> configurationRows();
+
     // Change log methods
 
     /**
@@ -113,6 +172,12 @@ public:
      */
     Q_INVOKABLE QVariantList getAllChanges();
 
+    /**
+     * @brief Typed variant of getAllChanges() for C++ callers.
+     * @return Change rows (values still encrypted).
+     */
+    QVector<ChangeRow> changeRows();
+
     /**
      * @brief Updates the acknowledgment status for a specific configuration.
      * @param configName Name/key of the configuration to mark as acknowledged.
@@ -129,12 +194,23 @@ public:
     Q_INVOKABLE QVariantList searchChangeHistory(const QString &date,
                                                  const QString &configName);
 
+    /**
+     * @brief Typed variant of searchChangeHistory() (values still encrypted).
+     */
+    QVector<ChangeRow> changeHistoryRows(const QString &date,
+                                         const QString &configName);
+
     /**
      * @brief Retrieves counts of changes grouped by date and configuration.
      * @return List of counts as a QVariantList of QVariantMap entries.
      */
     Q_INVOKABLE QVariantList getChangesCountByDateAndConfig();
 
+    /**
+     * @brief Typed variant of getChangesCountByDateAndConfig().
+     */
+    QVector<ChangeCountRow> changeCountRows();
+
     /**
      * @brief Searches change logs within a date range and optional filters.
      * @param start Start date string ("YYYY-MM-DD").
@@ -150,6 +226,95 @@ public:
                                                       const QVariant &ackFilter,
                                                       const QVariant &criticalFilter);
 
+    /**
+     * @brief Streams matching change logs without decrypting them.
+     *
+     * Archived rows (see ChangeArchive) are visited first, then the table.
+     *
+     * @param start, end, configName, ackFilter, criticalFilter Same as searchChangeHistoryRange().
+     * @param visitor Called per row (values still encrypted); return false to stop.
+     * @return False if the query failed or an archive segment is corrupt.
+     */
+    bool forEachChangeInRange(const QString &start,
+                              const QString &end,
+                              const QString &configName,
+                              const QVariant &ackFilter,
+                              const QVariant &criticalFilter,
+                              const std::function<bool(ChangeRow &&)> &visitor);
+
+    // Retention
+
+    /**
+     * @brief Delete up to @p limit rows matching @p rule, oldest first.
+     *
+     * Ordered by the timestamp indexes so the statement only touches the
+     * rows it removes.
+     *
+     * @return Number of rows deleted, or -1 on error.
+     */
+    int purgeChangesChunk(const ChangePurgeRule &rule, int limit);
+
+    /**
+     * @brief Oldest rows with a timestamp before @p before, for archiving.
+     * @return Up to @p limit rows ordered by timestamp, values still encrypted.
+     */
+    QVector<ChangeRow> archiveCandidates(const QDateTime &before, int limit);
+
+    /**
+     * @brief Delete rows by id (after they were archived).
+     * @return Number of rows deleted, or -1 on error.
+     */
+    int deleteChangesById(const QVector<qint64> &ids);
+
+    // Value history
+
+    /**
+     * @brief Store a keyframe for delta-encoded values (see ValueHistory).
+     * @param cipher EncryptionUtils::encryptBytes() output of the keyframe envelope.
+     * @return The keyframe id, or -1 on error.
+     */
+    qint64 insertKeyframe(const QString &configName, const QByteArray &cipher);
+
+    /**
+     * @brief Encrypted keyframes by id; ids not found are left out.
+     */
+    QHash<qint64, QByteArray> keyframeCiphers(const QVector<qint64> &ids);
+
+    /**
+     * @brief Delete up to @p limit keyframes created before @p before that
+     *        no Changes row refers to any more.
+     * @return Number of keyframes deleted, or -1 on error.
+     */
+    int purgeOrphanKeyframes(const QDateTime &before, int limit);
+
+    /**
+     * @brief Whether Changes is range-partitioned by month.
+     */
+    bool isChangesPartitioned();
+
+    /**
+     * @brief Convert Changes to monthly RANGE partitions on timestamp.
+     *
+     * Rebuilds the table (the primary key becomes (id, timestamp), as
+     * MySQL requires); intended to run once, off the GUI thread.
+     *
+     * @param monthsAhead Future months to create besides the current one.
+     * @return True on success or if already partitioned.
+     */
+    bool partitionChangesByMonth(int monthsAhead);
+
+    /**
+     * @brief Make sure partitions exist for the next @p monthsAhead months.
+     * @return True on success.
+     */
+    bool ensureChangePartitions(int monthsAhead);
+
+    /**
+     * @brief Drop monthly partitions whose whole range is before @p cutoff.
+     * @return Number of partitions dropped, or -1 on error.
+     */
+    int dropChangePartitionsBefore(const QDate &cutoff);
+
     /**
      * @brief Resolves the filesystem path to encryption keys for secure database operations.
      * @return Path to the encryption keys directory or file.
@@ -5,8 +5,13 @@
 #include <QList> // Includes the QList class for managing lists of items
 #include "plistFile.h" // Includes the RegistryKey class definition for use in this header
 
+class ConfigSource;
+class ItemPatternExpander;
+
 namespace MacOSJsonUtils { // Defines the JsonUtils namespace to organize related functions
 QList<PlistFile*> readFilesFromJson(const QString &filePath); // Declares a function to read registry keys from a JSON file
+QList<PlistFile*> parseFilesJson(const QByteArray &json, const QString &origin); // Same, from JSON text already in memory
+QList<PlistFile*> loadFiles(const ConfigSource &source, ItemPatternExpander *patterns = nullptr); // Same, from a config source, via the parsed-list cache; patterned entries expand through @p patterns
 }
 
 #endif // MACOSJSONUTILS_H 
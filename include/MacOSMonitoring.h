@@ -4,15 +4,22 @@
 #include "monitoringBase.h"
 #include "plistFile.h"
 #include "plistFileModel.h"
+#include "monitoredItemsProxyModel.h"
 #include "MacOSRollback.h"
 #include "alert.h"
 #include "settings.h"
 #include "Database.h"
+#include "changeDispatcher.h"
+#include "clock.h"
+#include "configSource.h"
+#include "tickWatchdog.h"
+#include "itemPatternExpander.h"
 
 #include <QObject>
 #include <QList>
-#include <QTimer>
-#include <QFileSystemWatcher>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QThreadPool>
 
 /**
  * @brief Monitors macOS plist files for unauthorized changes.
@@ -28,19 +35,32 @@ class MacOSMonitoring : public MonitoringBase {
     Q_PROPERTY(PlistFileModel* plistFiles
                    READ plistFiles
                        NOTIFY plistFilesChanged)
+    Q_PROPERTY(MonitoredItemsProxyModel* monitoredItems
+                   READ monitoredItems
+                       CONSTANT)
+    Q_PROPERTY(TickWatchdog* watchdog
+                   READ watchdog
+                       CONSTANT)
 
 public:
     /**
      * @brief Construct a MacOSMonitoring instance.
      * @param settings    Pointer to global Settings object.
+     * @param source      List of monitored plists; nullptr watches
+     *                    monitoredPlists.json. Not owned.
      * @param parent      Parent QObject (default nullptr).
      */
-    explicit MacOSMonitoring(Settings *settings, QObject *parent = nullptr);
+    explicit MacOSMonitoring(Settings *settings, ConfigSource *source = nullptr,
+                             QObject *parent = nullptr);
+
+    /**
+     * @brief Finish background work (see shutdown()).
+     */
+    ~MacOSMonitoring() override;
 
     /**
      * @brief Start monitoring:
-     *  - Sets up QFileSystemWatcher callbacks.
-     *  - Launches the periodic QTimer.
+     *  - Launches the periodic check timer.
      */
     Q_INVOKABLE void startMonitoring();
 
@@ -50,11 +70,18 @@ public:
     Q_INVOKABLE void stopMonitoring();
 
     /**
-     * @brief Mark a specific plist file as critical.
-     * @param fileName    The full path or identifier of the plist.
+     * @brief Stop monitoring, wait for baseline reads and drain the dispatcher.
+     */
+    void shutdown() override;
+
+    /**
+     * @brief Mark a specific plist entry as critical.
+     * @param plistPath   Path of the plist file holding the key.
+     * @param valueName   Key name inside the plist.
      * @param isCritical  If true, any change triggers a rollback & alert.
      */
-    Q_INVOKABLE void setFileCriticalStatus(const QString &fileName, bool isCritical);
+    Q_INVOKABLE void setFileCriticalStatus(const QString &plistPath, const QString &valueName,
+                                           bool isCritical);
 
     /**
      * @brief Temporarily allow the next change on a file without alerting.
@@ -68,6 +95,41 @@ public:
      */
     PlistFileModel* plistFiles();
 
+    /**
+     * @brief Sorted/filterable view of plistFiles for the monitored-items list.
+     * @return Pointer to the proxy model.
+     */
+    MonitoredItemsProxyModel* monitoredItems();
+
+    /**
+     * @brief Per-lane queue depth and latency (p50/p99/max) for diagnostics.
+     * @return Map keyed by lane name.
+     */
+    Q_INVOKABLE QVariantMap laneStats() const;
+
+    /**
+     * @brief Expansion size and watched directories of patterned entries.
+     * @return Map produced by ItemPatternExpander::stats().
+     */
+    Q_INVOKABLE QVariantMap patternStats() const;
+
+    /**
+     * @brief Check-cycle overruns, missed cycles and throttling level.
+     * @return Pointer to the watchdog.
+     */
+    TickWatchdog* watchdog();
+
+    /**
+     * @brief Whether every plist's initial value has been read.
+     * @return False while loadBaselines() is still running.
+     */
+    bool baselinesReady() const;
+
+    /**
+     * @brief Block until all baselines are read and persisted (tools only).
+     */
+    void waitForBaselines();
+
 signals:
     /**
      * @brief Emitted when the overall monitoring status changes.
@@ -98,33 +160,94 @@ signals:
      */
     void changeAcknowledged(const QString &fileName);
 
+    /**
+     * @brief Emitted when every plist of the current list has its baseline.
+     */
+    void baselinesLoaded();
+
 private slots:
     /**
-     * @brief Periodic slot invoked by QTimer to scan for changes.
+     * @brief Periodic slot invoked by the check timer to scan for changes.
      */
     void checkForChanges();
 
     /**
-     * @brief Invoked by QFileSystemWatcher when a file on disk changes.
-     * @param path  Filesystem path to the changed plist.
+     * @brief Invoked when the config source reports a new plist list.
+     */
+    void onConfigChanged();
+
+    /**
+     * @brief Invoked when files or keys under a patterned entry change.
+     * @param added   New expanded entries.
+     * @param removed Expanded entries that no longer exist.
      */
-    void onPlistFileChanged(const QString &path);
+    void onPatternMatchesChanged(const QVector<ItemSpec> &added, const QVector<ItemSpec> &removed);
 
 private:
+    /// A value change found during the detection pass of checkForChanges().
+    struct DetectedChange {
+        PlistFile *plist;
+        QString    prevValue;
+        QString    currentValue;
+    };
+
     /**
      * @brief Reload the list of plist files from Settings into the model.
      */
     void reloadPlistFiles();
 
+    /**
+     * @brief Read the initial value of every plist on a thread pool.
+     */
+    void loadBaselines();
+
+    /**
+     * @brief Read the initial value of @p plists, adding to the current load.
+     */
+    void readBaselines(const QList<PlistFile*> &plists);
+
+    /**
+     * @brief Persist a finished chunk of baselines (monitor thread).
+     * @param chunk      Plists whose baseline was just read.
+     * @param generation loadBaselines() call the chunk belongs to.
+     */
+    void onBaselinesLoaded(const QList<PlistFile*> &chunk, quint64 generation);
+
+    /**
+     * @brief Fill missing Settings contacts from the database in the background.
+     */
+    void syncContacts();
+
+    /**
+     * @brief Apply the rows read by syncContacts() (monitor thread).
+     * @param userSettings Rows read from UserSettings.
+     */
+    void applyContacts(const QVector<UserRow> &userSettings);
+
+    /**
+     * @brief Apply rollback/alert/persistence policy to one detected change.
+     * @param change The changed entry with its previous and current values.
+     */
+    void handleChange(const DetectedChange &change);
+
     QList<PlistFile*>      m_plistFiles;         ///< Raw monitoring objects
     PlistFileModel         m_plistFilesModel;    ///< Exposed QAbstractListModel for UI
+    MonitoredItemsProxyModel m_monitoredItems;   ///< Sorted/filtered view of m_plistFilesModel
     MacOSRollback          m_rollback;           ///< Handles rollback operations
     Alert                  m_alert;              ///< Sends out alerts on critical events
     Settings              *m_settings;           ///< App configuration & thresholds
-    QTimer                 m_timer;              ///< Drives periodic checks
+    ClockTimer             m_timer;              ///< Drives periodic checks
     bool                   m_monitoringActive;   ///< True if monitoring is currently running
-    Database               m_database;           ///< Logs all change events
-    QFileSystemWatcher     m_fileWatcher;        ///< Watches for immediate file changes
+    ConfigSource          *m_configSource;       ///< Supplies the monitored-plist list
+    ChangeDispatcher       m_dispatcher;         ///< Priority lanes for change side effects
+    TickWatchdog           m_watchdog;           ///< Cycle budget and non-critical throttling
+    ItemPatternExpander    m_patterns;           ///< Expands and watches patterned entries
+    QThreadPool            m_baselinePool;       ///< Reads initial plist values
+    QElapsedTimer          m_baselineTimer;      ///< Time taken by the current baseline load
+    quint64                m_baselineGeneration = 0; ///< Bumped per loadBaselines()
+    int                    m_pendingBaselines = 0;   ///< Plists still being read
+    QSet<PlistFile*>       m_reading;            ///< Entries in a queued baseline chunk
+    QSet<PlistFile*>       m_retired;            ///< Removed entries freed once their chunk is back
 
     ///< Last-alerted values per file to debounce duplicate alerts
     QHash<QString, QString> m_lastAlertedValue;
@@ -2,8 +2,11 @@
 #define MACOSROLLBACK_H
 
 #include <QObject>
+#include <QPointer>
 #include "plistFile.h"
 
+class ChangeDispatcher;
+
 /**
  * @brief Handles rollback operations for monitored macOS plist files.
  *
@@ -45,6 +48,13 @@ public:
      */
     void cancelRollback(PlistFile* plist);
 
+    /**
+     * @brief Route the rollback's database bookkeeping through a dispatcher.
+     * @param dispatcher Dispatcher whose current check cycle the write joins;
+     *                   nullptr writes inline (the default).
+     */
+    void setDispatcher(ChangeDispatcher *dispatcher);
+
 signals:
     /**
      * @brief Emitted when a rollback operation has been completed.
@@ -58,6 +68,8 @@ private:
      * @param plist Pointer to the PlistFile whose value will be restored.
      */
     void restorePreviousValue(PlistFile* plist);
+
+    QPointer<ChangeDispatcher> m_dispatcher;  ///< Optional lane router for DB writes
 };
 
 #endif // MACOSROLLBACK_H
@@ -5,6 +5,8 @@
 #include <QList>     ///< QList class for managing lists of items
 #include "registryKey.h" ///< RegistryKey class definition for use in this header
 
+class ConfigSource;
+
 /**
  * @brief Utility namespace for JSON-based registry key I/O on Windows.
  *
@@ -28,6 +30,22 @@ namespace WindowsJsonUtils {
      */
 QList<RegistryKey*> readKeysFromJson(const QString &filePath);
 
+/**
+     * @brief Same as readKeysFromJson(), from JSON text already in memory.
+     * @param json   Raw JSON document.
+     * @param origin Where @p json came from, for log messages.
+     */
+QList<RegistryKey*> parseKeysJson(const QByteArray &json, const QString &origin);
+
+/**
+     * @brief Same as readKeysFromJson(), from a config source.
+     *
+     * An unchanged file is read from the compiled cache without parsing
+     * the JSON (see ItemListCache).
+     * @param source Config source holding the key list.
+     */
+QList<RegistryKey*> loadKeys(const ConfigSource &source);
+
 } // namespace WindowsJsonUtils
 
 #endif // WINDOWSJSONUTILS_H
@@ -3,17 +3,22 @@
 
 #include <QObject>
 #include <QList>
-#include <QTimer>
 #include <QHash>
 #include <QDateTime>
-#include <QFileSystemWatcher>
+#include <QElapsedTimer>
+#include <QThreadPool>
 #include "registryKey.h"
 #include "registryKeyModel.h"
+#include "monitoredItemsProxyModel.h"
 #include "WindowsRollback.h"
 #include "alert.h"
 #include "settings.h"
 #include "monitoringBase.h"
 #include "Database.h"
+#include "changeDispatcher.h"
+#include "clock.h"
+#include "configSource.h"
+#include "tickWatchdog.h"
 
 /**
  * @brief Monitors Windows registry keys for unauthorized changes.
@@ -35,18 +40,39 @@ class WindowsMonitoring : public MonitoringBase {
                    READ registryKeys
                        NOTIFY registryKeysChanged)
 
+    /**
+     * @brief Sorted/filterable view of registryKeys for the monitored-items list.
+     */
+    Q_PROPERTY(MonitoredItemsProxyModel* monitoredItems
+                   READ monitoredItems
+                       CONSTANT)
+
+    /**
+     * @brief Check-cycle budget and throttling state.
+     */
+    Q_PROPERTY(TickWatchdog* watchdog
+                   READ watchdog
+                       CONSTANT)
+
 public:
     /**
      * @brief Construct a WindowsMonitoring instance.
      * @param settings  Pointer to global Settings for thresholds & contact info.
+     * @param source    List of monitored keys; nullptr watches
+     *                  monitoredKeys.json. Not owned.
      * @param parent    Optional QObject parent.
      */
-    explicit WindowsMonitoring(Settings *settings, QObject *parent = nullptr);
+    explicit WindowsMonitoring(Settings *settings, ConfigSource *source = nullptr,
+                               QObject *parent = nullptr);
+
+    /**
+     * @brief Finish background work (see shutdown()).
+     */
+    ~WindowsMonitoring() override;
 
     /**
      * @brief Begin monitoring:
-     *  - Initializes file watcher for JSON config.
-     *  - Starts periodic QTimer scanning.
+     *  - Starts periodic scanning on the check timer.
      */
     Q_INVOKABLE void startMonitoring();
 
@@ -55,6 +81,11 @@ public:
      */
     Q_INVOKABLE void stopMonitoring();
 
+    /**
+     * @brief Stop monitoring, wait for baseline reads and drain the dispatcher.
+     */
+    void shutdown() override;
+
     /**
      * @brief Mark or unmark a registry key as critical.
      * @param keyName    Full name or identifier of the registry key.
@@ -81,6 +112,35 @@ public:
      */
     RegistryKeyModel* registryKeys();
 
+    /**
+     * @brief Sorted/filterable view of registryKeys for the monitored-items list.
+     * @return Pointer to the proxy model.
+     */
+    MonitoredItemsProxyModel* monitoredItems();
+
+    /**
+     * @brief Per-lane queue depth and latency (p50/p99/max) for diagnostics.
+     * @return Map keyed by lane name.
+     */
+    Q_INVOKABLE QVariantMap laneStats() const;
+
+    /**
+     * @brief Check-cycle overruns, missed cycles and throttling level.
+     * @return Pointer to the watchdog.
+     */
+    TickWatchdog* watchdog();
+
+    /**
+     * @brief Whether every key's initial value has been read.
+     * @return False while loadBaselines() is still running.
+     */
+    bool baselinesReady() const;
+
+    /**
+     * @brief Block until all baselines are read and persisted (tools only).
+     */
+    void waitForBaselines();
+
 signals:
     /**
      * @brief Emitted when the overall monitoring status changes.
@@ -118,31 +178,77 @@ signals:
      */
     void changeAcknowledged(const QString &keyName);
 
+    /**
+     * @brief Emitted when every key of the current list has its baseline.
+     */
+    void baselinesLoaded();
+
 private slots:
     /**
-     * @brief Periodic slot invoked by QTimer to scan all monitored keys.
+     * @brief Periodic slot invoked by the check timer to scan all monitored keys.
      */
     void checkForChanges();
 
     /**
-     * @brief Invoked by QFileSystemWatcher when the JSON config file changes.
-     * @param path  Filesystem path to the modified file.
+     * @brief Invoked when the config source reports a new key list.
      */
-    void onMonitoredFileChanged(const QString &path);
+    void onConfigChanged();
 
 private:
+    /// A value change found during the detection pass of checkForChanges().
+    struct DetectedChange {
+        RegistryKey *key;
+        QString      prevValue;
+        QString      currentValue;
+    };
+
+    /**
+     * @brief Apply rollback/alert/persistence policy to one detected change.
+     * @param change The changed key with its previous and current values.
+     */
+    void handleChange(const DetectedChange &change);
+
+    /**
+     * @brief Read the initial value of every key on a thread pool.
+     */
+    void loadBaselines();
+
+    /**
+     * @brief Persist a finished chunk of baselines (monitor thread).
+     * @param chunk      Keys whose baseline was just read.
+     * @param generation loadBaselines() call the chunk belongs to.
+     */
+    void onBaselinesLoaded(const QList<RegistryKey*> &chunk, quint64 generation);
+
+    /**
+     * @brief Fill Settings contacts from the database in the background.
+     */
+    void syncContacts();
+
+    /**
+     * @brief Apply the rows read by syncContacts() (monitor thread).
+     * @param userSettings Rows read from UserSettings.
+     */
+    void applyContacts(const QVector<UserRow> &userSettings);
+
     QList<RegistryKey*>   m_registryKeys;        ///< List of monitored registry keys
     RegistryKeyModel      m_registryKeysModel;   ///< Exposed model for UI binding
+    MonitoredItemsProxyModel m_monitoredItems;   ///< Sorted/filtered view of m_registryKeysModel
     WindowsRollback       m_rollback;            ///< Manages rollback operations
     Alert                 m_alert;               ///< Sends alerts on critical events
     Settings             *m_settings;            ///< User settings & thresholds
-    QTimer                m_timer;               ///< Drives periodic checking
+    ClockTimer            m_timer;               ///< Drives periodic checking
     bool                  m_monitoringActive;    ///< True if monitoring is active
-    Database              m_database;            ///< Logs change events
 
     QHash<QString, QString> m_lastAlertedValue;  ///< Debounce duplicate alerts per key
     QVector<QDateTime>      m_alertTimestamps;   ///< Track global alert send times
-    QFileSystemWatcher      m_fileWatcher;       ///< Watches monitoredKeys.json for updates
+    ConfigSource           *m_configSource;      ///< Supplies the monitored-key list
+    ChangeDispatcher        m_dispatcher;        ///< Priority lanes for change side effects
+    TickWatchdog            m_watchdog;          ///< Cycle budget and non-critical throttling
+    QThreadPool             m_baselinePool;      ///< Reads initial key values
+    QElapsedTimer           m_baselineTimer;     ///< Time taken by the current baseline load
+    quint64                 m_baselineGeneration = 0; ///< Bumped per loadBaselines()
+    int                     m_pendingBaselines = 0;   ///< Keys still being read
 };
 
 #endif // WINDOWSMONITORING_H
@@ -2,8 +2,11 @@
 #define WINDOWSROLLBACK_H
 
 #include <QObject>
+#include <QPointer>
 #include "registryKey.h"
 
+class ChangeDispatcher;
+
 /**
  * @brief Handles rollback operations for monitored Windows registry keys.
  *
@@ -45,6 +48,13 @@ public:
      */
     void cancelRollback(RegistryKey* key);
 
+    /**
+     * @brief Route the rollback's database bookkeeping through a dispatcher.
+     * @param dispatcher Dispatcher whose current check cycle the write joins;
+     *                   nullptr writes inline (the default).
+     */
+    void setDispatcher(ChangeDispatcher *dispatcher);
+
 signals:
     /**
      * @brief Emitted when a rollback operation has been executed.
@@ -58,6 +68,8 @@ private:
      * @param key Pointer to the RegistryKey whose value will be restored.
      */
     void restorePreviousValue(RegistryKey* key);
+
+    QPointer<ChangeDispatcher> m_dispatcher;  ///< Optional lane router for DB writes
 };
 
 #endif // WINDOWSROLLBACK_H
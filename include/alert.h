@@ -3,13 +3,15 @@
 
 #include <QObject>
 #include <QDateTime>
+#include <QMutex>
 #include <vector>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <aws/sns/SNSClient.h>
 #include <aws/sesv2/SESV2Client.h>
 
 // Forward declarations for classes used by Alert
-class Database;
 class Settings;
 
 /**
@@ -57,20 +59,37 @@ private:
      */
     QString resolveAwsConfigPath();
 
+    /**
+     * @brief Creates the AWS clients the first time an alert is sent.
+     * @return true if at least one client is available.
+     */
+    bool ensureClients();
+
+    /**
+     * @brief Copies the notification frequency from Settings; runs on the GUI thread.
+     */
+    void updateAlertsPerHour();
+
     // AWS SNS client used for sending SMS notifications
     std::unique_ptr<Aws::SNS::SNSClient>    m_snsClient;
 
     // AWS SESv2 client used for sending Email notifications
     std::unique_ptr<Aws::SESV2::SESV2Client> m_sesv2Client;
 
-    // Pointer to the database for logging or retrieving alert-related data
-    Database *m_database;
-
     // Pointer to application settings containing alert configuration (e.g., recipients, thresholds)
     Settings *m_settings;
 
+    // Settings.notificationFrequency as alerts per hour, readable from lane workers.
+    std::atomic<int> m_alertsPerHour{0};
+
     // Tracks timestamps of recent alerts for rate limiting.
     std::vector<QDateTime> m_alertTimestamps;
+
+    // Serializes rate-limit checks; sendAlert is called from lane workers.
+    QMutex m_rateMutex;
+
+    // Guards the one-time client creation in ensureClients().
+    std::once_flag m_clientsOnce;
 };
 
 /**
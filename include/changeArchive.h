@@ -0,0 +1,200 @@
+#ifndef CHANGEARCHIVE_H
+#define CHANGEARCHIVE_H
+
+#include <QDateTime>
+#include <QFile>
+#include <QReadWriteLock>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "databaseRows.h"
+
+/// Outcome of an archive scan.
+enum class ScanResult : int {
+    Completed,  ///< Every matching row was visited
+    Stopped,    ///< The visitor returned false
+    Failed      ///< A segment column could not be decoded
+};
+
+/**
+ * @brief One immutable, memory-mapped segment of archived Changes rows.
+ *
+ * Segment layout (little-endian):
+ *
+ *     header   magic "MCA1", version, rowCount, minTs, maxTs,
+ *              criticalCount, acknowledgedCount, column directory
+ *     dict     config names, each stored once (rows refer to them by index)
+ *     ids      zig-zag varint deltas, zlib-compressed
+ *     ts       zig-zag varint deltas in ms since epoch, zlib-compressed
+ *     config   varint dictionary index per row, zlib-compressed
+ *     flags    one byte per row (bit 0 acknowledged, bit 1 critical), zlib-compressed
+ *     values   blocks of kValueBlockRows rows; each block holds the old/new
+ *              ciphertexts length-prefixed and zlib-compressed
+ *
+ * Rows are sorted by timestamp. The header min/max, the dictionary and
+ * the flag counts let a search skip whole segments. Inside a segment the
+ * small columns are filtered first, and only value blocks holding a
+ * matching row are decompressed.
+ */
+class ArchiveSegment {
+public:
+    static constexpr int kValueBlockRows = 256;
+
+    /**
+     * @brief Map and validate a segment file.
+     * @return The segment, or null if the file is missing or malformed.
+     */
+    static std::shared_ptr<ArchiveSegment> open(const QString &filePath);
+
+    /**
+     * @brief Write rows (sorted by timestamp) to a new segment file.
+     * @return True if the file was written and flushed completely.
+     */
+    static bool write(const QString &filePath, const QVector<ChangeRow> &rows);
+
+    ~ArchiveSegment();
+
+    QString filePath() const { return m_file.fileName(); }
+    int     rowCount() const { return m_rowCount; }
+    qint64  minTimestampMs() const { return m_minTs; }
+    qint64  maxTimestampMs() const { return m_maxTs; }
+
+    /// Delete the file once the last reader has released the segment.
+    void markForRemoval() { m_removeOnClose = true; }
+
+    /// @return Ids of every row in the segment (used for crash recovery).
+    QVector<qint64> ids() const;
+
+    /// Retention cutoff of a row; an invalid QDateTime keeps it forever.
+    using CutoffFn = std::function<QDateTime(const QString &configName, bool critical)>;
+
+    /**
+     * @brief Whether every row is older than its cutoff.
+     *
+     * Reads only the timestamp, config and flag columns; @p cutoffFor is
+     * called once per config and criticality, not per row.
+     *
+     * @return False if some row is still retained or a column is corrupt.
+     */
+    bool allExpired(const CutoffFn &cutoffFor) const;
+
+    /**
+     * @brief Visit rows matching the filters, oldest first.
+     * @param startMs/endMs  Inclusive bounds in ms since epoch (INT64_MIN/MAX for none).
+     * @param configName     Exact config filter or empty.
+     * @param ackFilter      Acknowledged filter (null = any).
+     * @param criticalFilter Critical filter (null = any).
+     * @param visitor        Receives rows with ciphertext set; return false to stop.
+     * @return Stopped if the visitor stopped the scan, Failed if a column
+     *         needed by the filters is corrupt.
+     */
+    ScanResult scan(qint64 startMs,
+                    qint64 endMs,
+                    const QString &configName,
+                    const QVariant &ackFilter,
+                    const QVariant &criticalFilter,
+                    const std::function<bool(ChangeRow &&)> &visitor) const;
+
+private:
+    ArchiveSegment() = default;
+
+    enum Column { Ids, Timestamps, Configs, Flags, Values, ColumnCount };
+
+    /// @return Decompressed bytes of a column.
+    QByteArray column(Column c) const;
+
+    QFile        m_file;
+    std::atomic<bool> m_removeOnClose{false};
+    const uchar *m_data = nullptr;
+    qint64       m_size = 0;
+    int          m_rowCount = 0;
+    qint64       m_minTs = 0;
+    qint64       m_maxTs = 0;
+    int          m_criticalCount = 0;
+    int          m_acknowledgedCount = 0;
+    QStringList  m_dictionary;
+    quint64      m_columnOffset[ColumnCount] = {};
+    quint64      m_columnLength[ColumnCount] = {};
+};
+
+/**
+ * @brief Directory of archive segments, searchable alongside the hot table.
+ *
+ * Database::forEachChangeInRange() consults the process-wide instance (if
+ * one was installed) before querying MySQL, so searches span hot and cold
+ * history transparently. Segments are immutable; adding or removing one
+ * swaps the segment list under a lock, and scans work on a snapshot.
+ */
+class ChangeArchive {
+public:
+    /**
+     * @brief Open (creating if needed) an archive directory and map its segments.
+     */
+    explicit ChangeArchive(const QString &directory);
+
+    /// Install or clear the archive consulted by Database searches.
+    static void setInstance(ChangeArchive *archive);
+
+    /// @return Archive consulted by Database searches, or nullptr.
+    static ChangeArchive *instance();
+
+    QString directory() const { return m_directory; }
+
+    /**
+     * @brief Persist rows as a new segment, in two phases.
+     *
+     * The segment is first written as "<name>.pending". Call commit() once
+     * the rows are deleted from the hot table. pendingSegments() lists the
+     * ones a crash left behind so the archiver can finish them.
+     *
+     * @return Pending file path, or empty on failure.
+     */
+    QString stage(const QVector<ChangeRow> &rows);
+
+    /// Make a staged segment visible to searches.
+    bool commit(const QString &pendingPath);
+
+    /**
+     * @brief Pending segments left by an interrupted archive pass.
+     * @return Valid pending files; corrupt ones are deleted.
+     */
+    QStringList pendingSegments() const;
+
+    /**
+     * @brief Delete segments in which every row is past its retention.
+     * @param cutoffFor Cutoff of a row's config and criticality (see ArchiveSegment::allExpired()).
+     * @return Number of segments dropped.
+     */
+    int dropExpiredSegments(const ArchiveSegment::CutoffFn &cutoffFor);
+
+    /// @return Number of committed segments and rows.
+    int segmentCount() const;
+    qint64 rowCount() const;
+
+    /**
+     * @brief Visit archived rows matching the filters, oldest first.
+     * @return Stopped if the visitor stopped the scan, Failed if a segment
+     *         is corrupt (rows before it may already have been visited).
+     */
+    ScanResult scan(const QString &start,
+                    const QString &end,
+                    const QString &configName,
+                    const QVariant &ackFilter,
+                    const QVariant &criticalFilter,
+                    const std::function<bool(ChangeRow &&)> &visitor) const;
+
+private:
+    using SegmentList = QVector<std::shared_ptr<ArchiveSegment>>;
+
+    SegmentList snapshot() const;
+
+    QString                 m_directory;
+    mutable QReadWriteLock  m_lock;
+    SegmentList             m_segments;   ///< Sorted by minimum timestamp
+};
+
+#endif // CHANGEARCHIVE_H
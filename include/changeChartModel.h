@@ -0,0 +1,116 @@
+#ifndef CHANGECHARTMODEL_H
+#define CHANGECHARTMODEL_H
+
+#include <QAbstractTableModel>
+#include <QDateTime>
+#include <QHash>
+#include <QPair>
+#include <QStringList>
+#include <vector>
+#include "clock.h"
+#include "databaseRows.h"
+
+/**
+ * @brief Table model of change counts per day and configuration for the stacked bar chart.
+ *
+ * Rows are dates (chart categories, ascending) and columns are configuration
+ * names (one bar set each), so the model plugs directly into a
+ * VBarModelMapper / QVBarModelMapper. Horizontal header data gives the bar
+ * set labels; vertical header data gives the date.
+ *
+ * The table is built once from Database::changeCountRows()
+ * and then updated incrementally from MonitoringBase::changeRecorded().
+ * Increments are accumulated and published at most once per repaint
+ * interval, as a single dataChanged() range.
+ */
+class ChangeChartModel : public QAbstractTableModel {
+    Q_OBJECT
+    Q_PROPERTY(QStringList categories READ categories NOTIFY categoriesChanged)
+    Q_PROPERTY(int configCount READ configCount NOTIFY shapeChanged)
+    Q_PROPERTY(int dateCount READ dateCount NOTIFY shapeChanged)
+    Q_PROPERTY(int maxStackedValue READ maxStackedValue NOTIFY maxStackedValueChanged)
+
+public:
+    /**
+     * @brief Construct an empty chart model.
+     * @param days   Width of the rolling window in days (today included).
+     * @param parent Optional QObject parent for ownership.
+     */
+    explicit ChangeChartModel(int days = 7, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    /// @return Dates shown on the X axis ("yyyy-MM-dd", ascending).
+    QStringList categories() const { return m_dates; }
+
+    /// @return Number of configurations (bar sets).
+    int configCount() const { return m_configs.size(); }
+
+    /// @return Number of dates (categories).
+    int dateCount() const { return m_dates.size(); }
+
+    /// @return Tallest stacked bar, for scaling the value axis.
+    int maxStackedValue() const { return m_maxStacked; }
+
+    /**
+     * @brief Rebuild the table from the database aggregate.
+     */
+    Q_INVOKABLE void reload();
+
+    /**
+     * @brief Rebuild the table from Database::changeCountRows() output.
+     * @param rows Per-day, per-config counts.
+     */
+    void loadRows(const QVector<ChangeCountRow> &rows);
+
+    /**
+     * @brief Apply buffered increments now instead of at the next repaint.
+     */
+    void flushPending();
+
+public slots:
+    /**
+     * @brief Count one change; published at the next repaint.
+     * @param configName Changed configuration.
+     * @param timestamp  When the change happened.
+     */
+    void recordChange(const QString &configName, const QDateTime &timestamp);
+
+signals:
+    void categoriesChanged();
+    void shapeChanged();
+    void maxStackedValueChanged();
+
+private:
+    /// @return Row for a date, inserting it in sorted position if needed.
+    int ensureDateRow(const QString &date);
+
+    /// @return Column for a configuration, appending it if needed.
+    int ensureConfigColumn(const QString &configName);
+
+    /// Remove rows that have fallen out of the rolling window.
+    void dropExpiredDates();
+
+    /// @return First date ("yyyy-MM-dd") still inside the window.
+    QString windowStart() const;
+
+    void updateMaxStacked();
+
+    int                            m_days;
+    QStringList                    m_dates;         ///< Row → date
+    QStringList                    m_configs;       ///< Column → config name
+    QHash<QString, int>            m_dateRow;       ///< date → row
+    QHash<QString, int>            m_configColumn;  ///< config name → column
+    std::vector<std::vector<int>>  m_counts;        ///< [row][column]
+    std::vector<int>               m_rowTotals;     ///< Stacked height per row
+    int                            m_maxStacked = 0;
+
+    QHash<QPair<QString, QString>, int> m_pending;  ///< (date, config) → increment
+    ClockTimer                     m_repaintTimer;  ///< Single-shot repaint throttle
+};
+
+#endif // CHANGECHARTMODEL_H
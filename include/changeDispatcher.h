@@ -0,0 +1,198 @@
+#ifndef CHANGEDISPATCHER_H
+#define CHANGEDISPATCHER_H
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QVariantMap>
+#include <deque>
+#include <functional>
+#include <vector>
+#include "Database.h"
+
+/**
+ * @brief Priority lanes used to order the work generated by a detected change.
+ *
+ * Lower values are served first. The rollback lane runs inline on the
+ * monitoring thread; every other lane is drained by a dedicated worker.
+ */
+enum class ChangeLane : int {
+    Rollback = 0,        ///< Restore a critical item to its baseline value
+    CriticalAlert,       ///< Notify users about a critical change
+    CriticalPersist,     ///< Database writes belonging to a critical change
+    Persist,             ///< Database writes for non-critical changes (same ordered queue)
+    Alert,               ///< Threshold alerts for non-critical changes
+    Count
+};
+
+/**
+ * @brief Rolling latency record for a single lane.
+ *
+ * Keeps the most recent samples (queue wait + service time, in microseconds)
+ * so percentiles reflect current load rather than the whole process lifetime.
+ */
+class LaneStats {
+public:
+    /// @param capacity Number of recent samples to keep.
+    explicit LaneStats(int capacity = 4096);
+
+    /// Record one completed job's latency.
+    void record(qint64 latencyUs);
+
+    /// @return Latency percentile (0-100) in microseconds, or 0 if empty.
+    qint64 percentile(double p) const;
+
+    /// @return Total number of jobs completed since construction.
+    quint64 completed() const { return m_completed; }
+
+    /// @return Largest latency ever observed, in microseconds.
+    qint64 maximum() const { return m_max; }
+
+private:
+    std::vector<qint64> m_samples;  ///< Ring of recent latencies
+    int     m_next = 0;             ///< Next slot to overwrite
+    bool    m_full = false;         ///< True once the ring has wrapped
+    quint64 m_completed = 0;        ///< Lifetime job count
+    qint64  m_max = 0;              ///< Lifetime worst latency
+};
+
+/**
+ * @brief Worker thread that serves one or more lanes in strict priority order.
+ *
+ * Each lane has its own FIFO; the worker always pops from the highest-priority
+ * non-empty lane, so a backlog in a low lane never delays a higher one.
+ */
+class LaneWorker : public QThread {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Construct a worker serving the given lanes.
+     * @param lanes  Lanes handled by this worker (any order; priority is by enum value).
+     * @param parent Optional parent QObject.
+     */
+    explicit LaneWorker(const QList<ChangeLane> &lanes, QObject *parent = nullptr);
+    ~LaneWorker() override;
+
+    /// Queue a job on one of this worker's lanes.
+    void post(ChangeLane lane, std::function<void()> job);
+
+    /// Ask the worker to finish queued jobs and exit.
+    void shutdown();
+
+    /// @return Number of jobs currently waiting in a lane.
+    int pending(ChangeLane lane) const;
+
+    /// @return Snapshot of the latency statistics for a lane.
+    LaneStats stats(ChangeLane lane) const;
+
+protected:
+    void run() override;
+
+private:
+    struct Job {
+        std::function<void()> fn;
+        QElapsedTimer         queued;
+    };
+
+    QList<ChangeLane>                 m_lanes;
+    std::deque<Job>                   m_queues[int(ChangeLane::Count)];
+    LaneStats                         m_stats[int(ChangeLane::Count)];
+    mutable QMutex                    m_mutex;
+    QWaitCondition                    m_wake;
+    bool                              m_stopping = false;
+};
+
+/**
+ * @brief Routes the side effects of detected changes into priority lanes.
+ *
+ * Monitors classify each change and post its work here:
+ *  - Rollback jobs are queued for the monitoring thread and executed by
+ *    serviceRollbacks() before any other work of the same tick.
+ *  - Critical alerts have a dedicated worker.
+ *  - Threshold alerts have a separate bulk worker, so a burst of
+ *    non-critical changes cannot delay critical alerts.
+ *  - Database writes, critical or not, go to one persistence worker with a
+ *    single FIFO, so they commit in the order they were produced.
+ *
+ * Database writes are staged rather than posted: everything a check cycle
+ * writes (change log rows, configuration upserts, rollback bookkeeping) is
+ * collected between beginTick() and commitTick() and applied as a single
+ * transaction, behind the transactions of earlier cycles. Splitting them
+ * by criticality would let an older batch commit after a newer one and
+ * overwrite last-writer-wins upserts with stale values.
+ */
+class ChangeDispatcher : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ChangeDispatcher(QObject *parent = nullptr);
+    ~ChangeDispatcher() override;
+
+    /**
+     * @brief Finish queued work and stop both workers.
+     *
+     * Called by the owner before the services its jobs use (AWS SDK,
+     * logger) go away; the destructor calls it too.
+     */
+    void shutdown();
+
+    /**
+     * @brief Queue a job on a lane.
+     * @param lane Lane to use; Rollback jobs wait for serviceRollbacks().
+     * @param job  Work to execute. Worker lanes run it on a background thread,
+     *             so it must only touch thread-safe state (e.g. a local Database).
+     */
+    void post(ChangeLane lane, std::function<void()> job);
+
+    /**
+     * @brief Start collecting the database writes of one check cycle.
+     */
+    void beginTick();
+
+    /**
+     * @brief Add a write to the current cycle's unit of work.
+     * @param lane  CriticalPersist or Persist; both use the ordered persistence queue.
+     * @param write Database side effect, run on a worker thread's connection.
+     *
+     * Outside a cycle the write is posted on its own.
+     */
+    void stage(ChangeLane lane, Database::Write write);
+
+    /**
+     * @brief Post the cycle's staged writes as one transaction.
+     */
+    void commitTick();
+
+    /**
+     * @brief Run all queued rollback jobs on the calling thread.
+     *
+     * Called by the monitor right after its detection pass.
+     */
+    void serviceRollbacks();
+
+    /// @return p99 latency for a lane in milliseconds.
+    Q_INVOKABLE double laneP99Ms(int lane) const;
+
+    /// @return Per-lane pending counts, completed counts and p50/p99/max latency.
+    Q_INVOKABLE QVariantMap laneStats() const;
+
+    /// @return Human-readable name of a lane (for logs).
+    static QString laneName(ChangeLane lane);
+
+private:
+    LaneStats statsFor(ChangeLane lane) const;
+
+    std::deque<std::pair<std::function<void()>, QElapsedTimer>> m_rollbacks;
+    LaneStats   m_rollbackStats;
+    std::vector<Database::Write> m_staged;          ///< Writes of the current cycle
+    bool        m_inTick = false;
+    bool        m_shutDown = false;             ///< Workers joined by shutdown()
+    LaneWorker *m_criticalWorker;   ///< Serves CriticalAlert
+    LaneWorker *m_bulkWorker;       ///< Serves Alert
+    LaneWorker *m_persistWorker;    ///< Serves CriticalPersist + Persist, in posting order
+};
+
+#endif // CHANGEDISPATCHER_H
@@ -0,0 +1,110 @@
+#ifndef CHANGEEXPORT_H
+#define CHANGEEXPORT_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVariant>
+#include <atomic>
+
+/**
+ * @brief Streams change history to a CSV or JSON Lines file off the GUI thread.
+ *
+ * Rows come from Database::forEachChangeInRange() (archive segments, then
+ * keyset pages of the table) in fixed-size batches. Each batch is
+ * batch-decrypted in parallel chunks, formatted into a reusable buffer and
+ * written through an optional gzip (or zstd, when built with it) stream,
+ * so memory stays constant whatever the row count.
+ *
+ * The output is written via QSaveFile: it only appears under its final
+ * name once complete, and a cancelled or failed export leaves nothing
+ * behind. Starting a new export or calling cancel() supersedes the
+ * running one.
+ */
+class ChangeExport : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
+
+public:
+    /**
+     * @brief Construct the exporter and its worker pools.
+     * @param parent Optional QObject parent for ownership.
+     */
+    explicit ChangeExport(QObject *parent = nullptr);
+
+    /// Calls shutdown().
+    ~ChangeExport() override;
+
+    /// Cancel any running export and wait for the workers to finish.
+    void shutdown();
+
+    /**
+     * @brief Start an export; progress arrives through exportProgress().
+     * @param filePath       Destination file (a local path or file:// URL).
+     * @param format         "csv" or "jsonl".
+     * @param compression    "none", "gzip" or "zstd".
+     * @param start, end, configName, ackFilter, criticalFilter
+     *                       Same filters as Database::searchChangeHistoryRange().
+     * @return Identifier of this export, echoed by the signals.
+     */
+    Q_INVOKABLE int exportChanges(const QString &filePath,
+                                  const QString &format,
+                                  const QString &compression,
+                                  const QString &start,
+                                  const QString &end,
+                                  const QString &configName,
+                                  const QVariant &ackFilter,
+                                  const QVariant &criticalFilter);
+
+    /// Abandon the running export; the partial file is discarded.
+    Q_INVOKABLE void cancel();
+
+    /// @return Compression names available in this build.
+    Q_INVOKABLE QStringList compressions() const;
+
+    /// @return True while an export is running.
+    bool busy() const { return m_busy; }
+
+signals:
+    void exportStarted(int exportId);
+
+    /// Rows written so far (emitted a few times per second at most).
+    void exportProgress(int exportId, qint64 rows);
+
+    /**
+     * @brief The export completed, failed or was cancelled.
+     * @param error Empty on success.
+     */
+    void exportFinished(int exportId, qint64 rows, bool cancelled, const QString &error);
+
+    void busyChanged();
+
+private:
+    struct Job {
+        quint64  generation = 0;
+        QString  filePath;
+        QString  format;
+        QString  compression;
+        QString  start;
+        QString  end;
+        QString  configName;
+        QVariant ackFilter;
+        QVariant criticalFilter;
+    };
+
+    /// Export job body; runs on m_queryPool.
+    void run(const Job &job);
+
+    bool isCurrent(quint64 generation) const { return m_generation.load() == generation; }
+
+    void setBusy(bool busy);
+
+    QThreadPool            m_queryPool;    ///< One worker with its own DB connection
+    QThreadPool            m_decryptPool;  ///< Parallel batch decryption
+    std::atomic<quint64>   m_generation{0};
+    int                    m_activeId = 0;
+    bool                   m_busy = false;
+};
+
+#endif // CHANGEEXPORT_H
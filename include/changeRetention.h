@@ -0,0 +1,132 @@
+#ifndef CHANGERETENTION_H
+#define CHANGERETENTION_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+
+#include "clock.h"
+
+class ChangeArchive;
+class Database;
+struct ChangePurgeRule;
+
+/**
+ * @brief How long rows of the Changes table are kept.
+ *
+ * Non-critical changes expire after maxAgeDays and critical ones after
+ * criticalMaxAgeDays. A per-config entry overrides both for that config.
+ * A value of 0 or less keeps rows forever.
+ */
+struct RetentionPolicy {
+    int  maxAgeDays         = 90;
+    int  criticalMaxAgeDays = 365;
+    QHash<QString, int> perConfigDays;   ///< config_name → days
+
+    int  chunkSize          = 1000;      ///< Rows per DELETE statement
+    int  chunkPauseMs       = 50;        ///< Pause between chunks (lets replicas catch up)
+    int  intervalMinutes    = 60;        ///< How often the purge runs
+
+    bool partitionByMonth   = false;     ///< Range-partition Changes by month of timestamp
+    int  partitionsAhead    = 3;         ///< Future monthly partitions kept ready
+
+    int  archiveAfterDays   = 0;         ///< Move rows older than this to the archive (0 = off)
+    int  archiveSegmentRows = 50000;     ///< Rows per archive segment
+
+    /// @return Longest retention of any rule (0 if some rule keeps rows forever).
+    int longestDays() const;
+
+    /// @return Retention of a row of @p configName (0 keeps it forever).
+    int daysFor(const QString &configName, bool critical) const;
+
+    /**
+     * @brief Load a policy from JSON; missing keys keep their defaults.
+     * @param filePath Path to a JSON object (see resources/retentionPolicy.json).
+     */
+    static RetentionPolicy fromJson(const QString &filePath);
+
+    /// @return Platform-specific path to resources/retentionPolicy.json.
+    static QString defaultPath();
+};
+
+/**
+ * @brief Background job enforcing a RetentionPolicy on the Changes table.
+ *
+ * Runs on its own thread (and database connection) every intervalMinutes.
+ * Expired rows are deleted in small chunks ordered by the timestamp
+ * indexes, so each statement holds its locks only briefly. When monthly
+ * partitioning is enabled, whole months older than the longest retention
+ * are removed with DROP PARTITION and upcoming months are pre-created.
+ *
+ * With an archive and archiveAfterDays set, rows still retained after the
+ * rules have run are moved into compressed segment files, one segment per
+ * rule. The same rules then expire whole segments once every row in them
+ * is past its own retention.
+ */
+class ChangeRetention : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+
+public:
+    /**
+     * @brief Construct the job; call start() to schedule it.
+     * @param policy  Retention rules to enforce.
+     * @param archive Cold-history archive (may be null); must outlive the job.
+     * @param parent  Optional QObject parent for ownership.
+     */
+    explicit ChangeRetention(const RetentionPolicy &policy,
+                             ChangeArchive *archive = nullptr,
+                             QObject *parent = nullptr);
+
+    /// Calls shutdown().
+    ~ChangeRetention() override;
+
+    /// Stop scheduling purges, stop any running one between chunks and wait for it.
+    void shutdown();
+
+    /// Schedule periodic purges, the first one shortly after startup.
+    void start();
+
+    /// Run a purge now unless one is already in progress.
+    Q_INVOKABLE void runNow();
+
+    /// @return True while a purge is running.
+    bool running() const { return m_running.load(); }
+
+    /// @return Policy being enforced.
+    const RetentionPolicy &policy() const { return m_policy; }
+
+signals:
+    void runningChanged();
+
+    /// A purge pass finished.
+    void purgeFinished(int rowsDeleted, int partitionsDropped, int rowsArchived);
+
+private:
+    /// Worker-thread body of one purge pass.
+    void purge();
+
+    /// Delete rows matching one rule chunk by chunk; @return rows deleted.
+    int purgeRule(Database &db, const ChangePurgeRule &rule);
+
+    /// Move aged rows into archive segments; @return rows archived.
+    int archive(Database &db, const QDateTime &now);
+
+    /// Drop archive segments whose rows have all expired; @return segments dropped.
+    int expireSegments(const QDateTime &now);
+
+    /// Delete unreferenced value keyframes; @return keyframes deleted.
+    int purgeKeyframes(Database &db, const QDateTime &now);
+
+    RetentionPolicy    m_policy;
+    ChangeArchive     *m_archive = nullptr;
+    ClockTimer         m_timer;
+    QThreadPool        m_pool;            ///< One thread with its own DB connection
+    std::atomic<bool>  m_running{false};
+    std::atomic<bool>  m_stopping{false};
+};
+
+#endif // CHANGERETENTION_H
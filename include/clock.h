@@ -0,0 +1,190 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <atomic>
+#include <functional>
+#include <map>
+
+class ClockTimer;
+
+/**
+ * @brief Source of wall-clock time and timers for the engine.
+ *
+ * Everything time-dependent (the monitors' check timer, alert rate
+ * limiting, delayed alerts, retention scheduling, UI throttles) asks
+ * Clock::instance() instead of QDateTime/QTimer directly. Production runs
+ * on SystemClock; tests and replays install a VirtualClock and advance it
+ * explicitly, so a week of traffic takes as long as its callbacks do and
+ * runs in the same order every time.
+ */
+class Clock {
+public:
+    virtual ~Clock() = default;
+
+    /// @return Current local time.
+    virtual QDateTime now() const = 0;
+
+    /**
+     * @brief Run @p fn once after @p ms, like QTimer::singleShot().
+     * @param context Dropped if destroyed first; SystemClock also runs @p fn on its thread.
+     */
+    virtual void singleShot(int ms, QObject *context, std::function<void()> fn) = 0;
+
+    /// @return The installed clock; SystemClock unless setInstance() was called.
+    static Clock *instance();
+
+    /**
+     * @brief Install @p clock process-wide (nullptr restores SystemClock).
+     *
+     * Install before creating timers: running ClockTimers stay on the
+     * clock they were started with.
+     */
+    static void setInstance(Clock *clock);
+
+protected:
+    friend class ClockTimer;
+
+    /// Schedule @p timer to fire after @p ms, then every @p ms if @p repeat.
+    virtual void arm(ClockTimer *timer, int ms, bool repeat) = 0;
+
+    /// Cancel @p timer's pending expiry.
+    virtual void disarm(ClockTimer *timer) = 0;
+
+    /// Deliver one expiry to @p timer.
+    static void fire(ClockTimer *timer);
+
+private:
+    static std::atomic<Clock *> s_instance;
+};
+
+/**
+ * @brief Real time: QDateTime::currentDateTime() and QTimer.
+ */
+class SystemClock : public Clock {
+public:
+    QDateTime now() const override;
+    void singleShot(int ms, QObject *context, std::function<void()> fn) override;
+
+protected:
+    void arm(ClockTimer *timer, int ms, bool repeat) override;
+    void disarm(ClockTimer *timer) override;
+};
+
+/**
+ * @brief Manually advanced time for deterministic tests and replays.
+ *
+ * Time only moves in advance()/advanceTo(), which run every expiry that
+ * falls inside the step in due-time order (ties in scheduling order) on
+ * the calling thread, with now() set to each expiry's due time. Repeating
+ * timers keep a fixed period regardless of how long their callbacks take.
+ * now() may be read from any thread; timers and singleShot() are meant to
+ * be used from the thread that advances the clock.
+ */
+class VirtualClock : public Clock {
+public:
+    /// @param start Initial time (default 2024-01-01 00:00 local).
+    explicit VirtualClock(const QDateTime &start = QDateTime(QDate(2024, 1, 1), QTime(0, 0)));
+
+    QDateTime now() const override;
+    void singleShot(int ms, QObject *context, std::function<void()> fn) override;
+
+    /// Move time forward by @p ms, running everything that falls due.
+    void advance(qint64 ms);
+
+    /// Move time forward to @p time (no-op if it is in the past).
+    void advanceTo(const QDateTime &time);
+
+    /// @return Scheduled expiries (timers and single shots).
+    int pendingCount() const;
+
+    /// @return Due time of the next expiry, or an invalid QDateTime if none.
+    QDateTime nextDue() const;
+
+protected:
+    void arm(ClockTimer *timer, int ms, bool repeat) override;
+    void disarm(ClockTimer *timer) override;
+
+private:
+    using Key = std::pair<qint64, quint64>;   ///< (due ms since epoch, sequence)
+
+    struct Entry {
+        ClockTimer              *timer = nullptr;   ///< Null for single shots
+        int                      intervalMs = 0;
+        bool                     repeat = false;
+        bool                     hasContext = false;
+        QPointer<QObject>        context;
+        std::function<void()>    fn;
+    };
+
+    void schedule(qint64 dueMs, Entry entry);
+
+    std::atomic<qint64>           m_nowMs;
+    mutable QMutex                m_mutex;
+    quint64                       m_sequence = 0;
+    std::map<Key, Entry>          m_queue;
+    QHash<ClockTimer *, Key>      m_timerKeys;
+};
+
+/**
+ * @brief QTimer-like timer driven by a Clock.
+ *
+ * Same surface as the parts of QTimer the engine uses (interval,
+ * single-shot, start/stop, timeout()), and usable from QML as ClockTimer
+ * with interval/repeat/running like Timer. Each start() binds to the clock
+ * installed at that moment.
+ */
+class ClockTimer : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(int interval READ interval WRITE setInterval NOTIFY intervalChanged)
+    Q_PROPERTY(bool repeat READ repeat WRITE setRepeat NOTIFY repeatChanged)
+    Q_PROPERTY(bool running READ isActive WRITE setRunning NOTIFY runningChanged)
+
+public:
+    explicit ClockTimer(QObject *parent = nullptr);
+    ~ClockTimer() override;
+
+    int interval() const { return m_interval; }
+    void setInterval(int ms);
+
+    bool repeat() const { return !m_singleShot; }
+    void setRepeat(bool repeat) { setSingleShot(!repeat); }
+
+    bool isSingleShot() const { return m_singleShot; }
+    void setSingleShot(bool singleShot);
+
+    bool isActive() const { return m_clock != nullptr; }
+    void setRunning(bool running);
+
+    /// Set the interval and (re)start.
+    void start(int ms);
+
+public slots:
+    /// (Re)start with the current interval.
+    void start();
+    void stop();
+
+signals:
+    void timeout();
+    void intervalChanged();
+    void repeatChanged();
+    void runningChanged();
+
+private:
+    friend class Clock;
+    friend class SystemClock;
+
+    void expire();
+
+    QTimer  m_systemTimer;            ///< Backing timer under SystemClock
+    Clock  *m_clock = nullptr;        ///< Clock it is armed on; null when stopped
+    int     m_interval = 0;
+    bool    m_singleShot = false;
+};
+
+#endif // CLOCK_H
@@ -0,0 +1,89 @@
+#ifndef CONFIGSOURCE_H
+#define CONFIGSOURCE_H
+
+#include <QByteArray>
+#include <QFileSystemWatcher>
+#include <QIODevice>
+#include <QObject>
+#include <QString>
+#include <memory>
+
+/**
+ * @brief Where a monitor reads its list of monitored items from.
+ *
+ * The monitors re-read the JSON list whenever changed() fires. Production
+ * uses FileConfigSource on monitoredPlists.json / monitoredKeys.json; tests
+ * and replays pass a MemoryConfigSource to the monitor's constructor.
+ */
+class ConfigSource : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ConfigSource(QObject *parent = nullptr) : QObject(parent) {}
+    ~ConfigSource() override = default;
+
+    /// @return True if read() has something to return.
+    virtual bool isAvailable() const = 0;
+
+    /// @return The current JSON document; empty if unavailable.
+    virtual QByteArray read() const = 0;
+
+    /// @return Human-readable origin for log messages (a path, "memory").
+    virtual QString description() const = 0;
+
+    /// @return The current document as an open device, for streaming; nullptr if unavailable.
+    virtual std::unique_ptr<QIODevice> open() const;
+
+    /// @return True if parsed lists may be cached under description() (see ItemListCache).
+    virtual bool isCacheable() const { return false; }
+
+signals:
+    /// The content may have changed; the owner should read() again.
+    void changed();
+};
+
+/**
+ * @brief JSON file on disk, watched with QFileSystemWatcher.
+ */
+class FileConfigSource : public ConfigSource {
+    Q_OBJECT
+
+public:
+    explicit FileConfigSource(const QString &path, QObject *parent = nullptr);
+
+    bool isAvailable() const override;
+    QByteArray read() const override;
+    QString description() const override { return m_path; }
+    std::unique_ptr<QIODevice> open() const override;
+    bool isCacheable() const override { return true; }
+
+private slots:
+    /// Forward the change and re-add the path, which editors that replace the file drop.
+    void onFileChanged(const QString &path);
+
+private:
+    QString             m_path;
+    QFileSystemWatcher  m_watcher;
+};
+
+/**
+ * @brief JSON held in memory; setContent() emits changed().
+ */
+class MemoryConfigSource : public ConfigSource {
+    Q_OBJECT
+
+public:
+    explicit MemoryConfigSource(const QByteArray &content = QByteArray(), QObject *parent = nullptr);
+
+    bool isAvailable() const override { return !m_content.isEmpty(); }
+    QByteArray read() const override { return m_content; }
+    QString description() const override { return QStringLiteral("memory"); }
+
+    /// Replace the document and notify the owner.
+    void setContent(const QByteArray &content);
+
+private:
+    QByteArray m_content;
+};
+
+#endif // CONFIGSOURCE_H
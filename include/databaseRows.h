@@ -0,0 +1,191 @@
+#ifndef DATABASEROWS_H
+#define DATABASEROWS_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+#include <QVariantList>
+#include <QVariantMap>
+#include <QVector>
+
+class QSqlQuery;
+class QThreadPool;
+
+/**
+ * @file databaseRows.h
+ * @brief Typed result rows returned by Database, with positional decoders.
+ *
+ * Each row type owns the column list it is selected with (kColumns) and an
+ * enum giving every column's position in that list. decode() reads values
+ * by position, so no per-row name lookups or QVariantMap allocations
+ * happen while a result set is walked. A static_assert keeps the enum and
+ * the SQL text in step. Rows become QVariantMaps only at the QML boundary
+ * via toVariantMap().
+ */
+
+namespace DatabaseRows {
+
+/// Number of comma-separated entries in a SELECT column list.
+inline constexpr int columnCount(const char *columns) {
+    int count = 1;
+    for (; *columns; ++columns) {
+        if (*columns == ',') {
+            ++count;
+        }
+    }
+    return count;
+}
+
+/// Convert a typed row list for QML.
+template <typename Row>
+inline QVariantList toVariantList(const QVector<Row> &rows) {
+    QVariantList list;
+    list.reserve(rows.size());
+    for (const Row &row : rows) {
+        list.append(row.toVariantMap());
+    }
+    return list;
+}
+
+} // namespace DatabaseRows
+
+/**
+ * @brief One row of the Changes table.
+ *
+ * oldCipher/newCipher hold the encrypt() output (the stored column with its
+ * outer base64 layer removed); oldValue/newValue stay empty until
+ * DatabaseRows::decryptValues() fills them.
+ *
+ * configName is a monitored entry's name, or for one changed leaf of a
+ * container entry "<entry>|<file>|<key path>" (see leafConfigName()), so
+ * rules keyed by entry name cover the entry's leaf rows too.
+ */
+struct ChangeRow {
+    static constexpr const char *kColumns =
+        "id, config_name, old_value, new_value, acknowledged, critical, timestamp";
+    enum Column { Id, ConfigName, OldValue, NewValue, Acknowledged, Critical, Timestamp, ColumnCount };
+
+    qint64     id = 0;
+    QString    configName;
+    QByteArray oldCipher;
+    QByteArray newCipher;
+    QString    oldValue;      ///< Plaintext, once decrypted
+    QString    newValue;      ///< Plaintext, once decrypted
+    bool       acknowledged = false;
+    bool       critical = false;
+    QDateTime  timestamp;
+
+    /// Decode the current row of a query selected with kColumns.
+    static ChangeRow decode(const QSqlQuery &query);
+
+    /// Keys: id, config_name, old_value, new_value, acknowledged, critical, timestamp.
+    QVariantMap toVariantMap() const;
+
+    /// Separator between the parts of a leaf row's configName.
+    static constexpr QChar kLeafSeparator = u'|';
+
+    /**
+     * @brief configName of a row for one changed leaf of an entry.
+     * @param entryName Entry name (plist valueName, "/" for a whole document).
+     * @param filePath  File holding the entry, so equal names in two files differ.
+     * @param keyPath   Leaf key path, e.g. "NSNavPanel/Recents[0]".
+     */
+    static QString leafConfigName(const QString &entryName, const QString &filePath,
+                                  const QString &keyPath);
+
+    /// @return Entry @p configName belongs to: the leaf name's first part, else itself.
+    static QString entryOf(const QString &configName);
+};
+static_assert(DatabaseRows::columnCount(ChangeRow::kColumns) == ChangeRow::ColumnCount,
+              "ChangeRow::Column out of sync with kColumns");
+
+/**
+ * @brief One row of the ConfigurationSettings table (value still encrypted).
+ *
+ * configValue is encrypt() output of a ValueEnvelope::encode() plaintext;
+ * read it back with EncryptionUtils::decryptBatchBytes() and ValueEnvelope::decode().
+ */
+struct ConfigRow {
+    static constexpr const char *kColumns =
+        "id, config_name, config_path, config_value, is_critical, timestamp";
+    enum Column { Id, ConfigName, ConfigPath, ConfigValue, IsCritical, Timestamp, ColumnCount };
+
+    qint64     id = 0;
+    QString    configName;
+    QString    configPath;
+    QByteArray configValue;
+    bool       isCritical = false;
+    QDateTime  timestamp;
+
+    static ConfigRow decode(const QSqlQuery &query);
+
+    /// Keys: id, config_name, config_path, config_value, is_critical, timestamp.
+    QVariantMap toVariantMap() const;
+};
+static_assert(DatabaseRows::columnCount(ConfigRow::kColumns) == ConfigRow::ColumnCount,
+              "ConfigRow::Column out of sync with kColumns");
+
+/**
+ * @brief One row of the UserSettings table with email/phone decrypted.
+ */
+struct UserRow {
+    static constexpr const char *kColumns =
+        "id, user_email, phone_number, non_critical_threshold, timestamp";
+    enum Column { Id, Email, Phone, Threshold, Timestamp, ColumnCount };
+
+    qint64    id = 0;
+    QString   email;
+    QString   phone;
+    int       threshold = 0;
+    QDateTime timestamp;
+
+    /// Decode and decrypt the current row of a query selected with kColumns.
+    static UserRow decode(const QSqlQuery &query);
+
+    /// Keys: id, email, phone, threshold, timestamp.
+    QVariantMap toVariantMap() const;
+};
+static_assert(DatabaseRows::columnCount(UserRow::kColumns) == UserRow::ColumnCount,
+              "UserRow::Column out of sync with kColumns");
+
+/**
+ * @brief Number of changes for one configuration on one day.
+ */
+struct ChangeCountRow {
+    static constexpr const char *kColumns =
+        "DATE(timestamp) AS date, config_name, COUNT(*) AS change_count";
+    enum Column { Date, ConfigName, Count, ColumnCount };
+
+    QString date;        ///< ISO date ("YYYY-MM-DD")
+    QString configName;
+    int     count = 0;
+
+    static ChangeCountRow decode(const QSqlQuery &query);
+
+    /// Keys: date, config_name, count.
+    QVariantMap toVariantMap() const;
+};
+static_assert(DatabaseRows::columnCount(ChangeCountRow::kColumns) == ChangeCountRow::ColumnCount,
+              "ChangeCountRow::Column out of sync with kColumns");
+
+namespace DatabaseRows {
+
+/**
+ * @brief Decrypt the old/new values of [begin, end) with one batch call.
+ *
+ * Fills oldValue/newValue; values that fail to decrypt become empty.
+ */
+void decryptValues(ChangeRow *begin, ChangeRow *end);
+
+/**
+ * @brief Decrypt [begin, end) in parallel chunks on @p pool.
+ *
+ * Each chunk is one decryptValues() call; ranges shorter than two chunks
+ * of @p minChunk rows are decrypted on the calling thread. Blocks until
+ * every chunk is done.
+ */
+void decryptValuesParallel(QThreadPool &pool, ChangeRow *begin, ChangeRow *end, int minChunk = 64);
+
+} // namespace DatabaseRows
+
+#endif // DATABASEROWS_H
@@ -2,9 +2,11 @@
 #define ENCRYPTIONUTILS_H
 
 #include <QString>
+#include <QStringList>
 #include <QByteArray>
 #include <QDateTime>
 #include <QFileSystemWatcher>
+#include <QMutex>
 
 /**
  * @brief EncryptionUtils provides static methods for encrypting and decrypting data
@@ -27,6 +29,13 @@ public:
      */
     static QByteArray encrypt(const QString &data);
 
+    /**
+     * @brief Encrypts raw bytes; encrypt() is this over the UTF-8 of its input.
+     * @param data The plaintext bytes to encrypt.
+     * @return Base64-encoded ciphertext, or empty for empty input or on failure.
+     */
+    static QByteArray encryptBytes(const QByteArray &data);
+
     /**
      * @brief Decrypts previously encrypted data using the loaded key and IV.
      * @param encryptedData The binary data to decrypt.
@@ -34,6 +43,19 @@ public:
      */
     static QString decrypt(const QByteArray &encryptedData);
 
+    /**
+     * @brief Decrypts many values with one key snapshot and one cipher context.
+     * @param encryptedData Base64-encoded ciphertexts, as produced by encrypt().
+     * @return Plaintexts in input order (empty where decryption failed).
+     */
+    static QStringList decryptBatch(const QList<QByteArray> &encryptedData);
+
+    /**
+     * @brief decryptBatch() without the UTF-8 conversion, for binary payloads.
+     * @return Plaintext bytes in input order (empty where decryption failed).
+     */
+    static QList<QByteArray> decryptBatchBytes(const QList<QByteArray> &encryptedData);
+
     /**
      * @brief Loads encryption keys (key and initialization vector) from the
      *        specified file path. Overrides any existing keys in memory.
@@ -73,6 +95,11 @@ private:
      * @brief File system watcher monitoring the key file for changes.
      */
     static QFileSystemWatcher *keyFileWatcher;
+
+    /**
+     * @brief Protects key, IV and timestamp against concurrent reload.
+     */
+    static QMutex keyMutex;
 };
 
 #endif // ENCRYPTIONUTILS_H
@@ -0,0 +1,102 @@
+#ifndef HISTORYSEARCH_H
+#define HISTORYSEARCH_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QVariant>
+#include <QVariantList>
+#include <QVector>
+#include <atomic>
+#include "databaseRows.h"
+
+/**
+ * @brief Runs change-history searches off the GUI thread and streams plaintext pages.
+ *
+ * The query runs on a dedicated single-thread pool with its own per-thread
+ * Database connection and a forward-only cursor. Rows are grouped into
+ * pages; each page's old/new values are batch-decrypted in parallel chunks
+ * on a second pool and delivered to the GUI thread via pageReady().
+ *
+ * Page size adapts so that fetching plus decrypting one page stays close
+ * to a fixed latency budget: the first rows appear quickly and large
+ * result sets do not flood the event loop.
+ *
+ * Starting a new search or calling cancel() supersedes the running one;
+ * pages from a superseded search are dropped, never delivered.
+ */
+class HistorySearch : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
+
+public:
+    /**
+     * @brief Construct the search service and its worker pools.
+     * @param parent Optional QObject parent for ownership.
+     */
+    explicit HistorySearch(QObject *parent = nullptr);
+
+    /// Calls shutdown().
+    ~HistorySearch() override;
+
+    /// Cancel any running search, release the query connection and wait for the workers.
+    void shutdown();
+
+    /**
+     * @brief Start a search; results arrive through pageReady().
+     * @param start          Start timestamp (inclusive) or empty.
+     * @param end            End timestamp (inclusive) or empty.
+     * @param configName     Exact config name filter or empty.
+     * @param ackFilter      Acknowledged filter (null = any).
+     * @param criticalFilter Critical filter (null = any).
+     * @return Identifier of this search, echoed by the signals.
+     */
+    Q_INVOKABLE int search(const QString &start,
+                           const QString &end,
+                           const QString &configName,
+                           const QVariant &ackFilter,
+                           const QVariant &criticalFilter);
+
+    /// Abandon the running search, if any.
+    Q_INVOKABLE void cancel();
+
+    /// @return True while a search is running.
+    bool busy() const { return m_busy; }
+
+signals:
+    /// A new search began; views should clear previous results.
+    void searchStarted(int searchId);
+
+    /// One page of decrypted rows (QVariantMap per row, oldest first).
+    void pageReady(int searchId, const QVariantList &rows);
+
+    /// The search completed or was cancelled.
+    void searchFinished(int searchId, int total, bool cancelled);
+
+    void busyChanged();
+
+private:
+    /// Query job body; runs on m_queryPool.
+    void runQuery(quint64 generation,
+                  const QString &start,
+                  const QString &end,
+                  const QString &configName,
+                  const QVariant &ackFilter,
+                  const QVariant &criticalFilter);
+
+    /// Decrypt old/new values of @p rows in place using m_decryptPool.
+    void decryptPage(QVector<ChangeRow> &rows);
+
+    /// @return True if @p generation is still the current search.
+    bool isCurrent(quint64 generation) const { return m_generation.load() == generation; }
+
+    /// Set m_busy and notify (GUI thread only).
+    void setBusy(bool busy);
+
+    QThreadPool            m_queryPool;    ///< One worker; searches run one at a time
+    QThreadPool            m_decryptPool;  ///< Parallel batch decryption
+    std::atomic<quint64>   m_generation{0};///< Bumped by search()/cancel()
+    int                    m_activeId = 0; ///< Id of the search shown in the UI
+    bool                   m_busy = false;
+};
+
+#endif // HISTORYSEARCH_H
@@ -0,0 +1,128 @@
+#ifndef ITEMLISTCACHE_H
+#define ITEMLISTCACHE_H
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QIODevice>
+#include <QString>
+#include <QVector>
+
+class ConfigSource;
+
+/**
+ * @brief One validated entry of a monitored-items list.
+ */
+struct ItemSpec {
+    QString hive;               ///< Registry hive; empty for plist entries
+    QString path;               ///< "plistPath" or "keyPath"
+    QString valueName;
+    bool    isCritical = false;
+};
+
+/**
+ * @brief Field layout of a list: which member holds the path and whether
+ *        entries also need a "hive".
+ */
+struct ItemListFormat {
+    const char *pathKey;        ///< "plistPath" (macOS) or "keyPath" (Windows)
+    bool        withHive;       ///< Entries without a "hive" string are invalid
+};
+
+/**
+ * @brief Outcome of reading a list from JSON or from the cache.
+ */
+struct ItemListResult {
+    QVector<ItemSpec> items;
+    bool    ok = false;         ///< False if the document is not a JSON array
+    bool    fromCache = false;  ///< True if no JSON was parsed
+    int     skipped = 0;        ///< Entries dropped as non-objects or missing fields
+    QString error;              ///< Parse error, when !ok
+};
+
+/**
+ * @brief Streaming reader for the monitored-items JSON format.
+ *
+ * Accepts the same documents as QJsonDocument::fromJson followed by the
+ * JsonUtils validation: a top-level array whose objects carry the path,
+ * "valueName", optionally "hive" (strings) and "isCritical" (bool).
+ * Entries that are not objects or lack a required string are skipped;
+ * any syntax error rejects the whole document.
+ *
+ * The device is read in fixed-size chunks and only the entry being parsed
+ * is held besides the result, so memory does not grow with a DOM of the
+ * whole file.
+ */
+class ItemListReader {
+public:
+    /**
+     * @param device Open device positioned at the start of the document.
+     * @param format Path member name and hive requirement.
+     * @param hash   If set, receives every byte read (for the cache key).
+     */
+    ItemListReader(QIODevice *device, const ItemListFormat &format,
+                   QCryptographicHash *hash = nullptr);
+
+    /// Parse the whole document.
+    ItemListResult read();
+
+private:
+    bool fill();
+    int  peek();
+    int  get();
+    void skipWhitespace();
+    bool fail(const char *what);
+    bool readString(QByteArray *utf8);
+    bool readLiteral(const char *word);
+    bool readNumber();
+    bool skipValue(int depth);
+    bool skipContainer(int close, int depth);
+    bool readEntry(ItemSpec &spec);
+
+    QIODevice          *m_device;
+    ItemListFormat      m_format;
+    QCryptographicHash *m_hash;
+    QByteArray          m_buffer;
+    int                 m_pos = 0;
+    qint64              m_offset = 0;     ///< Bytes consumed before m_buffer
+    QByteArray          m_key;            ///< Member name being read (entry level)
+    QByteArray          m_value;          ///< String value being read (entry level)
+    QString             m_error;
+};
+
+/**
+ * @brief Compiled cache of parsed monitored-item lists.
+ *
+ * A validated list is written to a small binary file next to the user's
+ * other caches, keyed by a SHA-256 of the format and the source JSON.
+ * When the JSON is unchanged, load() hashes it and maps the cache instead
+ * of parsing; on a miss it streams the JSON through ItemListReader and
+ * rewrites the cache.
+ *
+ * Cache file layout (little-endian), mapped read-only:
+ *   header   magic "MIL1", version, entryCount, reserved, key[32], fileSize
+ *   entries  flags u8 (bit 0 = critical), then hive, path and valueName,
+ *            each as u32 byte length + UTF-8
+ *
+ * MONITOR_ITEM_CACHE names the cache directory; "off" disables caching.
+ */
+namespace ItemListCache {
+
+/**
+ * @brief Read the list of @p source, from the cache when possible.
+ *
+ * Sources that are not cacheable (in memory) are always parsed.
+ */
+ItemListResult load(const ConfigSource &source, const ItemListFormat &format);
+
+/**
+ * @brief Parse a JSON document without touching the cache.
+ * @param device Open device positioned at the start of the document.
+ */
+ItemListResult parse(QIODevice *device, const ItemListFormat &format);
+
+/// @return Cache file used for the list at @p sourcePath; empty if caching is off.
+QString cacheFileFor(const QString &sourcePath);
+
+} // namespace ItemListCache
+
+#endif // ITEMLISTCACHE_H
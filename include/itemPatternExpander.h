@@ -0,0 +1,122 @@
+#ifndef ITEMPATTERNEXPANDER_H
+#define ITEMPATTERNEXPANDER_H
+
+#include "itemListCache.h"
+
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+#include <QVariantMap>
+#include <QVector>
+
+/**
+ * @brief Expands patterned plist entries into concrete ones and keeps the
+ *        expansion current as directories change.
+ *
+ * A patterned entry uses wildcards in its path, its key, or both:
+ *   - "*", "?" and "[...]" match within one path segment, in directories
+ *     as well as file names (e.g. "/Library/Preferences/com.apple.*.plist").
+ *   - A "**" segment matches any number of directories (symlinked
+ *     directories are not followed).
+ *   - Wildcards in "valueName" match the plist's keys; "*" also matches
+ *     the "/" of nested keys.
+ * Every expanded entry inherits the pattern's isCritical flag.
+ *
+ * Directory listings are cached and each directory the patterns walk
+ * through is watched. A change marks only that directory for rescanning;
+ * after a short delay the patterns are re-matched against the cache, so
+ * unchanged directories are not read again. Keys of plists used with key
+ * wildcards are cached by modification time. New and vanished entries are
+ * reported through expansionChanged(). A pattern whose literal directory
+ * prefix does not exist matches nothing until the list is reloaded.
+ */
+class ItemPatternExpander : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ItemPatternExpander(QObject *parent = nullptr);
+
+    /// @return True if @p spec has wildcards in its path or key.
+    static bool isPattern(const ItemSpec &spec);
+
+    /**
+     * @brief Replace the patterns and expand them.
+     * @param patterns Entries for which isPattern() is true.
+     * @param exclude  "path\nvalueName" of explicit entries, which patterns
+     *                 never produce a second time.
+     * @return The expanded entries.
+     */
+    QVector<ItemSpec> setPatterns(const QVector<ItemSpec> &patterns,
+                                  const QSet<QString> &exclude = QSet<QString>());
+
+    /// @return The current expansion.
+    const QVector<ItemSpec> &expansion() const { return m_expansion; }
+
+    /**
+     * @brief Expansion size and cache/watch counters for diagnostics.
+     * @return Map with patterns, matches, watchedDirectories,
+     *         cachedDirectories, directoryScans and rescans.
+     */
+    Q_INVOKABLE QVariantMap stats() const;
+
+    /// @return "path\nvalueName", the identity of an entry.
+    static QString keyOf(const QString &path, const QString &valueName);
+
+signals:
+    /**
+     * @brief Entries appeared or disappeared after a directory changed.
+     * @param added   New entries.
+     * @param removed Entries whose file or key is gone.
+     */
+    void expansionChanged(const QVector<ItemSpec> &added, const QVector<ItemSpec> &removed);
+
+private slots:
+    void onDirectoryChanged(const QString &directory);
+    void rescan();
+
+private:
+    struct Pattern {
+        ItemSpec                    spec;
+        QString                     root;       ///< Literal directory prefix
+        QStringList                 segments;   ///< Remaining path segments
+        QVector<QRegularExpression> matchers;   ///< One per segment ("**" unused)
+        bool                        keyWildcard = false;
+        QRegularExpression          keyMatcher;
+    };
+
+    struct Listing {
+        QStringList files;
+        QStringList directories;
+    };
+
+    struct PlistKeys {
+        QDateTime   modified;
+        QStringList keys;
+    };
+
+    Listing listing(const QString &directory);
+    void walk(const Pattern &pattern, const QString &directory, int segment, int depth,
+              QStringList &files);
+    QStringList keysOf(const QString &file);
+    QVector<ItemSpec> expandAll();
+
+    QVector<Pattern>            m_patterns;
+    QSet<QString>               m_exclude;
+    QVector<ItemSpec>           m_expansion;
+    QHash<QString, Listing>     m_listings;     ///< Expansion cache per directory
+    QHash<QString, PlistKeys>   m_keys;         ///< Keys of plists with key wildcards
+    QSet<QString>               m_usedDirectories;
+    QSet<QString>               m_dirty;        ///< Directories to re-read on the next rescan
+    QFileSystemWatcher          m_watcher;
+    QTimer                      m_rescanTimer;
+    quint64                     m_directoryScans = 0;
+    quint64                     m_rescans = 0;
+    bool                        m_watchLimitLogged = false;
+};
+
+#endif // ITEMPATTERNEXPANDER_H
@@ -0,0 +1,88 @@
+#ifndef LOGMODEL_H
+#define LOGMODEL_H
+
+#include <QAbstractListModel>
+#include <QDateTime>
+#include <vector>
+
+#include "clock.h"
+
+/**
+ * @brief Capped list model of UI log lines.
+ *
+ * Lines are kept in a fixed-size ring buffer so memory stays bounded and
+ * the oldest lines are evicted once the capacity is reached. Appends are
+ * buffered and published to views at most once per frame, so a burst of
+ * messages costs one rowsInserted/rowsRemoved pair instead of one per line.
+ *
+ * append() must be called on the model's thread; connect signals from other
+ * threads with a queued connection.
+ */
+class LogModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(int capacity READ capacity CONSTANT)
+
+public:
+    /**
+     * @brief Roles exposed to views for each log line.
+     */
+    enum LogRoles {
+        MessageRole = Qt::UserRole + 1,  ///< The log text
+        TimestampRole                    ///< Time the line was appended ("hh:mm:ss")
+    };
+
+    /**
+     * @brief Construct an empty LogModel.
+     * @param capacity Maximum number of lines retained.
+     * @param parent   Optional QObject parent for ownership.
+     */
+    explicit LogModel(int capacity = 2000, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    /// @return Number of lines currently visible to views.
+    int count() const { return m_count; }
+
+    /// @return Maximum number of lines retained.
+    int capacity() const { return int(m_lines.size()); }
+
+    /**
+     * @brief Queue a line; it becomes visible at the next frame flush.
+     * @param message Log text.
+     */
+    Q_INVOKABLE void append(const QString &message);
+
+    /**
+     * @brief Remove every line, including ones not yet flushed.
+     */
+    Q_INVOKABLE void clear();
+
+    /**
+     * @brief Publish buffered lines now instead of at the next frame.
+     */
+    void flushPending();
+
+signals:
+    /// Emitted after a flush or clear changes the number of rows.
+    void countChanged();
+
+private:
+    struct Line {
+        QString   message;
+        QDateTime timestamp;
+    };
+
+    /// @return Ring slot holding the given row.
+    int slotForRow(int row) const { return (m_first + row) % int(m_lines.size()); }
+
+    std::vector<Line> m_lines;    ///< Ring storage, sized to capacity
+    int               m_first = 0;  ///< Slot of row 0
+    int               m_count = 0;  ///< Rows currently published
+    std::vector<Line> m_pending;  ///< Lines appended since the last flush
+    ClockTimer        m_flushTimer; ///< Single-shot, one frame long
+};
+
+#endif // LOGMODEL_H
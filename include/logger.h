@@ -0,0 +1,173 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <QString>
+#include <QDebug>
+#include <atomic>
+#include <optional>
+
+/**
+ * @brief Severity of a log record. Records below a category's level are dropped.
+ */
+enum class LogLevel : int {
+    Trace = 0,
+    Debug,
+    Info,
+    Warning,
+    Error,
+    Off
+};
+
+/**
+ * @brief Subsystem that produced a log record; each has its own runtime level.
+ */
+enum class LogCategory : int {
+    General = 0,   ///< Qt messages and anything uncategorised
+    Monitoring,    ///< Check loop, reloads, user overrides
+    Database,      ///< Schema, queries, connections
+    Crypto,        ///< EncryptionUtils
+    Alert,         ///< SNS / SES delivery and rate limiting
+    Item,          ///< PlistFile / RegistryKey reads and writes
+    Rollback,      ///< MacOSRollback / WindowsRollback
+    Dispatcher,    ///< Priority lanes
+    Count
+};
+
+/**
+ * @brief Lowest level compiled into the binary.
+ *
+ * Statements below this level are eliminated at compile time together with
+ * the evaluation of their arguments. Release builds keep Info and above.
+ */
+#ifndef MONITOR_LOG_COMPILED_LEVEL
+#  ifdef QT_NO_DEBUG
+#    define MONITOR_LOG_COMPILED_LEVEL 2
+#  else
+#    define MONITOR_LOG_COMPILED_LEVEL 0
+#  endif
+#endif
+
+/**
+ * @brief Runtime options for the logger; see Logger::start().
+ */
+struct LoggerConfig {
+    QString  filePath;                          ///< Active log file (rotated as filePath.1 ... .N)
+    qint64   maxFileBytes = 10 * 1024 * 1024;   ///< Rotate once the active file exceeds this
+    int      maxFiles = 5;                      ///< Rotated files to keep
+    LogLevel consoleLevel = LogLevel::Warning;  ///< Also echo records at/above this to stderr
+    int      ringCapacity = 8192;               ///< Records buffered between producers and writer
+    QString  levelSpec;                         ///< e.g. "database=warning,monitoring=info,*=info"
+};
+
+/**
+ * @brief Asynchronous structured logger.
+ *
+ * Producers format a record and push it onto a lock-free ring; a background
+ * writer drains the ring into a rotating JSON-lines file. When the ring is
+ * full records are dropped and counted rather than blocking the caller.
+ * Before start() (or after stop()) records go straight to stderr.
+ */
+class Logger {
+public:
+    /// Start the background writer and install the Qt message handler.
+    static void start(const LoggerConfig &config);
+
+    /// Drain outstanding records, stop the writer and restore the Qt handler.
+    static void stop();
+
+    /// @return True if a record at this level would be kept for the category.
+    static bool isEnabled(LogCategory category, LogLevel level) {
+        return int(level) >= s_levels[int(category)].load(std::memory_order_relaxed);
+    }
+
+    /// Change the runtime level of one category.
+    static void setLevel(LogCategory category, LogLevel level);
+
+    /// Apply a spec such as "database=warning,*=info" ("*" sets every category).
+    static void applyLevelSpec(const QString &spec);
+
+    /// Queue one formatted record; @p suppressed counts rate-limited repeats folded into it.
+    static void write(LogLevel level, LogCategory category, const QString &message,
+                      quint32 suppressed = 0);
+
+    /// @return Records dropped because the ring was full.
+    static quint64 droppedCount();
+
+    /// @return Lower-case name used in the log file for a category/level.
+    static const char *categoryName(LogCategory category);
+    static const char *levelName(LogLevel level);
+
+private:
+    static std::atomic<int> s_levels[int(LogCategory::Count)];
+};
+
+/**
+ * @brief Per-call-site limiter for messages that would otherwise repeat every tick.
+ *
+ * Lets one record through per interval and counts what was suppressed in between.
+ */
+class LogRateGate {
+public:
+    /// @return True if a record may be emitted now.
+    bool allow(qint64 intervalMs);
+
+    /// @return Number of records suppressed since the last allowed one (and reset it).
+    quint32 takeSuppressed() { return m_suppressed.exchange(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<qint64>  m_nextAllowedMs{0};
+    std::atomic<quint32> m_suppressed{0};
+};
+
+/**
+ * @brief Stream used by the MON_* macros; formats like qDebug() and submits on destruction.
+ */
+class LogStream {
+public:
+    LogStream(LogLevel level, LogCategory category, quint32 suppressed = 0);
+    ~LogStream();
+
+    LogStream(const LogStream &) = delete;
+    LogStream &operator=(const LogStream &) = delete;
+
+    template <typename T>
+    LogStream &operator<<(const T &value) {
+        *m_debug << value;
+        return *this;
+    }
+
+private:
+    LogLevel              m_level;
+    LogCategory           m_category;
+    quint32               m_suppressed;
+    QString               m_text;
+    std::optional<QDebug> m_debug;
+};
+
+#define MON_LOG_ENABLED(level, category) \
+    (int(level) >= MONITOR_LOG_COMPILED_LEVEL && Logger::isEnabled(category, level))
+
+/// Log at an explicit level: MON_LOG(LogLevel::Info, LogCategory::Database) << "x" << y;
+#define MON_LOG(level, category) \
+    if (!MON_LOG_ENABLED(level, category)) {} \
+    else LogStream(level, category)
+
+/// Log at most once per intervalMs from this call site; suppressed repeats are counted.
+#define MON_LOG_EVERY(level, category, intervalMs) \
+    if (!MON_LOG_ENABLED(level, category)) {} \
+    else if (LogRateGate *mon_gate_ = [] { static LogRateGate gate; return &gate; }(); \
+             !mon_gate_->allow(intervalMs)) {} \
+    else LogStream(level, category, mon_gate_->takeSuppressed())
+
+#define MON_TRACE(category) MON_LOG(LogLevel::Trace,   category)
+#define MON_DEBUG(category) MON_LOG(LogLevel::Debug,   category)
+#define MON_INFO(category)  MON_LOG(LogLevel::Info,    category)
+#define MON_WARN(category)  MON_LOG(LogLevel::Warning, category)
+#define MON_ERROR(category) MON_LOG(LogLevel::Error,   category)
+
+#define MON_WARN_EVERY(category, intervalMs) \
+    MON_LOG_EVERY(LogLevel::Warning, category, intervalMs)
+#define MON_DEBUG_EVERY(category, intervalMs) \
+    MON_LOG_EVERY(LogLevel::Debug, category, intervalMs)
+
+#endif // LOGGER_H
@@ -0,0 +1,63 @@
+#ifndef MONITOREDITEMSPROXYMODEL_H
+#define MONITOREDITEMSPROXYMODEL_H
+
+#include <QSortFilterProxyModel>
+
+/**
+ * @brief Sorted, filterable view over PlistFileModel or RegistryKeyModel.
+ *
+ * Drives the "monitored items" list: rows are sorted by name and can be
+ * narrowed by a case-insensitive substring and/or to critical entries
+ * only. Filtering and sorting happen in C++, and because the proxy is
+ * dynamic, incremental row edits in the source stay incremental.
+ *
+ * Roles are resolved by name from the source model ("valueName" or
+ * "name", and "isCritical"), so one proxy serves both platforms.
+ */
+class MonitoredItemsProxyModel : public QSortFilterProxyModel {
+    Q_OBJECT
+    Q_PROPERTY(QString filterText READ filterText WRITE setFilterText NOTIFY filterTextChanged)
+    Q_PROPERTY(bool criticalOnly READ criticalOnly WRITE setCriticalOnly NOTIFY criticalOnlyChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    /**
+     * @brief Construct an empty proxy.
+     * @param parent Optional QObject parent for ownership.
+     */
+    explicit MonitoredItemsProxyModel(QObject *parent = nullptr);
+
+    /// Attach the source and resolve its name/critical roles.
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+
+    /// @return Current name filter.
+    QString filterText() const { return m_filterText; }
+
+    /// Set the case-insensitive name filter (empty shows everything).
+    void setFilterText(const QString &text);
+
+    /// @return True if only critical entries are shown.
+    bool criticalOnly() const { return m_criticalOnly; }
+
+    /// Show only critical entries when true.
+    void setCriticalOnly(bool criticalOnly);
+
+    /// @return Number of rows passing the filter.
+    int count() const { return rowCount(); }
+
+signals:
+    void filterTextChanged();
+    void criticalOnlyChanged();
+    void countChanged();
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    QString m_filterText;
+    bool    m_criticalOnly = false;
+    int     m_nameRole = -1;      ///< Source role holding the item name
+    int     m_criticalRole = -1;  ///< Source role holding the critical flag
+};
+
+#endif // MONITOREDITEMSPROXYMODEL_H
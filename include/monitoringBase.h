@@ -2,6 +2,9 @@
 #define MONITORINGBASE_H
 
 #include <QObject>
+#include <QDateTime>
+
+#include "Database.h"
 
 /**
  * @brief Abstract base class for all monitoring modules.
@@ -29,6 +32,35 @@ public:
      */
     virtual ~MonitoringBase() = default;
 
+    /**
+     * @brief Stop monitoring and finish all background work.
+     *
+     * main() calls this before shutting down the logger and the AWS SDK,
+     * which queued alert and persistence jobs still use.
+     */
+    virtual void shutdown() {}
+
+    /**
+     * @brief Write that logs one detected change in the Changes table.
+     *
+     * Both monitors stage this, so every row carries the entry's
+     * criticality and falls under the matching retention rule.
+     *
+     * @param configName Changes.config_name (entry name or leaf key path).
+     * @param oldValue   Value before the change.
+     * @param newValue   Value after the change.
+     * @param critical   Whether the entry is monitored as critical.
+     */
+    static Database::Write changeLogWrite(const QString &configName,
+                                          const QString &oldValue,
+                                          const QString &newValue,
+                                          bool critical)
+    {
+        return [=](Database &db) {
+            return db.insertChange(configName, oldValue, newValue, false, critical);
+        };
+    }
+
 signals:
     /**
      * @brief Emit informational or debug messages.
@@ -37,6 +69,16 @@ signals:
      * Derived classes should emit this to report status or errors.
      */
     void logMessage(const QString &message);
+
+    /**
+     * @brief Emitted whenever a change row is queued for the Changes table.
+     * @param configName Name of the changed entry (Changes.config_name).
+     * @param timestamp  Time the change was detected.
+     *
+     * Lets views such as ChangeChartModel update incrementally instead of
+     * re-querying the database.
+     */
+    void changeRecorded(const QString &configName, const QDateTime &timestamp);
 };
 
 #endif // MONITORINGBASE_H
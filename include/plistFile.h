@@ -1,15 +1,32 @@
 #ifndef PLISTFILE_H
 #define PLISTFILE_H
 
+#include "plistTree.h"
+
 #include <QString>
 #include <QSettings>
 #include <QObject>
+#include <QMutex>
+#include <QSet>
+#include <atomic>
 
 /**
  * @brief Represents a single plist file entry to monitor.
  *
  * Wraps access to a macOS plist key/value pair, tracks its state,
  * handles criticality, rollback cancellation, and change counting.
+ *
+ * valueName() addresses what is watched:
+ *   - A top-level key ("mineffect").
+ *   - A key path into nested dictionaries and arrays
+ *     ("NSNavPanel/Recents[0]"); a name that does not parse as a key path
+ *     is used as a plain key.
+ *   - "/" for the whole document.
+ * Scalars keep their QVariant::toString() text. Dictionaries and arrays
+ * are rendered as canonical JSON (see PlistTree); the parsed tree of each
+ * recent rendering is retained, so an unchanged container is recognised by
+ * its root hash, changedLeaves() can name what changed, and rollbacks can
+ * write the original typed values back.
  */
 class PlistFile : public QObject {
     Q_OBJECT
@@ -38,12 +55,34 @@ public:
                        bool isCritical,
                        QObject *parent = nullptr);
 
+    /**
+     * @brief Open the plist and read the value changes are compared against.
+     *
+     * Safe on a worker thread before the entry is handed to the check loop.
+     */
+    void loadBaseline();
+
+    /// @return True once loadBaseline() finished; the check loop skips the entry until then.
+    bool baselineReady() const { return m_baselineReady.load(std::memory_order_acquire); }
+
     /// @return The filesystem path of the monitored plist.
     QString plistPath() const;
 
     /// @return The key name inside the plist being tracked.
     QString valueName() const;
 
+    /// @return True if valueName() is "/", i.e. every key is watched.
+    bool isWholeDocument() const { return m_wholeDocument; }
+
+    /**
+     * @brief Leaves that differ between two renderings of a container value.
+     *
+     * Key paths are absolute within the plist. Empty if either text is not
+     * a recent container rendering of this entry (e.g. a scalar), in which
+     * case the change is only known as a whole.
+     */
+    QVector<PlistLeafChange> changedLeaves(const QString &from, const QString &to) const;
+
     /// @return The currently stored value for this plist entry.
     QString value() const;
 
@@ -53,8 +92,8 @@ public:
      */
     void setValue(const QString &value);
 
-    /// @return Fresh value read from disk via QSettings.
-    QString getValue();
+    /// @return Fresh value read from disk via QSettings (or the installed ValueStore).
+    QString getCurrentValue() const;
 
     /// @return True if this entry is marked critical.
     bool isCritical() const;
@@ -101,6 +140,13 @@ public:
      */
     void setNewValue(const QString &value);
 
+    /**
+     * @brief Write @p value to the plist (or the installed ValueStore)
+     *        without touching the in-memory state; used by rollbacks.
+     * @return True if the value reads back as written.
+     */
+    bool writeStoredValue(const QString &value);
+
     /// @return Pointer to internal QSettings used for plist I/O.
     QSettings* settings() const { return m_settings; }
 
@@ -139,6 +185,31 @@ signals:
     void previousValueChanged();
 
 private:
+    /// A container value as it was rendered, with its parsed tree.
+    struct Snapshot {
+        QString   text;
+        QVariant  value;
+        PlistTree tree;
+    };
+
+    /// @return m_plistPath with a leading "~" expanded.
+    QString expandedPath() const;
+
+    /**
+     * @brief Read what valueName() addresses.
+     * @param settings Settings to read from; nullptr reads the ValueStore.
+     */
+    QVariant readAddressed(QSettings *settings) const;
+
+    /// Write @p value where valueName() points, leaving sibling values alone.
+    bool writeAddressed(const QVariant &value, bool convertLeaf);
+
+    /// @return Text of @p value; containers are rendered and snapshotted.
+    QString textOf(const QVariant &value) const;
+
+    /// @return The retained snapshot rendered as @p text, or nullptr.
+    const Snapshot *findSnapshot(const QString &text) const;
+
     QString     m_plistPath;          ///< Full path to the plist file
     QString     m_valueName;          ///< The specific key within the plist
     QString     m_value;              ///< Last known value in memory
@@ -150,6 +221,13 @@ private:
     QSettings  *m_settings = nullptr; ///< QSettings for reading/writing plist
     QString     m_newValue;           ///< Pending new value to compare
     int         m_changeCount = 0;    ///< Number of times value has changed
+    std::atomic<bool> m_baselineReady{false};  ///< Set by loadBaseline()
+
+    QVector<PlistKeyPath::Step> m_keyPath;    ///< Parsed valueName; one step for plain keys
+    bool        m_wholeDocument = false;      ///< valueName is "/"
+    mutable QMutex            m_snapshotMutex;
+    mutable QVector<Snapshot> m_snapshots;    ///< Recent container renderings, oldest first
+    mutable QSet<size_t>      m_evicted;      ///< qHash() of renderings dropped from m_snapshots
 };
 
 #endif // PLISTFILE_H
@@ -2,13 +2,14 @@
 #define PLISTFILEMODEL_H
 
 #include <QAbstractListModel>
+#include <QHash>
 #include "plistFile.h"
 
 /**
  * @brief List-model wrapper for displaying and interacting with PlistFile objects.
  *
- * Exposes each PlistFile’s key name, critical flag, and formatted display text
- * as roles consumable by QML or other Qt view layers.
+ * Exposes each PlistFile’s key name, critical flag, formatted display text
+ * and plist path as roles consumable by QML or other Qt view layers.
  */
 class PlistFileModel : public QAbstractListModel {
     Q_OBJECT
@@ -26,7 +27,8 @@ public:
     enum PlistFileRoles {
         ValueNameRole    = Qt::UserRole + 1,  ///< The key name inside the plist
         IsCriticalRole,                      ///< Whether this entry is marked critical
-        DisplayTextRole                      ///< Combined path/key/value text for UI
+        DisplayTextRole,                     ///< Combined path/key/value text for UI
+        PlistPathRole                        ///< Path of the plist holding the key
     };
 
     /**
@@ -52,13 +54,36 @@ public:
     QHash<int, QByteArray> roleNames() const override;
 
     /**
-     * @brief Replace the model’s entire list of PlistFile items.
+     * @brief Bring the model in line with a new list of PlistFile items.
      * @param files List of pointers to PlistFile instances to display.
      *
-     * Emits beginResetModel()/endResetModel() around the update.
+     * Entries are matched by plist path + key name. Rows that disappeared are
+     * removed, new ones inserted, reordered ones moved, and rows whose
+     * entry object was replaced get a dataChanged() limited to the roles
+     * whose values differ, so views keep their existing delegates.
      */
     void setPlistFiles(const QList<PlistFile*> &files);
 
+    /**
+     * @brief O(1) lookup of a row by plist path + key name.
+     *
+     * Expanded patterns can list the same key name in several files, so
+     * the name alone does not identify an entry.
+     *
+     * @param plistPath Path of the plist file.
+     * @param valueName Key name inside the plist.
+     * @return Row index, or -1 if not present.
+     */
+    int rowFor(const QString &plistPath, const QString &valueName) const;
+
+    /**
+     * @brief O(1) lookup of an entry by plist path + key name.
+     * @param plistPath Path of the plist file.
+     * @param valueName Key name inside the plist.
+     * @return The PlistFile, or nullptr if not present.
+     */
+    PlistFile *fileFor(const QString &plistPath, const QString &valueName) const;
+
     /**
      * @brief Clear out all items and reset the model.
      *
@@ -67,7 +92,26 @@ public:
     void resetModel();
 
 private:
-    QList<PlistFile*> m_plistFiles;  ///< Underlying list of monitored PlistFile objects
+    /// @return Identity used to match entries across reloads and for lookups.
+    static QString identity(const PlistFile *file);
+    static QString identity(const QString &plistPath, const QString &valueName);
+
+    /// @return Roles whose values differ between two versions of an entry.
+    static QList<int> changedRoles(const PlistFile *before, const PlistFile *after);
+
+    /// Forward an entry's change signals as per-role dataChanged().
+    void watch(PlistFile *file);
+    void unwatch(PlistFile *file);
+
+    /// Emit dataChanged() for one entry's row.
+    void notifyRoles(const PlistFile *file, const QList<int> &roles);
+
+    /// Recompute both lookup indexes after structural changes.
+    void rebuildIndex();
+
+    QList<PlistFile*>               m_plistFiles;  ///< Underlying list of monitored PlistFile objects
+    QHash<QString, int>             m_rowById;     ///< identity() → row
+    QHash<const PlistFile*, int>    m_rowByFile;   ///< entry → row
 };
 
 #endif // PLISTFILEMODEL_H
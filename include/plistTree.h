@@ -0,0 +1,128 @@
+#ifndef PLISTTREE_H
+#define PLISTTREE_H
+
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+/**
+ * @brief Addressing of values nested inside a plist key.
+ *
+ * A key path names the top-level key followed by dictionary keys separated
+ * by "/" and array indices in brackets, e.g. "NSNavPanel/Recents[0]".
+ */
+namespace PlistKeyPath {
+
+/// One step of a key path: a dictionary key, or an array index when index >= 0.
+struct Step {
+    QString key;
+    int     index = -1;
+};
+
+/**
+ * @brief Split @p keyPath into steps.
+ * @param ok Set to false if the path is malformed (unbalanced or
+ *           non-numeric brackets, empty segments, leading index).
+ */
+QVector<Step> parse(const QString &keyPath, bool *ok = nullptr);
+
+/**
+ * @brief Follow @p steps from @p from on, starting at @p value.
+ * @param found Set to false if a step is missing or addresses the wrong kind.
+ */
+QVariant resolve(const QVariant &value, const QVector<Step> &steps, int from, bool *found = nullptr);
+
+/**
+ * @brief Replace what @p steps from @p from on address inside @p root.
+ *
+ * Missing dictionary keys are created; array indices must exist.
+ * @return False if a step cannot be followed.
+ */
+bool assign(QVariant &root, const QVector<Step> &steps, int from, const QVariant &value);
+
+} // namespace PlistKeyPath
+
+/**
+ * @brief A leaf whose value differs between two parses.
+ */
+struct PlistLeafChange {
+    QString keyPath;    ///< e.g. "NSNavPanel/Recents[0]"
+    QString before;     ///< Rendered old value; empty if the leaf was added
+    QString after;      ///< Rendered new value; empty if the leaf was removed
+};
+
+/**
+ * @brief Parsed plist value with a hash for every subtree.
+ *
+ * Dictionaries and arrays are flattened into nodes; each node's hash covers
+ * its kind, its value or children and, for dictionaries, the keys. Hashes
+ * are seeded per process, so colliding documents cannot be prepared ahead.
+ * Two trees with the same root hash are treated as equal, and diff() skips
+ * every pair of subtrees with equal hashes without visiting them.
+ *
+ * Nesting deeper than a fixed limit is cut off and reported as a leaf.
+ */
+class PlistTree {
+public:
+    PlistTree() = default;
+    explicit PlistTree(const QVariant &root);
+
+    /// @return True for a default-constructed tree.
+    bool isNull() const { return m_nodes.isEmpty(); }
+
+    /// @return Hash of the whole tree; 0 for a null tree.
+    quint64 hash() const { return m_nodes.isEmpty() ? 0 : m_nodes.first().hash; }
+
+    /// @return Number of nodes (containers and leaves).
+    int size() const { return m_nodes.size(); }
+
+    /**
+     * @brief Canonical text of the tree: compact JSON with dictionary keys
+     *        sorted, dates in ISO 8601 and data in hex.
+     */
+    QString render() const;
+
+    /// @return True if @p value is a dictionary or an array.
+    static bool isContainer(const QVariant &value);
+
+    /**
+     * @brief Minimal set of changed leaves between two trees.
+     *
+     * Dictionaries are compared key by key. Arrays are compared after
+     * dropping their common prefix and suffix, so an insertion or removal
+     * reports the affected elements rather than every shifted one. A value
+     * that changes kind, or an added or removed subtree, is one change
+     * carrying its rendered text.
+     *
+     * @param basePath Key path of the trees' root; empty for a document.
+     */
+    static QVector<PlistLeafChange> diff(const PlistTree &before, const PlistTree &after,
+                                         const QString &basePath = QString());
+
+private:
+    enum class Kind : quint8 { Null, Bool, Number, String, Date, Data, Dictionary, Array };
+
+    struct Node {
+        quint64 hash  = 0;
+        Kind    kind  = Kind::Null;
+        int     first = 0;      ///< First child in m_children
+        int     count = 0;      ///< Number of children
+        QString text;           ///< Leaf value
+    };
+
+    struct Child {
+        QString key;            ///< Dictionary key; empty in arrays
+        int     node = 0;
+    };
+
+    int build(const QVariant &value, int depth);
+    QString textOf(int node) const;
+    void renderNode(int node, QString &out) const;
+    static void diffNodes(const PlistTree &before, int a, const PlistTree &after, int b,
+                          const QString &path, QVector<PlistLeafChange> &out);
+
+    QVector<Node>  m_nodes;     ///< Root first; children of a node are contiguous
+    QVector<Child> m_children;
+};
+
+#endif // PLISTTREE_H
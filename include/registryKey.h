@@ -4,6 +4,7 @@
 #include <QString>
 #include <QSettings>
 #include <QObject>
+#include <atomic>
 
 /**
  * @brief Represents and monitors a Windows registry key/value pair.
@@ -40,6 +41,16 @@ public:
                          bool isCritical,
                          QObject *parent = nullptr);
 
+    /**
+     * @brief Read the value changes are compared against.
+     *
+     * Safe on a worker thread before the key is handed to the check loop.
+     */
+    void loadBaseline();
+
+    /// @return True once loadBaseline() finished; the check loop skips the key until then.
+    bool baselineReady() const { return m_baselineReady.load(std::memory_order_acquire); }
+
     /// @return True if the key is marked critical.
     bool isCritical() const;
 
@@ -58,9 +69,15 @@ public:
     /// @return Monitored value name.
     QString valueName() const;
 
+    /// @return Identifier used by the UI and database (the value name).
+    QString name() const;
+
     /// @return In-memory current value.
     QString value() const;
 
+    /// @return Value read directly from the registry.
+    QString getCurrentValue() const;
+
     /**
      * @brief Update the in-memory stored value.
      * @param value New value to store.
@@ -106,6 +123,13 @@ public:
     /// @brief Reset the change counter to zero.
     void resetChangeCount();
 
+    /**
+     * @brief Write @p value to the registry (or the installed ValueStore)
+     *        without touching the in-memory state; used by rollbacks.
+     * @return True if the value reads back as written.
+     */
+    bool writeStoredValue(const QString &value);
+
     /// @return Pointer to QSettings used for registry access.
     QSettings* settings() const;
 
@@ -134,6 +158,9 @@ private:
      */
     QString readCurrentValue() const;
 
+    /// @return Hive and key path as one QSettings registry path.
+    QString fullKey() const;
+
     QString    m_hive;               ///< Hive identifier
     QString    m_keyPath;            ///< Key path within the hive
     QString    m_valueName;          ///< Registry value name
@@ -145,6 +172,7 @@ private:
     int        m_changeCount = 0;    ///< Modification counter
     bool       m_rollbackCancelled = false; ///< Skip next rollback if true
     QSettings* m_settings = nullptr; ///< QSettings for registry I/O
+    std::atomic<bool> m_baselineReady{false}; ///< Set by loadBaseline()
 };
 
 #endif // REGISTRYKEY_H
@@ -2,6 +2,7 @@
 #define REGISTRYKEYMODEL_H
 
 #include <QAbstractListModel>
+#include <QHash>
 #include "registryKey.h"
 
 /**
@@ -52,13 +53,30 @@ public:
     QHash<int, QByteArray> roleNames() const override;
 
     /**
-     * @brief Replace the model’s entire list of RegistryKey items.
+     * @brief Bring the model in line with a new list of RegistryKey items.
      * @param keys List of pointers to RegistryKey instances to display.
      *
-     * Emits beginResetModel()/endResetModel() around the update.
+     * Entries are matched by hive + key path + value name. Rows that
+     * disappeared are removed, new ones inserted, reordered ones moved, and
+     * rows whose entry object was replaced get a dataChanged() limited to
+     * the roles whose values differ, so views keep their existing delegates.
      */
     void setRegistryKeys(const QList<RegistryKey*> &keys);
 
+    /**
+     * @brief O(1) lookup of a row by value name.
+     * @param name Registry value name (RegistryKey::name()).
+     * @return Row index, or -1 if not present.
+     */
+    int rowForName(const QString &name) const;
+
+    /**
+     * @brief O(1) lookup of an entry by value name.
+     * @param name Registry value name (RegistryKey::name()).
+     * @return The RegistryKey, or nullptr if not present.
+     */
+    RegistryKey *keyForName(const QString &name) const;
+
     /**
      * @brief Clear out all items and reset the model.
      *
@@ -67,7 +85,25 @@ public:
     void resetModel();
 
 private:
-    QList<RegistryKey*> m_registryKeys;  ///< Underlying list of monitored RegistryKey objects
+    /// @return Identity used to match entries across reloads.
+    static QString identity(const RegistryKey *key);
+
+    /// @return Roles whose values differ between two versions of an entry.
+    static QList<int> changedRoles(const RegistryKey *before, const RegistryKey *after);
+
+    /// Forward an entry's change signals as per-role dataChanged().
+    void watch(RegistryKey *key);
+    void unwatch(RegistryKey *key);
+
+    /// Emit dataChanged() for one entry's row.
+    void notifyRoles(const RegistryKey *key, const QList<int> &roles);
+
+    /// Recompute both lookup indexes after structural changes.
+    void rebuildIndex();
+
+    QList<RegistryKey*>             m_registryKeys;  ///< Underlying list of monitored RegistryKey objects
+    QHash<QString, int>             m_rowByName;     ///< name → row (first occurrence)
+    QHash<const RegistryKey*, int>  m_rowByKey;      ///< entry → row
 };
 
 #endif // REGISTRYKEYMODEL_H
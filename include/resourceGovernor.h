@@ -0,0 +1,132 @@
+#ifndef RESOURCEGOVERNOR_H
+#define RESOURCEGOVERNOR_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <QVariantMap>
+#include <atomic>
+
+/**
+ * @brief CPU and I/O envelope the engine should stay within; 0 = uncapped.
+ */
+struct ResourceBudget {
+    double cpuPercent = 0;   ///< Share of the whole host (all cores), e.g. 5 = 5 %
+    double iops       = 0;   ///< Read plus write operations per second
+
+    /// @return True if either cap is set.
+    bool isCapped() const { return cpuPercent > 0 || iops > 0; }
+
+    /// Caps from MONITOR_CPU_CAP_PERCENT and MONITOR_IOPS_CAP (unset = uncapped).
+    static ResourceBudget fromEnvironment();
+};
+
+/**
+ * @brief Keeps the engine's own CPU and I/O under a ResourceBudget.
+ *
+ * Once a second the governor samples the process's CPU time and I/O
+ * operation counters, compares the rates against the budget and moves a
+ * throttle level between 0 and 3. Two consecutive samples over a cap raise
+ * the level; ten consecutive samples under 60 % of every cap lower it.
+ * Each level halves the background work the engine does per unit of time:
+ *  - scanSpread(): non-critical items are checked every 2^level cycles
+ *    (the monitors' TickWatchdog applies it; critical items are exempt).
+ *  - batchSize() / pauseMs(): retention and export work in smaller chunks
+ *    with longer pauses between them.
+ *  - workers(): fewer threads for parallel batch decryption.
+ * Critical checks, rollbacks and alerts are never throttled, so their
+ * latency is protected even when the budget cannot be met.
+ *
+ * Samples use real time, not Clock::instance(): CPU and I/O are spent in
+ * real time even when a VirtualClock drives the engine.
+ *
+ * The static accessors read the installed governor and are safe from any
+ * thread; with none installed they return the unthrottled values.
+ */
+class ResourceGovernor : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(int level READ currentLevel NOTIFY levelChanged)
+
+public:
+    static constexpr int kMaxLevel = 3;
+
+    explicit ResourceGovernor(const ResourceBudget &budget, QObject *parent = nullptr);
+
+    /// Begin sampling (the first rates are available after one interval).
+    void start(int intervalMs = 1000);
+    void stop();
+
+    /// @return The current throttle level, 0 (none) to kMaxLevel.
+    int currentLevel() const { return m_level.load(std::memory_order_relaxed); }
+
+    const ResourceBudget &budget() const { return m_budget; }
+
+    /**
+     * @brief Usage, caps and budget compliance for diagnostics.
+     * @return Map with cpuPercent, iops, readBytesPerSec, writeBytesPerSec,
+     *         cpuCapPercent, iopsCap, level, samples, samplesOverCpu,
+     *         samplesOverIops and compliancePercent.
+     */
+    Q_INVOKABLE QVariantMap stats() const;
+
+    /// @return The installed governor, or nullptr when the engine is unthrottled.
+    static ResourceGovernor *instance() { return s_instance.load(std::memory_order_acquire); }
+
+    /// Install @p governor process-wide (nullptr removes it); must outlive its use.
+    static void setInstance(ResourceGovernor *governor) { s_instance.store(governor, std::memory_order_release); }
+
+    /// @return Throttle level of the installed governor (0 without one).
+    static int level();
+
+    /// @return Cycles per check of a non-critical item: 1, 2, 4 or 8.
+    static int scanSpread() { return 1 << level(); }
+
+    /// @return @p normal rows per chunk, halved per level (at least 1).
+    static int batchSize(int normal) { return qMax(1, normal >> level()); }
+
+    /// @return @p normal pause between chunks, doubled per level.
+    static int pauseMs(int normal) { return normal << level(); }
+
+    /// @return @p normal parallel workers, halved per level (at least 1).
+    static int workers(int normal) { return qMax(1, normal >> level()); }
+
+signals:
+    void levelChanged(int level);
+
+private:
+    /// Cumulative counters of this process.
+    struct Usage {
+        qint64 cpuNs = 0;
+        qint64 readOps = 0;
+        qint64 writeOps = 0;
+        qint64 readBytes = 0;
+        qint64 writeBytes = 0;
+    };
+
+    static Usage readUsage();
+    void sample();
+    void setLevel(int level);
+
+    ResourceBudget    m_budget;
+    QTimer            m_timer;
+    QElapsedTimer     m_sinceSample;
+    Usage             m_last;
+    std::atomic<int>  m_level{0};
+    int               m_overStreak = 0;
+    int               m_underStreak = 0;
+    int               m_cores = 1;
+
+    // Last sample's rates and compliance counters
+    double   m_cpuPercent = 0;
+    double   m_iops = 0;
+    double   m_readBytesPerSec = 0;
+    double   m_writeBytesPerSec = 0;
+    quint64  m_samples = 0;
+    quint64  m_overCpu = 0;
+    quint64  m_overIops = 0;
+    quint64  m_compliant = 0;
+
+    static std::atomic<ResourceGovernor *> s_instance;
+};
+
+#endif // RESOURCEGOVERNOR_H
@@ -0,0 +1,51 @@
+#ifndef ROWREORDERINDEX_H
+#define ROWREORDERINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief Finds where a model's existing rows sit while it is being reordered.
+ *
+ * The list models apply a new item list by walking it front to back: row i
+ * is either inserted or moved up from further down, after which rows
+ * [0, i] are final. The remaining old rows keep their original relative
+ * order below row i, so the current row of one of them is i plus the
+ * number of old rows before it that have not been placed yet.
+ *
+ * The index is built once per diff from the identities of the rows
+ * present when the walk starts. It maps each identity to its original
+ * rows and keeps a Fenwick tree of the rows not yet placed, so each lookup
+ * costs O(log n) instead of a scan that rebuilds identity strings.
+ * Duplicate identities are handed out in their original order, matching
+ * a first-match scan.
+ */
+class RowReorderIndex {
+public:
+    /// @param ids Identity of each current row, in row order.
+    explicit RowReorderIndex(const QStringList &ids);
+
+    /**
+     * @brief Current row of the next unplaced row with @p id, marking it placed.
+     * @param id Identity of the row to move into place.
+     * @param placed Number of leading rows that are already final.
+     * @return The row to move from, or -1 when no old row is left for @p id.
+     */
+    int take(const QString &id, int placed);
+
+private:
+    /// Number of unplaced rows whose original row is below @p row.
+    int unplacedBefore(int row) const;
+
+    struct Rows {
+        QVector<int> original;  ///< Original rows with this identity, ascending
+        int next = 0;           ///< First of them not yet placed
+    };
+
+    QHash<QString, Rows> m_rows;
+    QVector<int>         m_tree;  ///< 1-based Fenwick tree over unplaced rows
+};
+
+#endif // ROWREORDERINDEX_H
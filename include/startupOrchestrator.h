@@ -0,0 +1,97 @@
+#ifndef STARTUPORCHESTRATOR_H
+#define STARTUPORCHESTRATOR_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QThreadPool>
+#include <QVariantMap>
+#include <QWaitCondition>
+#include <atomic>
+#include <functional>
+
+/**
+ * @brief Runs independent startup work concurrently and times startup.
+ *
+ * main() submits initializers that do not depend on each other (AWS SDK
+ * setup, database and schema checks, key loading, contact lookup) as named
+ * tasks on a small pool, then shows the window straight away. Code that
+ * needs one of them later blocks in await() only at that point, e.g. the
+ * first alert waits for "aws".
+ *
+ * Milestones (window shown, item baselines read, first check cycle) are
+ * recorded as milliseconds since the orchestrator was created; the first
+ * check logs a one-line startup summary.
+ *
+ * Without an installed orchestrator (bench and replay tools) submit() runs
+ * the task inline and await() returns at once, which is the old serial
+ * behaviour.
+ */
+class StartupOrchestrator : public QObject {
+    Q_OBJECT
+
+public:
+    explicit StartupOrchestrator(QObject *parent = nullptr);
+
+    /// Waits for every task; tasks must not outlive the objects they use.
+    ~StartupOrchestrator() override;
+
+    /**
+     * @brief Start @p task on a worker thread under @p name.
+     *
+     * The worker's database connection is released when the task ends.
+     * Names are unique; a second task with the same name is ignored.
+     */
+    void run(const QString &name, std::function<void()> task);
+
+    /// Block until the task @p name has finished (true), or was never submitted (false).
+    bool waitFor(const QString &name);
+
+    /// Block until every submitted task has finished.
+    void waitForAll();
+
+    /// Record @p name at the current time since startup, once.
+    void mark(const QString &name);
+
+    /**
+     * @brief Task timings and milestones.
+     * @return Map with "tasks" (name → {startMs, durationMs}) and
+     *         "milestones" (name → ms since startup).
+     */
+    Q_INVOKABLE QVariantMap stats() const;
+
+    /// @return The installed orchestrator, or nullptr outside the application.
+    static StartupOrchestrator *instance() { return s_instance.load(std::memory_order_acquire); }
+
+    /// Install @p orchestrator process-wide (nullptr removes it); must outlive its use.
+    static void setInstance(StartupOrchestrator *orchestrator) { s_instance.store(orchestrator, std::memory_order_release); }
+
+    /// run() on the installed orchestrator, or call @p task inline without one.
+    static void submit(const QString &name, std::function<void()> task);
+
+    /// waitFor() on the installed orchestrator; returns immediately without one.
+    static void await(const QString &name);
+
+    /// mark() on the installed orchestrator, if any.
+    static void milestone(const QString &name);
+
+private:
+    struct Task {
+        qint64 startMs = 0;
+        qint64 durationMs = -1;   ///< -1 while running
+    };
+
+    void logSummary() const;
+
+    QElapsedTimer             m_sinceStart;
+    QThreadPool               m_pool;
+    mutable QMutex            m_mutex;
+    QWaitCondition            m_finished;
+    QHash<QString, Task>      m_tasks;
+    QHash<QString, qint64>    m_milestones;
+
+    static std::atomic<StartupOrchestrator *> s_instance;
+};
+
+#endif // STARTUPORCHESTRATOR_H
@@ -0,0 +1,88 @@
+#ifndef STATEMENTCACHE_H
+#define STATEMENTCACHE_H
+
+#include <QHash>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <memory>
+
+/**
+ * @brief Prepared statements kept alive per database connection.
+ *
+ * Every Database method used on a hot path fetches its statement from the
+ * cache of the connection it runs on. The first use prepares it (a server
+ * round trip for MySQL server-side prepares); later uses only bind and
+ * execute. Statements are keyed by a fixed id plus a variant number, so
+ * dynamically built queries (e.g. one per filter combination) each get
+ * their own prepared handle.
+ *
+ * Connections are per thread (see Database::connectionNameForCurrentThread()),
+ * so a cache is only ever touched by the thread owning its connection; the
+ * registry lookup itself is mutex-protected. A returned statement is
+ * borrowed: finish it before another call on the same id/variant reuses it.
+ */
+class StatementCache {
+public:
+    /// Ids of every cached statement.
+    enum Statement : quint16 {
+        InsertUserSettings,
+        FindUserByEmail,
+        FindUserByPhone,
+        UpdateUserSettings,
+        SelectUserSettings,
+        UpsertConfiguration,
+        SelectConfigurations,
+        InsertChange,
+        UpdateAcknowledgment,
+        SelectChanges,
+        ChangesByDate,         ///< variant = filter bitmask
+        ChangeCounts,
+        ChangesInRange,        ///< variant = filter bitmask | 0x20 after the first page
+        PurgeChanges,          ///< variant = rule shape (see Database::purgeChangesChunk)
+        ArchiveCandidates,
+        InsertKeyframe
+    };
+
+    /**
+     * @brief Cache belonging to @p db's connection, created on first use.
+     */
+    static StatementCache &forConnection(const QSqlDatabase &db);
+
+    /**
+     * @brief Drop the cache of a connection that is about to be removed.
+     * @param connectionName Qt SQL connection name.
+     */
+    static void release(const QString &connectionName);
+
+    /**
+     * @brief Prepared statement for @p id / @p variant, preparing @p sql on a miss.
+     * @return The statement, or null if preparing failed (error already logged).
+     *         The handle stays valid even if the entry is discarded meanwhile.
+     */
+    std::shared_ptr<QSqlQuery> acquire(Statement id, quint16 variant, const QString &sql);
+
+    /// Convenience overload for statements without variants.
+    std::shared_ptr<QSqlQuery> acquire(Statement id, const QString &sql) { return acquire(id, 0, sql); }
+
+    /**
+     * @brief Forget one statement, e.g. after the server invalidated it.
+     */
+    void discard(Statement id, quint16 variant = 0);
+
+    /// Forget every statement (after a reconnect).
+    void clear();
+
+    /// @return Number of prepared statements held.
+    int size() const { return int(m_statements.size()); }
+
+private:
+    explicit StatementCache(const QSqlDatabase &db);
+
+    static quint32 key(Statement id, quint16 variant) { return (quint32(id) << 16) | variant; }
+
+    QSqlDatabase                                  m_db;          ///< Connection the statements belong to
+    QHash<quint32, std::shared_ptr<QSqlQuery>>    m_statements;  ///< key(id, variant) → prepared query
+};
+
+#endif // STATEMENTCACHE_H
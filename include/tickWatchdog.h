@@ -0,0 +1,102 @@
+#ifndef TICKWATCHDOG_H
+#define TICKWATCHDOG_H
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QVariantMap>
+#include "changeDispatcher.h"
+
+/**
+ * @brief Measures each check cycle against its interval and throttles
+ *        non-critical items when the host cannot keep up.
+ *
+ * A cycle that runs longer than the check interval is an overrun; the
+ * intervals that passed without a cycle starting (late timers, a blocked
+ * event loop) are counted as missed cycles. After repeated overruns, or one
+ * cycle of twice the interval, the watchdog escalates one step:
+ *  - Spreading: non-critical items are split into 2, 4, then 8 groups and
+ *    each cycle checks one group, so every item is still seen, just later.
+ *  - Shedding: at the widest spread, non-critical items are not checked
+ *    at all until the load drops.
+ * ResourceGovernor::scanSpread() widens the spread further while the
+ * engine is over its CPU/I/O budget.
+ * Critical items are checked every cycle at every level. A long run of
+ * cycles under a quarter of the interval steps back down one level, so
+ * the roughly doubled cost after relaxing still fits comfortably.
+ * Changes on deferred items are found on their next check, compared
+ * against the last value seen, so only intermediate values are lost.
+ */
+class TickWatchdog : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool overloaded READ overloaded NOTIFY stateChanged)
+    Q_PROPERTY(QString state READ stateName NOTIFY stateChanged)
+    Q_PROPERTY(int spread READ spread NOTIFY stateChanged)
+
+public:
+    explicit TickWatchdog(QObject *parent = nullptr);
+
+    /// Set the check interval, which is each cycle's time budget.
+    void setBudget(int ms) { m_budgetMs = ms; }
+
+    /// @return The current time budget in milliseconds.
+    int budget() const { return m_budgetMs; }
+
+    /// Forget the previous cycle, e.g. when monitoring restarts, so the pause is not counted as missed cycles.
+    void restart();
+
+    /// Mark the start of a check cycle.
+    void beginCycle();
+
+    /**
+     * @brief Whether the item at @p index is checked this cycle.
+     * @param index    Position in the monitor's item list.
+     * @param critical Critical items are always checked.
+     */
+    bool admit(int index, bool critical);
+
+    /// Mark the end of the cycle started by beginCycle() and adapt.
+    void endCycle();
+
+    /// @return True while non-critical items are being spread or shed.
+    bool overloaded() const { return m_spread > 1 || m_shedding; }
+
+    /// @return "normal", "spreading" or "shedding".
+    QString stateName() const;
+
+    /// @return Number of groups non-critical items are spread across.
+    int spread() const { return m_spread; }
+
+    /**
+     * @brief Cycle counters and durations for diagnostics.
+     * @return Map with cycles, overruns, missedCycles, deferredItems,
+     *         budgetMs, lastMs, p50Ms, p99Ms, maxMs, spread and state.
+     */
+    Q_INVOKABLE QVariantMap stats() const;
+
+signals:
+    /// Emitted when the throttling level changes.
+    void stateChanged();
+
+private:
+    void escalate(qint64 elapsedMs);
+    void relax();
+
+    int           m_budgetMs = 1000;       ///< The monitors check every second
+    QElapsedTimer m_cycleTimer;            ///< Wall time of the running cycle
+    QDateTime     m_lastStart;             ///< Clock time of the previous cycle start
+    LaneStats     m_durations{1024};       ///< Recent cycle durations (us)
+    qint64        m_lastUs = 0;
+    quint64       m_cycles = 0;
+    quint64       m_overruns = 0;
+    quint64       m_missed = 0;
+    quint64       m_deferred = 0;          ///< Item checks skipped by spreading or shedding
+    int           m_overrunStreak = 0;
+    int           m_calmStreak = 0;
+    int           m_spread = 1;
+    int           m_cycleSpread = 1;       ///< m_spread or the governor's, whichever is wider
+    int           m_phase = 0;             ///< Group checked this cycle
+    bool          m_shedding = false;
+};
+
+#endif // TICKWATCHDOG_H
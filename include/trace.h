@@ -0,0 +1,130 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include "logger.h"
+
+/**
+ * @brief Whether MON_SPAN statements are compiled in.
+ *
+ * With 0 every MON_SPAN disappears at compile time; with 1 an inactive
+ * span costs one relaxed atomic load.
+ */
+#ifndef MONITOR_TRACE_COMPILED
+#  define MONITOR_TRACE_COMPILED 1
+#endif
+
+/**
+ * @brief Scoped-span recorder with Chrome trace export.
+ *
+ * Each thread appends finished spans to its own fixed-size buffer without
+ * locks: the owning thread is the only writer and publishes each span with
+ * a release store, so export can read a consistent prefix at any time.
+ * Buffers are allocated the first time a thread records; a full buffer
+ * drops spans and counts them rather than wrapping.
+ *
+ * setEnabled(true) starts a new recording; spans from the previous one are
+ * discarded as each thread records again. exportChromeTrace() writes the
+ * Trace Event Format that chrome://tracing and ui.perfetto.dev open.
+ */
+class Tracer {
+public:
+    /// Start (clearing the previous recording) or pause recording.
+    static void setEnabled(bool enabled);
+
+    /// @return True while spans are being recorded.
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Write the current recording as Chrome trace JSON.
+     *
+     * Safe while recording; spans finished after the call started may be
+     * missing. Must not race with setEnabled(true).
+     *
+     * @param error Set to a message on failure (optional).
+     * @return True on success.
+     */
+    static bool exportChromeTrace(const QString &path, QString *error = nullptr);
+
+    /// @return Spans recorded in the current recording.
+    static quint64 recordedCount();
+
+    /// @return Spans dropped because a thread's buffer was full.
+    static quint64 droppedCount();
+
+    /// @return Monotonic nanoseconds since the first use of the tracer.
+    static qint64 nowNs();
+
+    /// Append one finished span for the calling thread; @p name must outlive the process.
+    static void record(LogCategory category, const char *name, qint64 startNs, qint64 endNs);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+/**
+ * @brief RAII span used by MON_SPAN: times its scope if tracing is enabled
+ *        when it starts.
+ */
+class TraceSpan {
+public:
+    TraceSpan(LogCategory category, const char *name)
+        : m_name(Tracer::isEnabled() ? name : nullptr)
+        , m_category(category)
+    {
+        if (m_name) {
+            m_startNs = Tracer::nowNs();
+        }
+    }
+
+    ~TraceSpan() {
+        if (m_name) {
+            Tracer::record(m_category, m_name, m_startNs, Tracer::nowNs());
+        }
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char  *m_name;
+    LogCategory  m_category;
+    qint64       m_startNs = 0;
+};
+
+/**
+ * @brief Runtime switch for QML and tools: Tracer behind properties.
+ */
+class TraceControl : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+
+public:
+    explicit TraceControl(QObject *parent = nullptr) : QObject(parent) {}
+
+    bool enabled() const { return Tracer::isEnabled(); }
+    void setEnabled(bool enabled);
+
+    /**
+     * @brief Export the recording (a local path or file:// URL).
+     * @return Empty on success, otherwise the error.
+     */
+    Q_INVOKABLE QString exportTo(const QString &path);
+
+signals:
+    void enabledChanged();
+};
+
+#define MON_SPAN_CONCAT_(a, b) a##b
+#define MON_SPAN_VAR_(line) MON_SPAN_CONCAT_(mon_span_, line)
+
+#if MONITOR_TRACE_COMPILED
+/// Time the enclosing scope: MON_SPAN(LogCategory::Database, "db.applyBatch");
+#  define MON_SPAN(category, name) TraceSpan MON_SPAN_VAR_(__LINE__)(category, name)
+#else
+#  define MON_SPAN(category, name) do {} while (0)
+#endif
+
+#endif // TRACE_H
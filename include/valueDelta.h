@@ -0,0 +1,38 @@
+#ifndef VALUEDELTA_H
+#define VALUEDELTA_H
+
+#include <QByteArray>
+
+/**
+ * @brief Compact binary diff between two versions of a value.
+ *
+ * A delta rebuilds the target from the base with two operations: copy a
+ * run of the base, or insert literal bytes. Runs are found by indexing the
+ * base in 16-byte blocks and scanning the target with a rolling hash, so
+ * edits anywhere in the value (not only one changed region) cost about
+ * their own size. Encoding and applying are linear in the value size.
+ *
+ * Layout: varint target size, then operations, each a varint
+ * (length << 1 | copy) followed by a varint base offset (copy) or the
+ * literal bytes (insert).
+ */
+namespace ValueDelta {
+
+/// @return Delta that turns @p base into @p target.
+QByteArray encode(const QByteArray &base, const QByteArray &target);
+
+/**
+ * @brief Rebuild the target of @p delta from @p base.
+ * @return False if @p delta is malformed or does not fit @p base.
+ */
+bool apply(const QByteArray &base, const QByteArray &delta, QByteArray *target);
+
+/// Append @p value as a little-endian base-128 varint.
+void putVarint(QByteArray &out, quint64 value);
+
+/// Read a varint at @p p, advancing it; false if truncated.
+bool getVarint(const char *&p, const char *end, quint64 &value);
+
+} // namespace ValueDelta
+
+#endif // VALUEDELTA_H
@@ -0,0 +1,66 @@
+#ifndef VALUEENVELOPE_H
+#define VALUEENVELOPE_H
+
+#include <QByteArray>
+#include <QString>
+
+/**
+ * @brief Plaintext layout of a stored value, inside the encryption.
+ *
+ * Legacy values are the value's UTF-8, which never contains the byte 0xFF.
+ * An envelope starts with 0xFF and a flags byte; a delta then names its
+ * keyframe (varint id), and the body follows. A compressed body is a zstd
+ * frame (Zstd) or qCompress() output (Compressed) of the bytes it replaces.
+ *
+ * Values shorter than compressThreshold() keep the legacy layout, so small
+ * values cost nothing extra and older rows need no migration. Compression
+ * uses zstd when the build has it and zlib otherwise; both are always
+ * understood on read, except zstd in a build without it.
+ */
+namespace ValueEnvelope {
+
+enum Flag : quint8 {
+    Delta      = 0x01,          ///< Body is a ValueDelta against a keyframe
+    Compressed = 0x02,          ///< Body is qCompress() output
+    Zstd       = 0x04,          ///< Body is a zstd frame
+};
+
+/**
+ * @brief Smallest body that is compressed, in bytes; 0 disables compression.
+ *
+ * Read once from MONITOR_VALUE_COMPRESS_MIN (default 512).
+ */
+int compressThreshold();
+
+/// Override compressThreshold() for the rest of the process (benchmarks).
+void setCompressThreshold(int bytes);
+
+/// Wrap @p body, compressing it if it reaches the threshold and that makes it smaller.
+QByteArray wrap(const QByteArray &body, quint8 flags, qint64 keyframeId = 0);
+
+/**
+ * @brief Split a stored plaintext.
+ * @return False for legacy (plain UTF-8) values and corrupt envelopes;
+ *         otherwise @p body is decompressed.
+ */
+bool unwrap(const QByteArray &plain, quint8 *flags, qint64 *keyframeId, QByteArray *body);
+
+/// @return True if @p plain starts an envelope (rather than legacy UTF-8).
+bool isEnvelope(const QByteArray &plain);
+
+/**
+ * @brief Plaintext to encrypt for a whole value: its UTF-8, or a
+ *        compressed envelope when the value is large enough to gain.
+ */
+QByteArray encode(const QString &value);
+
+/**
+ * @brief Value of a stored plaintext that is not a delta.
+ * @param ok Set to false for corrupt envelopes and deltas, which need
+ *           their keyframe (see ValueHistory::decode()).
+ */
+QString decode(const QByteArray &plain, bool *ok = nullptr);
+
+} // namespace ValueEnvelope
+
+#endif // VALUEENVELOPE_H
@@ -0,0 +1,156 @@
+#ifndef VALUEHISTORY_H
+#define VALUEHISTORY_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <atomic>
+#include "valueEnvelope.h"
+
+class Database;
+struct ChangeRow;
+
+/**
+ * @brief When Changes values are stored as deltas.
+ */
+struct DeltaPolicy {
+    int keyframeInterval = 0;   ///< Rows per keyframe chain; 0 disables delta storage
+    int minValueBytes = 256;    ///< Smaller values are always stored whole
+    int maxDeltaPercent = 50;   ///< A larger delta (relative to the value) starts a new keyframe
+
+    bool isEnabled() const { return keyframeInterval > 0; }
+
+    /// Interval from MONITOR_VALUE_DELTA (unset or 0 = off).
+    static DeltaPolicy fromEnvironment();
+};
+
+/**
+ * @brief Delta-encoded storage of Changes values.
+ *
+ * With delta storage on, each configuration keeps a chain. Its keyframe, a
+ * full copy of one version, goes into the ValueKeyframes table. Each row's
+ * old and new values are then stored as deltas against that keyframe and
+ * compressed before encryption. A new keyframe is started every
+ * keyframeInterval rows, and also when a delta would no longer be small.
+ * Values below minValueBytes are stored whole.
+ *
+ * Deltas are taken against the chain's keyframe rather than the previous
+ * row. Rebuilding any version therefore costs one keyframe lookup and one
+ * delta, and rows never depend on each other, so retention can delete or
+ * archive any of them. Keyframes no longer referenced by a row are purged
+ * by the retention pass once they are kKeyframeGraceSecs old; a chain stops
+ * using its keyframe after half that time, so a purged keyframe is never
+ * referenced again. Archived rows are rebuilt to full values first.
+ *
+ * Chains are kept per thread connection as well as per configuration, so a
+ * delta only refers to keyframes written by the same transaction sequence.
+ * A failed batch commit resets every chain.
+ *
+ * Reading does not need an installed instance: decode() rebuilds deltas,
+ * whether or not delta storage is on for writes. Recently used keyframes
+ * are kept in a process-wide cache; missing ones are loaded with one query
+ * per batch, on the calling thread's database connection, so decryption
+ * pools fetch keyframes through their caller (see keyframesFor()).
+ */
+class ValueHistory {
+public:
+    /// Age before an unreferenced keyframe may be purged; chains rotate at half of it.
+    static constexpr int kKeyframeGraceSecs = 3600;
+
+    /// Plaintexts for one Changes row, ready to encrypt.
+    struct Encoded {
+        QByteArray oldValue;
+        QByteArray newValue;
+        qint64     keyframeId = 0;  ///< Keyframe either value refers to; 0 for none
+    };
+
+    explicit ValueHistory(const DeltaPolicy &policy);
+
+    const DeltaPolicy &policy() const { return m_policy; }
+
+    /**
+     * @brief Encode the values of one row of @p configName.
+     *
+     * May write a new keyframe through @p db, within the caller's transaction.
+     */
+    Encoded encode(Database &db, const QString &configName,
+                   const QString &oldValue, const QString &newValue);
+
+    /// Forget every chain; the next row of each configuration starts a keyframe.
+    void reset();
+
+    /// Forget the chains of @p connectionName; called when that connection is removed.
+    void forgetConnection(const QString &connectionName);
+
+    /**
+     * @brief Storage counters for diagnostics.
+     * @return Map with rows, deltaValues, fullValues, keyframes, valueBytes
+     *         (plaintext) and storedBytes (before encryption).
+     */
+    QVariantMap stats() const;
+
+    /// @return The installed history, or nullptr when values are stored whole.
+    static ValueHistory *instance() { return s_instance.load(std::memory_order_acquire); }
+
+    /// Install @p history process-wide (nullptr stores values whole); must outlive its use.
+    static void setInstance(ValueHistory *history) { s_instance.store(history, std::memory_order_release); }
+
+    /**
+     * @brief Values of decrypted stored plaintexts, deltas rebuilt.
+     * @return One string per input; empty where a keyframe is missing or
+     *         the envelope is corrupt.
+     */
+    static QStringList decode(const QList<QByteArray> &plaintexts);
+
+    /// decode() against @p keyframes only; never touches the database.
+    static QStringList decode(const QList<QByteArray> &plaintexts,
+                              const QHash<qint64, QByteArray> &keyframes);
+
+    /**
+     * @brief Plaintext of every keyframe the deltas in @p plaintexts refer to.
+     *
+     * Served from the cache where possible; the rest is loaded with one
+     * query on the calling thread's connection.
+     */
+    static QHash<qint64, QByteArray> keyframesFor(const QList<QByteArray> &plaintexts);
+
+    /// @return True if @p plaintext is a delta envelope.
+    static bool isDelta(const QByteArray &plaintext);
+
+    /**
+     * @brief Replace delta-encoded ciphers of [begin, end) with full values.
+     *
+     * Used before rows leave the table for archive segments, which must not
+     * depend on ValueKeyframes.
+     */
+    static void materialize(ChangeRow *begin, ChangeRow *end);
+
+private:
+    struct Chain {
+        qint64     keyframeId = 0;
+        QByteArray keyframe;        ///< Plaintext of the keyframe
+        int        rows = 0;        ///< Rows encoded against it
+        QDateTime  created;         ///< Clock time the keyframe was stored
+    };
+
+    QByteArray deltaOf(const Chain &chain, const QByteArray &value) const;
+
+    DeltaPolicy              m_policy;
+    mutable QMutex           m_mutex;
+    QHash<QString, Chain>    m_chains;      ///< By connection + configuration
+    quint64                  m_rows = 0;
+    quint64                  m_deltaValues = 0;
+    quint64                  m_fullValues = 0;
+    quint64                  m_keyframes = 0;
+    quint64                  m_valueBytes = 0;
+    quint64                  m_storedBytes = 0;
+
+    static std::atomic<ValueHistory *> s_instance;
+};
+
+#endif // VALUEHISTORY_H
@@ -0,0 +1,81 @@
+#ifndef VALUESTORE_H
+#define VALUESTORE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVariantMap>
+#include <atomic>
+
+/**
+ * @brief Backing store for monitored item values (plist files, registry keys).
+ *
+ * PlistFile and RegistryKey read and write through QSettings by default.
+ * Installing a store with setInstance() routes all of their I/O, including
+ * rollbacks, through it instead, so tests can run the monitors without
+ * touching the filesystem or the registry.
+ */
+class ValueStore {
+public:
+    virtual ~ValueStore() = default;
+
+    /**
+     * @param location Plist path (with "~" expanded) or full registry key.
+     * @param key      Value name inside @p location.
+     * @return The stored value, or an invalid QVariant if absent.
+     */
+    virtual QVariant value(const QString &location, const QString &key) const = 0;
+
+    /// Store @p value; @return True on success.
+    virtual bool setValue(const QString &location, const QString &key, const QVariant &value) = 0;
+
+    /// @return True if @p location exists at all (a plist file, a registry key).
+    virtual bool exists(const QString &location) const = 0;
+
+    /// @return Names of the values in @p location that hold a value.
+    virtual QStringList keys(const QString &location) const = 0;
+
+    /// @return The installed store, or nullptr when items use QSettings.
+    static ValueStore *instance() { return s_instance.load(std::memory_order_acquire); }
+
+    /// Install @p store process-wide (nullptr restores QSettings); must outlive its use.
+    static void setInstance(ValueStore *store) { s_instance.store(store, std::memory_order_release); }
+
+private:
+    static std::atomic<ValueStore *> s_instance;
+};
+
+/**
+ * @brief Thread-safe in-memory ValueStore.
+ *
+ * Writes from a test stand in for an external process changing a file or
+ * key; writes from the engine (rollbacks, setValue) are counted separately
+ * so a test can assert what the engine did.
+ */
+class MemoryValueStore : public ValueStore {
+public:
+    QVariant value(const QString &location, const QString &key) const override;
+    bool setValue(const QString &location, const QString &key, const QVariant &value) override;
+    bool exists(const QString &location) const override;
+    QStringList keys(const QString &location) const override;
+
+    /// Write as an outside party would; not counted in engineWrites().
+    void put(const QString &location, const QString &key, const QVariant &value);
+
+    /// Remove @p key, or the whole @p location when @p key is empty.
+    void remove(const QString &location, const QString &key = QString());
+
+    /// @return Writes made through setValue() since construction or clear().
+    qint64 engineWrites() const;
+
+    void clear();
+
+private:
+    mutable QMutex               m_mutex;
+    QHash<QString, QVariantMap>  m_locations;
+    qint64                       m_engineWrites = 0;
+};
+
+#endif // VALUESTORE_H
@@ -3,6 +3,7 @@ import QtQuick.Controls 2.15
 import QtQuick.Layouts 1.15
 import QtCharts 2.1
 import Monitor.Database 1.0
+import Monitor.Time 1.0
 import QtQuick.Controls.Material 2.15
 
 ApplicationWindow {
@@ -18,27 +19,22 @@ ApplicationWindow {
     // Monitoring, Logging, & Chart Data Properties
     // ----------------------------------------------------------------
     property string monitoringStatus: "Waiting..."
-    property var logMessages: []
     property var criticalChanges: []
-    property var searchResults: []
-
-    property var chartCategories: []
-    property var barSetModel: []
 
     // ----------------------------------------------------------------
     // Logging and Critical Changes Functions
     // ----------------------------------------------------------------
     function addLog(message) {
-        logMessages.push(message)
-        logArea.text = logMessages.join("\n")
+        // Capped C++ ring buffer; appends are published once per frame
+        LogModel.append(message)
     }
 
-    Timer {
+    ClockTimer {
         id: removalTimer
         interval: 30000
         repeat: false
         running: false
-        onTriggered: {
+        onTimeout: {
             if (criticalChanges.length > 0) {
                 criticalChanges = []
                 criticalChanges.push({ "changeText": "No changes detected yet." })
@@ -84,6 +80,8 @@ ApplicationWindow {
             formatted += "Configuration: " + (result.config_name || "N/A") +
                          " | Approved: " + (result.acknowledged ? "true" : "false") +
                          " | Critical: " + (result.critical ? "true" : "false") +
+                         " | Old: " + (result.old_value || "") +
+                         " | New: " + (result.new_value || "") +
                          " | Date: " + cleanedDate + "\n";
         });
         return formatted.trim();
@@ -131,98 +129,38 @@ ApplicationWindow {
                     ", configName =", searchKeyNameField.text,
                     ", ackFilter =", ackFilter, ", criticalFilter =", criticalFilter);
 
-        let results = Database.searchChangeHistoryRange(
+        // Runs off the GUI thread; decrypted pages arrive via the Connections below
+        HistorySearch.search(
             start,
             end,
             searchKeyNameField.text,
             ackFilter,
             criticalFilter
         );
-        console.log("Updated search results:", results);
-        window.searchResults = results ? results : [];
     }
 
-
-    function buildStackedBarData(data) {
-        var dates = []
-        var configNames = []
-        var dataMap = {}
-
-        // Process each record from the database.
-        for (var i = 0; i < data.length; i++) {
-            var row = data[i]
-            var date = row.date
-            var configName = row.config_name
-            var count = row.count
-
-            if (dates.indexOf(date) === -1) {
-                dates.push(date)
-            }
-            if (configNames.indexOf(configName) === -1) {
-                configNames.push(configName)
-            }
-            // Combined key for lookup.
-            var key = configName + "_" + date
-            dataMap[key] = count
+    // Stream search result pages into the results area as they are decrypted
+    Connections {
+        target: HistorySearch
+        function onSearchStarted(searchId) {
+            searchResultsArea.text = "";
         }
-        dates.sort()
-        console.log("Data for the past 7 days:", data)
-
-        var barSets = []
-        // For each configuration, build an array of values corresponding to each date.
-        for (var i = 0; i < configNames.length; i++) {
-            var configName = configNames[i]
-            var values = []
-            for (var j = 0; j < dates.length; j++) {
-                var date = dates[j]
-                var key = configName + "_" + date
-                values.push(dataMap[key] !== undefined ? dataMap[key] : 0)
+        function onPageReady(searchId, rows) {
+            searchResultsArea.append(formatSearchResults(rows));
+        }
+        function onSearchFinished(searchId, total, cancelled) {
+            if (!cancelled && total === 0) {
+                searchResultsArea.text = "No matching changes.";
             }
-            barSets.push({ "label": configName, "values": values })
         }
-        return { "dates": dates, "barSets": barSets }
     }
 
     // ----------------------------------------------------------------
-    // Initialize the chart data when the component is completed.
+    // Load the chart buckets once; ChangeChart then updates them live.
     // ----------------------------------------------------------------
     Component.onCompleted: {
-       let data = Database.getChangesCountByDateAndConfig()
-       let chartData = buildStackedBarData(data)
-
-       // Set x-axis categories (dates)
-       chartCategories = chartData.dates
-       barSetModel = chartData.barSets
-
-       console.log("Axis Categories (Dates for last 7 days):", chartCategories)
-
-       if (mySeries.barSets && mySeries.barSets.length > 0) {
-           for (var i = mySeries.barSets.length - 1; i >= 0; i--) {
-               mySeries.remove(mySeries.barSets[i])
-           }
-       }
-
-       for (var k = 0; k < barSetModel.length; k++) {
-           let item = barSetModel[k];
-           console.log("BarSet Label:", item.label);
-           console.log("BarSet Values:", item.values);
-           mySeries.append(item.label, item.values);
-       }
-
-       var maxVal = 0;
-       for (var d = 0; d < chartCategories.length; d++) {
-           var cumulative = 0;
-           for (var b = 0; b < barSetModel.length; b++) {
-               cumulative += barSetModel[b].values[d];
-           }
-           if (cumulative > maxVal) {
-               maxVal = cumulative;
-           }
-       }
-       valueAxis.max = maxVal * 1;
-       console.log("Dynamic Y-Axis Max Value:", valueAxis.max);
-       chartView.zoomReset();
-   }
+        ChangeChart.reload()
+    }
 
    Connections {
        target: Monitoring
@@ -290,6 +228,17 @@ ApplicationWindow {
                             color: "darkBlue"
                         }
 
+                        // Shown while cycles overrun and non-critical checks are throttled
+                        Label {
+                            visible: Monitoring && Monitoring.watchdog.overloaded
+                            text: Monitoring && Monitoring.watchdog.state === "shedding"
+                                  ? "Over capacity: non-critical checks paused"
+                                  : "Over capacity: non-critical checks every "
+                                    + (Monitoring ? Monitoring.watchdog.spread : 1) + "s"
+                            font.pixelSize: 14
+                            color: "darkorange"
+                        }
+
                         Button {
                             text: "Start Monitoring"
                             onClicked: {
@@ -393,16 +342,33 @@ ApplicationWindow {
                         Layout.preferredHeight: 300
                         font.pointSize: 10
 
-                        ScrollView {
+                        ListView {
+                            id: logList
                             anchors.fill: parent
                             anchors.margins: 10
+                            clip: true
+                            model: LogModel
+                            reuseItems: true
 
-                            TextArea {
-                                id: logArea
-                                width: parent.width
-                                height: 100
-                                readOnly: true
-                                placeholderText: "[INFO] System monitoring initialized."
+                            // Follow new lines only while the view is scrolled to the bottom
+                            property bool followTail: true
+                            onMovementEnded: followTail = atYEnd
+                            onCountChanged: if (followTail) positionViewAtEnd()
+
+                            ScrollBar.vertical: ScrollBar { }
+
+                            delegate: Text {
+                                width: ListView.view.width
+                                text: model.timestamp + "  " + model.message
+                                wrapMode: Text.WrapAnywhere
+                                font.pointSize: 10
+                            }
+
+                            Label {
+                                anchors.centerIn: parent
+                                visible: logList.count === 0
+                                text: "[INFO] System monitoring initialized."
+                                opacity: 0.6
                             }
                         }
                     }
@@ -526,6 +492,24 @@ ApplicationWindow {
                     anchors.horizontalCenter: parent.horizontalCenter
                     spacing: 10
 
+                    // Filtering/sorting runs in C++ (MonitoredItemsProxyModel)
+                    RowLayout {
+                        Layout.preferredWidth: 700
+                        Layout.alignment: Qt.AlignHCenter
+                        spacing: 10
+
+                        TextField {
+                            Layout.fillWidth: true
+                            placeholderText: "Filter by key name"
+                            onTextChanged: if (Monitoring) Monitoring.monitoredItems.filterText = text
+                        }
+
+                        CheckBox {
+                            text: "Critical only"
+                            onCheckedChanged: if (Monitoring) Monitoring.monitoredItems.criticalOnly = checked
+                        }
+                    }
+
                     GroupBox {
                         title: "Plist Files"
                         font.pointSize: 10
@@ -541,7 +525,7 @@ ApplicationWindow {
                                 id: plistListView
                                 Layout.fillWidth: true
                                 clip: true
-                                model: Monitoring ? Monitoring.plistFiles : []
+                                model: Monitoring ? Monitoring.monitoredItems : []
                                 focus: true
 
                                 delegate: Rectangle {
@@ -563,7 +547,7 @@ ApplicationWindow {
                                             checked: model.isCritical
                                             // When toggled, update the status and log the change.
                                             onCheckedChanged: {
-                                                Monitoring.setFileCriticalStatus(model.valueName, checked)
+                                                Monitoring.setFileCriticalStatus(model.plistPath, model.valueName, checked)
                                                 addLog("[INFO] " + model.valueName +
                                                        (checked ? " marked as critical." : " marked as uncritical."))
                                             }
@@ -581,6 +565,14 @@ ApplicationWindow {
                                                 color: "#333"
                                                 elide: Text.ElideRight
                                             }
+
+                                            // Plist holding the key; names repeat across expanded files
+                                            Text {
+                                                text: model.plistPath
+                                                font.pixelSize: 12
+                                                color: "#777"
+                                                elide: Text.ElideMiddle
+                                            }
                                         }
                                     }
                                     MouseArea {
@@ -749,7 +741,8 @@ ApplicationWindow {
                                     unacknowledgedOnlyCheckBox.checked = false;
                                     criticalOnlyCheckBox.checked = false;
                                     nonCriticalOnlyCheckBox.checked = false;
-                                    window.searchResults = [];
+                                    HistorySearch.cancel();
+                                    searchResultsArea.text = "";
                                 }
                             }
                         }
@@ -775,9 +768,6 @@ ApplicationWindow {
                                     font.pointSize: 10
                                     wrapMode: TextArea.NoWrap
                                     placeholderText: "No search performed."
-                                    text: (window.searchResults && window.searchResults.length > 0)
-                                          ? formatSearchResults(window.searchResults)
-                                          : "No search performed."
                                 }
                             }
                         }
@@ -801,19 +791,28 @@ ApplicationWindow {
 
                     BarCategoryAxis {
                         id: categoryAxisX
-                        categories: chartCategories
+                        categories: ChangeChart.categories
                     }
 
                     ValueAxis {
                         id: valueAxis
                         min: 0
-                        max: valueAxis.max
+                        max: Math.max(1, ChangeChart.maxStackedValue * 1)
                     }
 
                     StackedBarSeries {
                         id: mySeries
                         axisX: categoryAxisX
                         axisY: valueAxis
+
+                        // Columns are configs (bar sets), rows are dates
+                        VBarModelMapper {
+                            model: ChangeChart
+                            firstBarSetColumn: 0
+                            lastBarSetColumn: ChangeChart.configCount - 1
+                            firstRow: 0
+                            rowCount: ChangeChart.dateCount
+                        }
                     }
                 }
             }
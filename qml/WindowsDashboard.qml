@@ -3,6 +3,7 @@ import QtQuick.Controls 2.15
 import QtQuick.Layouts 1.15
 import QtCharts 2.1
 import Monitor.Database 1.0
+import Monitor.Time 1.0
 import QtQuick.Controls.Material 2.15
 
 ApplicationWindow {
@@ -19,29 +20,22 @@ ApplicationWindow {
     // Monitoring, Logging, & Chart Data Properties
     // ----------------------------------------------------------------
     property string monitoringStatus: "Waiting..."
-    property var logMessages: []
     property var criticalChanges: []
-    property var searchResults: []
-
-    // Chart data properties
-    property var chartCategories: []
-    property var barSetModel: []
 
     // ----------------------------------------------------------------
     // Logging and Critical Changes Functions
     // ----------------------------------------------------------------
     function addLog(message) {
-        logMessages.push(message)
-        // Update the text area in the Logs tab
-        logArea.text = logMessages.join("\n")
+        // Capped C++ ring buffer; appends are published once per frame
+        LogModel.append(message)
     }
 
-    Timer {
+    ClockTimer {
         id: removalTimer
         interval: 10000
         repeat: false
         running: false
-        onTriggered: {
+        onTimeout: {
             if (criticalChanges.length > 0) {
                 criticalChanges = []
                 criticalChanges.push({ "changeText": "No changes detected yet." })
@@ -87,6 +81,8 @@ ApplicationWindow {
             formatted += "Configuration: " + (result.config_name || "N/A") +
                          " | Approved: " + (result.acknowledged ? "true" : "false") +
                          " | Critical: " + (result.critical ? "true" : "false") +
+                         " | Old: " + (result.old_value || "") +
+                         " | New: " + (result.new_value || "") +
                          " | Date: " + cleanedDate + "\n";
         });
         return formatted.trim();
@@ -134,94 +130,37 @@ ApplicationWindow {
                     ", configName =", searchKeyNameField.text,
                     ", ackFilter =", ackFilter, ", criticalFilter =", criticalFilter);
 
-        let results = Database.searchChangeHistoryRange(
+        // Runs off the GUI thread; decrypted pages arrive via the Connections below
+        HistorySearch.search(
             start,
             end,
             searchKeyNameField.text,
             ackFilter,
             criticalFilter
         );
-        console.log("Updated search results:", results);
-        window.searchResults = results ? results : [];
     }
 
-    // Build stacked bar data for the Chart
-    function buildStackedBarData(data) {
-        var dates = []
-        var configNames = []
-        var dataMap = {}
-
-        for (var i = 0; i < data.length; i++) {
-            var row = data[i]
-            var date = row.date
-            var configName = row.config_name
-            var count = row.count
-
-            if (dates.indexOf(date) === -1) {
-                dates.push(date)
-            }
-            if (configNames.indexOf(configName) === -1) {
-                configNames.push(configName)
-            }
-            var key = configName + "_" + date
-            dataMap[key] = count
+    // Stream search result pages into the results area as they are decrypted
+    Connections {
+        target: HistorySearch
+        function onSearchStarted(searchId) {
+            searchResultsArea.text = "";
         }
-        dates.sort()
-        console.log("Data for the past 7 days:", data)
-
-        var barSets = []
-        for (var c = 0; c < configNames.length; c++) {
-            var config = configNames[c]
-            var values = []
-            for (var d = 0; d < dates.length; d++) {
-                var dateKey = dates[d]
-                var lookup = config + "_" + dateKey
-                values.push(dataMap[lookup] !== undefined ? dataMap[lookup] : 0)
+        function onPageReady(searchId, rows) {
+            searchResultsArea.append(formatSearchResults(rows));
+        }
+        function onSearchFinished(searchId, total, cancelled) {
+            if (!cancelled && total === 0) {
+                searchResultsArea.text = "No matching changes.";
             }
-            barSets.push({ "label": config, "values": values })
         }
-        return { "dates": dates, "barSets": barSets }
     }
 
     // ----------------------------------------------------------------
-    // Initialize the chart data when the component is completed.
+    // Load the chart buckets once; ChangeChart then updates them live.
     // ----------------------------------------------------------------
     Component.onCompleted: {
-        let data = Database.getChangesCountByDateAndConfig()
-        let chartData = buildStackedBarData(data)
-
-        // Set x-axis categories (dates)
-        chartCategories = chartData.dates
-        barSetModel = chartData.barSets
-
-        console.log("Axis Categories (Dates for last 7 days):", chartCategories)
-
-        if (mySeries.barSets && mySeries.barSets.length > 0) {
-            for (var i = mySeries.barSets.length - 1; i >= 0; i--) {
-                mySeries.remove(mySeries.barSets[i])
-            }
-        }
-
-        for (var k = 0; k < barSetModel.length; k++) {
-            let item = barSetModel[k];
-            console.log("BarSet Label:", item.label);
-            console.log("BarSet Values:", item.values);
-            mySeries.append(item.label, item.values);
-        }
-
-        var maxVal = 0;
-        for (var d = 0; d < chartCategories.length; d++) {
-            var cumulative = 0;
-            for (var b = 0; b < barSetModel.length; b++) {
-                cumulative += barSetModel[b].values[d];
-            }
-            if (cumulative > maxVal) {
-                maxVal = cumulative;
-            }
-        }
-        valueAxis.max = maxVal * 1;
-        console.log("Dynamic Y-Axis Max Value:", valueAxis.max);
-        chartView.zoomReset();
+        ChangeChart.reload()
     }
 
     Connections {
@@ -291,6 +230,17 @@ ApplicationWindow {
                             color: "darkBlue"
                         }
 
+                        // Shown while cycles overrun and non-critical checks are throttled
+                        Label {
+                            visible: Monitoring && Monitoring.watchdog.overloaded
+                            text: Monitoring && Monitoring.watchdog.state === "shedding"
+                                  ? "Over capacity: non-critical checks paused"
+                                  : "Over capacity: non-critical checks every "
+                                    + (Monitoring ? Monitoring.watchdog.spread : 1) + "s"
+                            font.pixelSize: 14
+                            color: "darkorange"
+                        }
+
                         Button {
                             text: "Start Monitoring"
                             onClicked: {
@@ -394,16 +344,33 @@ ApplicationWindow {
                         Layout.preferredHeight: 300
                         font.pointSize: 10
 
-                        ScrollView {
+                        ListView {
+                            id: logList
                             anchors.fill: parent
                             anchors.margins: 10
+                            clip: true
+                            model: LogModel
+                            reuseItems: true
 
-                            TextArea {
-                                id: logArea
-                                width: parent.width
-                                height: 100
-                                readOnly: true
-                                placeholderText: "[INFO] System monitoring initialized."
+                            // Follow new lines only while the view is scrolled to the bottom
+                            property bool followTail: true
+                            onMovementEnded: followTail = atYEnd
+                            onCountChanged: if (followTail) positionViewAtEnd()
+
+                            ScrollBar.vertical: ScrollBar { }
+
+                            delegate: Text {
+                                width: ListView.view.width
+                                text: model.timestamp + "  " + model.message
+                                wrapMode: Text.WrapAnywhere
+                                font.pointSize: 10
+                            }
+
+                            Label {
+                                anchors.centerIn: parent
+                                visible: logList.count === 0
+                                text: "[INFO] System monitoring initialized."
+                                opacity: 0.6
                             }
                         }
                     }
@@ -540,6 +507,24 @@ ApplicationWindow {
                     anchors.topMargin: 20
                     spacing: 20
 
+                    // Filtering/sorting runs in C++ (MonitoredItemsProxyModel)
+                    RowLayout {
+                        Layout.preferredWidth: 700
+                        Layout.alignment: Qt.AlignHCenter
+                        spacing: 10
+
+                        TextField {
+                            Layout.fillWidth: true
+                            placeholderText: "Filter by value name"
+                            onTextChanged: if (Monitoring) Monitoring.monitoredItems.filterText = text
+                        }
+
+                        CheckBox {
+                            text: "Critical only"
+                            onCheckedChanged: if (Monitoring) Monitoring.monitoredItems.criticalOnly = checked
+                        }
+                    }
+
                     GroupBox {
                         title: "Registry Keys"
                         font.pointSize: 10
@@ -555,7 +540,7 @@ ApplicationWindow {
                                 id: keyListView
                                 Layout.fillWidth: true
                                 focus: true
-                                model: Monitoring ? Monitoring.registryKeys : []
+                                model: Monitoring ? Monitoring.monitoredItems : []
 
                                 delegate: Rectangle {
                                     id: keyDelegate
@@ -754,7 +739,8 @@ ApplicationWindow {
                                     unacknowledgedOnlyCheckBox.checked = false;
                                     criticalOnlyCheckBox.checked = false;
                                     nonCriticalOnlyCheckBox.checked = false;
-                                    window.searchResults = [];
+                                    HistorySearch.cancel();
+                                    searchResultsArea.text = "";
                                 }
                             }
                         }
@@ -780,9 +766,6 @@ ApplicationWindow {
                                     font.pointSize: 10
                                     wrapMode: TextArea.NoWrap
                                     placeholderText: "No search performed."
-                                    text: (window.searchResults && window.searchResults.length > 0)
-                                          ? formatSearchResults(window.searchResults)
-                                          : "No search performed."
                                 }
                             }
                         }
@@ -806,19 +789,28 @@ ApplicationWindow {
 
                     BarCategoryAxis {
                         id: categoryAxisX
-                        categories: chartCategories
+                        categories: ChangeChart.categories
                     }
 
                     ValueAxis {
                         id: valueAxis
                         min: 0
-                        max: valueAxis.max * 1.1
+                        max: Math.max(1, ChangeChart.maxStackedValue * 1.1)
                     }
 
                     StackedBarSeries {
                         id: mySeries
                         axisX: categoryAxisX
                         axisY: valueAxis
+
+                        // Columns are configs (bar sets), rows are dates
+                        VBarModelMapper {
+                            model: ChangeChart
+                            firstBarSetColumn: 0
+                            lastBarSetColumn: ChangeChart.configCount - 1
+                            firstRow: 0
+                            rowCount: ChangeChart.dateCount
+                        }
                     }
                 }
             }
@@ -1,5 +1,13 @@
 #include "Database.h"
 #include "EncryptionUtils.h"
+#include "logger.h"
+#include "trace.h"
+#include "databaseRows.h"
+#include "statementCache.h"
+#include "changeArchive.h"
+#include "clock.h"
+#include "valueEnvelope.h"
+#include "valueHistory.h"
 
 #include <QDir>
 #include <QCoreApplication>
@@ -7,10 +15,65 @@
 #include <QSqlError>
 #include <QDebug>
 #include <QRegularExpression>
+#include <QSet>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
 
 // Static flag to ensure we only create the MonitorDB database once per process
 static bool s_databaseInitialized = false;
 
+// Guards the one-time process setup now that Database is used from lane workers
+static QMutex s_initMutex;
+
+// Name of the connection owned by the GUI thread
+static const char *kMainConnectionName = "qt_sql_default_connection";
+
+// Source of worker connection tokens; never reused within the process
+static std::atomic<quint64> s_nextConnectionToken{0};
+
+// Execute a cached statement. A failed statement is discarded so the next
+// call prepares it afresh (the server may have dropped the handle).
+static bool execCached(StatementCache &cache,
+                       QSqlQuery &query,
+                       StatementCache::Statement id,
+                       quint16 variant = 0)
+{
+    MON_SPAN(LogCategory::Database, "db.exec");
+    if (query.exec()) {
+        return true;
+    }
+    cache.discard(id, variant);
+    return false;
+}
+
+// Server and credentials; MONITOR_DB_* environment variables point a bench
+// or soak run at a stand-in server/schema instead of the production one
+struct ConnectionSettings {
+    QString host     = qEnvironmentVariable("MONITOR_DB_HOST", "localhost");
+    int     port     = qEnvironmentVariableIsSet("MONITOR_DB_PORT")
+                           ? qEnvironmentVariableIntValue("MONITOR_DB_PORT") : 3306;
+    QString name     = qEnvironmentVariable("MONITOR_DB_NAME", "MonitorDB");
+    QString user     = qEnvironmentVariable("MONITOR_DB_USER", "monitor_user");
+    QString password = qEnvironmentVariable("MONITOR_DB_PASSWORD", "Monitor1230.");
+};
+
+static const ConnectionSettings &connectionSettings() {
+    static const ConnectionSettings settings = []() {
+        ConnectionSettings s;
+        // The name is spliced into CREATE DATABASE; accept identifiers only
+        static const QRegularExpression identifier("^[A-Za-z0-9_]+$");
+        if (!identifier.match(s.name).hasMatch()) {
+            MON_WARN(LogCategory::Database) << "[DATABASE] Ignoring invalid MONITOR_DB_NAME:" << s.name;
+            s.name = "MonitorDB";
+        }
+        return s;
+    }();
+    return settings;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Constructor / Destructor
 ////////////////////////////////////////////////////////////////////////////////
@@ -18,97 +81,149 @@ static bool s_databaseInitialized = false;
 /**
  * @brief Construct the Database object.
  *
- * - Ensures the MySQL database MonitorDB exists (creates it if not).
- * - Opens a persistent connection to MonitorDB.
+ * - Once per process: ensures the MySQL database MonitorDB exists (creates
+ *   it if not) and loads encryption keys.
+ * - Opens (or reuses) the calling thread's connection to MonitorDB.
  * - Creates required tables if they do not exist.
- * - Loads encryption keys for later use.
+ *
+ * Only the once-per-process step is serialized; threads open their own
+ * connections concurrently.
  */
 Database::Database(QObject *parent)
     : QObject(parent)
 {
+    // One-time process setup only; opening this thread's connection below
+    // must not wait for other threads' connects
+    QMutexLocker initLocker(&s_initMutex);
+
     // One-time creation of the MonitorDB database itself
     if (!s_databaseInitialized) {
         {
             // Temporary connection with no default DB to check/create MonitorDB
+            const ConnectionSettings &conn = connectionSettings();
             QSqlDatabase tempDb = QSqlDatabase::addDatabase("QMYSQL", "temp_connection");
-            tempDb.setHostName("localhost");
-            tempDb.setPort(3306);
+            tempDb.setHostName(conn.host);
+            tempDb.setPort(conn.port);
             tempDb.setDatabaseName("");
-            tempDb.setUserName("monitor_user");
-            tempDb.setPassword("Monitor1230.");
+            tempDb.setUserName(conn.user);
+            tempDb.setPassword(conn.password);
 
             if (!tempDb.open()) {
-                qWarning() << "[DATABASE] Failed to open temporary connection:"
+                MON_WARN(LogCategory::Database) << "[DATABASE] Failed to open temporary connection:"
                            << tempDb.lastError().text();
             } else {
                 // Check if MonitorDB exists
                 QSqlQuery checkQuery(tempDb);
-                if (checkQuery.exec("SHOW DATABASES LIKE 'MonitorDB'")) {
+                if (checkQuery.exec(QStringLiteral("SHOW DATABASES LIKE '%1'").arg(conn.name))) {
                     if (checkQuery.next()) {
-                        qDebug() << "[DATABASE] Database MonitorDB already exists.";
+                        MON_DEBUG(LogCategory::Database) << "[DATABASE] Database" << conn.name << "already exists.";
                     } else {
                         // Create MonitorDB if missing
                         QSqlQuery createQuery(tempDb);
-                        if (!createQuery.exec("CREATE DATABASE MonitorDB")) {
-                            qWarning() << "[DATABASE] Failed to create MonitorDB:"
+                        if (!createQuery.exec("CREATE DATABASE " + conn.name)) {
+                            MON_WARN(LogCategory::Database) << "[DATABASE] Failed to create" << conn.name << ":"
                                        << createQuery.lastError().text();
                         } else {
-                            qDebug() << "[DATABASE] Database MonitorDB created successfully.";
+                            MON_DEBUG(LogCategory::Database) << "[DATABASE] Database" << conn.name << "created successfully.";
                         }
                     }
                 } else {
-                    qWarning() << "[DATABASE] Failed to check for database existence:"
+                    MON_WARN(LogCategory::Database) << "[DATABASE] Failed to check for database existence:"
                                << checkQuery.lastError().text();
                 }
                 tempDb.close();
             }
         }
         QSqlDatabase::removeDatabase("temp_connection");
+
+        // Load encryption keys for encrypting/decrypting sensitive fields. The
+        // key file is watched by EncryptionUtils itself, so it only needs loading once.
+        QString encryptionKeysPath = resolveEncryptionKeysPath();
+        EncryptionUtils::loadEncryptionKeys(encryptionKeysPath);
+        MON_DEBUG(LogCategory::Database) << "[DATABASE] Encryption keys loaded from:" << encryptionKeysPath;
+
         s_databaseInitialized = true;
     }
+    initLocker.unlock();
 
-    // Establish or reuse the default Qt SQL connection to MonitorDB
-    if (QSqlDatabase::contains("qt_sql_default_connection")) {
-        db = QSqlDatabase::database("qt_sql_default_connection");
+    // Establish or reuse this thread's connection to MonitorDB. QtSql
+    // connections may only be used by the thread that created them.
+    const QString connectionName = connectionNameForCurrentThread();
+    if (QSqlDatabase::contains(connectionName)) {
+        db = QSqlDatabase::database(connectionName);
     } else {
-        db = QSqlDatabase::addDatabase("QMYSQL", "qt_sql_default_connection");
-        db.setHostName("localhost");
-        db.setPort(3306);
-        db.setDatabaseName("MonitorDB");
-        db.setUserName("monitor_user");
-        db.setPassword("Monitor1230.");
+        const ConnectionSettings &conn = connectionSettings();
+        db = QSqlDatabase::addDatabase("QMYSQL", connectionName);
+        db.setHostName(conn.host);
+        db.setPort(conn.port);
+        db.setDatabaseName(conn.name);
+        db.setUserName(conn.user);
+        db.setPassword(conn.password);
     }
 
-    static bool s_dbConnectionLogged = false;
+    static std::atomic<bool> s_dbConnectionLogged{false};
     if (!db.isOpen() && !db.open()) {
-        qWarning() << "[DATABASE] Failed to connect to MonitorDB:"
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to connect to MonitorDB:"
                    << db.lastError().text();
     } else {
-        if (!s_dbConnectionLogged) {
-            qDebug() << "[DATABASE] Database connection established.";
-            s_dbConnectionLogged = true;
+        if (!s_dbConnectionLogged.exchange(true)) {
+            MON_DEBUG(LogCategory::Database) << "[DATABASE] Database connection established.";
         }
         // Ensure all required tables exist
         createSchema();
     }
+}
 
-    // Load encryption keys for encrypting/decrypting sensitive fields
-    static bool s_keysLoadedLogged = false;
-    QString encryptionKeysPath = resolveEncryptionKeysPath();
-    EncryptionUtils::loadEncryptionKeys(encryptionKeysPath);
-    if (!s_keysLoadedLogged) {
-        qDebug() << "[DATABASE] Encryption keys loaded from:" << encryptionKeysPath;
-        s_keysLoadedLogged = true;
+/**
+ * @brief Destructor leaves the connection open.
+ *
+ * The connection is shared by every Database instance on the same thread;
+ * closing it here forced the next short-lived instance to reconnect.
+ * Worker threads drop theirs with releaseThreadConnection().
+ */
+Database::~Database() = default;
+
+/**
+ * @brief Connection name used by the calling thread.
+ *
+ * The GUI thread keeps the historical default connection; every other
+ * thread (lane workers, background jobs) gets its own named connection.
+ * Workers are named by a token drawn once per thread rather than by the
+ * OS thread id, which is reused after a thread exits: a new thread must
+ * never inherit a connection (or keyframe chains) left by an old one.
+ */
+QString Database::connectionNameForCurrentThread() {
+    QCoreApplication *app = QCoreApplication::instance();
+    if (!app || QThread::currentThread() == app->thread()) {
+        return QString::fromLatin1(kMainConnectionName);
     }
+    thread_local const quint64 token = ++s_nextConnectionToken;
+    return QStringLiteral("monitor_worker_%1").arg(token);
 }
 
 /**
- * @brief Destructor closes the database connection if open.
+ * @brief Remove the calling worker thread's connection.
+ *
+ * Must be called by a worker before it exits, once no Database instance
+ * created on that thread is still alive.
  */
-Database::~Database() {
-    if (db.isOpen()) {
-        db.close();
+void Database::releaseThreadConnection() {
+    const QString connectionName = connectionNameForCurrentThread();
+    if (connectionName == QLatin1String(kMainConnectionName)) {
+        return;
     }
+    // Prepared handles must go before their connection does
+    StatementCache::release(connectionName);
+    if (ValueHistory *history = ValueHistory::instance()) {
+        history->forgetConnection(connectionName);
+    }
+    {
+        QSqlDatabase conn = QSqlDatabase::database(connectionName, false);
+        if (conn.isOpen()) {
+            conn.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -142,14 +257,66 @@ QString Database::resolveEncryptionKeysPath() {
  */
 void Database::ensureConnection() {
     if (!db.isOpen()) {
-        qWarning() << "[DATABASE] Connection closed; attempting reopen...";
+        MON_WARN(LogCategory::Database) << "[DATABASE] Connection closed; attempting reopen...";
         if (!db.open()) {
-            qCritical() << "[DATABASE] Failed to reopen connection:"
+            MON_ERROR(LogCategory::Database) << "[DATABASE] Failed to reopen connection:"
                         << db.lastError().text();
         } else {
-            qDebug() << "[DATABASE] Connection reopened successfully.";
+            MON_DEBUG(LogCategory::Database) << "[DATABASE] Connection reopened successfully.";
+        }
+        // Handles prepared on the old session are gone server-side
+        StatementCache::forConnection(db).clear();
+    }
+}
+
+/**
+ * @brief Run a group of writes in one transaction (one redo-log flush).
+ *
+ * A failing statement does not abort the others; only a failed BEGIN or
+ * COMMIT makes the whole group fall back to autocommitted writes.
+ */
+bool Database::applyBatch(const std::vector<Write> &writes) {
+    MON_SPAN(LogCategory::Database, "db.applyBatch");
+    if (writes.empty()) {
+        return true;
+    }
+    ensureConnection();
+
+    auto applyEach = [this, &writes]() {
+        int failed = 0;
+        for (const Write &write : writes) {
+            if (!write(*this)) {
+                ++failed;
+            }
+        }
+        return failed;
+    };
+
+    if (writes.size() == 1) {
+        return applyEach() == 0;
+    }
+
+    if (!db.transaction()) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Could not begin batch transaction:"
+                                        << db.lastError().text() << "; applying writes individually.";
+        return applyEach() == 0;
+    }
+
+    const int failed = applyEach();
+    if (!db.commit()) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Batch commit failed:" << db.lastError().text()
+                                        << "; replaying" << writes.size() << "writes individually.";
+        db.rollback();
+        // Keyframes written inside the transaction are gone with it
+        if (ValueHistory *history = ValueHistory::instance()) {
+            history->reset();
         }
+        return applyEach() == 0;
     }
+
+    MON_DEBUG(LogCategory::Database) << "[DATABASE] Committed" << writes.size()
+                                     << "writes in one transaction," << failed << "failed.";
+    return failed == 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -161,16 +328,27 @@ void Database::ensureConnection() {
  * @return True if schema exists or was created successfully.
  */
 bool Database::createSchema() {
+    // The startup task and the QML singleton may both get here first
+    static QMutex s_schemaMutex;
     static bool s_schemaCreated = false;
+    QMutexLocker schemaLocker(&s_schemaMutex);
     if (s_schemaCreated) {
         return true;
     }
 
-    QSqlQuery query;
+    QSqlQuery query(db);
+
+    // One round trip for all three probes; names compared case-insensitively
+    // because lower_case_table_names differs between servers
+    QSet<QString> tables;
+    if (query.exec("SHOW TABLES")) {
+        while (query.next()) {
+            tables.insert(query.value(0).toString().toLower());
+        }
+    }
 
     // ── UserSettings table ─────────────────────────────────────────────
-    query.exec("SHOW TABLES LIKE 'UserSettings'");
-    if (!query.next()) {
+    if (!tables.contains("usersettings")) {
         QString sql = R"(
             CREATE TABLE UserSettings (
                 id INT AUTO_INCREMENT PRIMARY KEY,
@@ -184,18 +362,17 @@ bool Database::createSchema() {
             )
         )";
         if (!query.exec(sql)) {
-            qWarning() << "[DATABASE] Failed to create UserSettings table:"
+            MON_WARN(LogCategory::Database) << "[DATABASE] Failed to create UserSettings table:"
                        << query.lastError().text();
             return false;
         }
-        qDebug() << "[DATABASE] UserSettings table created.";
+        MON_DEBUG(LogCategory::Database) << "[DATABASE] UserSettings table created.";
     } else {
-        qDebug() << "[DATABASE] UserSettings table already exists.";
+        MON_DEBUG(LogCategory::Database) << "[DATABASE] UserSettings table already exists.";
     }
 
     // ── ConfigurationSettings table ─────────────────────────────────
-    query.exec("SHOW TABLES LIKE 'ConfigurationSettings'");
-    if (!query.next()) {
+    if (!tables.contains("configurationsettings")) {
         QString sql = R"(
             CREATE TABLE ConfigurationSettings (
                 id INT AUTO_INCREMENT PRIMARY KEY,
@@ -207,18 +384,17 @@ bool Database::createSchema() {
             )
         )";
         if (!query.exec(sql)) {
-            qWarning() << "[DATABASE] Failed to create ConfigurationSettings:"
+            MON_WARN(LogCategory::Database) << "[DATABASE] Failed to create ConfigurationSettings:"
                        << query.lastError().text();
             return false;
         }
-        qDebug() << "[DATABASE] ConfigurationSettings table created.";
+        MON_DEBUG(LogCategory::Database) << "[DATABASE] ConfigurationSettings table created.";
     } else {
-        qDebug() << "[DATABASE] ConfigurationSettings table already exists.";
+        MON_DEBUG(LogCategory::Database) << "[DATABASE] ConfigurationSettings table already exists.";
     }
 
     // ── Changes table ─────────────────────────────────────────────────
-    query.exec("SHOW TABLES LIKE 'Changes'");
-    if (!query.next()) {
+    if (!tables.contains("changes")) {
         QString sql = R"(
             CREATE TABLE Changes (
                 id INT AUTO_INCREMENT PRIMARY KEY,
@@ -227,17 +403,64 @@ bool Database::createSchema() {
                 new_value TEXT,
                 acknowledged BOOLEAN DEFAULT FALSE,
                 critical BOOLEAN DEFAULT FALSE,
-                timestamp DATETIME DEFAULT CURRENT_TIMESTAMP
+                timestamp DATETIME DEFAULT CURRENT_TIMESTAMP,
+                keyframe_id BIGINT NULL,
+                INDEX idx_changes_timestamp (timestamp),
+                INDEX idx_changes_config_ts (config_name, timestamp),
+                INDEX idx_changes_keyframe (keyframe_id)
             )
         )";
         if (!query.exec(sql)) {
-            qWarning() << "[DATABASE] Failed to create Changes table:"
+            MON_WARN(LogCategory::Database) << "[DATABASE] Failed to create Changes table:"
                        << query.lastError().text();
             return false;
         }
-        qDebug() << "[DATABASE] Changes table created.";
+        MON_DEBUG(LogCategory::Database) << "[DATABASE] Changes table created.";
     } else {
-        qDebug() << "[DATABASE] Changes table already exists.";
+        MON_DEBUG(LogCategory::Database) << "[DATABASE] Changes table already exists.";
+
+        // Tables created before retention existed lack the purge indexes
+        const char *indexes[][2] = {
+            {"idx_changes_timestamp", "CREATE INDEX idx_changes_timestamp ON Changes (timestamp)"},
+            {"idx_changes_config_ts", "CREATE INDEX idx_changes_config_ts ON Changes (config_name, timestamp)"},
+        };
+        for (const auto &index : indexes) {
+            query.exec(QStringLiteral("SHOW INDEX FROM Changes WHERE Key_name = '%1'")
+                           .arg(QLatin1String(index[0])));
+            if (!query.next() && !query.exec(QLatin1String(index[1]))) {
+                MON_WARN(LogCategory::Database) << "[DATABASE] Failed to create index" << index[0]
+                           << ":" << query.lastError().text();
+            }
+        }
+
+        // Tables created before delta-encoded values lack the keyframe reference
+        query.exec("SHOW COLUMNS FROM Changes LIKE 'keyframe_id'");
+        if (!query.next()
+            && !query.exec("ALTER TABLE Changes ADD COLUMN keyframe_id BIGINT NULL, "
+                           "ADD INDEX idx_changes_keyframe (keyframe_id)")) {
+            MON_WARN(LogCategory::Database) << "[DATABASE] Failed to add Changes.keyframe_id:"
+                       << query.lastError().text();
+            return false;
+        }
+    }
+
+    // ── ValueKeyframes table ──────────────────────────────────────────
+    if (!tables.contains("valuekeyframes")) {
+        QString sql = R"(
+            CREATE TABLE ValueKeyframes (
+                id BIGINT AUTO_INCREMENT PRIMARY KEY,
+                config_name VARCHAR(255),
+                value MEDIUMTEXT,
+                created DATETIME DEFAULT CURRENT_TIMESTAMP,
+                INDEX idx_keyframes_created (created)
+            )
+        )";
+        if (!query.exec(sql)) {
+            MON_WARN(LogCategory::Database) << "[DATABASE] Failed to create ValueKeyframes table:"
+                       << query.lastError().text();
+            return false;
+        }
+        MON_DEBUG(LogCategory::Database) << "[DATABASE] ValueKeyframes table created.";
     }
 
     s_schemaCreated = true;
@@ -260,11 +483,11 @@ bool Database::insertUserSettings(const QString &email,
     ensureConnection();
 
     if (email.isEmpty() && phone.isEmpty()) {
-        qWarning() << "[DATABASE] Empty email & phone; skipping insert.";
+        MON_WARN(LogCategory::Database) << "[DATABASE] Empty email & phone; skipping insert.";
         return false;
     }
 
-    qDebug() << "[DATABASE] Inserting user settings:"
+    MON_DEBUG(LogCategory::Database) << "[DATABASE] Inserting user settings:"
              << "email=" << email
              << "phone=" << phone
              << "threshold=" << threshold
@@ -279,29 +502,32 @@ bool Database::insertUserSettings(const QString &email,
         encryptedPhone = EncryptionUtils::encrypt(phone);
     }
 
-    QSqlQuery insertQuery;
-    insertQuery.prepare(R"(
+    StatementCache &cache = StatementCache::forConnection(db);
+    auto insertQuery = cache.acquire(StatementCache::InsertUserSettings, R"(
         INSERT INTO UserSettings
           (user_email, phone_number, non_critical_threshold, notification_frequency)
         VALUES
           (:email, :phone, :threshold, :frequency)
     )");
-    insertQuery.bindValue(":email",
-                          email.isEmpty() ? QVariant(QVariant::String)
-                                          : encryptedEmail.toBase64());
-    insertQuery.bindValue(":phone",
-                          phone.isEmpty() ? QVariant(QVariant::String)
-                                          : encryptedPhone.toBase64());
-    insertQuery.bindValue(":threshold", threshold);
-    insertQuery.bindValue(":frequency", notificationFrequency);
-
-    if (!insertQuery.exec()) {
-        qWarning() << "[DATABASE] Failed to insert user settings:"
-                   << insertQuery.lastError().text();
+    if (!insertQuery) {
+        return false;
+    }
+    insertQuery->bindValue(":email",
+                           email.isEmpty() ? QVariant(QVariant::String)
+                                           : encryptedEmail.toBase64());
+    insertQuery->bindValue(":phone",
+                           phone.isEmpty() ? QVariant(QVariant::String)
+                                           : encryptedPhone.toBase64());
+    insertQuery->bindValue(":threshold", threshold);
+    insertQuery->bindValue(":frequency", notificationFrequency);
+
+    if (!execCached(cache, *insertQuery, StatementCache::InsertUserSettings)) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to insert user settings:"
+                   << insertQuery->lastError().text();
         return false;
     }
 
-    qDebug() << "[DATABASE] User settings inserted.";
+    MON_DEBUG(LogCategory::Database) << "[DATABASE] User settings inserted.";
     return true;
 }
 
@@ -328,19 +554,19 @@ bool Database::insertOrUpdateUserSettings(const QString &email,
 
     // Validate formats
     if (!email.isEmpty() && !isValidEmail(email)) {
-        qWarning() << "[DATABASE] Invalid email:" << email;
+        MON_WARN(LogCategory::Database) << "[DATABASE] Invalid email:" << email;
         return false;
     }
     if (!phone.isEmpty() && !isValidPhoneNumber(phone)) {
-        qWarning() << "[DATABASE] Invalid phone:" << phone;
+        MON_WARN(LogCategory::Database) << "[DATABASE] Invalid phone:" << phone;
         return false;
     }
     if (email.isEmpty() && phone.isEmpty()) {
-        qWarning() << "[DATABASE] Empty email & phone; skipping.";
+        MON_WARN(LogCategory::Database) << "[DATABASE] Empty email & phone; skipping.";
         return false;
     }
 
-    qDebug() << "[DATABASE] Insert/update user settings:"
+    MON_DEBUG(LogCategory::Database) << "[DATABASE] Insert/update user settings:"
              << "email=" << email
              << "phone=" << phone
              << "threshold=" << threshold
@@ -350,25 +576,31 @@ bool Database::insertOrUpdateUserSettings(const QString &email,
     QByteArray encryptedPhone = phone.isEmpty() ? QByteArray() : EncryptionUtils::encrypt(phone);
 
     // Check if an entry already exists by email or phone
-    QSqlQuery checkQuery;
-    bool exists = false;
-    int existingId = -1;
+    StatementCache &cache = StatementCache::forConnection(db);
+    const StatementCache::Statement findId = email.isEmpty() ? StatementCache::FindUserByPhone
+                                                             : StatementCache::FindUserByEmail;
+    auto checkQuery = email.isEmpty()
+        ? cache.acquire(findId, "SELECT id FROM UserSettings WHERE phone_number = :phone")
+        : cache.acquire(findId, "SELECT id FROM UserSettings WHERE user_email = :email");
+    if (!checkQuery) {
+        return false;
+    }
     if (!email.isEmpty()) {
-        checkQuery.prepare("SELECT id FROM UserSettings WHERE user_email = :email");
-        checkQuery.bindValue(":email", encryptedEmail.toBase64());
+        checkQuery->bindValue(":email", encryptedEmail.toBase64());
     } else {
-        checkQuery.prepare("SELECT id FROM UserSettings WHERE phone_number = :phone");
-        checkQuery.bindValue(":phone", encryptedPhone.toBase64());
+        checkQuery->bindValue(":phone", encryptedPhone.toBase64());
     }
-    if (checkQuery.exec() && checkQuery.next()) {
+    bool exists = false;
+    int existingId = -1;
+    if (execCached(cache, *checkQuery, findId) && checkQuery->next()) {
         exists = true;
-        existingId = checkQuery.value("id").toInt();
+        existingId = checkQuery->value(0).toInt();
     }
+    checkQuery->finish();
 
     if (exists) {
         // Update existing record
-        QSqlQuery updateQuery;
-        updateQuery.prepare(R"(
+        auto updateQuery = cache.acquire(StatementCache::UpdateUserSettings, R"(
             UPDATE UserSettings
             SET phone_number = :phone,
                 non_critical_threshold = :threshold,
@@ -376,19 +608,22 @@ bool Database::insertOrUpdateUserSettings(const QString &email,
                 timestamp = CURRENT_TIMESTAMP
             WHERE id = :id
         )");
-        updateQuery.bindValue(":phone",
-                              phone.isEmpty() ? QVariant(QVariant::String)
-                                              : encryptedPhone.toBase64());
-        updateQuery.bindValue(":threshold", threshold);
-        updateQuery.bindValue(":frequency", notificationFrequency);
-        updateQuery.bindValue(":id", existingId);
-
-        if (!updateQuery.exec()) {
-            qWarning() << "[DATABASE] Failed to update user settings:"
-                       << updateQuery.lastError().text();
+        if (!updateQuery) {
+            return false;
+        }
+        updateQuery->bindValue(":phone",
+                               phone.isEmpty() ? QVariant(QVariant::String)
+                                               : encryptedPhone.toBase64());
+        updateQuery->bindValue(":threshold", threshold);
+        updateQuery->bindValue(":frequency", notificationFrequency);
+        updateQuery->bindValue(":id", existingId);
+
+        if (!execCached(cache, *updateQuery, StatementCache::UpdateUserSettings)) {
+            MON_WARN(LogCategory::Database) << "[DATABASE] Failed to update user settings:"
+                       << updateQuery->lastError().text();
             return false;
         }
-        qDebug() << "[DATABASE] Updated user settings for id" << existingId;
+        MON_DEBUG(LogCategory::Database) << "[DATABASE] Updated user settings for id" << existingId;
     } else {
         // Insert a new record
         Database::insertUserSettings(email, phone, threshold, notificationFrequency);
@@ -402,26 +637,33 @@ bool Database::insertOrUpdateUserSettings(const QString &email,
  * @return List of maps containing id, email, phone, threshold, timestamp.
  */
 QVariantList Database::getAllUserSettings() {
+    return DatabaseRows::toVariantList(userSettingsRows());
+}
+
+/**
+ * @brief Typed variant of getAllUserSettings().
+ * @return One decrypted UserRow per UserSettings record.
+ */
+QVector<UserRow> Database::userSettingsRows() {
     ensureConnection();
-    QVariantList list;
-    QSqlQuery query("SELECT * FROM UserSettings");
+    QVector<UserRow> rows;
+    StatementCache &cache = StatementCache::forConnection(db);
+    auto query = cache.acquire(StatementCache::SelectUserSettings,
+                               QStringLiteral("SELECT %1 FROM UserSettings").arg(QLatin1String(UserRow::kColumns)));
+    if (!query) {
+        return rows;
+    }
+    if (!execCached(cache, *query, StatementCache::SelectUserSettings)) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to read user settings:" << query->lastError().text();
+        return rows;
+    }
 
-    while (query.next()) {
-        QVariantMap row;
-        row["id"] = query.value("id");
-        QByteArray encEmail = QByteArray::fromBase64(
-            query.value("user_email").toByteArray()
-            );
-        QByteArray encPhone = QByteArray::fromBase64(
-            query.value("phone_number").toByteArray()
-            );
-        row["email"]     = EncryptionUtils::decrypt(encEmail);
-        row["phone"]     = EncryptionUtils::decrypt(encPhone);
-        row["threshold"]= query.value("non_critical_threshold");
-        row["timestamp"]= query.value("timestamp");
-        list.append(row);
+    if (query->size() > 0) rows.reserve(query->size());
+    while (query->next()) {
+        rows.append(UserRow::decode(*query));
     }
-    return list;
+    query->finish();
+    return rows;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -439,10 +681,11 @@ bool Database::insertOrUpdateConfiguration(const QString &configName,
 {
     ensureConnection();
 
-    QByteArray encryptedValue = EncryptionUtils::encrypt(configValue);
+    // Large values (whole plist documents) are compressed inside the encryption
+    QByteArray encryptedValue = EncryptionUtils::encryptBytes(ValueEnvelope::encode(configValue));
 
-    QSqlQuery query;
-    query.prepare(R"(
+    StatementCache &cache = StatementCache::forConnection(db);
+    auto query = cache.acquire(StatementCache::UpsertConfiguration, R"(
         INSERT INTO ConfigurationSettings
           (config_name, config_path, config_value, is_critical)
         VALUES
@@ -452,14 +695,17 @@ bool Database::insertOrUpdateConfiguration(const QString &configName,
           config_value = VALUES(config_value),
           is_critical = VALUES(is_critical)
     )");
-    query.bindValue(":configName", configName);
-    query.bindValue(":configPath", configPath);
-    query.bindValue(":configValue", encryptedValue);
-    query.bindValue(":isCritical", isCritical);
-
-    if (!query.exec()) {
-        qWarning() << "[DATABASE] Failed to upsert configuration:"
-                   << query.lastError().text();
+    if (!query) {
+        return false;
+    }
+    query->bindValue(":configName", configName);
+    query->bindValue(":configPath", configPath);
+    query->bindValue(":configValue", encryptedValue);
+    query->bindValue(":isCritical", isCritical);
+
+    if (!execCached(cache, *query, StatementCache::UpsertConfiguration)) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to upsert configuration:"
+                   << query->lastError().text();
         return false;
     }
     return true;
@@ -470,21 +716,33 @@ bool Database::insertOrUpdateConfiguration(const QString &configName,
  * @return List of maps with id, name, path, value (encrypted), is_critical, timestamp.
  */
 QVariantList Database::getAllConfigurations() {
+    return DatabaseRows::toVariantList(configurationRows());
+}
+
+/**
+ * @brief Typed variant of getAllConfigurations().
+ * @return One ConfigRow per ConfigurationSettings record.
+ */
+QVector<ConfigRow> Database::configurationRows() {
     ensureConnection();
-    QVariantList list;
-    QSqlQuery query("SELECT * FROM ConfigurationSettings");
+    QVector<ConfigRow> rows;
+    StatementCache &cache = StatementCache::forConnection(db);
+    auto query = cache.acquire(StatementCache::SelectConfigurations,
+                               QStringLiteral("SELECT %1 FROM ConfigurationSettings").arg(QLatin1String(ConfigRow::kColumns)));
+    if (!query) {
+        return rows;
+    }
+    if (!execCached(cache, *query, StatementCache::SelectConfigurations)) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to read configurations:" << query->lastError().text();
+        return rows;
+    }
 
-    while (query.next()) {
-        QVariantMap row;
-        row["id"]           = query.value("id");
-        row["config_name"]  = query.value("config_name");
-        row["config_path"]  = query.value("config_path");
-        row["config_value"] = query.value("config_value");
-        row["is_critical"]  = query.value("is_critical");
-        row["timestamp"]    = query.value("timestamp");
-        list.append(row);
+    if (query->size() > 0) rows.reserve(query->size());
+    while (query->next()) {
+        rows.append(ConfigRow::decode(*query));
     }
-    return list;
+    query->finish();
+    return rows;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -503,25 +761,42 @@ bool Database::insertChange(const QString &configName,
 {
     ensureConnection();
 
-    QByteArray encOld = EncryptionUtils::encrypt(oldValue);
-    QByteArray encNew = EncryptionUtils::encrypt(newValue);
+    QByteArray encOld;
+    QByteArray encNew;
+    qint64 keyframeId = 0;
+    if (ValueHistory *history = ValueHistory::instance()) {
+        const ValueHistory::Encoded encoded = history->encode(*this, configName, oldValue, newValue);
+        encOld = EncryptionUtils::encryptBytes(encoded.oldValue);
+        encNew = EncryptionUtils::encryptBytes(encoded.newValue);
+        keyframeId = encoded.keyframeId;
+    } else {
+        encOld = EncryptionUtils::encryptBytes(ValueEnvelope::encode(oldValue));
+        encNew = EncryptionUtils::encryptBytes(ValueEnvelope::encode(newValue));
+    }
 
-    QSqlQuery query;
-    query.prepare(R"(
+    StatementCache &cache = StatementCache::forConnection(db);
+    auto query = cache.acquire(StatementCache::InsertChange, R"(
         INSERT INTO Changes
-          (config_name, old_value, new_value, acknowledged, critical)
+          (config_name, old_value, new_value, acknowledged, critical, timestamp, keyframe_id)
         VALUES
-          (:configName, :oldValue, :newValue, :acknowledged, :critical)
+          (:configName, :oldValue, :newValue, :acknowledged, :critical, :timestamp, :keyframeId)
     )");
-    query.bindValue(":configName", configName);
-    query.bindValue(":oldValue", encOld.toBase64());
-    query.bindValue(":newValue", encNew.toBase64());
-    query.bindValue(":acknowledged", acknowledged);
-    query.bindValue(":critical", critical);
-
-    if (!query.exec()) {
-        qWarning() << "[DATABASE] Failed to insert change:"
-                   << query.lastError().text();
+    if (!query) {
+        return false;
+    }
+    query->bindValue(":configName", configName);
+    query->bindValue(":oldValue", encOld.toBase64());
+    query->bindValue(":newValue", encNew.toBase64());
+    query->bindValue(":acknowledged", acknowledged);
+    query->bindValue(":critical", critical);
+    query->bindValue(":keyframeId", keyframeId > 0 ? QVariant(keyframeId)
+                                                   : QVariant(QMetaType(QMetaType::LongLong)));
+    // Stamped from the engine's clock so retention and charts agree with it
+    query->bindValue(":timestamp", Clock::instance()->now());
+
+    if (!execCached(cache, *query, StatementCache::InsertChange)) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to insert change:"
+                   << query->lastError().text();
         return false;
     }
     return true;
@@ -529,26 +804,52 @@ bool Database::insertChange(const QString &configName,
 
 /**
  * @brief Retrieve all change records (unencrypted).
- * @return List of maps with id, config_name, old/new values (base64), acknowledged, timestamp.
+ * @return List of maps with id, config_name, old/new values (base64, as
+ *         stored), acknowledged, timestamp.
  */
 QVariantList Database::getAllChanges() {
-    ensureConnection();
+    const QVector<ChangeRow> rows = changeRows();
     QVariantList list;
-    QSqlQuery query("SELECT * FROM Changes");
-
-    while (query.next()) {
-        QVariantMap row;
-        row["id"]           = query.value("id");
-        row["config_name"]  = query.value("config_name");
-        row["old_value"]    = query.value("old_value").toString();
-        row["new_value"]    = query.value("new_value").toString();
-        row["acknowledged"] = query.value("acknowledged").toBool();
-        row["timestamp"]    = query.value("timestamp");
-        list.append(row);
+    list.reserve(rows.size());
+    for (const ChangeRow &row : rows) {
+        QVariantMap map;
+        map.insert(QStringLiteral("id"),           row.id);
+        map.insert(QStringLiteral("config_name"),  row.configName);
+        map.insert(QStringLiteral("old_value"),    QString::fromLatin1(row.oldCipher.toBase64()));
+        map.insert(QStringLiteral("new_value"),    QString::fromLatin1(row.newCipher.toBase64()));
+        map.insert(QStringLiteral("acknowledged"), row.acknowledged);
+        map.insert(QStringLiteral("timestamp"),    row.timestamp);
+        list.append(map);
     }
     return list;
 }
 
+/**
+ * @brief Typed variant of getAllChanges(); values stay encrypted.
+ * @return One ChangeRow per Changes record.
+ */
+QVector<ChangeRow> Database::changeRows() {
+    ensureConnection();
+    QVector<ChangeRow> rows;
+    StatementCache &cache = StatementCache::forConnection(db);
+    auto query = cache.acquire(StatementCache::SelectChanges,
+                               QStringLiteral("SELECT %1 FROM Changes").arg(QLatin1String(ChangeRow::kColumns)));
+    if (!query) {
+        return rows;
+    }
+    if (!execCached(cache, *query, StatementCache::SelectChanges)) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to read changes:" << query->lastError().text();
+        return rows;
+    }
+
+    if (query->size() > 0) rows.reserve(query->size());
+    while (query->next()) {
+        rows.append(ChangeRow::decode(*query));
+    }
+    query->finish();
+    return rows;
+}
+
 /**
  * @brief Mark all unacknowledged changes for a config as acknowledged.
  * @return True if any rows were updated.
@@ -556,37 +857,50 @@ QVariantList Database::getAllChanges() {
 bool Database::updateAcknowledgmentStatus(const QString &configName) {
     ensureConnection();
 
-    QSqlQuery query;
-    query.prepare(R"(
+    StatementCache &cache = StatementCache::forConnection(db);
+    auto query = cache.acquire(StatementCache::UpdateAcknowledgment, R"(
         UPDATE Changes
         SET acknowledged = TRUE
         WHERE config_name = :configName
           AND acknowledged = FALSE
     )");
-    query.bindValue(":configName", configName);
+    if (!query) {
+        return false;
+    }
+    query->bindValue(":configName", configName);
 
-    if (!query.exec()) {
-        qWarning() << "[DATABASE] Failed to update acknowledgment status:"
-                   << query.lastError().text();
+    if (!execCached(cache, *query, StatementCache::UpdateAcknowledgment)) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to update acknowledgment status:"
+                   << query->lastError().text();
         return false;
     }
-    return query.numRowsAffected() > 0;
+    return query->numRowsAffected() > 0;
 }
 
 /**
  * @brief Search change history by exact date and/or config name.
- * @return Matching records list.
+ * @return Matching records list with plaintext values.
  */
 QVariantList Database::searchChangeHistory(const QString &date,
                                            const QString &configName)
+{
+    QVector<ChangeRow> rows = changeHistoryRows(date, configName);
+    DatabaseRows::decryptValues(rows.data(), rows.data() + rows.size());
+    return DatabaseRows::toVariantList(rows);
+}
+
+/**
+ * @brief Typed variant of searchChangeHistory(); values stay encrypted.
+ */
+QVector<ChangeRow> Database::changeHistoryRows(const QString &date,
+                                               const QString &configName)
 {
     ensureConnection();
-    QVariantList results;
-    QString sql = R"(
-        SELECT id, config_name, old_value, new_value, timestamp
-        FROM Changes
-        WHERE 1=1
-    )";
+    QVector<ChangeRow> rows;
+    // Each filter combination is its own cached statement
+    const quint16 variant = (date.isEmpty() ? 0 : 0x1)
+                          | (configName.isEmpty() ? 0 : 0x2);
+    QString sql = QStringLiteral("SELECT %1 FROM Changes WHERE 1=1").arg(QLatin1String(ChangeRow::kColumns));
     if (!date.isEmpty()) {
         sql += " AND DATE(timestamp) = :date";
     }
@@ -594,26 +908,25 @@ QVariantList Database::searchChangeHistory(const QString &date,
         sql += " AND config_name = :configName";
     }
 
-    QSqlQuery query;
-    query.prepare(sql);
-    if (!date.isEmpty())        query.bindValue(":date", date);
-    if (!configName.isEmpty())  query.bindValue(":configName", configName);
+    StatementCache &cache = StatementCache::forConnection(db);
+    auto query = cache.acquire(StatementCache::ChangesByDate, variant, sql);
+    if (!query) {
+        return rows;
+    }
+    if (!date.isEmpty())        query->bindValue(":date", date);
+    if (!configName.isEmpty())  query->bindValue(":configName", configName);
 
-    if (!query.exec()) {
-        qWarning() << "[DATABASE] Search history failed:" << query.lastError().text();
-        return results;
+    if (!execCached(cache, *query, StatementCache::ChangesByDate, variant)) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Search history failed:" << query->lastError().text();
+        return rows;
     }
 
-    while (query.next()) {
-        QVariantMap rec;
-        rec["id"]           = query.value("id");
-        rec["config_name"]  = query.value("config_name");
-        rec["old_value"]    = query.value("old_value").toString();
-        rec["new_value"]    = query.value("new_value").toString();
-        rec["timestamp"]    = query.value("timestamp");
-        results.append(rec);
+    if (query->size() > 0) rows.reserve(query->size());
+    while (query->next()) {
+        rows.append(ChangeRow::decode(*query));
     }
-    return results;
+    query->finish();
+    return rows;
 }
 
 /**
@@ -621,38 +934,48 @@ QVariantList Database::searchChangeHistory(const QString &date,
  * @return List of records with date, config_name, and count.
  */
 QVariantList Database::getChangesCountByDateAndConfig() {
+    return DatabaseRows::toVariantList(changeCountRows());
+}
+
+/**
+ * @brief Typed variant of getChangesCountByDateAndConfig().
+ */
+QVector<ChangeCountRow> Database::changeCountRows() {
     ensureConnection();
-    QVariantList results;
+    QVector<ChangeCountRow> rows;
 
-    QString sql = R"(
-        SELECT DATE(timestamp) AS date,
-               config_name,
-               COUNT(*) AS change_count
+    const QString sql = QStringLiteral(R"(
+        SELECT %1
         FROM Changes
         WHERE DATE(timestamp) >= CURDATE() - INTERVAL 6 DAY
         GROUP BY DATE(timestamp), config_name
         ORDER BY date ASC
-    )";
+    )").arg(QLatin1String(ChangeCountRow::kColumns));
 
-    QSqlQuery query;
-    if (!query.exec(sql)) {
-        qWarning() << "[DATABASE] Failed to get change counts:" << query.lastError();
-        return results;
+    StatementCache &cache = StatementCache::forConnection(db);
+    auto query = cache.acquire(StatementCache::ChangeCounts, sql);
+    if (!query) {
+        return rows;
+    }
+    if (!execCached(cache, *query, StatementCache::ChangeCounts)) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to get change counts:" << query->lastError();
+        return rows;
     }
 
-    while (query.next()) {
-        QVariantMap row;
-        row["date"]        = query.value("date").toString();
-        row["config_name"] = query.value("config_name").toString();
-        row["count"]       = query.value("change_count").toInt();
-        results.append(row);
+    if (query->size() > 0) rows.reserve(query->size());
+    while (query->next()) {
+        rows.append(ChangeCountRow::decode(*query));
     }
-    return results;
+    query->finish();
+    return rows;
 }
 
 /**
  * @brief Search change history within a date range and optional filters.
- * @return Matching records list with all fields.
+ *
+ * old_value/new_value are decrypted with one batch call per result set.
+ *
+ * @return Matching records list with all fields (plaintext values).
  */
 QVariantList Database::searchChangeHistoryRange(const QString &start,
                                                 const QString &end,
@@ -660,54 +983,483 @@ QVariantList Database::searchChangeHistoryRange(const QString &start,
                                                 const QVariant &ackFilter,
                                                 const QVariant &criticalFilter)
 {
+    QVector<ChangeRow> rows;
+    forEachChangeInRange(start, end, configName, ackFilter, criticalFilter,
+                         [&rows](ChangeRow &&row) {
+        rows.append(std::move(row));
+        return true;
+    });
+
+    DatabaseRows::decryptValues(rows.data(), rows.data() + rows.size());
+    return DatabaseRows::toVariantList(rows);
+}
+
+/**
+ * @brief Stream Changes rows matching the filters without decrypting them.
+ *
+ * Archived segments are scanned first (with the filters pushed down), then
+ * the table is read oldest first in keyset pages with a forward-only
+ * cursor. Each row is handed to @p visitor one at a time, still
+ * encrypted, so callers can batch-decrypt them off the GUI thread with
+ * DatabaseRows::decryptValues().
+ *
+ * @param visitor Receives each row; return false to stop early.
+ * @return False if the query could not be run or an archive segment is
+ *         corrupt; rows already visited are then incomplete.
+ */
+bool Database::forEachChangeInRange(const QString &start,
+                                    const QString &end,
+                                    const QString &configName,
+                                    const QVariant &ackFilter,
+                                    const QVariant &criticalFilter,
+                                    const std::function<bool(ChangeRow &&)> &visitor)
+{
+    // Cold history first: archived rows are older than anything left in the table
+    if (ChangeArchive *archive = ChangeArchive::instance()) {
+        switch (archive->scan(start, end, configName, ackFilter, criticalFilter, visitor)) {
+        case ScanResult::Completed:
+            break;
+        case ScanResult::Stopped:
+            return true;
+        case ScanResult::Failed:
+            MON_WARN(LogCategory::Database) << "[DATABASE] Cannot search; an archive segment is corrupt.";
+            return false;
+        }
+    }
+
     ensureConnection();
-    QVariantList results;
     if (!db.isOpen()) {
-        qWarning() << "[DATABASE] Cannot search; DB is closed.";
-        return results;
+        MON_WARN(LogCategory::Database) << "[DATABASE] Cannot search; DB is closed.";
+        return false;
     }
 
-    // Build dynamic SQL query with optional WHERE clauses
-    QString sql = R"(
-        SELECT id, config_name, old_value, new_value,
-               acknowledged, critical, timestamp
-        FROM Changes
-        WHERE 1=1
-    )";
-    if (!start.isEmpty())         sql += " AND timestamp >= :start";
-    if (!end.isEmpty())           sql += " AND timestamp <= :end";
-    if (!configName.isEmpty())    sql += " AND config_name = :configName";
-    if (!ackFilter.isNull())      sql += " AND acknowledged = :ackFilter";
-    if (!criticalFilter.isNull()) sql += " AND critical = :criticalFilter";
-
-    QSqlQuery query;
-    query.prepare(sql);
-    if (!start.isEmpty())        query.bindValue(":start", start);
-    if (!end.isEmpty())          query.bindValue(":end", end);
-    if (!configName.isEmpty())   query.bindValue(":configName", configName);
-    if (!ackFilter.isNull()) {
-        query.bindValue(":ackFilter", ackFilter.toBool() ? 1 : 0);
-    }
-    if (!criticalFilter.isNull()) {
-        query.bindValue(":criticalFilter", criticalFilter.toBool() ? 1 : 0);
+    // Build dynamic SQL query with optional WHERE clauses; each filter
+    // combination (and first vs. later page) is its own cached statement
+    const quint16 filterBits = (start.isEmpty()          ? 0 : 0x01)
+                             | (end.isEmpty()            ? 0 : 0x02)
+                             | (configName.isEmpty()     ? 0 : 0x04)
+                             | (ackFilter.isNull()       ? 0 : 0x08)
+                             | (criticalFilter.isNull()  ? 0 : 0x10);
+    QString filterSql = QStringLiteral("SELECT %1 FROM Changes WHERE 1=1").arg(QLatin1String(ChangeRow::kColumns));
+    if (!start.isEmpty())         filterSql += " AND timestamp >= :start";
+    if (!end.isEmpty())           filterSql += " AND timestamp <= :end";
+    if (!configName.isEmpty())    filterSql += " AND config_name = :configName";
+    if (!ackFilter.isNull())      filterSql += " AND acknowledged = :ackFilter";
+    if (!criticalFilter.isNull()) filterSql += " AND critical = :criticalFilter";
+
+    // Keyset pages along the timestamp index: MySQL buffers a whole result
+    // set client-side, so bounded pages keep memory flat for huge ranges
+    const int kPageRows = 5000;
+    QDateTime afterTs;
+    qint64 afterId = 0;
+    StatementCache &cache = StatementCache::forConnection(db);
+
+    for (bool firstPage = true;; firstPage = false) {
+        const quint16 variant = filterBits | (firstPage ? 0 : 0x20);
+        QString sql = filterSql;
+        if (!firstPage) sql += " AND (timestamp, id) > (:afterTs, :afterId)";
+        sql += " ORDER BY timestamp, id LIMIT :pageRows";
+
+        auto query = cache.acquire(StatementCache::ChangesInRange, variant, sql);
+        if (!query) {
+            return false;
+        }
+        if (!start.isEmpty())        query->bindValue(":start", start);
+        if (!end.isEmpty())          query->bindValue(":end", end);
+        if (!configName.isEmpty())   query->bindValue(":configName", configName);
+        if (!ackFilter.isNull()) {
+            query->bindValue(":ackFilter", ackFilter.toBool() ? 1 : 0);
+        }
+        if (!criticalFilter.isNull()) {
+            query->bindValue(":criticalFilter", criticalFilter.toBool() ? 1 : 0);
+        }
+        if (!firstPage) {
+            query->bindValue(":afterTs", afterTs);
+            query->bindValue(":afterId", afterId);
+        }
+        query->bindValue(":pageRows", kPageRows);
+
+        if (!execCached(cache, *query, StatementCache::ChangesInRange, variant)) {
+            MON_WARN(LogCategory::Database) << "[DATABASE] Range search failed:" << query->lastError().text();
+            return false;
+        }
+
+        int rows = 0;
+        while (query->next()) {
+            ChangeRow row = ChangeRow::decode(*query);
+            afterTs = row.timestamp;
+            afterId = row.id;
+            ++rows;
+            if (!visitor(std::move(row))) {
+                query->finish();
+                return true;
+            }
+        }
+        query->finish();
+        if (rows < kPageRows) {
+            return true;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Retention
+////////////////////////////////////////////////////////////////////////////////
+
+// Monthly partition naming: p202601 holds January 2026
+static QString partitionName(const QDate &month) {
+    return QStringLiteral("p%1").arg(month.toString("yyyyMM"));
+}
+
+static QString partitionDefinition(const QDate &month) {
+    return QStringLiteral("PARTITION %1 VALUES LESS THAN (TO_DAYS('%2'))")
+        .arg(partitionName(month), month.addMonths(1).toString(Qt::ISODate));
+}
+
+/**
+ * @brief Delete one chunk of expired rows.
+ *
+ * Each rule shape (critical filter, single config, number of excluded
+ * configs) is its own cached statement.
+ */
+int Database::purgeChangesChunk(const ChangePurgeRule &rule, int limit) {
+    ensureConnection();
+
+    // Leaf rows of an entry are "<entry>|...": a LIKE prefix with wildcards escaped
+    auto leafPattern = [](QString entry) {
+        entry.replace('\\', QLatin1String("\\\\"))
+             .replace('%', QLatin1String("\\%"))
+             .replace('_', QLatin1String("\\_"));
+        return entry + ChangeRow::kLeafSeparator + QLatin1Char('%');
+    };
+
+    const int criticalBits = rule.critical.isNull() ? 0 : (rule.critical.toBool() ? 1 : 2);
+    const quint16 variant = quint16(criticalBits
+                                    | (rule.configName.isEmpty() ? 0 : 0x4)
+                                    | (rule.excludeConfigs.size() << 3));
+
+    QString sql = QStringLiteral("DELETE FROM Changes WHERE timestamp < :cutoff");
+    if (criticalBits != 0)          sql += " AND critical = :critical";
+    if (!rule.configName.isEmpty()) {
+        sql += " AND (config_name = :configName OR config_name LIKE :configLeaves)";
+    }
+    if (!rule.excludeConfigs.isEmpty()) {
+        QStringList placeholders;
+        for (int i = 0; i < rule.excludeConfigs.size(); ++i) {
+            placeholders << QStringLiteral(":exclude%1").arg(i);
+            sql += QStringLiteral(" AND config_name NOT LIKE :excludeLeaves%1").arg(i);
+        }
+        sql += " AND config_name NOT IN (" + placeholders.join(", ") + ")";
     }
+    sql += " ORDER BY timestamp LIMIT :limit";
 
+    StatementCache &cache = StatementCache::forConnection(db);
+    auto query = cache.acquire(StatementCache::PurgeChanges, variant, sql);
+    if (!query) {
+        return -1;
+    }
+    query->bindValue(":cutoff", rule.cutoff);
+    if (criticalBits != 0)          query->bindValue(":critical", criticalBits == 1 ? 1 : 0);
+    if (!rule.configName.isEmpty()) {
+        query->bindValue(":configName", rule.configName);
+        query->bindValue(":configLeaves", leafPattern(rule.configName));
+    }
+    for (int i = 0; i < rule.excludeConfigs.size(); ++i) {
+        query->bindValue(QStringLiteral(":exclude%1").arg(i), rule.excludeConfigs.at(i));
+        query->bindValue(QStringLiteral(":excludeLeaves%1").arg(i), leafPattern(rule.excludeConfigs.at(i)));
+    }
+    query->bindValue(":limit", limit);
+
+    if (!execCached(cache, *query, StatementCache::PurgeChanges, variant)) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Purge chunk failed:" << query->lastError().text();
+        return -1;
+    }
+    return query->numRowsAffected();
+}
+
+/**
+ * @brief Oldest rows before @p before, oldest first.
+ */
+QVector<ChangeRow> Database::archiveCandidates(const QDateTime &before, int limit) {
+    ensureConnection();
+    QVector<ChangeRow> rows;
+
+    StatementCache &cache = StatementCache::forConnection(db);
+    auto query = cache.acquire(StatementCache::ArchiveCandidates,
+        QStringLiteral("SELECT %1 FROM Changes WHERE timestamp < :before "
+                       "ORDER BY timestamp, id LIMIT :limit").arg(QLatin1String(ChangeRow::kColumns)));
+    if (!query) {
+        return rows;
+    }
+    query->bindValue(":before", before);
+    query->bindValue(":limit", limit);
+    if (!execCached(cache, *query, StatementCache::ArchiveCandidates)) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to select archive candidates:" << query->lastError().text();
+        return rows;
+    }
+    while (query->next()) {
+        rows.append(ChangeRow::decode(*query));
+    }
+    query->finish();
+    // Archive segments outlive the keyframes, so they get full values
+    ValueHistory::materialize(rows.begin(), rows.end());
+    return rows;
+}
+
+/**
+ * @brief Delete rows by id, a thousand ids per statement.
+ *
+ * Ids are integers, so they are inlined rather than bound; the statement
+ * shape changes with every chunk and is not cached.
+ */
+int Database::deleteChangesById(const QVector<qint64> &ids) {
+    ensureConnection();
+    const int kIdsPerStatement = 1000;
+
+    int total = 0;
+    QSqlQuery query(db);
+    for (int first = 0; first < ids.size(); first += kIdsPerStatement) {
+        QStringList list;
+        const int last = std::min(int(ids.size()), first + kIdsPerStatement);
+        for (int i = first; i < last; ++i) {
+            list << QString::number(ids[i]);
+        }
+        if (!query.exec("DELETE FROM Changes WHERE id IN (" + list.join(',') + ")")) {
+            MON_WARN(LogCategory::Database) << "[DATABASE] Failed to delete archived rows:" << query.lastError().text();
+            return -1;
+        }
+        total += query.numRowsAffected();
+    }
+    return total;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Value Keyframes
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Insert one keyframe; runs inside the caller's batch transaction.
+ */
+qint64 Database::insertKeyframe(const QString &configName, const QByteArray &cipher) {
+    ensureConnection();
+    StatementCache &cache = StatementCache::forConnection(db);
+    auto query = cache.acquire(StatementCache::InsertKeyframe, R"(
+        INSERT INTO ValueKeyframes (config_name, value, created)
+        VALUES (:configName, :value, :created)
+    )");
+    if (!query) {
+        return -1;
+    }
+    query->bindValue(":configName", configName);
+    query->bindValue(":value", cipher.toBase64());
+    query->bindValue(":created", Clock::instance()->now());
+    if (!execCached(cache, *query, StatementCache::InsertKeyframe)) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to insert keyframe:" << query->lastError().text();
+        return -1;
+    }
+    const QVariant id = query->lastInsertId();
+    query->finish();
+    return id.isValid() ? id.toLongLong() : -1;
+}
+
+/**
+ * @brief Fetch keyframes by id, a thousand ids per statement (inlined, not cached).
+ */
+QHash<qint64, QByteArray> Database::keyframeCiphers(const QVector<qint64> &ids) {
+    ensureConnection();
+    const int kIdsPerStatement = 1000;
+
+    QHash<qint64, QByteArray> ciphers;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    for (int first = 0; first < ids.size(); first += kIdsPerStatement) {
+        QStringList list;
+        const int last = std::min(int(ids.size()), first + kIdsPerStatement);
+        for (int i = first; i < last; ++i) {
+            list << QString::number(ids[i]);
+        }
+        if (!query.exec("SELECT id, value FROM ValueKeyframes WHERE id IN (" + list.join(',') + ")")) {
+            MON_WARN(LogCategory::Database) << "[DATABASE] Failed to load keyframes:" << query.lastError().text();
+            return ciphers;
+        }
+        while (query.next()) {
+            ciphers.insert(query.value(0).toLongLong(), QByteArray::fromBase64(query.value(1).toByteArray()));
+        }
+    }
+    return ciphers;
+}
+
+/**
+ * @brief Delete unreferenced keyframes.
+ *
+ * @p before keeps keyframes that a still-open batch may be about to
+ * reference from being taken for orphans.
+ */
+int Database::purgeOrphanKeyframes(const QDateTime &before, int limit) {
+    ensureConnection();
+    QSqlQuery query(db);
+    query.prepare(R"(
+        DELETE FROM ValueKeyframes
+        WHERE created < :before
+          AND NOT EXISTS (SELECT 1 FROM Changes c WHERE c.keyframe_id = ValueKeyframes.id)
+        LIMIT :limit
+    )");
+    query.bindValue(":before", before);
+    query.bindValue(":limit", limit);
     if (!query.exec()) {
-        qWarning() << "[DATABASE] Range search failed:" << query.lastError().text();
-        return results;
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to purge orphan keyframes:" << query.lastError().text();
+        return -1;
     }
+    return query.numRowsAffected();
+}
 
-    // Collect and return matching records
+/**
+ * @brief Whether Changes already has partitions.
+ */
+bool Database::isChangesPartitioned() {
+    ensureConnection();
+    QSqlQuery query(db);
+    if (!query.exec(R"(
+            SELECT COUNT(*) FROM INFORMATION_SCHEMA.PARTITIONS
+            WHERE TABLE_SCHEMA = DATABASE()
+              AND TABLE_NAME = 'Changes'
+              AND PARTITION_NAME IS NOT NULL
+        )") || !query.next()) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to inspect partitions:" << query.lastError().text();
+        return false;
+    }
+    return query.value(0).toInt() > 0;
+}
+
+/**
+ * @brief One-off conversion of Changes to monthly RANGE partitions.
+ *
+ * Partitions cover the month of the oldest row up to @p monthsAhead
+ * months from now, plus a catch-all pmax.
+ */
+bool Database::partitionChangesByMonth(int monthsAhead) {
+    if (isChangesPartitioned()) {
+        return true;
+    }
+
+    QSqlQuery query(db);
+    const QDate today = Clock::instance()->now().date();
+    const QDate thisMonth = today.addDays(1 - today.day());
+    QDate month = thisMonth;
+    if (query.exec("SELECT MIN(timestamp) FROM Changes") && query.next() && !query.isNull(0)) {
+        const QDate oldest = query.value(0).toDate();
+        month = std::min(thisMonth, oldest.addDays(1 - oldest.day()));
+    }
+
+    QStringList definitions;
+    for (; month <= thisMonth.addMonths(monthsAhead); month = month.addMonths(1)) {
+        definitions << partitionDefinition(month);
+    }
+    definitions << "PARTITION pmax VALUES LESS THAN MAXVALUE";
+
+    MON_INFO(LogCategory::Database) << "[DATABASE] Partitioning Changes into" << definitions.size()
+                                    << "monthly partitions; this rebuilds the table.";
+
+    // Every unique key must include the partitioning column
+    if (!query.exec("ALTER TABLE Changes DROP PRIMARY KEY, ADD PRIMARY KEY (id, timestamp)")) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to rekey Changes:" << query.lastError().text();
+        return false;
+    }
+    if (!query.exec("ALTER TABLE Changes PARTITION BY RANGE (TO_DAYS(timestamp)) ("
+                    + definitions.join(", ") + ")")) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to partition Changes:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Split pmax so the next @p monthsAhead months have their own partitions.
+ */
+bool Database::ensureChangePartitions(int monthsAhead) {
+    ensureConnection();
+
+    QSqlQuery query(db);
+    if (!query.exec(R"(
+            SELECT PARTITION_NAME FROM INFORMATION_SCHEMA.PARTITIONS
+            WHERE TABLE_SCHEMA = DATABASE()
+              AND TABLE_NAME = 'Changes'
+              AND PARTITION_NAME IS NOT NULL
+        )")) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to list partitions:" << query.lastError().text();
+        return false;
+    }
+    QStringList existing;
+    while (query.next()) {
+        existing << query.value(0).toString();
+    }
+    if (!existing.contains("pmax")) {
+        return false;
+    }
+
+    // Partitions are only ever added after the newest one
+    QDate newest;
+    for (const QString &name : existing) {
+        const QDate month = QDate::fromString(name.mid(1) + "01", "yyyyMMdd");
+        if (month.isValid() && (!newest.isValid() || month > newest)) {
+            newest = month;
+        }
+    }
+    const QDate today = Clock::instance()->now().date();
+    const QDate thisMonth = today.addDays(1 - today.day());
+    QDate month = newest.isValid() ? newest.addMonths(1) : thisMonth;
+
+    QStringList definitions;
+    for (; month <= thisMonth.addMonths(monthsAhead); month = month.addMonths(1)) {
+        definitions << partitionDefinition(month);
+    }
+    if (definitions.isEmpty()) {
+        return true;
+    }
+    definitions << "PARTITION pmax VALUES LESS THAN MAXVALUE";
+
+    if (!query.exec("ALTER TABLE Changes REORGANIZE PARTITION pmax INTO ("
+                    + definitions.join(", ") + ")")) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to add partitions:" << query.lastError().text();
+        return false;
+    }
+    MON_DEBUG(LogCategory::Database) << "[DATABASE] Added" << definitions.size() - 1 << "monthly partitions.";
+    return true;
+}
+
+/**
+ * @brief Drop whole months that lie entirely before @p cutoff.
+ */
+int Database::dropChangePartitionsBefore(const QDate &cutoff) {
+    ensureConnection();
+
+    QSqlQuery query(db);
+    if (!query.exec(R"(
+            SELECT PARTITION_NAME FROM INFORMATION_SCHEMA.PARTITIONS
+            WHERE TABLE_SCHEMA = DATABASE()
+              AND TABLE_NAME = 'Changes'
+              AND PARTITION_NAME IS NOT NULL
+        )")) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to list partitions:" << query.lastError().text();
+        return -1;
+    }
+
+    QStringList expired;
     while (query.next()) {
-        QVariantMap rec;
-        rec["id"]           = query.value("id");
-        rec["config_name"]  = query.value("config_name");
-        rec["old_value"]    = query.value("old_value").toString();
-        rec["new_value"]    = query.value("new_value").toString();
-        rec["acknowledged"] = query.value("acknowledged").toBool();
-        rec["critical"]     = query.value("critical").toBool();
-        rec["timestamp"]    = query.value("timestamp");
-        results.append(rec);
-    }
-    return results;
+        const QString name = query.value(0).toString();
+        const QDate month = QDate::fromString(name.mid(1) + "01", "yyyyMMdd");
+        if (month.isValid() && month.addMonths(1) <= cutoff) {
+            expired << name;
+        }
+    }
+    if (expired.isEmpty()) {
+        return 0;
+    }
+
+    if (!query.exec("ALTER TABLE Changes DROP PARTITION " + expired.join(", "))) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to drop partitions:" << query.lastError().text();
+        return -1;
+    }
+    MON_INFO(LogCategory::Database) << "[DATABASE] Dropped expired partitions:" << expired.join(", ");
+    return expired.size();
 }
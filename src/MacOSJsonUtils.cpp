@@ -1,9 +1,10 @@
 #include "MacOSJsonUtils.h"
+#include "configSource.h"
+#include "itemListCache.h"
+#include "itemPatternExpander.h"
+#include "logger.h"
+#include <QBuffer>
 #include <QFile>
-#include <QJsonDocument>
-#include <QJsonArray>
-#include <QJsonObject>
-#include <QDebug>
 
 /**
  * @file MacOSJsonUtils.cpp
@@ -15,6 +16,34 @@
 
 namespace MacOSJsonUtils {
 
+namespace {
+
+const ItemListFormat kFormat{"plistPath", false};
+
+/// Instantiate the entries of a parsed list, logging what was dropped.
+QList<PlistFile*> toPlistFiles(const ItemListResult &result, const QString &origin) {
+    QList<PlistFile*> plistFiles;
+    if (!result.ok) {
+        MON_WARN(LogCategory::Item) << "[MacOSJsonUtils] Expected JSON array in file:" << origin << "-" << result.error;
+        return plistFiles;
+    }
+    if (result.skipped > 0) {
+        MON_WARN(LogCategory::Item) << "[MacOSJsonUtils] Skipped" << result.skipped
+                                    << "invalid entries (not an object, or missing plistPath or valueName)";
+    }
+
+    plistFiles.reserve(result.items.size());
+    for (const ItemSpec &spec : result.items) {
+        plistFiles.append(new PlistFile(spec.path, spec.valueName, spec.isCritical));
+    }
+
+    MON_DEBUG(LogCategory::Item) << "[MacOSJsonUtils] Loaded" << plistFiles.size() << "plist entries from"
+                                 << (result.fromCache ? "cache." : "JSON.");
+    return plistFiles;
+}
+
+} // namespace
+
 /**
  * @brief Read plist definitions from a JSON file and instantiate PlistFile objects.
  *
@@ -24,57 +53,67 @@ namespace MacOSJsonUtils {
  *   - "valueName"   : QString, the key within the plist to monitor
  *   - "isCritical"  : bool, whether changes to this plist are critical
  *
+ * The file is parsed as a stream (see ItemListReader).
+ *
  * @param filePath Absolute or relative path to the JSON configuration file.
  * @return QList<PlistFile*> A list of newly allocated PlistFile pointers.
  *         Ownership is transferred to the caller.
  *         Returns an empty list on error (e.g., file cannot be opened or JSON is malformed).
  */
 QList<PlistFile*> readFilesFromJson(const QString &filePath) {
-    QList<PlistFile*> plistFiles;
-
     // Attempt to open the JSON file for reading
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "[MacOSJsonUtils] Could not open JSON file:" << filePath;
-        return plistFiles;
+        MON_WARN(LogCategory::Item) << "[MacOSJsonUtils] Could not open JSON file:" << filePath;
+        return QList<PlistFile*>();
     }
+    return toPlistFiles(ItemListCache::parse(&file, kFormat), filePath);
+}
 
-    // Parse entire file content into a QJsonDocument
-    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-    file.close();
-
-    // Ensure the document contains a JSON array at the top level
-    if (!doc.isArray()) {
-        qWarning() << "[MacOSJsonUtils] Expected JSON array in file:" << filePath;
-        return plistFiles;
-    }
-    QJsonArray filesArray = doc.array();
-
-    // Iterate over each element in the array
-    for (const QJsonValue &value : filesArray) {
-        if (!value.isObject()) {
-            qWarning() << "[MacOSJsonUtils] Skipping non-object entry in array";
-            continue;
-        }
-        QJsonObject obj = value.toObject();
-
-        // Extract required fields with default fallbacks
-        QString plistPath  = obj.value("plistPath").toString();
-        QString valueName  = obj.value("valueName").toString();
-        bool    isCritical = obj.value("isCritical").toBool(false);
+/**
+ * @brief Instantiate PlistFile objects from JSON text in the readFilesFromJson() format.
+ *
+ * @param json   Raw JSON document.
+ * @param origin Where @p json came from, for log messages.
+ * @return QList<PlistFile*> Newly allocated entries owned by the caller; empty on error.
+ */
+QList<PlistFile*> parseFilesJson(const QByteArray &json, const QString &origin) {
+    QBuffer buffer;
+    buffer.setData(json);
+    buffer.open(QIODevice::ReadOnly);
+    return toPlistFiles(ItemListCache::parse(&buffer, kFormat), origin);
+}
 
-        // Validate that mandatory strings are present
-        if (plistPath.isEmpty() || valueName.isEmpty()) {
-            qWarning() << "[MacOSJsonUtils] Invalid entry (missing plistPath or valueName)";
-            continue;
+/**
+ * @brief Instantiate PlistFile objects from the list supplied by @p source.
+ *
+ * An unchanged file is read from the compiled cache without parsing the
+ * JSON (see ItemListCache). With @p patterns, entries with wildcards in
+ * plistPath or valueName are replaced by their expansion and the expander
+ * keeps watching them; without it they are taken literally.
+ *
+ * @param source   Config source holding a readFilesFromJson()-format document.
+ * @param patterns Expander for patterned entries, or nullptr.
+ * @return QList<PlistFile*> Newly allocated entries owned by the caller; empty on error.
+ */
+QList<PlistFile*> loadFiles(const ConfigSource &source, ItemPatternExpander *patterns) {
+    ItemListResult result = ItemListCache::load(source, kFormat);
+    if (patterns && result.ok) {
+        QVector<ItemSpec> explicitEntries, patterned;
+        QSet<QString> exclude;
+        for (const ItemSpec &spec : std::as_const(result.items)) {
+            if (ItemPatternExpander::isPattern(spec)) {
+                patterned.append(spec);
+            } else {
+                explicitEntries.append(spec);
+                exclude.insert(ItemPatternExpander::keyOf(spec.path, spec.valueName));
+            }
         }
-
-        // Create a new PlistFile and append to the list
-        plistFiles.append(new PlistFile(plistPath, valueName, isCritical));
+        // Called without patterns too, so removed patterns stop being watched
+        explicitEntries += patterns->setPatterns(patterned, exclude);
+        result.items = explicitEntries;
     }
-
-    qDebug() << "[MacOSJsonUtils] Loaded" << plistFiles.size() << "plist entries from JSON.";
-    return plistFiles;
+    return toPlistFiles(result, source.description());
 }
 
 } // namespace MacOSJsonUtils
@@ -1,5 +1,9 @@
 #include "MacOSMonitoring.h"
 #include "MacOSJsonUtils.h"
+#include "logger.h"
+#include "trace.h"
+#include "resourceGovernor.h"
+#include "startupOrchestrator.h"
 
 #include <QDebug>
 #include <QDir>
@@ -8,6 +12,9 @@
 #include <QDateTime>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QPointer>
+#include <QStringList>
+#include <QThread>
 #include <algorithm>
 
 /**
@@ -21,26 +28,52 @@
 // Constructor / Initialization
 ////////////////////////////////////////////////////////////////////////////////
 
+/// Plists read per baseline job; small enough to spread over the pool.
+static constexpr int kBaselineChunk = 64;
+
+/**
+ * @brief Path of the JSON list of monitored plists.
+ *
+ * MONITOR_ITEMS_CONFIG overrides the bundled resource, e.g. for soak runs
+ * against synthetic files.
+ */
+static QString monitoredPlistsPath() {
+    const QString overridePath = qEnvironmentVariable("MONITOR_ITEMS_CONFIG");
+    if (!overridePath.isEmpty()) {
+        return overridePath;
+    }
+    return QDir::cleanPath(
+        QCoreApplication::applicationDirPath() +
+        "/../../../../../resources/monitoredPlists.json");
+}
+
 /**
  * @brief Construct and initialize a MacOSMonitoring instance.
  *
- * - Sets up a periodic QTimer to drive checkForChanges().
+ * - Sets up a periodic ClockTimer to drive checkForChanges().
  * - Hooks rollbackPerformed → alert emission.
- * - Loads the initial plist list from JSON and watches that file for updates.
- * - Loads/stores user contact settings from the database.
+ * - Loads the initial plist list from the config source and follows its updates;
+ *   plist values are read in the background (see loadBaselines()).
+ * - Loads/stores user contact settings from the database, also in the
+ *   background (see syncContacts()).
  *
  * @param settings Pointer to the shared Settings object.
+ * @param source   Config source, or nullptr for a watched monitoredPlists.json.
  * @param parent   Optional parent QObject.
  */
-MacOSMonitoring::MacOSMonitoring(Settings *settings, QObject *parent)
+MacOSMonitoring::MacOSMonitoring(Settings *settings, ConfigSource *source, QObject *parent)
     : MonitoringBase(parent)
     , m_monitoringActive(false)
     , m_settings(settings)
     , m_alert(settings, this)
-    , m_database()  // Uses default-constructed Database instance
+    , m_configSource(source ? source : new FileConfigSource(monitoredPlistsPath(), this))
+    , m_dispatcher(this)
 {
+    // Sorted/filtered view used by the monitored-items list
+    m_monitoredItems.setSourceModel(&m_plistFilesModel);
+
     // When the timer fires, invoke our change-checking routine
-    connect(&m_timer, &QTimer::timeout,
+    connect(&m_timer, &ClockTimer::timeout,
             this, &MacOSMonitoring::checkForChanges);
 
     // When a rollback is performed, emit a criticalChangeDetected signal
@@ -50,61 +83,104 @@ MacOSMonitoring::MacOSMonitoring(Settings *settings, QObject *parent)
                 QString alertMessage =
                     "[CRITICAL] Revert performed for file: " + valueName;
                 emit criticalChangeDetected(alertMessage);
-                m_alert.sendAlert(alertMessage);
-                qDebug() << "[INFO] Revert performed for file:" << valueName;
+                m_dispatcher.post(ChangeLane::CriticalAlert, [this, alertMessage]() {
+                    m_alert.sendAlert(alertMessage);
+                });
+                MON_DEBUG(LogCategory::Monitoring) << "[INFO] Revert performed for file:" << valueName;
             });
 
-    // Load the initial set of plist files from JSON configuration
+    // Rollback bookkeeping writes go through the critical persistence lane
+    m_rollback.setDispatcher(&m_dispatcher);
+
+    // Load the initial set of plist files from JSON configuration, and pick
+    // up changes to the list of monitored plists at runtime.
     reloadPlistFiles();
+    connect(m_configSource, &ConfigSource::changed,
+            this, &MacOSMonitoring::onConfigChanged);
+    connect(&m_patterns, &ItemPatternExpander::expansionChanged,
+            this, &MacOSMonitoring::onPatternMatchesChanged);
 
-    // Watch the JSON file itself so changes to the list of monitored plists
-    // are picked up at runtime.
-    QString filePath = QDir::cleanPath(
-        QCoreApplication::applicationDirPath() +
-        "/../../../../../resources/monitoredPlists.json");
-    if (QFile::exists(filePath)) {
-        m_fileWatcher.addPath(filePath);
-        connect(&m_fileWatcher, &QFileSystemWatcher::fileChanged,
-                this, &MacOSMonitoring::onPlistFileChanged);
-        qDebug() << "[MONITORING INIT] Watching JSON config:" << filePath;
+    // Ensure we have email/phone in Settings; if not, load from DB and save back.
+    if (m_settings) {
+        syncContacts();
     } else {
-        qWarning() << "[MONITORING INIT] JSON file not found:" << filePath;
+        MON_WARN(LogCategory::Monitoring) << "[MONITORING INIT] Settings object is null.";
     }
+}
 
-    // Ensure we have email/phone in Settings; if not, load from DB and save back.
-    if (m_settings) {
-        QString email = m_settings->getEmail();
-        QString phone = m_settings->getPhoneNumber();
-        if (email.isEmpty() || phone.isEmpty()) {
-            QVariantList userSettings = m_database.getAllUserSettings();
-            if (!userSettings.isEmpty()) {
-                QVariantMap user = userSettings.first().toMap();
-                if (email.isEmpty()) {
-                    email = user["email"].toString();
-                    m_settings->setEmail(email);
-                }
-                if (phone.isEmpty()) {
-                    phone = user["phone"].toString();
-                    m_settings->setPhoneNumber(phone);
-                }
+/**
+ * @brief Destructor: wait for baseline reads still using the plist entries.
+ */
+MacOSMonitoring::~MacOSMonitoring() {
+    shutdown();
+}
+
+void MacOSMonitoring::shutdown() {
+    stopMonitoring();
+    m_baselinePool.waitForDone();
+    m_dispatcher.shutdown();
+
+    // Their chunks will not report back any more
+    qDeleteAll(m_retired);
+    m_retired.clear();
+    m_reading.clear();
+}
+
+/**
+ * @brief Load contacts from UserSettings into Settings and save them back.
+ *
+ * The query runs as the "contacts" startup task; Settings is updated on
+ * this thread when it returns. Every saved contact is joined into Settings,
+ * as alerts go to all of them.
+ */
+void MacOSMonitoring::syncContacts() {
+    QPointer<MacOSMonitoring> self(this);
+    StartupOrchestrator::submit("contacts", [self]() {
+        Database db;
+        const QVector<UserRow> userSettings = db.userSettingsRows();
+        QMetaObject::invokeMethod(self, [self, userSettings]() {
+            if (self) {
+                self->applyContacts(userSettings);
             }
-        }
-        qDebug() << "[MONITORING INIT] Final email:" << email
-                 << "phone:" << phone;
-
-        // Persist back into the database if both are now set
-        if (!email.isEmpty() && !phone.isEmpty()) {
-            QString freq = m_settings->getNotificationFrequency();
-            if (!m_database.insertUserSettings(email, phone, 0, freq)) {
-                qWarning() << "[MONITORING INIT] Failed to save user settings.";
-            } else {
-                qDebug() << "[MONITORING INIT] User settings saved.";
+        }, Qt::QueuedConnection);
+    });
+}
+
+/**
+ * @brief Second half of syncContacts(), on the monitor's thread.
+ * @param userSettings Rows read from UserSettings.
+ */
+void MacOSMonitoring::applyContacts(const QVector<UserRow> &userSettings) {
+    QStringList emails, phones;
+    for (const UserRow &user : userSettings) {
+        if (!user.email.isEmpty()) emails << user.email;
+        if (!user.phone.isEmpty()) phones << user.phone;
+    }
+    if (!emails.isEmpty()) {
+        m_settings->setEmail(emails.join(", "));
+    }
+    if (!phones.isEmpty()) {
+        m_settings->setPhoneNumber(phones.join(", "));
+    }
+
+    const QString email = m_settings->getEmail();
+    const QString phone = m_settings->getPhoneNumber();
+    MON_DEBUG(LogCategory::Monitoring) << "[MONITORING INIT] Final email:" << email
+             << "phone:" << phone;
+
+    // Persist back into the database if both are now set
+    if (!email.isEmpty() && !phone.isEmpty()) {
+        const QString freq = m_settings->getNotificationFrequency();
+        m_dispatcher.stage(ChangeLane::Persist, [email, phone, freq](Database &db) {
+            if (!db.insertUserSettings(email, phone, 0, freq)) {
+                MON_WARN(LogCategory::Monitoring) << "[MONITORING INIT] Failed to save user settings.";
+                return false;
             }
-        } else {
-            qWarning() << "[MONITORING INIT] Missing contact info; alerts disabled.";
-        }
+            MON_DEBUG(LogCategory::Monitoring) << "[MONITORING INIT] User settings saved.";
+            return true;
+        });
     } else {
-        qWarning() << "[MONITORING INIT] Settings object is null.";
+        MON_WARN(LogCategory::Monitoring) << "[MONITORING INIT] Missing contact info; alerts disabled.";
     }
 }
 
@@ -115,24 +191,24 @@ MacOSMonitoring::MacOSMonitoring(Settings *settings, QObject *parent)
 /**
  * @brief Reload the list of monitored plist files from JSON config.
  *
- * - Reads JSON array of {plistPath, valueName, isCritical}.
+ * - Reads JSON array of {plistPath, valueName, isCritical}; entries with
+ *   wildcards are expanded and followed by m_patterns.
  * - Updates the model, emits plistFilesChanged().
- * - Inserts/updates each entry into ConfigurationSettings.
+ * - Starts reading the entries' values; each chunk is inserted/updated
+ *   into ConfigurationSettings as it completes.
  */
 void MacOSMonitoring::reloadPlistFiles() {
-    QString filePath = QDir::cleanPath(
-        QCoreApplication::applicationDirPath() +
-        "/../../../../../resources/monitoredPlists.json");
-    if (!QFile::exists(filePath)) {
-        qWarning() << "[RELOAD PLIST] JSON not found:" << filePath;
+    if (!m_configSource->isAvailable()) {
+        MON_WARN(LogCategory::Monitoring) << "[RELOAD PLIST] JSON not found:"
+                                          << m_configSource->description();
         return;
     }
 
-    // Parse JSON into new list
+    // Parse JSON (or its cached form) into new list; patterned entries are expanded
     QList<PlistFile*> newPlistFiles =
-        MacOSJsonUtils::readFilesFromJson(filePath);
+        MacOSJsonUtils::loadFiles(*m_configSource, &m_patterns);
     if (newPlistFiles.isEmpty()) {
-        qWarning() << "[RELOAD PLIST] No entries in JSON.";
+        MON_WARN(LogCategory::Monitoring) << "[RELOAD PLIST] No entries in JSON.";
         return;
     }
 
@@ -141,32 +217,181 @@ void MacOSMonitoring::reloadPlistFiles() {
     m_plistFilesModel.setPlistFiles(m_plistFiles);
     emit plistFilesChanged();
 
-    // Persist these plist definitions into the database
-    Database db;
-    for (PlistFile *plist : m_plistFiles) {
-        db.insertOrUpdateConfiguration(
-            plist->valueName(),
-            plist->plistPath(),
-            plist->value(),
-            plist->isCritical()
-            );
+    MON_DEBUG(LogCategory::Monitoring) << "[RELOAD PLIST] Loaded" << m_plistFiles.size()
+             << "plist files from JSON.";
+
+    loadBaselines();
+}
+
+/**
+ * @brief Read every entry's initial value in parallel chunks.
+ *
+ * The list is visible in the UI immediately; the check loop skips each
+ * entry until its value has been read. A chunk's ConfigurationSettings
+ * rows are written as one transaction once it completes. A reload while
+ * chunks are running starts a new generation and ignores the old one.
+ */
+void MacOSMonitoring::loadBaselines() {
+    ++m_baselineGeneration;
+    m_pendingBaselines = 0;
+    readBaselines(m_plistFiles);
+}
+
+/**
+ * @brief Queue baseline reads for @p plists in the current generation.
+ * @param plists Entries of m_plistFiles without a baseline yet.
+ */
+void MacOSMonitoring::readBaselines(const QList<PlistFile *> &plists) {
+    const quint64 generation = m_baselineGeneration;
+    if (m_pendingBaselines == 0) {
+        m_baselineTimer.start();
+    }
+    m_pendingBaselines += plists.size();
+    for (PlistFile *plist : plists) {
+        m_reading.insert(plist);
+    }
+    m_baselinePool.setMaxThreadCount(
+        ResourceGovernor::workers(std::max(1, QThread::idealThreadCount())));
+
+    QPointer<MacOSMonitoring> self(this);
+    for (int from = 0; from < plists.size(); from += kBaselineChunk) {
+        const QList<PlistFile *> chunk = plists.mid(from, kBaselineChunk);
+        m_baselinePool.start([self, chunk, generation]() {
+            for (PlistFile *plist : chunk) {
+                plist->loadBaseline();
+            }
+            QMetaObject::invokeMethod(self, [self, chunk, generation]() {
+                if (self) {
+                    self->onBaselinesLoaded(chunk, generation);
+                }
+            }, Qt::QueuedConnection);
+        });
     }
+    if (m_pendingBaselines == 0) {
+        emit baselinesLoaded();
+    }
+}
 
-    qDebug() << "[RELOAD PLIST] Loaded" << m_plistFiles.size()
-             << "plist files from JSON.";
+/**
+ * @brief Persist one chunk of freshly read entries and track completion.
+ * @param chunk      Entries whose baselines are now ready.
+ * @param generation loadBaselines() call the chunk belongs to.
+ */
+void MacOSMonitoring::onBaselinesLoaded(const QList<PlistFile *> &chunk, quint64 generation) {
+    // Entries removed while the chunk was being read are freed only now
+    QList<PlistFile *> live;
+    live.reserve(chunk.size());
+    for (PlistFile *plist : chunk) {
+        m_reading.remove(plist);
+        if (m_retired.remove(plist)) {
+            plist->deleteLater();
+        } else {
+            live.append(plist);
+        }
+    }
+    if (generation != m_baselineGeneration) {
+        return;
+    }
+
+    m_dispatcher.beginTick();
+    for (PlistFile *plist : std::as_const(live)) {
+        const QString valueName = plist->valueName();
+        const QString plistPath = plist->plistPath();
+        const QString value     = plist->value();
+        const bool    critical  = plist->isCritical();
+        m_dispatcher.stage(ChangeLane::Persist, [=](Database &db) {
+            return db.insertOrUpdateConfiguration(valueName, plistPath, value, critical);
+        });
+    }
+    m_dispatcher.commitTick();
+
+    m_pendingBaselines -= chunk.size();
+    if (m_pendingBaselines == 0) {
+        MON_INFO(LogCategory::Monitoring) << "[RELOAD PLIST] All" << m_plistFiles.size()
+                                          << "baselines read after" << m_baselineTimer.elapsed() << "ms.";
+        StartupOrchestrator::milestone("baselinesReady");
+        emit baselinesLoaded();
+    }
 }
 
 /**
- * @brief Slot invoked when the JSON config file itself is modified.
- * @param path Filesystem path of the changed JSON file.
+ * @brief Follow files and keys that appeared or vanished under a pattern.
+ *
+ * Entries outside the patterns keep their objects and baselines; only new
+ * entries are read. Removed entries are deleted once nothing refers to
+ * them: at once, or when their pending baseline chunk reports back.
+ * Rollback jobs never outlive the check cycle that queued them.
+ *
+ * @param added   New expanded entries.
+ * @param removed Expanded entries whose file or key is gone.
  */
-void MacOSMonitoring::onPlistFileChanged(const QString &path) {
-    qDebug() << "[FILE WATCHER] JSON changed:" << path;
-    reloadPlistFiles();
-    // Re-add watcher if needed
-    if (!m_fileWatcher.files().contains(path)) {
-        m_fileWatcher.addPath(path);
+void MacOSMonitoring::onPatternMatchesChanged(const QVector<ItemSpec> &added,
+                                              const QVector<ItemSpec> &removed) {
+    QSet<QString> gone;
+    for (const ItemSpec &spec : removed) {
+        gone.insert(ItemPatternExpander::keyOf(spec.path, spec.valueName));
+    }
+    QList<PlistFile*> plistFiles;
+    QList<PlistFile*> removedFiles;
+    plistFiles.reserve(m_plistFiles.size() + added.size());
+    for (PlistFile *plist : std::as_const(m_plistFiles)) {
+        if (gone.contains(ItemPatternExpander::keyOf(plist->plistPath(), plist->valueName()))) {
+            removedFiles.append(plist);
+        } else {
+            plistFiles.append(plist);
+        }
+    }
+    QList<PlistFile*> fresh;
+    for (const ItemSpec &spec : added) {
+        fresh.append(new PlistFile(spec.path, spec.valueName, spec.isCritical));
+    }
+    plistFiles += fresh;
+
+    m_plistFiles = plistFiles;
+    m_plistFilesModel.setPlistFiles(m_plistFiles);
+    emit plistFilesChanged();
+
+    // The model has let go of them; a baseline read may still be running
+    for (PlistFile *plist : std::as_const(removedFiles)) {
+        if (m_reading.contains(plist)) {
+            m_retired.insert(plist);
+        } else {
+            plist->deleteLater();
+        }
     }
+
+    MON_DEBUG(LogCategory::Monitoring) << "[RELOAD PLIST] Patterns added" << fresh.size()
+                                       << "and removed" << removedFiles.size() << "entries.";
+    readBaselines(fresh);
+}
+
+/**
+ * @brief Expansion and directory-watch counters of the patterned entries.
+ * @return Map produced by ItemPatternExpander::stats().
+ */
+QVariantMap MacOSMonitoring::patternStats() const {
+    return m_patterns.stats();
+}
+
+/**
+ * @brief Block until every baseline read has finished and been applied.
+ */
+void MacOSMonitoring::waitForBaselines() {
+    m_baselinePool.waitForDone();
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+}
+
+/**
+ * @brief Whether all entries of the current list have their baseline.
+ */
+bool MacOSMonitoring::baselinesReady() const {
+    return m_pendingBaselines == 0;
+}
+/**
+ * @brief Slot invoked when the config source's plist list changes.
+ */
+void MacOSMonitoring::onConfigChanged() {
+    reloadPlistFiles();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -179,8 +404,9 @@ void MacOSMonitoring::onPlistFileChanged(const QString &path) {
 void MacOSMonitoring::startMonitoring() {
     if (!m_monitoringActive) {
         m_monitoringActive = true;
-        m_timer.start(1000);  // Check every second
-        qDebug() << "[START MONITORING] Started.";
+        m_watchdog.restart();
+        m_timer.start(m_watchdog.budget());  // Check every second
+        MON_DEBUG(LogCategory::Monitoring) << "[START MONITORING] Started.";
         emit statusChanged("Monitoring started");
     }
 }
@@ -192,7 +418,7 @@ void MacOSMonitoring::stopMonitoring() {
     if (m_monitoringActive) {
         m_monitoringActive = false;
         m_timer.stop();
-        qDebug() << "[STOP MONITORING] Stopped.";
+        MON_DEBUG(LogCategory::Monitoring) << "[STOP MONITORING] Stopped.";
         emit statusChanged("Monitoring stopped");
     }
 }
@@ -204,88 +430,165 @@ void MacOSMonitoring::stopMonitoring() {
 /**
  * @brief Scan all monitored plist files for value changes.
  *
- * For each changed file:
- *  - Log the change in the Changes table.
- *  - Debounce duplicate alerts by tracking m_lastAlertedValue.
- *  - If critical: perform rollback & send critical alert.
- *  - If non-critical: track change count, alert if threshold met.
- *  - Update ConfigurationSettings and in-memory value.
+ * Runs in three passes so a burst of non-critical changes cannot delay a
+ * critical rollback:
+ *  1. Detection: read every file, split changed entries by criticality.
+ *  2. Critical changes: queue rollbacks and run them immediately.
+ *  3. Non-critical changes: count against the threshold.
+ * Alerts are posted to the dispatcher's worker lanes; every database write
+ * of the cycle is staged and committed as one transaction at the end.
+ * The watchdog times the cycle and, when cycles overrun the interval,
+ * defers or sheds non-critical entries in the detection pass.
  */
 void MacOSMonitoring::checkForChanges() {
-    for (PlistFile *plist : m_plistFiles) {
+    MON_SPAN(LogCategory::Monitoring, "checkForChanges");
+    m_watchdog.beginCycle();
+    m_dispatcher.beginTick();
+
+    QVector<DetectedChange> criticalChanges;
+    QVector<DetectedChange> otherChanges;
+
+    for (int i = 0; i < m_plistFiles.size(); ++i) {
+        PlistFile *plist = m_plistFiles[i];
+        if (!plist->baselineReady() || !m_watchdog.admit(i, plist->isCritical())) {
+            continue;
+        }
         QString currentValue = plist->getCurrentValue();
         QString prevValue    = plist->value();
 
         // If value differs, handle the change
         if (currentValue != prevValue) {
-            qDebug() << "[DEBUG] Change:" << plist->plistPath()
+            MON_DEBUG(LogCategory::Monitoring) << "[DEBUG] Change:" << plist->plistPath()
             << "from" << prevValue
             << "to"   << currentValue;
 
-            Database db;
-            db.insertChange(plist->valueName(), prevValue, currentValue, false);
-
-            // Skip if we already alerted for this exact new value
-            if (m_lastAlertedValue.value(plist->valueName()) == currentValue) {
-                qDebug() << "[DEBUG] Debounced duplicate change for"
-                         << plist->plistPath();
-                plist->setValue(currentValue);
-                continue;
-            }
-            m_lastAlertedValue.insert(plist->valueName(), currentValue);
-
-            QString alertMessage;
-
+            DetectedChange change{plist, prevValue, currentValue};
             if (plist->isCritical()) {
-                // Critical: perform rollback if needed
-                plist->setRollbackCancelled(false);
-                plist->setNewValue(currentValue);
-                m_rollback.rollbackIfNeeded(plist);
-                alertMessage = "[CRITICAL ALERT] " +
-                               plist->plistPath() +
-                               " changed to " + currentValue;
+                criticalChanges.append(change);
             } else {
-                // Non-critical: accumulate count and compare to threshold
-                plist->incrementChangeCount();
-                int threshold = m_settings->getNonCriticalAlertThreshold().toInt();
-                int count     = plist->changeCount();
-
-                qDebug() << "[INFO] Non-critical count for"
-                         << plist->plistPath()
-                         << "=" << count
-                         << "threshold=" << threshold;
-
-                if (threshold > 0 && count >= threshold) {
-                    alertMessage = "[ALERT] Threshold reached for " +
-                                   plist->plistPath() +
-                                   ": " + currentValue;
-                    plist->resetChangeCount();
-                    qDebug() << "[DEBUG] Reset count for"
-                             << plist->plistPath();
-                } else {
-                    // Below threshold: just update config and continue
-                    db.insertOrUpdateConfiguration(
-                        plist->valueName(),
-                        plist->plistPath(),
-                        currentValue,
-                        false
-                        );
-                    plist->setValue(currentValue);
-                    continue;
-                }
+                otherChanges.append(change);
             }
+        }
+    }
 
-            // Send the alert and persist final state
-            m_alert.sendAlert(alertMessage);
-            db.insertOrUpdateConfiguration(
-                plist->valueName(),
-                plist->plistPath(),
-                currentValue,
-                plist->isCritical()
-                );
-            plist->setValue(currentValue);
+    for (const DetectedChange &change : criticalChanges) {
+        handleChange(change);
+    }
+    m_dispatcher.serviceRollbacks();
+
+    for (const DetectedChange &change : otherChanges) {
+        handleChange(change);
+    }
+
+    m_dispatcher.commitTick();
+    m_watchdog.endCycle();
+
+    // Time-to-first-check: the first cycle that covered every entry
+    if (baselinesReady()) {
+        StartupOrchestrator::milestone("firstCheck");
+    }
+}
+
+/**
+ * @brief Apply the change policy to one detected change.
+ *
+ * - Log the change in the Changes table; for dictionaries, arrays and
+ *   whole documents, one row per changed leaf, named by its key path.
+ * - Debounce duplicate alerts by tracking m_lastAlertedValue.
+ * - If critical: perform rollback & send critical alert.
+ * - If non-critical: track change count, alert if threshold met.
+ * - Update ConfigurationSettings and in-memory value.
+ *
+ * @param change The entry and its previous/current values.
+ */
+void MacOSMonitoring::handleChange(const DetectedChange &change) {
+    MON_SPAN(LogCategory::Monitoring, "handleChange");
+    PlistFile *plist          = change.plist;
+    const QString prevValue    = change.prevValue;
+    const QString currentValue = change.currentValue;
+    const QString valueName    = plist->valueName();
+    const QString plistPath    = plist->plistPath();
+    const bool    critical     = plist->isCritical();
+    const ChangeLane persistLane = critical ? ChangeLane::CriticalPersist
+                                            : ChangeLane::Persist;
+
+    // Views are told about each row under the config_name it is stored with
+    const QDateTime detectedAt = Clock::instance()->now();
+    const QVector<PlistLeafChange> leaves = plist->changedLeaves(prevValue, currentValue);
+    if (leaves.isEmpty()) {
+        m_dispatcher.stage(persistLane, changeLogWrite(valueName, prevValue, currentValue, critical));
+        emit changeRecorded(valueName, detectedAt);
+    }
+    for (const PlistLeafChange &leaf : leaves) {
+        const QString rowName = ChangeRow::leafConfigName(valueName, plistPath, leaf.keyPath);
+        m_dispatcher.stage(persistLane, changeLogWrite(rowName, leaf.before, leaf.after, critical));
+        emit changeRecorded(rowName, detectedAt);
+    }
+
+    // Alerts name the changed leaves rather than quoting a whole container
+    QString changeText = currentValue;
+    if (!leaves.isEmpty()) {
+        QStringList paths;
+        for (const PlistLeafChange &leaf : leaves) {
+            paths << leaf.keyPath;
         }
+        changeText = QStringLiteral("%1 changed key(s): %2").arg(leaves.size()).arg(paths.join(", "));
+    }
+
+    // Skip if we already alerted for this exact new value
+    if (m_lastAlertedValue.value(valueName) == currentValue) {
+        MON_DEBUG(LogCategory::Monitoring) << "[DEBUG] Debounced duplicate change for" << plistPath;
+        plist->setValue(currentValue);
+        return;
+    }
+    m_lastAlertedValue.insert(valueName, currentValue);
+
+    if (critical) {
+        // Critical: rollback runs on this thread ahead of all other work;
+        // the alert and final state are only queued once it has completed.
+        plist->setRollbackCancelled(false);
+        plist->setNewValue(currentValue);
+        QString alertMessage = "[CRITICAL ALERT] " + plistPath +
+                               (leaves.isEmpty() ? " changed to " : " changed, ") + changeText;
+
+        m_dispatcher.post(ChangeLane::Rollback, [=]() {
+            m_rollback.rollbackIfNeeded(plist);
+            m_dispatcher.post(ChangeLane::CriticalAlert, [this, alertMessage]() {
+                m_alert.sendAlert(alertMessage);
+            });
+            m_dispatcher.stage(ChangeLane::CriticalPersist, [=](Database &db) {
+                return db.insertOrUpdateConfiguration(valueName, plistPath, currentValue, true);
+            });
+            plist->setValue(currentValue);
+        });
+        return;
     }
+
+    // Non-critical: accumulate count and compare to threshold
+    plist->incrementChangeCount();
+    int threshold = m_settings->getNonCriticalAlertThreshold().toInt();
+    int count     = plist->changeCount();
+
+    MON_DEBUG(LogCategory::Monitoring) << "[INFO] Non-critical count for" << plistPath
+             << "=" << count
+             << "threshold=" << threshold;
+
+    if (threshold > 0 && count >= threshold) {
+        QString alertMessage = "[ALERT] Threshold reached for " +
+                               plistPath + ": " + changeText;
+        plist->resetChangeCount();
+        MON_DEBUG(LogCategory::Monitoring) << "[DEBUG] Reset count for" << plistPath;
+
+        m_dispatcher.post(ChangeLane::Alert, [this, alertMessage]() {
+            m_alert.sendAlert(alertMessage);
+        });
+    }
+
+    // Persist final state
+    m_dispatcher.stage(ChangeLane::Persist, [=](Database &db) {
+        return db.insertOrUpdateConfiguration(valueName, plistPath, currentValue, false);
+    });
+    plist->setValue(currentValue);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -300,15 +603,15 @@ void MacOSMonitoring::checkForChanges() {
  * - Cancels the pending rollback on the corresponding PlistFile.
  */
 void MacOSMonitoring::allowChange(const QString &fileName) {
-    qDebug() << "[ALLOW CHANGE] for" << fileName;
+    MON_DEBUG(LogCategory::Monitoring) << "[ALLOW CHANGE] for" << fileName;
 
     Database db;
     // Acknowledge in the Changes table if not already done
     if (db.updateAcknowledgmentStatus(fileName)) {
-        qDebug() << "[ALLOW CHANGE] Acknowledged in DB for" << fileName;
+        MON_DEBUG(LogCategory::Monitoring) << "[ALLOW CHANGE] Acknowledged in DB for" << fileName;
         emit changeAcknowledged(fileName);
     } else {
-        qDebug() << "[ALLOW CHANGE] Nothing to acknowledge for" << fileName;
+        MON_DEBUG(LogCategory::Monitoring) << "[ALLOW CHANGE] Nothing to acknowledge for" << fileName;
     }
 
     // Cancel rollback on the in-memory PlistFile
@@ -317,44 +620,46 @@ void MacOSMonitoring::allowChange(const QString &fileName) {
             plist->setRollbackCancelled(true);
             m_rollback.cancelRollback(plist);
             plist->setPreviousValue(plist->newValue());
-            qDebug() << "[ALLOW CHANGE] Cancelled rollback for" << fileName;
+            MON_DEBUG(LogCategory::Monitoring) << "[ALLOW CHANGE] Cancelled rollback for" << fileName;
             break;
         }
     }
 }
 
 /**
- * @brief Mark or unmark a plist file as critical at runtime.
- * @param fileName   The valueName identifier of the plist entry.
+ * @brief Mark or unmark a plist entry as critical at runtime.
+ * @param plistPath  Path of the plist file holding the key.
+ * @param valueName  Key name inside the plist.
  * @param isCritical True to treat subsequent changes as critical.
  */
-void MacOSMonitoring::setFileCriticalStatus(const QString &fileName, bool isCritical) {
-    qDebug() << "[DEBUG] setFileCriticalStatus:" << fileName << isCritical;
+void MacOSMonitoring::setFileCriticalStatus(const QString &plistPath, const QString &valueName,
+                                            bool isCritical) {
+    MON_DEBUG(LogCategory::Monitoring) << "[DEBUG] setFileCriticalStatus:" << plistPath << valueName << isCritical;
 
-    for (int i = 0; i < m_plistFiles.size(); ++i) {
-        PlistFile *plist = m_plistFiles[i];
-        if (plist->valueName() == fileName) {
-            // Update in-memory flag and notify any bound views
-            plist->setCritical(isCritical);
-            QModelIndex idx = m_plistFilesModel.index(i);
-            emit m_plistFilesModel.dataChanged(
-                idx, idx, { PlistFileModel::DisplayTextRole }
-                );
-
-            // Register or unregister rollback as needed
-            Database db;
-            if (isCritical) {
-                m_rollback.plistFileForRollback(plist);
-            }
-            db.insertOrUpdateConfiguration(
-                plist->valueName(),
-                plist->plistPath(),
-                plist->value(),
-                isCritical
-                );
-            break;
-        }
+    PlistFile *plist = m_plistFilesModel.fileFor(plistPath, valueName);
+    if (!plist) {
+        return;
     }
+
+    // The model forwards isCriticalChanged/displayTextChanged to bound views
+    plist->setCritical(isCritical);
+
+    // Still being read; its baseline row will carry the new flag
+    if (!plist->baselineReady()) {
+        return;
+    }
+
+    // Register or unregister rollback as needed
+    Database db;
+    if (isCritical) {
+        m_rollback.plistFileForRollback(plist);
+    }
+    db.insertOrUpdateConfiguration(
+        plist->valueName(),
+        plist->plistPath(),
+        plist->value(),
+        isCritical
+        );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -368,3 +673,27 @@ void MacOSMonitoring::setFileCriticalStatus(const QString &fileName, bool isCrit
 PlistFileModel* MacOSMonitoring::plistFiles() {
     return &m_plistFilesModel;
 }
+
+/**
+ * @brief Provide the sorted/filterable view used by the monitored-items list.
+ * @return Pointer to the proxy model.
+ */
+MonitoredItemsProxyModel* MacOSMonitoring::monitoredItems() {
+    return &m_monitoredItems;
+}
+
+/**
+ * @brief Latency and queue depth for each priority lane.
+ * @return Map produced by ChangeDispatcher::laneStats().
+ */
+QVariantMap MacOSMonitoring::laneStats() const {
+    return m_dispatcher.laneStats();
+}
+
+/**
+ * @brief Provide the check-cycle watchdog for diagnostics and UI binding.
+ * @return Pointer to the watchdog.
+ */
+TickWatchdog* MacOSMonitoring::watchdog() {
+    return &m_watchdog;
+}
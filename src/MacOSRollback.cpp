@@ -1,5 +1,8 @@
 #include "MacOSRollback.h"
 #include "Database.h"
+#include "changeDispatcher.h"
+#include "logger.h"
+#include "trace.h"
 #include <QDebug>
 #include <QDateTime>
 
@@ -25,6 +28,14 @@ MacOSRollback::MacOSRollback(QObject *parent)
     // Nothing to initialize here beyond QObject parent.
 }
 
+/**
+ * @brief Send the rollback's ConfigurationSettings write to a dispatcher lane.
+ * @param dispatcher Dispatcher to use, or nullptr to write inline.
+ */
+void MacOSRollback::setDispatcher(ChangeDispatcher *dispatcher) {
+    m_dispatcher = dispatcher;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Public API
 ////////////////////////////////////////////////////////////////////////////////
@@ -38,7 +49,7 @@ MacOSRollback::MacOSRollback(QObject *parent)
  */
 void MacOSRollback::plistFileForRollback(PlistFile* plist) {
     if (plist->isCritical()) {
-        qDebug() << "[ROLLBACK] Registered for rollback:" << plist->plistPath();
+        MON_DEBUG(LogCategory::Rollback) << "[ROLLBACK] Registered for rollback:" << plist->plistPath();
     }
 }
 
@@ -51,8 +62,9 @@ void MacOSRollback::plistFileForRollback(PlistFile* plist) {
  * - Syncs via QSettings and confirms the update succeeded.
  */
 void MacOSRollback::cancelRollback(PlistFile* plist) {
+    MON_SPAN(LogCategory::Rollback, "rollback.cancel");
     if (!plist) {
-        qWarning() << "[CANCEL ROLLBACK] Null PlistFile pointer";
+        MON_WARN(LogCategory::Rollback) << "[CANCEL ROLLBACK] Null PlistFile pointer";
         return;
     }
 
@@ -62,21 +74,20 @@ void MacOSRollback::cancelRollback(PlistFile* plist) {
     if (!newValue.isEmpty()) {
         // Apply stored new value
         plist->setValue(newValue);
-        plist->settings()->sync();
 
         // Confirm the on-disk value matches
         QString confirmed = plist->getCurrentValue();
         if (confirmed == newValue) {
-            qDebug() << "[CANCEL ROLLBACK] Successfully reapplied new value for:"
+            MON_DEBUG(LogCategory::Rollback) << "[CANCEL ROLLBACK] Successfully reapplied new value for:"
                      << plist->plistPath() << "→" << confirmed;
         } else {
-            qWarning() << "[CANCEL ROLLBACK] Reapply failed for:"
+            MON_WARN(LogCategory::Rollback) << "[CANCEL ROLLBACK] Reapply failed for:"
                        << plist->plistPath()
                        << "expected:" << newValue
                        << "got:"      << confirmed;
         }
     } else {
-        qDebug() << "[CANCEL ROLLBACK] No stored newValue; nothing to reapply for:"
+        MON_DEBUG(LogCategory::Rollback) << "[CANCEL ROLLBACK] No stored newValue; nothing to reapply for:"
                  << plist->plistPath();
     }
 }
@@ -91,8 +102,9 @@ void MacOSRollback::cancelRollback(PlistFile* plist) {
  * - Logs changes to ConfigurationSettings via Database.
  */
 void MacOSRollback::rollbackIfNeeded(PlistFile* plist) {
+    MON_SPAN(LogCategory::Rollback, "rollback.check");
     if (!plist) {
-        qWarning() << "[ROLLBACK IF NEEDED] Null PlistFile pointer";
+        MON_WARN(LogCategory::Rollback) << "[ROLLBACK IF NEEDED] Null PlistFile pointer";
         return;
     }
 
@@ -101,7 +113,7 @@ void MacOSRollback::rollbackIfNeeded(PlistFile* plist) {
 
     // Only rollback critical entries with a divergence
     if (plist->isCritical() && current != prevValue) {
-        qDebug() << "[ROLLBACK] Unauthorized change detected for:"
+        MON_DEBUG(LogCategory::Rollback) << "[ROLLBACK] Unauthorized change detected for:"
                  << plist->valueName();
 
         // Store the current (bad) value as “newValue” for potential cancel
@@ -111,13 +123,18 @@ void MacOSRollback::rollbackIfNeeded(PlistFile* plist) {
         restorePreviousValue(plist);
 
         // Persist the restored state in the database
-        Database db;
-        db.insertOrUpdateConfiguration(
-            plist->valueName(),
-            plist->plistPath(),
-            prevValue,
-            true
-            );
+        const QString configName = plist->valueName();
+        const QString configPath = plist->plistPath();
+        auto persist = [configName, configPath, prevValue](Database &db) {
+            return db.insertOrUpdateConfiguration(configName, configPath, prevValue, true);
+        };
+        if (m_dispatcher) {
+            // Joins the current check cycle's transaction
+            m_dispatcher->stage(ChangeLane::CriticalPersist, persist);
+        } else {
+            Database db;
+            persist(db);
+        }
 
         // Notify listeners that rollback occurred
         emit rollbackPerformed(plist->valueName());
@@ -132,32 +149,32 @@ void MacOSRollback::rollbackIfNeeded(PlistFile* plist) {
  * @brief Restore the PlistFile’s on-disk value back to previousValue.
  * @param plist Pointer to the PlistFile to restore.
  *
- * - Writes previousValue via QSettings.
+ * - Writes previousValue via PlistFile::writeStoredValue().
  * - Syncs and confirms the on-disk value matches previousValue.
  */
 void MacOSRollback::restorePreviousValue(PlistFile* plist) {
+    MON_SPAN(LogCategory::Rollback, "rollback.restore");
     QString prevValue = plist->previousValue();
     QString current   = plist->getCurrentValue();
 
     if (current == prevValue) {
-        qDebug() << "[RESTORE] No change needed; already at previous value for:"
+        MON_DEBUG(LogCategory::Rollback) << "[RESTORE] No change needed; already at previous value for:"
                  << plist->plistPath()
                  << "value:" << prevValue;
         return;
     }
 
     // Apply the baseline value
-    plist->settings()->setValue(plist->valueName(), prevValue);
-    plist->settings()->sync();
+    plist->writeStoredValue(prevValue);
 
     // Confirm restoration
     QString confirmed = plist->getCurrentValue();
     if (confirmed == prevValue) {
-        qDebug() << "[ROLLBACK] Successfully restored:"
+        MON_DEBUG(LogCategory::Rollback) << "[ROLLBACK] Successfully restored:"
                  << plist->plistPath()
                  << "to" << confirmed;
     } else {
-        qWarning() << "[ROLLBACK FAILURE] Could not restore:"
+        MON_WARN(LogCategory::Rollback) << "[ROLLBACK FAILURE] Could not restore:"
                    << plist->plistPath()
                    << "expected:" << prevValue
                    << "got:"      << confirmed;
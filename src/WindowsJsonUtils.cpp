@@ -7,14 +7,43 @@
  */
 
 #include "WindowsJsonUtils.h"
+#include "configSource.h"
+#include "itemListCache.h"
+#include "logger.h"
+#include <QBuffer>
 #include <QFile>
-#include <QJsonDocument>
-#include <QJsonArray>
-#include <QJsonObject>
-#include <QDebug>
 
 namespace WindowsJsonUtils {
 
+namespace {
+
+const ItemListFormat kFormat{"keyPath", true};
+
+/// Instantiate the keys of a parsed list, logging what was dropped.
+QList<RegistryKey*> toRegistryKeys(const ItemListResult &result, const QString &origin) {
+    QList<RegistryKey*> registryKeys;
+    if (!result.ok) {
+        MON_WARN(LogCategory::Item) << "[WindowsJsonUtils] Expected top-level JSON array in file:" << origin
+                                    << "-" << result.error;
+        return registryKeys;
+    }
+    if (result.skipped > 0) {
+        MON_WARN(LogCategory::Item) << "[WindowsJsonUtils] Skipped" << result.skipped
+                                    << "invalid entries (not an object, or missing hive/keyPath/valueName)";
+    }
+
+    registryKeys.reserve(result.items.size());
+    for (const ItemSpec &spec : result.items) {
+        registryKeys.append(new RegistryKey(spec.hive, spec.path, spec.valueName, spec.isCritical));
+    }
+
+    MON_DEBUG(LogCategory::Item) << "[WindowsJsonUtils] Loaded" << registryKeys.size()
+                                 << "registry keys from" << (result.fromCache ? "cache." : "JSON.");
+    return registryKeys;
+}
+
+} // namespace
+
 /**
  * @brief Parse a JSON file and create RegistryKey instances.
  *
@@ -25,58 +54,44 @@ namespace WindowsJsonUtils {
  *   - "valueName"  : QString, the registry value to monitor
  *   - "isCritical" : bool, whether changes to this key are critical
  *
+ * The file is parsed as a stream (see ItemListReader).
+ *
  * @param filePath Path to the JSON configuration file.
  * @return QList<RegistryKey*> A list of new RegistryKey pointers.
  *         Ownership is transferred to the caller. Returns an empty list on error.
  */
 QList<RegistryKey*> readKeysFromJson(const QString &filePath) {
-    QList<RegistryKey*> registryKeys;
-
     // Attempt to open the JSON file for reading
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "[WindowsJsonUtils] Could not open JSON file:" << filePath;
-        return registryKeys;
+        MON_WARN(LogCategory::Item) << "[WindowsJsonUtils] Could not open JSON file:" << filePath;
+        return QList<RegistryKey*>();
     }
+    return toRegistryKeys(ItemListCache::parse(&file, kFormat), filePath);
+}
 
-    // Parse the entire file into a QJsonDocument
-    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-    file.close();
-
-    // Ensure the document contains a JSON array at the top level
-    if (!doc.isArray()) {
-        qWarning() << "[WindowsJsonUtils] Expected top-level JSON array in file:" << filePath;
-        return registryKeys;
-    }
-    QJsonArray keysArray = doc.array();
-
-    // Iterate over each object in the array
-    for (const QJsonValue &value : keysArray) {
-        if (!value.isObject()) {
-            qWarning() << "[WindowsJsonUtils] Skipping non-object entry in JSON array";
-            continue;
-        }
-        QJsonObject obj = value.toObject();
-
-        // Extract required fields with defaults
-        QString hive       = obj.value("hive").toString();
-        QString keyPath    = obj.value("keyPath").toString();
-        QString valueName  = obj.value("valueName").toString();
-        bool    isCritical = obj.value("isCritical").toBool(false);
-
-        // Validate mandatory strings
-        if (hive.isEmpty() || keyPath.isEmpty() || valueName.isEmpty()) {
-            qWarning() << "[WindowsJsonUtils] Invalid entry (missing hive/keyPath/valueName)";
-            continue;
-        }
-
-        // Instantiate a RegistryKey and append to the list
-        registryKeys.append(new RegistryKey(hive, keyPath, valueName, isCritical));
-    }
+/**
+ * @brief Create RegistryKey instances from JSON text in the readKeysFromJson() format.
+ *
+ * @param json   Raw JSON document.
+ * @param origin Where @p json came from, for log messages.
+ * @return QList<RegistryKey*> New RegistryKey pointers owned by the caller; empty on error.
+ */
+QList<RegistryKey*> parseKeysJson(const QByteArray &json, const QString &origin) {
+    QBuffer buffer;
+    buffer.setData(json);
+    buffer.open(QIODevice::ReadOnly);
+    return toRegistryKeys(ItemListCache::parse(&buffer, kFormat), origin);
+}
 
-    qDebug() << "[WindowsJsonUtils] Loaded" << registryKeys.size()
-             << "registry keys from JSON.";
-    return registryKeys;
+/**
+ * @brief Create RegistryKey instances from the list supplied by @p source.
+ *
+ * @param source Config source holding a readKeysFromJson()-format document.
+ * @return QList<RegistryKey*> New RegistryKey pointers owned by the caller; empty on error.
+ */
+QList<RegistryKey*> loadKeys(const ConfigSource &source) {
+    return toRegistryKeys(ItemListCache::load(source, kFormat), source.description());
 }
 
 } // namespace WindowsJsonUtils
@@ -7,6 +7,10 @@
 
 #include "WindowsMonitoring.h"
 #include "WindowsJsonUtils.h"
+#include "logger.h"
+#include "trace.h"
+#include "resourceGovernor.h"
+#include "startupOrchestrator.h"
 #include <QDebug>
 #include <QDir>
 #include <QCoreApplication>
@@ -14,32 +18,60 @@
 #include <QDateTime>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QPointer>
+#include <QThread>
 #include <algorithm>
 
 ////////////////////////////////////////////////////////////////////////////////
 // Constructor / Initialization
 ////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * @brief Path of the JSON list of monitored registry keys.
+ *
+ * MONITOR_ITEMS_CONFIG overrides the bundled resource, e.g. for soak runs
+ * against synthetic keys.
+ */
+static QString monitoredKeysPath() {
+    const QString overridePath = qEnvironmentVariable("MONITOR_ITEMS_CONFIG");
+    if (!overridePath.isEmpty()) {
+        return overridePath;
+    }
+    return QDir::cleanPath(
+        QCoreApplication::applicationDirPath() +
+        "/../../resources/monitoredKeys.json");
+}
+
+/// Keys read per baseline job; small enough to spread over the pool.
+static constexpr int kBaselineChunk = 64;
+
 /**
  * @brief Construct and initialize a WindowsMonitoring instance.
  *
  * - Sets up a periodic timer to invoke checkForChanges().
  * - Hooks rollbackPerformed → criticalChangeDetected.
- * - Loads the initial key list from JSON and watches that file for updates.
- * - Ensures user contact settings are loaded or stored in the database.
+ * - Loads the initial key list from the config source and follows its updates;
+ *   key values are read in the background (see loadBaselines()).
+ * - Ensures user contact settings are loaded or stored in the database, also
+ *   in the background (see syncContacts()).
  *
  * @param settings Pointer to the shared Settings object.
+ * @param source   Config source, or nullptr for a watched monitoredKeys.json.
  * @param parent   Optional parent QObject.
  */
-WindowsMonitoring::WindowsMonitoring(Settings *settings, QObject *parent)
+WindowsMonitoring::WindowsMonitoring(Settings *settings, ConfigSource *source, QObject *parent)
     : MonitoringBase(parent)
     , m_monitoringActive(false)
     , m_settings(settings)
     , m_alert(settings, this)
-    , m_database()  // Uses default-constructed Database instance
+    , m_configSource(source ? source : new FileConfigSource(monitoredKeysPath(), this))
+    , m_dispatcher(this)
 {
+    // Sorted/filtered view used by the monitored-items list
+    m_monitoredItems.setSourceModel(&m_registryKeysModel);
+
     // When the timer fires, perform change detection
-    connect(&m_timer, &QTimer::timeout,
+    connect(&m_timer, &ClockTimer::timeout,
             this, &WindowsMonitoring::checkForChanges);
 
     // When a rollback is performed, emit a criticalChangeDetected signal
@@ -48,60 +80,94 @@ WindowsMonitoring::WindowsMonitoring(Settings *settings, QObject *parent)
                 QString alertMessage =
                     "[CRITICAL] Rollback performed for key: " + valueName;
                 emit criticalChangeDetected(alertMessage);
-                qDebug() << "[INFO] Rollback performed for key:" << valueName;
+                MON_DEBUG(LogCategory::Monitoring) << "[INFO] Rollback performed for key:" << valueName;
             });
 
-    // Load the list of monitored registry keys from JSON
+    // Rollback bookkeeping writes go through the critical persistence lane
+    m_rollback.setDispatcher(&m_dispatcher);
+
+    // Load the list of monitored registry keys from JSON and follow runtime updates
     reloadMonitoredKeys();
+    connect(m_configSource, &ConfigSource::changed,
+            this, &WindowsMonitoring::onConfigChanged);
 
-    // Watch the JSON file itself for runtime updates
-    QString filePath = QDir::cleanPath(
-        QCoreApplication::applicationDirPath() +
-        "/../../resources/monitoredKeys.json");
-    if (QFile::exists(filePath)) {
-        m_fileWatcher.addPath(filePath);
-        connect(&m_fileWatcher, &QFileSystemWatcher::fileChanged,
-                this, &WindowsMonitoring::onMonitoredFileChanged);
-        qDebug() << "[MONITORING INIT] Watching JSON config:" << filePath;
+    // Ensure Settings has email/phone; otherwise load from DB and persist
+    if (m_settings) {
+        syncContacts();
     } else {
-        qWarning() << "[MONITORING INIT] JSON file not found at:" << filePath;
+        MON_WARN(LogCategory::Monitoring) << "[MONITORING INIT] Settings object is null.";
     }
+}
 
-    // Ensure Settings has email/phone; otherwise load from DB and persist
-    if (m_settings) {
-        QString email = m_settings->getEmail();
-        QString phone = m_settings->getPhoneNumber();
-        if (email.isEmpty() || phone.isEmpty()) {
-            QVariantList userSettings = m_database.getAllUserSettings();
-            if (!userSettings.isEmpty()) {
-                QVariantMap user = userSettings.first().toMap();
-                if (email.isEmpty()) {
-                    email = user["email"].toString();
-                    m_settings->setEmail(email);
-                }
-                if (phone.isEmpty()) {
-                    phone = user["phone"].toString();
-                    m_settings->setPhoneNumber(phone);
-                }
+/**
+ * @brief Destructor: wait for baseline reads still using the registry keys.
+ */
+WindowsMonitoring::~WindowsMonitoring() {
+    shutdown();
+}
+
+void WindowsMonitoring::shutdown() {
+    stopMonitoring();
+    m_baselinePool.waitForDone();
+    m_dispatcher.shutdown();
+}
+
+/**
+ * @brief Load contacts from UserSettings into Settings and save them back.
+ *
+ * The query runs as the "contacts" startup task; Settings is updated on
+ * this thread when it returns. Every saved contact is joined into Settings,
+ * as alerts go to all of them.
+ */
+void WindowsMonitoring::syncContacts() {
+    QPointer<WindowsMonitoring> self(this);
+    StartupOrchestrator::submit("contacts", [self]() {
+        Database db;
+        const QVector<UserRow> userSettings = db.userSettingsRows();
+        QMetaObject::invokeMethod(self, [self, userSettings]() {
+            if (self) {
+                self->applyContacts(userSettings);
             }
-        }
-        qDebug() << "[MONITORING INIT] Final email:" << email
-                 << "phone:" << phone;
-
-        // Persist back into the database if at least one contact is set
-        if (!email.isEmpty() || !phone.isEmpty()) {
-            QString freq = m_settings->getNotificationFrequency();
-            if (!m_database.insertUserSettings(email, phone, 0, freq)) {
-                qWarning() << "[MONITORING INIT] Failed to save settings.";
-            } else {
-                qDebug() << "[MONITORING INIT] User settings saved.";
+        }, Qt::QueuedConnection);
+    });
+}
+
+/**
+ * @brief Second half of syncContacts(), on the monitor's thread.
+ * @param userSettings Rows read from UserSettings.
+ */
+void WindowsMonitoring::applyContacts(const QVector<UserRow> &userSettings) {
+    QStringList emails, phones;
+    for (const UserRow &user : userSettings) {
+        if (!user.email.isEmpty()) emails << user.email;
+        if (!user.phone.isEmpty()) phones << user.phone;
+    }
+    if (!emails.isEmpty()) {
+        m_settings->setEmail(emails.join(", "));
+    }
+    if (!phones.isEmpty()) {
+        m_settings->setPhoneNumber(phones.join(", "));
+    }
+
+    const QString email = m_settings->getEmail();
+    const QString phone = m_settings->getPhoneNumber();
+    MON_DEBUG(LogCategory::Monitoring) << "[MONITORING INIT] Final email:" << email
+             << "phone:" << phone;
+
+    // Persist back into the database if at least one contact is set
+    if (!email.isEmpty() || !phone.isEmpty()) {
+        const QString freq = m_settings->getNotificationFrequency();
+        m_dispatcher.stage(ChangeLane::Persist, [email, phone, freq](Database &db) {
+            if (!db.insertUserSettings(email, phone, 0, freq)) {
+                MON_WARN(LogCategory::Monitoring) << "[MONITORING INIT] Failed to save settings.";
+                return false;
             }
-        } else {
-            qWarning() << "[MONITORING INIT]"
-                       << "Both email and phone empty; alerts disabled.";
-        }
+            MON_DEBUG(LogCategory::Monitoring) << "[MONITORING INIT] User settings saved.";
+            return true;
+        });
     } else {
-        qWarning() << "[MONITORING INIT] Settings object is null.";
+        MON_WARN(LogCategory::Monitoring) << "[MONITORING INIT]"
+                   << "Both email and phone empty; alerts disabled.";
     }
 }
 
@@ -114,22 +180,21 @@ WindowsMonitoring::WindowsMonitoring(Settings *settings, QObject *parent)
  *
  * - Reads JSON array of {hive, keyPath, valueName, isCritical}.
  * - Updates the model, emits registryKeysChanged().
- * - Inserts/updates each entry into the ConfigurationSettings table.
+ * - Starts reading the keys' values; each chunk is inserted/updated into
+ *   the ConfigurationSettings table as it completes.
  */
 void WindowsMonitoring::reloadMonitoredKeys() {
-    QString filePath = QDir::cleanPath(
-        QCoreApplication::applicationDirPath() +
-        "/../../resources/monitoredKeys.json");
-    if (!QFile::exists(filePath)) {
-        qWarning() << "[RELOAD KEYS] JSON not found at:" << filePath;
+    if (!m_configSource->isAvailable()) {
+        MON_WARN(LogCategory::Monitoring) << "[RELOAD KEYS] JSON not found at:"
+                                          << m_configSource->description();
         return;
     }
 
-    // Parse JSON into new list
+    // Parse JSON (or its cached form) into new list
     QList<RegistryKey*> newKeys =
-        WindowsJsonUtils::readKeysFromJson(filePath);
+        WindowsJsonUtils::loadKeys(*m_configSource);
     if (newKeys.isEmpty()) {
-        qWarning() << "[RELOAD KEYS] No entries in JSON.";
+        MON_WARN(LogCategory::Monitoring) << "[RELOAD KEYS] No entries in JSON.";
         return;
     }
 
@@ -138,34 +203,100 @@ void WindowsMonitoring::reloadMonitoredKeys() {
     m_registryKeysModel.setRegistryKeys(m_registryKeys);
     emit registryKeysChanged();
 
-    // Persist these key definitions into the database
-    for (RegistryKey *key : m_registryKeys) {
-        m_database.insertOrUpdateConfiguration(
-            key->name(),
-            key->keyPath(),
-            key->value(),
-            key->isCritical()
-            );
-    }
-
-    qDebug() << "[RELOAD KEYS] Loaded"
+    MON_DEBUG(LogCategory::Monitoring) << "[RELOAD KEYS] Loaded"
              << m_registryKeys.size()
              << "registry keys from JSON.";
+
+    loadBaselines();
 }
 
 /**
- * @brief Slot invoked when the JSON config file itself is modified.
- * @param path Filesystem path of the changed JSON file.
+ * @brief Read every key's initial value in parallel chunks.
+ *
+ * The list is visible in the UI immediately; the check loop skips each
+ * key until its value has been read. A chunk's ConfigurationSettings rows
+ * are written as one transaction once it completes. A reload while chunks
+ * are running starts a new generation and ignores the old one.
  */
-void WindowsMonitoring::onMonitoredFileChanged(const QString &path) {
-    qDebug() << "[FILE WATCHER] JSON changed:" << path;
-    reloadMonitoredKeys();
-    // Re-add watcher if needed
-    if (!m_fileWatcher.files().contains(path)) {
-        m_fileWatcher.addPath(path);
+void WindowsMonitoring::loadBaselines() {
+    const quint64 generation = ++m_baselineGeneration;
+    m_pendingBaselines = m_registryKeys.size();
+    m_baselineTimer.start();
+    m_baselinePool.setMaxThreadCount(
+        ResourceGovernor::workers(std::max(1, QThread::idealThreadCount())));
+
+    QPointer<WindowsMonitoring> self(this);
+    for (int from = 0; from < m_registryKeys.size(); from += kBaselineChunk) {
+        const QList<RegistryKey *> chunk = m_registryKeys.mid(from, kBaselineChunk);
+        m_baselinePool.start([self, chunk, generation]() {
+            for (RegistryKey *key : chunk) {
+                key->loadBaseline();
+            }
+            QMetaObject::invokeMethod(self, [self, chunk, generation]() {
+                if (self) {
+                    self->onBaselinesLoaded(chunk, generation);
+                }
+            }, Qt::QueuedConnection);
+        });
+    }
+    if (m_registryKeys.isEmpty()) {
+        emit baselinesLoaded();
     }
 }
 
+/**
+ * @brief Persist one chunk of freshly read keys and track completion.
+ * @param chunk      Keys whose baselines are now ready.
+ * @param generation loadBaselines() call the chunk belongs to.
+ */
+void WindowsMonitoring::onBaselinesLoaded(const QList<RegistryKey *> &chunk, quint64 generation) {
+    if (generation != m_baselineGeneration) {
+        return;
+    }
+
+    m_dispatcher.beginTick();
+    for (RegistryKey *key : chunk) {
+        const QString name     = key->name();
+        const QString keyPath  = key->keyPath();
+        const QString value    = key->value();
+        const bool    critical = key->isCritical();
+        m_dispatcher.stage(ChangeLane::Persist, [=](Database &db) {
+            return db.insertOrUpdateConfiguration(name, keyPath, value, critical);
+        });
+    }
+    m_dispatcher.commitTick();
+
+    m_pendingBaselines -= chunk.size();
+    if (m_pendingBaselines == 0) {
+        MON_INFO(LogCategory::Monitoring) << "[RELOAD KEYS] Read" << m_registryKeys.size()
+                                          << "baselines in" << m_baselineTimer.elapsed() << "ms.";
+        StartupOrchestrator::milestone("baselinesReady");
+        emit baselinesLoaded();
+    }
+}
+
+/**
+ * @brief Block until every baseline read has finished and been applied.
+ */
+void WindowsMonitoring::waitForBaselines() {
+    m_baselinePool.waitForDone();
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+}
+
+/**
+ * @brief Whether all keys of the current list have their baseline.
+ */
+bool WindowsMonitoring::baselinesReady() const {
+    return m_pendingBaselines == 0;
+}
+
+/**
+ * @brief Slot invoked when the config source's key list changes.
+ */
+void WindowsMonitoring::onConfigChanged() {
+    reloadMonitoredKeys();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Monitoring Control
 ////////////////////////////////////////////////////////////////////////////////
@@ -176,8 +307,9 @@ void WindowsMonitoring::onMonitoredFileChanged(const QString &path) {
 void WindowsMonitoring::startMonitoring() {
     if (!m_monitoringActive) {
         m_monitoringActive = true;
-        m_timer.start(1000);  // Check every second
-        qDebug() << "[START MONITORING] Started.";
+        m_watchdog.restart();
+        m_timer.start(m_watchdog.budget());  // Check every second
+        MON_DEBUG(LogCategory::Monitoring) << "[START MONITORING] Started.";
         emit statusChanged("Monitoring started");
     }
 }
@@ -189,7 +321,7 @@ void WindowsMonitoring::stopMonitoring() {
     if (m_monitoringActive) {
         m_monitoringActive = false;
         m_timer.stop();
-        qDebug() << "[STOP MONITORING] Stopped.";
+        MON_DEBUG(LogCategory::Monitoring) << "[STOP MONITORING] Stopped.";
         emit statusChanged("Monitoring stopped");
     }
 }
@@ -201,122 +333,176 @@ void WindowsMonitoring::stopMonitoring() {
 /**
  * @brief Scan all monitored registry keys for value changes.
  *
- * For each changed key:
- *  - Log the change in the Changes table.
- *  - Debounce duplicate alerts by tracking m_lastAlertedValue.
- *  - If critical: schedule rollback and a delayed alert after 10 seconds.
- *  - If non-critical: track change count, alert when threshold met.
- *  - Update ConfigurationSettings and in-memory value.
+ * Runs in three passes so a burst of non-critical changes cannot delay a
+ * critical rollback:
+ *  1. Detection: read every key, split changed keys by criticality.
+ *  2. Critical changes: queue rollbacks and run them immediately.
+ *  3. Non-critical changes: count against the threshold.
+ * Alerts are posted to the dispatcher's worker lanes; every database write
+ * of the cycle is staged and committed as one transaction at the end.
+ * The watchdog times the cycle and, when cycles overrun the interval,
+ * defers or sheds non-critical entries in the detection pass.
  */
 void WindowsMonitoring::checkForChanges() {
-    for (RegistryKey *key : m_registryKeys) {
+    MON_SPAN(LogCategory::Monitoring, "checkForChanges");
+    m_watchdog.beginCycle();
+    m_dispatcher.beginTick();
+
+    QVector<DetectedChange> criticalChanges;
+    QVector<DetectedChange> otherChanges;
+
+    for (int i = 0; i < m_registryKeys.size(); ++i) {
+        RegistryKey *key = m_registryKeys[i];
+        if (!key->baselineReady() || !m_watchdog.admit(i, key->isCritical())) {
+            continue;
+        }
         QString currentValue = key->getCurrentValue();
         QString prevValue    = key->value();
 
         // Detect a change
         if (currentValue != prevValue) {
-            qDebug() << "[DEBUG] Change:" << key->name()
+            MON_DEBUG(LogCategory::Monitoring) << "[DEBUG] Change:" << key->name()
             << "from" << prevValue
             << "to"   << currentValue;
 
-            // Log the change
-            m_database.insertChange(
-                key->name(),
-                prevValue,
-                currentValue,
-                false
-                );
-
-            // Debounce duplicate alerts
-            if (m_lastAlertedValue.value(key->name()) == currentValue) {
-                qDebug() << "[DEBUG] Debounced duplicate for"
-                         << key->name();
-                key->setValue(currentValue);
-                continue;
-            }
-            m_lastAlertedValue.insert(key->name(), currentValue);
-
+            DetectedChange change{key, prevValue, currentValue};
             if (key->isCritical()) {
-                // Critical: allow user 10s to acknowledge before alert
-                key->setRollbackCancelled(false);
-                key->setNewValue(currentValue);
-                m_rollback.rollbackIfNeeded(key);
-
-                QString pendingMsg =
-                    "[CRITICAL ALERT] Key: " + key->name() +
-                    " changed to " + currentValue;
-
-                // Delay alert by 10 seconds
-                QTimer::singleShot(10000, this, [this, key, pendingMsg]() {
-                    if (!key->isRollbackCancelled()) {
-                        if (m_settings->getNotificationFrequency().compare(
-                                "Never", Qt::CaseInsensitive) == 0) {
-                            qDebug() << "[ALERT] Alerts are disabled (Never).";
-                        } else {
-                            bool sent = m_alert.sendAlert(pendingMsg);
-                            qDebug() << (sent
-                                             ? "[INFO] Delayed critical alert sent for" + key->name()
-                                             : "[INFO] Delayed alert skipped for" + key->name());
-                        }
-                    } else {
-                        qDebug() << "[INFO] Change acknowledged before delay for"
-                                 << key->name();
-                    }
-                });
+                criticalChanges.append(change);
             } else {
-                // Non-critical: count and threshold logic
-                key->incrementChangeCount();
-                int threshold = m_settings->getNonCriticalAlertThreshold().toInt();
-                int count     = key->changeCount();
-                int remaining = (threshold > 0) ? (threshold - count) : 0;
-
-                qDebug() << "[INFO] Key:" << key->name()
-                         << "count:" << count
-                         << "threshold:" << threshold;
-
-                if (threshold > 0 && count >= threshold) {
-                    qDebug() << "[INFO] Threshold reached for" << key->name();
-                    QString msg = "[ALERT] Non-critical threshold reached for " +
-                                  key->name() + ": " + currentValue;
-                    key->resetChangeCount();
-                    qDebug() << "[DEBUG] Reset count for" << key->name();
-
-                    if (m_settings->getNotificationFrequency().compare(
-                            "Never", Qt::CaseInsensitive) != 0) {
-                        bool sent = m_alert.sendAlert(msg);
-                        qDebug() << (sent
-                                         ? "[INFO] Non-critical alert sent for" + key->name()
-                                         : "[INFO] Non-critical alert skipped for" + key->name());
-                    } else {
-                        qDebug() << "[INFO] Alerts disabled (Never) for" << key->name();
-                    }
+                otherChanges.append(change);
+            }
+        }
+    }
+
+    for (const DetectedChange &change : criticalChanges) {
+        handleChange(change);
+    }
+    m_dispatcher.serviceRollbacks();
+
+    for (const DetectedChange &change : otherChanges) {
+        handleChange(change);
+    }
+
+    m_dispatcher.commitTick();
+    m_watchdog.endCycle();
+
+    // Time-to-first-check: the first cycle that covered every key
+    if (baselinesReady()) {
+        StartupOrchestrator::milestone("firstCheck");
+    }
+}
+
+/**
+ * @brief Apply the change policy to one detected change.
+ *
+ * - Log the change in the Changes table.
+ * - Debounce duplicate alerts by tracking m_lastAlertedValue.
+ * - If critical: rollback and schedule a delayed alert after 10 seconds.
+ * - If non-critical: track change count, alert when threshold met.
+ * - Update ConfigurationSettings and in-memory value.
+ *
+ * @param change The key and its previous/current values.
+ */
+void WindowsMonitoring::handleChange(const DetectedChange &change) {
+    MON_SPAN(LogCategory::Monitoring, "handleChange");
+    RegistryKey *key           = change.key;
+    const QString prevValue    = change.prevValue;
+    const QString currentValue = change.currentValue;
+    const QString keyName      = key->name();
+    const QString keyPath      = key->keyPath();
+    const bool    critical     = key->isCritical();
+    const ChangeLane persistLane = critical ? ChangeLane::CriticalPersist
+                                            : ChangeLane::Persist;
+
+    // Log the change
+    m_dispatcher.stage(persistLane, changeLogWrite(keyName, prevValue, currentValue, critical));
+    emit changeRecorded(keyName, Clock::instance()->now());
+
+    // Debounce duplicate alerts
+    if (m_lastAlertedValue.value(keyName) == currentValue) {
+        MON_DEBUG(LogCategory::Monitoring) << "[DEBUG] Debounced duplicate for" << keyName;
+        key->setValue(currentValue);
+        return;
+    }
+    m_lastAlertedValue.insert(keyName, currentValue);
+
+    if (critical) {
+        // Critical: rollback runs on this thread ahead of all other work,
+        // then the user has 10s to acknowledge before the alert goes out.
+        key->setRollbackCancelled(false);
+        key->setNewValue(currentValue);
+
+        QString pendingMsg =
+            "[CRITICAL ALERT] Key: " + keyName +
+            " changed to " + currentValue;
+
+        m_dispatcher.post(ChangeLane::Rollback, [=]() {
+            m_rollback.rollbackIfNeeded(key);
+            m_dispatcher.stage(ChangeLane::CriticalPersist, [=](Database &db) {
+                return db.insertOrUpdateConfiguration(keyName, keyPath, currentValue, true);
+            });
+            key->setValue(currentValue);
+        });
+
+        // Delay alert by 10 seconds
+        Clock::instance()->singleShot(10000, this, [this, key, keyName, pendingMsg]() {
+            if (!key->isRollbackCancelled()) {
+                if (m_settings->getNotificationFrequency().compare(
+                        "Never", Qt::CaseInsensitive) == 0) {
+                    MON_DEBUG(LogCategory::Monitoring) << "[ALERT] Alerts are disabled (Never).";
                 } else {
-                    if (threshold > 0) {
-                        qDebug() << "[INFO]" << remaining
-                                 << "more change(s) needed for" << key->name();
-                    }
-                    // Update DB and memory without alert
-                    m_database.insertOrUpdateConfiguration(
-                        key->name(),
-                        key->keyPath(),
-                        currentValue,
-                        false
-                        );
-                    key->setValue(currentValue);
-                    continue;
+                    m_dispatcher.post(ChangeLane::CriticalAlert, [this, keyName, pendingMsg]() {
+                        bool sent = m_alert.sendAlert(pendingMsg);
+                        MON_DEBUG(LogCategory::Monitoring) << (sent
+                                         ? "[INFO] Delayed critical alert sent for" + keyName
+                                         : "[INFO] Delayed alert skipped for" + keyName);
+                    });
                 }
+            } else {
+                MON_DEBUG(LogCategory::Monitoring) << "[INFO] Change acknowledged before delay for" << keyName;
             }
+        });
+        return;
+    }
 
-            // Persist the final state
-            m_database.insertOrUpdateConfiguration(
-                key->name(),
-                key->keyPath(),
-                currentValue,
-                key->isCritical()
-                );
-            key->setValue(currentValue);
+    // Non-critical: count and threshold logic
+    key->incrementChangeCount();
+    int threshold = m_settings->getNonCriticalAlertThreshold().toInt();
+    int count     = key->changeCount();
+    int remaining = (threshold > 0) ? (threshold - count) : 0;
+
+    MON_DEBUG(LogCategory::Monitoring) << "[INFO] Key:" << keyName
+             << "count:" << count
+             << "threshold:" << threshold;
+
+    if (threshold > 0 && count >= threshold) {
+        MON_DEBUG(LogCategory::Monitoring) << "[INFO] Threshold reached for" << keyName;
+        QString msg = "[ALERT] Non-critical threshold reached for " +
+                      keyName + ": " + currentValue;
+        key->resetChangeCount();
+        MON_DEBUG(LogCategory::Monitoring) << "[DEBUG] Reset count for" << keyName;
+
+        if (m_settings->getNotificationFrequency().compare(
+                "Never", Qt::CaseInsensitive) != 0) {
+            m_dispatcher.post(ChangeLane::Alert, [this, keyName, msg]() {
+                bool sent = m_alert.sendAlert(msg);
+                MON_DEBUG(LogCategory::Monitoring) << (sent
+                                 ? "[INFO] Non-critical alert sent for" + keyName
+                                 : "[INFO] Non-critical alert skipped for" + keyName);
+            });
+        } else {
+            MON_DEBUG(LogCategory::Monitoring) << "[INFO] Alerts disabled (Never) for" << keyName;
         }
+    } else if (threshold > 0) {
+        MON_DEBUG(LogCategory::Monitoring) << "[INFO]" << remaining
+                 << "more change(s) needed for" << keyName;
     }
+
+    // Persist the final state
+    m_dispatcher.stage(ChangeLane::Persist, [=](Database &db) {
+        return db.insertOrUpdateConfiguration(keyName, keyPath, currentValue, false);
+    });
+    key->setValue(currentValue);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -331,33 +517,30 @@ void WindowsMonitoring::checkForChanges() {
  * - Cancels rollback on the RegistryKey instance.
  */
 void WindowsMonitoring::allowChange(const QString &keyName) {
-    qDebug() << "[ALLOW CHANGE] for" << keyName;
+    MON_DEBUG(LogCategory::Monitoring) << "[ALLOW CHANGE] for" << keyName;
     bool alreadyAck = false;
 
     // Acknowledge in Changes table
-    QVariantList changes = m_database.getAllChanges();
-    for (const QVariant &change : changes) {
-        QVariantMap m = change.toMap();
-        if (m["config_name"] == keyName && m["acknowledged"].toBool()) {
+    Database db;
+    const QVector<ChangeRow> changes = db.changeRows();
+    for (const ChangeRow &change : changes) {
+        if (change.configName == keyName && change.acknowledged) {
             alreadyAck = true;
             break;
         }
     }
-    if (!alreadyAck && m_database.updateAcknowledgmentStatus(keyName)) {
-        qDebug() << "[ALLOW CHANGE] Acknowledged in DB for" << keyName;
+    if (!alreadyAck && db.updateAcknowledgmentStatus(keyName)) {
+        MON_DEBUG(LogCategory::Monitoring) << "[ALLOW CHANGE] Acknowledged in DB for" << keyName;
         emit changeAcknowledged(keyName);
     } else {
-        qDebug() << "[ALLOW CHANGE] Nothing to acknowledge for" << keyName;
+        MON_DEBUG(LogCategory::Monitoring) << "[ALLOW CHANGE] Nothing to acknowledge for" << keyName;
     }
 
     // Cancel rollback on the in-memory key
-    for (RegistryKey *key : m_registryKeys) {
-        if (key->name() == keyName) {
-            key->setRollbackCancelled(true);
-            m_rollback.cancelRollback(key);
-            key->setPreviousValue(key->newValue());
-            break;
-        }
+    if (RegistryKey *key = m_registryKeysModel.keyForName(keyName)) {
+        key->setRollbackCancelled(true);
+        m_rollback.cancelRollback(key);
+        key->setPreviousValue(key->newValue());
     }
 }
 
@@ -371,27 +554,29 @@ void WindowsMonitoring::allowChange(const QString &keyName) {
  * @param isCritical True to treat changes as critical (rollback+alert).
  */
 void WindowsMonitoring::setKeyCriticalStatus(const QString &keyName, bool isCritical) {
-    for (int i = 0; i < m_registryKeys.size(); ++i) {
-        RegistryKey *key = m_registryKeys[i];
-        if (key->name() == keyName) {
-            key->setCritical(isCritical);
-            QModelIndex idx = m_registryKeysModel.index(i);
-            emit m_registryKeysModel.dataChanged(
-                idx, idx, { RegistryKeyModel::DisplayTextRole }
-                );
-
-            if (isCritical) {
-                m_rollback.registerKeyForRollback(key);
-            }
-            m_database.insertOrUpdateConfiguration(
-                key->name(),
-                key->keyPath(),
-                key->value(),
-                isCritical
-                );
-            break;
-        }
+    RegistryKey *key = m_registryKeysModel.keyForName(keyName);
+    if (!key) {
+        return;
     }
+
+    // The model forwards isCriticalChanged/displayTextChanged to bound views
+    key->setCritical(isCritical);
+
+    // Still being read; its baseline row will carry the new flag
+    if (!key->baselineReady()) {
+        return;
+    }
+
+    if (isCritical) {
+        m_rollback.registerKeyForRollback(key);
+    }
+    Database db;
+    db.insertOrUpdateConfiguration(
+        key->name(),
+        key->keyPath(),
+        key->value(),
+        isCritical
+        );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -405,3 +590,27 @@ void WindowsMonitoring::setKeyCriticalStatus(const QString &keyName, bool isCrit
 RegistryKeyModel* WindowsMonitoring::registryKeys() {
     return &m_registryKeysModel;
 }
+
+/**
+ * @brief Provide the sorted/filterable view used by the monitored-items list.
+ * @return Pointer to the proxy model.
+ */
+MonitoredItemsProxyModel* WindowsMonitoring::monitoredItems() {
+    return &m_monitoredItems;
+}
+
+/**
+ * @brief Latency and queue depth for each priority lane.
+ * @return Map produced by ChangeDispatcher::laneStats().
+ */
+QVariantMap WindowsMonitoring::laneStats() const {
+    return m_dispatcher.laneStats();
+}
+
+/**
+ * @brief Provide the check-cycle watchdog for diagnostics and UI binding.
+ * @return Pointer to the watchdog.
+ */
+TickWatchdog* WindowsMonitoring::watchdog() {
+    return &m_watchdog;
+}
@@ -8,6 +8,9 @@
 
 #include "WindowsRollback.h"
 #include "Database.h"
+#include "changeDispatcher.h"
+#include "logger.h"
+#include "trace.h"
 #include <QDebug>
 #include <QDateTime>
 
@@ -25,6 +28,14 @@ WindowsRollback::WindowsRollback(QObject *parent)
     // No additional state to initialize
 }
 
+/**
+ * @brief Send the rollback's ConfigurationSettings write to a dispatcher lane.
+ * @param dispatcher Dispatcher to use, or nullptr to write inline.
+ */
+void WindowsRollback::setDispatcher(ChangeDispatcher *dispatcher) {
+    m_dispatcher = dispatcher;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Public API
 ////////////////////////////////////////////////////////////////////////////////
@@ -41,8 +52,9 @@ WindowsRollback::WindowsRollback(QObject *parent)
  * - Emits rollbackPerformed() on success.
  */
 void WindowsRollback::rollbackIfNeeded(RegistryKey* key) {
+    MON_SPAN(LogCategory::Rollback, "rollback.check");
     if (!key) {
-        qWarning() << "[ROLLBACK] Null key pointer provided; skipping.";
+        MON_WARN(LogCategory::Rollback) << "[ROLLBACK] Null key pointer provided; skipping.";
         return;
     }
 
@@ -50,7 +62,7 @@ void WindowsRollback::rollbackIfNeeded(RegistryKey* key) {
     QString current   = key->getCurrentValue();
 
     if (key->isCritical() && current != prevValue) {
-        qDebug() << "[ROLLBACK] Unauthorized change detected for key:" << key->name();
+        MON_DEBUG(LogCategory::Rollback) << "[ROLLBACK] Unauthorized change detected for key:" << key->name();
 
         // Cache the unauthorized value so it can be reapplied if cancelled
         key->setNewValue(current);
@@ -59,18 +71,23 @@ void WindowsRollback::rollbackIfNeeded(RegistryKey* key) {
         restorePreviousValue(key);
 
         // Persist the restored value in the database
-        Database db;
-        db.insertOrUpdateConfiguration(
-            key->name(),
-            key->keyPath(),
-            prevValue,
-            true
-            );
+        const QString configName = key->name();
+        const QString configPath = key->keyPath();
+        auto persist = [configName, configPath, prevValue](Database &db) {
+            return db.insertOrUpdateConfiguration(configName, configPath, prevValue, true);
+        };
+        if (m_dispatcher) {
+            // Joins the current check cycle's transaction
+            m_dispatcher->stage(ChangeLane::CriticalPersist, persist);
+        } else {
+            Database db;
+            persist(db);
+        }
 
         // Notify listeners that rollback occurred
         emit rollbackPerformed(key->name());
     } else {
-        qDebug() << "[ROLLBACK] No rollback needed for key:" << key->name();
+        MON_DEBUG(LogCategory::Rollback) << "[ROLLBACK] No rollback needed for key:" << key->name();
     }
 }
 
@@ -83,7 +100,7 @@ void WindowsRollback::rollbackIfNeeded(RegistryKey* key) {
  */
 void WindowsRollback::registerKeyForRollback(RegistryKey* key) {
     if (key && key->isCritical()) {
-        qDebug() << "[ROLLBACK] Key registered for rollback protection:" << key->name();
+        MON_DEBUG(LogCategory::Rollback) << "[ROLLBACK] Key registered for rollback protection:" << key->name();
     }
 }
 
@@ -100,8 +117,9 @@ void WindowsRollback::registerKeyForRollback(RegistryKey* key) {
  * - Syncs and confirms that the on-disk value matches newValue().
  */
 void WindowsRollback::cancelRollback(RegistryKey* key) {
+    MON_SPAN(LogCategory::Rollback, "rollback.cancel");
     if (!key) {
-        qWarning() << "[CANCEL ROLLBACK] Null key pointer provided; skipping.";
+        MON_WARN(LogCategory::Rollback) << "[CANCEL ROLLBACK] Null key pointer provided; skipping.";
         return;
     }
 
@@ -111,18 +129,17 @@ void WindowsRollback::cancelRollback(RegistryKey* key) {
     if (!newVal.isEmpty()) {
         // Reapply the stored new value
         key->setValue(newVal);
-        key->settings()->sync();
 
         QString confirmed = key->getCurrentValue();
         if (confirmed == newVal) {
-            qDebug() << "[CANCEL ROLLBACK] Successfully reapplied new value for key:"
+            MON_DEBUG(LogCategory::Rollback) << "[CANCEL ROLLBACK] Successfully reapplied new value for key:"
                      << key->name() << "→" << confirmed;
         } else {
-            qWarning() << "[CANCEL ROLLBACK] Reapply failed for key:" << key->name()
+            MON_WARN(LogCategory::Rollback) << "[CANCEL ROLLBACK] Reapply failed for key:" << key->name()
             << "Expected:" << newVal << "Found:" << confirmed;
         }
     } else {
-        qDebug() << "[CANCEL ROLLBACK] No stored newValue for key:" << key->name()
+        MON_DEBUG(LogCategory::Rollback) << "[CANCEL ROLLBACK] No stored newValue for key:" << key->name()
         << "; nothing to reapply.";
     }
 }
@@ -131,13 +148,14 @@ void WindowsRollback::cancelRollback(RegistryKey* key) {
  * @brief Restore the registry key’s on-disk value to its previousValue().
  * @param key Pointer to the RegistryKey to restore.
  *
- * - Writes previousValue() via QSettings.
+ * - Writes previousValue() via RegistryKey::writeStoredValue().
  * - Calls sync() to commit the change.
  * - Reads back and logs whether the restoration succeeded.
  */
 void WindowsRollback::restorePreviousValue(RegistryKey* key) {
+    MON_SPAN(LogCategory::Rollback, "rollback.restore");
     if (!key) {
-        qWarning() << "[RESTORE] Null key pointer provided; skipping.";
+        MON_WARN(LogCategory::Rollback) << "[RESTORE] Null key pointer provided; skipping.";
         return;
     }
 
@@ -145,22 +163,21 @@ void WindowsRollback::restorePreviousValue(RegistryKey* key) {
     QString current   = key->getCurrentValue();
 
     if (current == prevValue) {
-        qDebug() << "[RESTORE] No action needed; key already at previous value:"
+        MON_DEBUG(LogCategory::Rollback) << "[RESTORE] No action needed; key already at previous value:"
                  << key->name() << "→" << prevValue;
         return;
     }
 
     // Write the baseline value back to the registry
-    key->settings()->setValue(key->valueName(), prevValue);
-    key->settings()->sync();
+    key->writeStoredValue(prevValue);
 
     // Confirm the write
     QString confirmed = key->getCurrentValue();
     if (confirmed == prevValue) {
-        qDebug() << "[ROLLBACK] Successfully restored key:" << key->name()
+        MON_DEBUG(LogCategory::Rollback) << "[ROLLBACK] Successfully restored key:" << key->name()
         << "to previous value:" << confirmed;
     } else {
-        qWarning() << "[ROLLBACK] Failed to restore key:" << key->name()
+        MON_WARN(LogCategory::Rollback) << "[ROLLBACK] Failed to restore key:" << key->name()
         << "Expected:" << prevValue << "Found:" << confirmed;
     }
 }
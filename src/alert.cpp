@@ -5,7 +5,7 @@
 #include <QDir>
 #include <QCoreApplication>
 #include <QDateTime>
-#include <iostream>
+#include <QMutexLocker>
 
 #include <aws/core/auth/AWSCredentialsProvider.h>
 #include <aws/core/Aws.h>
@@ -17,63 +17,84 @@
 
 #include "Database.h"
 #include "settings.h"
+#include "logger.h"
+#include "trace.h"
+#include "clock.h"
+#include "startupOrchestrator.h"
 
 /**
  * @brief Construct an Alert instance.
  *
- * Initializes AWS SNS and SESv2 clients using credentials loaded from JSON,
- * then reads any existing user settings from the database to populate
- * the Settings object (email/phone).
+ * AWS clients are created by the first alert rather than here, so neither
+ * credential loading nor client setup sits on the startup path. Contacts
+ * are loaded into Settings by the monitor.
  */
 Alert::Alert(Settings *settings, QObject *parent)
     : QObject(parent)
     , m_settings(settings)
 {
-    Aws::Auth::AWSCredentials credentials;
-    Aws::Client::ClientConfiguration config;
-
-    // Determine config file path based on platform and load credentials.
-    QString credentialsPath = resolveAwsConfigPath();
-    if (!loadAwsCredentials(credentialsPath, credentials, config)) {
-        qWarning("Failed to initialize AWS clients with credentials from JSON");
-        return;
+    // sendAlert() runs on lane workers; they read this snapshot instead of
+    // the GUI-thread Settings object
+    if (m_settings) {
+        updateAlertsPerHour();
+        connect(m_settings, &Settings::notificationFrequencyChanged, this, &Alert::updateAlertsPerHour);
     }
+}
+
+/**
+ * @brief Snapshot Settings.notificationFrequency (alerts per hour) on the GUI thread.
+ */
+void Alert::updateAlertsPerHour()
+{
+    m_alertsPerHour.store(m_settings->getNotificationFrequency().toInt(), std::memory_order_relaxed);
+}
 
-    // Instantiate AWS SNS (SMS) and SESv2 (email) clients.
-    m_snsClient   = std::make_unique<Aws::SNS::SNSClient>(credentials, config);
-    m_sesv2Client = std::make_unique<Aws::SESV2::SESV2Client>(credentials, config);
-
-    // Create and query the Database for any saved user contact settings.
-    m_database = new Database(this);
-    QVariantList userSettings = m_database->getAllUserSettings();
-    if (!userSettings.isEmpty()) {
-        QStringList emails, phones;
-        for (const QVariant &v : userSettings) {
-            QVariantMap user = v.toMap();
-            QString e = user["email"].toString();
-            QString p = user["phone"].toString();
-            if (!e.isEmpty()) emails << e;
-            if (!p.isEmpty()) phones << p;
+/**
+ * @brief Create the SNS and SESv2 clients on first use.
+ *
+ * Runs once; concurrent callers (both lane workers) wait for it. A failed
+ * attempt is not retried, as the constructor used to behave.
+ *
+ * @return True if at least one client is available.
+ */
+bool Alert::ensureClients()
+{
+    std::call_once(m_clientsOnce, [this]() {
+        // Clients need the SDK, which main() initialises in the background
+        StartupOrchestrator::await("aws");
+
+        Aws::Auth::AWSCredentials credentials;
+        Aws::Client::ClientConfiguration config;
+
+        // Determine config file path based on platform and load credentials.
+        QString credentialsPath = resolveAwsConfigPath();
+        if (!loadAwsCredentials(credentialsPath, credentials, config)) {
+            MON_WARN(LogCategory::Alert) << "[ALERT] Failed to initialize AWS clients with credentials from JSON";
+            return;
         }
-        // Update the Settings object with comma-separated contacts.
-        if (!emails.isEmpty())
-            m_settings->setEmail(emails.join(", "));
-        if (!phones.isEmpty())
-            m_settings->setPhoneNumber(phones.join(", "));
-    }
 
-    qDebug() << "[ALERT INIT] Email:" << m_settings->getEmail()
-             << "Phone number:" << m_settings->getPhoneNumber();
+        // Instantiate AWS SNS (SMS) and SESv2 (email) clients.
+        m_snsClient   = std::make_unique<Aws::SNS::SNSClient>(credentials, config);
+        m_sesv2Client = std::make_unique<Aws::SESV2::SESV2Client>(credentials, config);
+        MON_DEBUG(LogCategory::Alert) << "[ALERT INIT] AWS clients created.";
+    });
+    return m_snsClient || m_sesv2Client;
 }
 
 /**
  * @brief Resolve the path to the AWS credentials JSON file.
  *
  * Uses a relative path under the application bundle/resources
- * folder, with a different prefix on macOS vs. other platforms.
+ * folder, with a different prefix on macOS vs. other platforms, unless
+ * MONITOR_AWS_CONFIG names a file.
  */
 QString Alert::resolveAwsConfigPath()
 {
+    // Bench and soak runs point at their own config (e.g. a stub endpoint)
+    const QString overridePath = qEnvironmentVariable("MONITOR_AWS_CONFIG");
+    if (!overridePath.isEmpty()) {
+        return overridePath;
+    }
 #ifdef Q_OS_MAC
     return QDir::cleanPath(
         QCoreApplication::applicationDirPath() +
@@ -97,92 +118,101 @@ QString Alert::resolveAwsConfigPath()
  */
 bool Alert::sendAlert(const QString &message)
 {
+    MON_SPAN(LogCategory::Alert, "alert.send");
     // Ensure AWS clients were initialized.
-    if (!m_snsClient && !m_sesv2Client) {
-        qDebug() << "[ALERT] AWS clients not initialized. Skipping alert.";
+    if (!ensureClients()) {
+        MON_DEBUG(LogCategory::Alert) << "[ALERT] AWS clients not initialized. Skipping alert.";
         return false;
     }
 
-    qDebug() << "[ALERT] sendAlert called with message:" << message;
+    MON_DEBUG(LogCategory::Alert) << "[ALERT] sendAlert called with message:" << message;
 
-    // Reload user settings (email/phone) from the database.
-    if (!m_database) {
-        qWarning() << "[ALERT] Database not initialized.";
-        return false;
-    }
-    QVariantList userSettings = m_database->getAllUserSettings();
+    // Reload user settings (email/phone) from the database. Alerts are
+    // dispatched from lane workers, so use this thread's own connection.
+    Database db;
+    const QVector<UserRow> userSettings = db.userSettingsRows();
     if (userSettings.isEmpty()) {
-        qWarning() << "[ALERT] No user settings found. Skipping alerts.";
+        MON_WARN(LogCategory::Alert) << "[ALERT] No user settings found. Skipping alerts.";
         return false;
     }
 
     // Ensure at least one contact (email or phone) exists.
     bool validContactFound = false;
-    for (const QVariant &v : userSettings) {
-        QVariantMap user = v.toMap();
-        if (!user["email"].toString().isEmpty() ||
-            !user["phone"].toString().isEmpty()) {
+    for (const UserRow &user : userSettings) {
+        if (!user.email.isEmpty() || !user.phone.isEmpty()) {
             validContactFound = true;
             break;
         }
     }
     if (!validContactFound) {
-        qWarning() << "[ALERT] No valid email or phone. Skipping alerts.";
+        MON_WARN(LogCategory::Alert) << "[ALERT] No valid email or phone. Skipping alerts.";
         return false;
     }
 
     // Parse rate-limit frequency (alerts per hour) from settings.
-    int freq = m_settings->getNotificationFrequency().toInt();
+    int freq = m_alertsPerHour.load(std::memory_order_relaxed);
     if (freq <= 0) freq = 10;
 
-    // Prune timestamps older than one hour to maintain sliding window.
-    QDateTime oneHourAgo = QDateTime::currentDateTime().addSecs(-3600);
-    m_alertTimestamps.erase(
-        std::remove_if(
-            m_alertTimestamps.begin(),
-            m_alertTimestamps.end(),
-            [oneHourAgo](const QDateTime &ts) { return ts < oneHourAgo; }
-            ),
-        m_alertTimestamps.end()
-        );
+    // The critical and bulk lane workers may both be inside sendAlert. A slot
+    // in the sliding window is reserved under the lock, but delivery happens
+    // outside it so a slow non-critical send never blocks a critical one.
+    const QDateTime reservedAt = Clock::instance()->now();
+    {
+        QMutexLocker rateLocker(&m_rateMutex);
+
+        // Prune timestamps older than one hour to maintain sliding window.
+        QDateTime oneHourAgo = reservedAt.addSecs(-3600);
+        m_alertTimestamps.erase(
+            std::remove_if(
+                m_alertTimestamps.begin(),
+                m_alertTimestamps.end(),
+                [oneHourAgo](const QDateTime &ts) { return ts < oneHourAgo; }
+                ),
+            m_alertTimestamps.end()
+            );
+
+        MON_DEBUG(LogCategory::Alert) << "[ALERT] Alerts sent in last hour:" << m_alertTimestamps.size()
+                 << " / allowed:" << freq;
+
+        if (static_cast<int>(m_alertTimestamps.size()) >= freq) {
+            MON_DEBUG(LogCategory::Alert) << "[ALERT] Rate limit reached; skipping alert.";
+            return false;
+        }
+        m_alertTimestamps.push_back(reservedAt);
+    }
 
-    qDebug() << "[ALERT] Alerts sent in last hour:" << m_alertTimestamps.size()
-             << " / allowed:" << freq;
-
-    // If under limit, send to each contact.
-    if (static_cast<int>(m_alertTimestamps.size()) < freq) {
-        bool anySent = false;
-        for (const QVariant &v : userSettings) {
-            QVariantMap user = v.toMap();
-            QString email = user["email"].toString();
-            QString phone = user["phone"].toString();
-
-            // Send email if configured.
-            if (!email.isEmpty()) {
-                qDebug() << "[ALERT] Sending email to:" << email;
-                if (sendEmailAlert(email, message)) anySent = true;
-                else qDebug() << "[ALERT] Email failed for:" << email;
-            }
-
-            // Send SMS if configured.
-            if (!phone.isEmpty()) {
-                qDebug() << "[ALERT] Sending SMS to:" << phone;
-                if (sendSmsAlert(phone, message)) anySent = true;
-                else qDebug() << "[ALERT] SMS failed for:" << phone;
-            }
+    // Under limit: send to each contact.
+    bool anySent = false;
+    for (const UserRow &user : userSettings) {
+        const QString &email = user.email;
+        const QString &phone = user.phone;
+
+        // Send email if configured.
+        if (!email.isEmpty()) {
+            MON_DEBUG(LogCategory::Alert) << "[ALERT] Sending email to:" << email;
+            if (sendEmailAlert(email, message)) anySent = true;
+            else MON_DEBUG(LogCategory::Alert) << "[ALERT] Email failed for:" << email;
         }
 
-        if (anySent) {
-            // Record timestamp only if at least one delivery succeeded.
-            m_alertTimestamps.push_back(QDateTime::currentDateTime());
-            return true;
+        // Send SMS if configured.
+        if (!phone.isEmpty()) {
+            MON_DEBUG(LogCategory::Alert) << "[ALERT] Sending SMS to:" << phone;
+            if (sendSmsAlert(phone, message)) anySent = true;
+            else MON_DEBUG(LogCategory::Alert) << "[ALERT] SMS failed for:" << phone;
         }
+    }
 
-        qDebug() << "[ALERT] No alerts sent (delivery failures).";
-        return false;
+    if (anySent) {
+        // Keep the reservation only if at least one delivery succeeded.
+        return true;
     }
 
-    qDebug() << "[ALERT] Rate limit reached; skipping alert.";
+    QMutexLocker rateLocker(&m_rateMutex);
+    auto it = std::find(m_alertTimestamps.begin(), m_alertTimestamps.end(), reservedAt);
+    if (it != m_alertTimestamps.end()) {
+        m_alertTimestamps.erase(it);
+    }
+    MON_DEBUG(LogCategory::Alert) << "[ALERT] No alerts sent (delivery failures).";
     return false;
 }
 
@@ -194,8 +224,9 @@ bool Alert::sendAlert(const QString &message)
  */
 bool Alert::sendSmsAlert(const QString &phoneNumber, const QString &message)
 {
+    MON_SPAN(LogCategory::Alert, "alert.sns");
     if (!m_snsClient) {
-        qWarning() << "[SMS ALERT] SNS client not initialized; skipping.";
+        MON_WARN(LogCategory::Alert) << "[SMS ALERT] SNS client not initialized; skipping.";
         return false;
     }
 
@@ -205,16 +236,12 @@ bool Alert::sendSmsAlert(const QString &phoneNumber, const QString &message)
 
     auto outcome = m_snsClient->Publish(req);
     if (!outcome.IsSuccess()) {
-        std::cerr << "[SMS ALERT] Failed to send SMS to "
-                  << phoneNumber.toStdString()
-                  << ". Error: "
-                  << outcome.GetError().GetMessage()
-                  << std::endl;
+        MON_WARN(LogCategory::Alert) << "[SMS ALERT] Failed to send SMS to" << phoneNumber
+                                     << "Error:" << QString::fromStdString(outcome.GetError().GetMessage());
         return false;
     }
 
-    std::cout << "[SMS ALERT] SMS sent to "
-              << phoneNumber.toStdString() << std::endl;
+    MON_INFO(LogCategory::Alert) << "[SMS ALERT] SMS sent to" << phoneNumber;
     return true;
 }
 
@@ -226,8 +253,9 @@ bool Alert::sendSmsAlert(const QString &phoneNumber, const QString &message)
  */
 bool Alert::sendEmailAlert(const QString &email, const QString &message)
 {
+    MON_SPAN(LogCategory::Alert, "alert.ses");
     if (!m_sesv2Client) {
-        qWarning() << "[EMAIL ALERT] SES client not initialized; skipping.";
+        MON_WARN(LogCategory::Alert) << "[EMAIL ALERT] SES client not initialized; skipping.";
         return false;
     }
 
@@ -254,24 +282,21 @@ bool Alert::sendEmailAlert(const QString &email, const QString &message)
 
     auto outcome = m_sesv2Client->SendEmail(req);
     if (!outcome.IsSuccess()) {
-        std::cerr << "[EMAIL ALERT] Failed to send email to "
-                  << email.toStdString()
-                  << ". Error: "
-                  << outcome.GetError().GetMessage()
-                  << std::endl;
+        MON_WARN(LogCategory::Alert) << "[EMAIL ALERT] Failed to send email to" << email
+                                     << "Error:" << QString::fromStdString(outcome.GetError().GetMessage());
         return false;
     }
 
-    std::cout << "[EMAIL ALERT] Email sent to "
-              << email.toStdString() << std::endl;
+    MON_INFO(LogCategory::Alert) << "[EMAIL ALERT] Email sent to" << email;
     return true;
 }
 
 /**
  * @brief Load AWS credentials and region from a JSON config file.
- * @param filePath Path to JSON file containing keys: accessKeyId, secretAccessKey, region.
+ * @param filePath Path to JSON file containing keys: accessKeyId, secretAccessKey,
+ *                 region and optionally endpoint.
  * @param creds    Output AWSCredentials object.
- * @param cfg      Output ClientConfiguration (region is set).
+ * @param cfg      Output ClientConfiguration (region and endpoint override are set).
  * @return True on successful parse and assignment, false otherwise.
  */
 bool loadAwsCredentials(const QString &filePath,
@@ -280,7 +305,7 @@ bool loadAwsCredentials(const QString &filePath,
 {
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning("Failed to open AWS config file");
+        MON_WARN(LogCategory::Alert) << "[ALERT] Failed to open AWS config file";
         return false;
     }
     QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
@@ -294,7 +319,7 @@ bool loadAwsCredentials(const QString &filePath,
     if (accessKeyId.isEmpty() ||
         secretAccessKey.isEmpty() ||
         region.isEmpty()) {
-        qWarning("AWS config file is missing required fields");
+        MON_WARN(LogCategory::Alert) << "[ALERT] AWS config file is missing required fields";
         return false;
     }
 
@@ -303,5 +328,14 @@ bool loadAwsCredentials(const QString &filePath,
         secretAccessKey.toStdString()
         );
     cfg.region = region.toStdString();
+
+    // Optional, e.g. "http://127.0.0.1:4566" for a local stand-in service
+    const QString endpoint = obj["endpoint"].toString();
+    if (!endpoint.isEmpty()) {
+        cfg.endpointOverride = endpoint.toStdString();
+        if (endpoint.startsWith("http://")) {
+            cfg.scheme = Aws::Http::Scheme::HTTP;
+        }
+    }
     return true;
 }
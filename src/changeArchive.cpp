@@ -0,0 +1,693 @@
+#include "changeArchive.h"
+#include "logger.h"
+#include <QDir>
+#include <QHash>
+#include <QPair>
+#include <QSaveFile>
+#include <QWriteLocker>
+#include <QReadLocker>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+/**
+ * @file changeArchive.cpp
+ * @brief Implements the columnar segment format and the segment directory.
+ */
+
+namespace {
+
+const char    kMagic[4]      = {'M', 'C', 'A', '1'};
+const quint32 kVersion       = 1;
+const int     kColumnCount   = 5;
+// magic, version, rowCount, criticalCount, acknowledgedCount, reserved,
+// minTs, maxTs, dictionary offset/length, column offsets/lengths, file size
+const int     kHeaderSize    = 4 + 4 * 5 + 8 * 2 + 8 * 2 + 8 * 2 * kColumnCount + 8;
+const int     kCompressLevel = 6;
+
+const quint8  kFlagAcknowledged = 0x01;
+const quint8  kFlagCritical     = 0x02;
+
+std::atomic<ChangeArchive *> s_instance{nullptr};
+
+////////////////////////////////////////////////////////////////////////////////
+// Encoding helpers
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+void putFixed(QByteArray &out, T value) {
+    const T le = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char *>(&le), sizeof(T));
+}
+
+template <typename T>
+T getFixed(const uchar *p) {
+    return qFromLittleEndian<T>(p);
+}
+
+void putVarint(QByteArray &out, quint64 value) {
+    while (value >= 0x80) {
+        out.append(char(value | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+bool getVarint(const char *&p, const char *end, quint64 &value) {
+    value = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        const quint8 byte = quint8(*p++);
+        value |= quint64(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+quint64 zigzag(qint64 n) {
+    return (quint64(n) << 1) ^ quint64(n >> 63);
+}
+
+qint64 unzigzag(quint64 n) {
+    return qint64(n >> 1) ^ -qint64(n & 1);
+}
+
+/// Delta + zig-zag varint encoding of a sorted-ish integer column.
+QByteArray encodeDeltas(const QVector<qint64> &values) {
+    QByteArray out;
+    out.reserve(values.size() * 2);
+    qint64 previous = 0;
+    for (qint64 v : values) {
+        putVarint(out, zigzag(v - previous));
+        previous = v;
+    }
+    return out;
+}
+
+bool decodeDeltas(const QByteArray &bytes, int count, QVector<qint64> &values) {
+    values.resize(count);
+    const char *p = bytes.constData();
+    const char *end = p + bytes.size();
+    qint64 previous = 0;
+    for (int i = 0; i < count; ++i) {
+        quint64 raw = 0;
+        if (!getVarint(p, end, raw)) {
+            return false;
+        }
+        previous += unzigzag(raw);
+        values[i] = previous;
+    }
+    return true;
+}
+
+/// Old/new ciphertexts of one value block, in row order.
+using ValuePair = QPair<QByteArray, QByteArray>;
+
+bool decodeValueBlock(const QByteArray &block, int count, QVector<ValuePair> &values) {
+    values.resize(count);
+    const char *p = block.constData();
+    const char *end = p + block.size();
+    for (int i = 0; i < count; ++i) {
+        for (QByteArray *field : {&values[i].first, &values[i].second}) {
+            quint64 length = 0;
+            if (!getVarint(p, end, length) || quint64(end - p) < length) {
+                return false;
+            }
+            *field = QByteArray(p, int(length));
+            p += length;
+        }
+    }
+    return true;
+}
+
+/// Parse "yyyy-MM-dd HH:mm:ss" (or ISO) into ms since epoch.
+qint64 parseBound(const QString &text, qint64 fallback) {
+    if (text.isEmpty()) {
+        return fallback;
+    }
+    QDateTime dt = QDateTime::fromString(text, "yyyy-MM-dd HH:mm:ss");
+    if (!dt.isValid()) {
+        dt = QDateTime::fromString(text, Qt::ISODate);
+    }
+    return dt.isValid() ? dt.toMSecsSinceEpoch() : fallback;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// ArchiveSegment: writing
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Encode @p rows column by column and write them atomically.
+ *
+ * QSaveFile writes to a temporary file and renames it on commit, so a
+ * crash never leaves a half-written segment under @p filePath.
+ */
+bool ArchiveSegment::write(const QString &filePath, const QVector<ChangeRow> &rows) {
+    if (rows.isEmpty()) {
+        return false;
+    }
+
+    QVector<const ChangeRow *> sorted;
+    sorted.reserve(rows.size());
+    for (const ChangeRow &row : rows) {
+        sorted.append(&row);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const ChangeRow *a, const ChangeRow *b) {
+        return a->timestamp < b->timestamp;
+    });
+
+    QVector<qint64> ids, timestamps;
+    ids.reserve(sorted.size());
+    timestamps.reserve(sorted.size());
+    QStringList dictionary;
+    QHash<QString, int> dictionaryIndex;
+    QByteArray configs, flags;
+    flags.reserve(sorted.size());
+    quint32 criticalCount = 0, acknowledgedCount = 0;
+
+    for (const ChangeRow *row : sorted) {
+        ids.append(row->id);
+        timestamps.append(row->timestamp.toMSecsSinceEpoch());
+
+        auto it = dictionaryIndex.find(row->configName);
+        if (it == dictionaryIndex.end()) {
+            it = dictionaryIndex.insert(row->configName, dictionary.size());
+            dictionary.append(row->configName);
+        }
+        putVarint(configs, quint64(it.value()));
+
+        quint8 f = 0;
+        if (row->acknowledged) { f |= kFlagAcknowledged; ++acknowledgedCount; }
+        if (row->critical)     { f |= kFlagCritical;     ++criticalCount; }
+        flags.append(char(f));
+    }
+
+    // Values: directory of compressed blocks, then the blocks themselves
+    const int blockCount = (sorted.size() + kValueBlockRows - 1) / kValueBlockRows;
+    QVector<QByteArray> blocks;
+    blocks.reserve(blockCount);
+    for (int b = 0; b < blockCount; ++b) {
+        QByteArray raw;
+        const int last = std::min(int(sorted.size()), (b + 1) * kValueBlockRows);
+        for (int i = b * kValueBlockRows; i < last; ++i) {
+            putVarint(raw, quint64(sorted[i]->oldCipher.size()));
+            raw.append(sorted[i]->oldCipher);
+            putVarint(raw, quint64(sorted[i]->newCipher.size()));
+            raw.append(sorted[i]->newCipher);
+        }
+        blocks.append(qCompress(raw, kCompressLevel));
+    }
+    QByteArray values;
+    putFixed<quint32>(values, quint32(blockCount));
+    quint64 blockOffset = 4 + quint64(blockCount) * 12;
+    for (const QByteArray &block : blocks) {
+        putFixed<quint64>(values, blockOffset);
+        putFixed<quint32>(values, quint32(block.size()));
+        blockOffset += block.size();
+    }
+    for (const QByteArray &block : blocks) {
+        values.append(block);
+    }
+
+    QByteArray dict;
+    putFixed<quint32>(dict, quint32(dictionary.size()));
+    for (const QString &name : dictionary) {
+        const QByteArray utf8 = name.toUtf8();
+        putFixed<quint32>(dict, quint32(utf8.size()));
+        dict.append(utf8);
+    }
+
+    const QByteArray columns[kColumnCount] = {
+        qCompress(encodeDeltas(ids), kCompressLevel),
+        qCompress(encodeDeltas(timestamps), kCompressLevel),
+        qCompress(configs, kCompressLevel),
+        qCompress(flags, kCompressLevel),
+        values
+    };
+
+    quint64 offset = kHeaderSize;
+    QByteArray header;
+    header.append(kMagic, 4);
+    putFixed<quint32>(header, kVersion);
+    putFixed<quint32>(header, quint32(sorted.size()));
+    putFixed<quint32>(header, criticalCount);
+    putFixed<quint32>(header, acknowledgedCount);
+    putFixed<quint32>(header, 0);
+    putFixed<qint64>(header, timestamps.first());
+    putFixed<qint64>(header, timestamps.last());
+    putFixed<quint64>(header, offset);
+    putFixed<quint64>(header, quint64(dict.size()));
+    offset += dict.size();
+    for (const QByteArray &c : columns) {
+        putFixed<quint64>(header, offset);
+        putFixed<quint64>(header, quint64(c.size()));
+        offset += c.size();
+    }
+    putFixed<quint64>(header, offset);
+    Q_ASSERT(header.size() == kHeaderSize);
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        MON_WARN(LogCategory::Database) << "[ARCHIVE] Cannot write segment" << filePath << ":" << file.errorString();
+        return false;
+    }
+    file.write(header);
+    file.write(dict);
+    for (const QByteArray &c : columns) {
+        file.write(c);
+    }
+    if (!file.commit()) {
+        MON_WARN(LogCategory::Database) << "[ARCHIVE] Failed to commit segment" << filePath << ":" << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ArchiveSegment: reading
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Map a segment and check its header against the file size.
+ */
+std::shared_ptr<ArchiveSegment> ArchiveSegment::open(const QString &filePath) {
+    std::shared_ptr<ArchiveSegment> segment(new ArchiveSegment());
+    segment->m_file.setFileName(filePath);
+    if (!segment->m_file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+    segment->m_size = segment->m_file.size();
+    if (segment->m_size < kHeaderSize) {
+        MON_WARN(LogCategory::Database) << "[ARCHIVE] Truncated segment" << filePath;
+        return nullptr;
+    }
+    segment->m_data = segment->m_file.map(0, segment->m_size);
+    if (!segment->m_data) {
+        MON_WARN(LogCategory::Database) << "[ARCHIVE] Cannot map segment" << filePath;
+        return nullptr;
+    }
+
+    const uchar *p = segment->m_data;
+    if (memcmp(p, kMagic, 4) != 0 || getFixed<quint32>(p + 4) != kVersion) {
+        MON_WARN(LogCategory::Database) << "[ARCHIVE] Unknown segment format" << filePath;
+        return nullptr;
+    }
+    segment->m_rowCount          = int(getFixed<quint32>(p + 8));
+    segment->m_criticalCount     = int(getFixed<quint32>(p + 12));
+    segment->m_acknowledgedCount = int(getFixed<quint32>(p + 16));
+    segment->m_minTs             = getFixed<qint64>(p + 24);
+    segment->m_maxTs             = getFixed<qint64>(p + 32);
+
+    const quint64 dictOffset = getFixed<quint64>(p + 40);
+    const quint64 dictLength = getFixed<quint64>(p + 48);
+    for (int c = 0; c < kColumnCount; ++c) {
+        segment->m_columnOffset[c] = getFixed<quint64>(p + 56 + c * 16);
+        segment->m_columnLength[c] = getFixed<quint64>(p + 64 + c * 16);
+    }
+    const quint64 fileSize = getFixed<quint64>(p + 56 + kColumnCount * 16);
+
+    const quint64 size = quint64(segment->m_size);
+    bool valid = fileSize == size && dictOffset + dictLength <= size && dictLength >= 4;
+    for (int c = 0; valid && c < kColumnCount; ++c) {
+        valid = segment->m_columnOffset[c] + segment->m_columnLength[c] <= size;
+    }
+    if (!valid) {
+        MON_WARN(LogCategory::Database) << "[ARCHIVE] Corrupt segment header" << filePath;
+        return nullptr;
+    }
+
+    const uchar *dict = p + dictOffset;
+    const uchar *dictEnd = dict + dictLength;
+    const quint32 entries = getFixed<quint32>(dict);
+    dict += 4;
+    for (quint32 i = 0; i < entries; ++i) {
+        if (dictEnd - dict < 4) {
+            return nullptr;
+        }
+        const quint32 length = getFixed<quint32>(dict);
+        dict += 4;
+        if (quint64(dictEnd - dict) < length) {
+            return nullptr;
+        }
+        segment->m_dictionary.append(QString::fromUtf8(reinterpret_cast<const char *>(dict), int(length)));
+        dict += length;
+    }
+    return segment;
+}
+
+/**
+ * @brief Unmap, deleting the file if the segment was dropped.
+ */
+ArchiveSegment::~ArchiveSegment() {
+    if (m_data) {
+        m_file.unmap(const_cast<uchar *>(m_data));
+    }
+    m_file.close();
+    if (m_removeOnClose) {
+        QFile::remove(m_file.fileName());
+    }
+}
+
+QByteArray ArchiveSegment::column(Column c) const {
+    return qUncompress(m_data + m_columnOffset[c], int(m_columnLength[c]));
+}
+
+QVector<qint64> ArchiveSegment::ids() const {
+    QVector<qint64> result;
+    if (!decodeDeltas(column(Ids), m_rowCount, result)) {
+        result.clear();
+    }
+    return result;
+}
+
+/**
+ * @brief Check each row's timestamp against the cutoff of its config and flag.
+ */
+bool ArchiveSegment::allExpired(const CutoffFn &cutoffFor) const {
+    QVector<qint64> timestamps;
+    if (!decodeDeltas(column(Timestamps), m_rowCount, timestamps)) {
+        MON_WARN(LogCategory::Database) << "[ARCHIVE] Bad timestamp column in" << filePath();
+        return false;
+    }
+    const QByteArray flags = column(Flags);
+    const QByteArray configBytes = column(Configs);
+    if (flags.size() < m_rowCount) {
+        MON_WARN(LogCategory::Database) << "[ARCHIVE] Bad flags column in" << filePath();
+        return false;
+    }
+
+    // Cutoff in ms per (config, critical); INT64_MIN keeps rows forever
+    const qint64 kUnset = std::numeric_limits<qint64>::max();
+    QVector<qint64> cutoffs(m_dictionary.size() * 2, kUnset);
+    const char *p = configBytes.constData();
+    const char *end = p + configBytes.size();
+    for (int i = 0; i < m_rowCount; ++i) {
+        quint64 index = 0;
+        if (!getVarint(p, end, index) || index >= quint64(m_dictionary.size())) {
+            MON_WARN(LogCategory::Database) << "[ARCHIVE] Bad config column in" << filePath();
+            return false;
+        }
+        const bool critical = quint8(flags[i]) & kFlagCritical;
+        qint64 &cutoff = cutoffs[int(index) * 2 + (critical ? 1 : 0)];
+        if (cutoff == kUnset) {
+            const QDateTime dt = cutoffFor(m_dictionary.at(int(index)), critical);
+            cutoff = dt.isValid() ? dt.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+        }
+        if (timestamps[i] >= cutoff) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Filter on the small columns, then decode only the needed value blocks.
+ */
+ScanResult ArchiveSegment::scan(qint64 startMs,
+                                qint64 endMs,
+                                const QString &configName,
+                                const QVariant &ackFilter,
+                                const QVariant &criticalFilter,
+                                const std::function<bool(ChangeRow &&)> &visitor) const
+{
+    // Segment-level pushdown
+    if (endMs < m_minTs || startMs > m_maxTs) {
+        return ScanResult::Completed;
+    }
+    int configIndex = -1;
+    if (!configName.isEmpty()) {
+        configIndex = m_dictionary.indexOf(configName);
+        if (configIndex < 0) {
+            return ScanResult::Completed;
+        }
+    }
+    if (!criticalFilter.isNull()
+        && (criticalFilter.toBool() ? m_criticalCount == 0 : m_criticalCount == m_rowCount)) {
+        return ScanResult::Completed;
+    }
+    if (!ackFilter.isNull()
+        && (ackFilter.toBool() ? m_acknowledgedCount == 0 : m_acknowledgedCount == m_rowCount)) {
+        return ScanResult::Completed;
+    }
+
+    // Rows are sorted, so the time range is a contiguous slice
+    QVector<qint64> timestamps;
+    if (!decodeDeltas(column(Timestamps), m_rowCount, timestamps)) {
+        MON_WARN(LogCategory::Database) << "[ARCHIVE] Bad timestamp column in" << filePath();
+        return ScanResult::Failed;
+    }
+    const int first = int(std::lower_bound(timestamps.begin(), timestamps.end(), startMs) - timestamps.begin());
+    const int last  = int(std::upper_bound(timestamps.begin(), timestamps.end(), endMs) - timestamps.begin());
+    if (first >= last) {
+        return ScanResult::Completed;
+    }
+
+    const QByteArray flags = column(Flags);
+    const QByteArray configBytes = column(Configs);
+    QVector<int> configs(m_rowCount);
+    {
+        const char *p = configBytes.constData();
+        const char *end = p + configBytes.size();
+        for (int i = 0; i < m_rowCount; ++i) {
+            quint64 index = 0;
+            if (!getVarint(p, end, index) || index >= quint64(m_dictionary.size())) {
+                MON_WARN(LogCategory::Database) << "[ARCHIVE] Bad config column in" << filePath();
+                return ScanResult::Failed;
+            }
+            configs[i] = int(index);
+        }
+    }
+    if (flags.size() < m_rowCount) {
+        MON_WARN(LogCategory::Database) << "[ARCHIVE] Bad flags column in" << filePath();
+        return ScanResult::Failed;
+    }
+
+    QVector<int> matches;
+    for (int i = first; i < last; ++i) {
+        const quint8 f = quint8(flags[i]);
+        if (configIndex >= 0 && configs[i] != configIndex) continue;
+        if (!ackFilter.isNull() && bool(f & kFlagAcknowledged) != ackFilter.toBool()) continue;
+        if (!criticalFilter.isNull() && bool(f & kFlagCritical) != criticalFilter.toBool()) continue;
+        matches.append(i);
+    }
+    if (matches.isEmpty()) {
+        return ScanResult::Completed;
+    }
+
+    QVector<qint64> rowIds;
+    if (!decodeDeltas(column(Ids), m_rowCount, rowIds)) {
+        MON_WARN(LogCategory::Database) << "[ARCHIVE] Bad id column in" << filePath();
+        return ScanResult::Failed;
+    }
+
+    // Value blocks are addressed through the directory at the column start
+    const uchar *values = m_data + m_columnOffset[Values];
+    const quint64 valuesLength = m_columnLength[Values];
+    const int blockCount = int(getFixed<quint32>(values));
+    if (4 + quint64(blockCount) * 12 > valuesLength) {
+        MON_WARN(LogCategory::Database) << "[ARCHIVE] Bad value directory in" << filePath();
+        return ScanResult::Failed;
+    }
+
+    int loadedBlock = -1;
+    QVector<ValuePair> blockValues;
+    for (int i : matches) {
+        const int block = i / kValueBlockRows;
+        if (block != loadedBlock) {
+            if (block >= blockCount) {
+                MON_WARN(LogCategory::Database) << "[ARCHIVE] Missing value block" << block << "in" << filePath();
+                return ScanResult::Failed;
+            }
+            const uchar *entry = values + 4 + block * 12;
+            const quint64 offset = getFixed<quint64>(entry);
+            const quint32 length = getFixed<quint32>(entry + 8);
+            const int rowsInBlock = std::min(kValueBlockRows, m_rowCount - block * kValueBlockRows);
+            if (offset + length > valuesLength
+                || !decodeValueBlock(qUncompress(values + offset, int(length)), rowsInBlock, blockValues)) {
+                MON_WARN(LogCategory::Database) << "[ARCHIVE] Bad value block" << block << "in" << filePath();
+                return ScanResult::Failed;
+            }
+            loadedBlock = block;
+        }
+
+        ChangeRow row;
+        row.id           = rowIds[i];
+        row.configName   = m_dictionary.at(configs[i]);
+        row.oldCipher    = blockValues[i % kValueBlockRows].first;
+        row.newCipher    = blockValues[i % kValueBlockRows].second;
+        row.acknowledged = quint8(flags[i]) & kFlagAcknowledged;
+        row.critical     = quint8(flags[i]) & kFlagCritical;
+        row.timestamp    = QDateTime::fromMSecsSinceEpoch(timestamps[i]);
+        if (!visitor(std::move(row))) {
+            return ScanResult::Stopped;
+        }
+    }
+    return ScanResult::Completed;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ChangeArchive
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Map every committed segment in @p directory.
+ */
+ChangeArchive::ChangeArchive(const QString &directory)
+    : m_directory(directory)
+{
+    QDir dir(m_directory);
+    if (!dir.mkpath(".")) {
+        MON_WARN(LogCategory::Database) << "[ARCHIVE] Cannot create archive directory" << m_directory;
+        return;
+    }
+    for (const QString &name : dir.entryList({"*.seg"}, QDir::Files)) {
+        if (auto segment = ArchiveSegment::open(dir.filePath(name))) {
+            m_segments.append(segment);
+        }
+    }
+    std::sort(m_segments.begin(), m_segments.end(), [](const auto &a, const auto &b) {
+        return a->minTimestampMs() < b->minTimestampMs();
+    });
+    MON_INFO(LogCategory::Database) << "[ARCHIVE] Opened" << m_segments.size() << "segments," << rowCount() << "rows.";
+}
+
+void ChangeArchive::setInstance(ChangeArchive *archive) {
+    s_instance.store(archive);
+}
+
+ChangeArchive *ChangeArchive::instance() {
+    return s_instance.load();
+}
+
+/**
+ * @brief Write rows to "changes-<minTs>-<firstId>.seg.pending".
+ */
+QString ChangeArchive::stage(const QVector<ChangeRow> &rows) {
+    if (rows.isEmpty()) {
+        return QString();
+    }
+    qint64 minTs = std::numeric_limits<qint64>::max();
+    qint64 minId = std::numeric_limits<qint64>::max();
+    for (const ChangeRow &row : rows) {
+        minTs = std::min(minTs, row.timestamp.toMSecsSinceEpoch());
+        minId = std::min(minId, row.id);
+    }
+    const QString path = QDir(m_directory).filePath(
+        QStringLiteral("changes-%1-%2.seg.pending").arg(minTs).arg(minId));
+    return ArchiveSegment::write(path, rows) ? path : QString();
+}
+
+/**
+ * @brief Rename a pending segment into place and add it to the search set.
+ */
+bool ChangeArchive::commit(const QString &pendingPath) {
+    QString finalPath = pendingPath;
+    finalPath.chop(int(strlen(".pending")));
+    QFile::remove(finalPath);
+    if (!QFile::rename(pendingPath, finalPath)) {
+        MON_WARN(LogCategory::Database) << "[ARCHIVE] Cannot commit segment" << pendingPath;
+        return false;
+    }
+    auto segment = ArchiveSegment::open(finalPath);
+    if (!segment) {
+        return false;
+    }
+
+    QWriteLocker locker(&m_lock);
+    auto pos = std::upper_bound(m_segments.begin(), m_segments.end(), segment,
+                                [](const auto &a, const auto &b) {
+        return a->minTimestampMs() < b->minTimestampMs();
+    });
+    m_segments.insert(pos, segment);
+    return true;
+}
+
+/**
+ * @brief Pending segments left behind by a crash; unreadable ones are deleted.
+ */
+QStringList ChangeArchive::pendingSegments() const {
+    QStringList result;
+    QDir dir(m_directory);
+    for (const QString &name : dir.entryList({"*.seg.pending"}, QDir::Files)) {
+        const QString path = dir.filePath(name);
+        if (ArchiveSegment::open(path)) {
+            result.append(path);
+        } else {
+            MON_WARN(LogCategory::Database) << "[ARCHIVE] Removing unreadable pending segment" << path;
+            QFile::remove(path);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Drop segments whose rows have all expired.
+ *
+ * Segments are checked on a snapshot, outside the lock. Files are deleted
+ * once the last in-flight scan releases them.
+ */
+int ChangeArchive::dropExpiredSegments(const ArchiveSegment::CutoffFn &cutoffFor) {
+    SegmentList dropped;
+    for (const auto &segment : snapshot()) {
+        if (segment->allExpired(cutoffFor)) {
+            dropped.append(segment);
+        }
+    }
+    if (dropped.isEmpty()) {
+        return 0;
+    }
+    {
+        QWriteLocker locker(&m_lock);
+        m_segments.erase(std::remove_if(m_segments.begin(), m_segments.end(), [&dropped](const auto &s) {
+            return dropped.contains(s);
+        }), m_segments.end());
+    }
+    for (const auto &segment : dropped) {
+        segment->markForRemoval();
+    }
+    return int(dropped.size());
+}
+
+int ChangeArchive::segmentCount() const {
+    QReadLocker locker(&m_lock);
+    return int(m_segments.size());
+}
+
+qint64 ChangeArchive::rowCount() const {
+    QReadLocker locker(&m_lock);
+    qint64 total = 0;
+    for (const auto &segment : m_segments) {
+        total += segment->rowCount();
+    }
+    return total;
+}
+
+ChangeArchive::SegmentList ChangeArchive::snapshot() const {
+    QReadLocker locker(&m_lock);
+    return m_segments;
+}
+
+/**
+ * @brief Scan every segment overlapping the range, oldest first.
+ */
+ScanResult ChangeArchive::scan(const QString &start,
+                               const QString &end,
+                               const QString &configName,
+                               const QVariant &ackFilter,
+                               const QVariant &criticalFilter,
+                               const std::function<bool(ChangeRow &&)> &visitor) const
+{
+    const qint64 startMs = parseBound(start, std::numeric_limits<qint64>::min());
+    const qint64 endMs   = parseBound(end, std::numeric_limits<qint64>::max());
+    for (const auto &segment : snapshot()) {
+        const ScanResult result = segment->scan(startMs, endMs, configName, ackFilter, criticalFilter, visitor);
+        if (result != ScanResult::Completed) {
+            return result;
+        }
+    }
+    return ScanResult::Completed;
+}
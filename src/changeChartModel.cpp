@@ -0,0 +1,265 @@
+#include "changeChartModel.h"
+#include "Database.h"
+#include <algorithm>
+#include <climits>
+
+/**
+ * @file changeChartModel.cpp
+ * @brief Implements the bucketed change-count table behind the stacked bar chart.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// Constructor
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Construct an empty chart model.
+ * @param days   Width of the rolling window in days (today included).
+ * @param parent Optional QObject parent for ownership.
+ */
+ChangeChartModel::ChangeChartModel(int days, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_days(std::max(1, days))
+{
+    // Live updates are batched so a burst of changes costs one repaint
+    m_repaintTimer.setSingleShot(true);
+    m_repaintTimer.setInterval(500);
+    connect(&m_repaintTimer, &ClockTimer::timeout, this, &ChangeChartModel::flushPending);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Population
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Rebuild from Database::changeCountRows().
+ */
+void ChangeChartModel::reload() {
+    Database db;
+    loadRows(db.changeCountRows());
+}
+
+/**
+ * @brief Rebuild the whole table in one pass over the aggregate rows.
+ * @param rows Per-day, per-config counts.
+ */
+void ChangeChartModel::loadRows(const QVector<ChangeCountRow> &rows) {
+    beginResetModel();
+
+    m_dates.clear();
+    m_configs.clear();
+    m_dateRow.clear();
+    m_configColumn.clear();
+    m_pending.clear();
+    m_repaintTimer.stop();
+
+    // Collect the axes first so the dense table is allocated once
+    for (const ChangeCountRow &row : rows) {
+        const QString &date   = row.date;
+        const QString &config = row.configName;
+        if (!m_dateRow.contains(date)) {
+            m_dateRow.insert(date, 0);
+            m_dates.append(date);
+        }
+        if (!m_configColumn.contains(config)) {
+            m_configColumn.insert(config, m_configs.size());
+            m_configs.append(config);
+        }
+    }
+    std::sort(m_dates.begin(), m_dates.end());
+    for (int i = 0; i < m_dates.size(); ++i) {
+        m_dateRow[m_dates[i]] = i;
+    }
+
+    m_counts.assign(m_dates.size(), std::vector<int>(m_configs.size(), 0));
+    m_rowTotals.assign(m_dates.size(), 0);
+    for (const ChangeCountRow &row : rows) {
+        const int r = m_dateRow.value(row.date);
+        const int c = m_configColumn.value(row.configName);
+        const int count = row.count;
+        m_counts[r][c] += count;
+        m_rowTotals[r] += count;
+    }
+
+    endResetModel();
+
+    emit categoriesChanged();
+    emit shapeChanged();
+    updateMaxStacked();
+}
+
+/**
+ * @brief Buffer one change and make sure a repaint is scheduled.
+ */
+void ChangeChartModel::recordChange(const QString &configName, const QDateTime &timestamp) {
+    const QString date = timestamp.date().toString(Qt::ISODate);
+    ++m_pending[qMakePair(date, configName)];
+    if (!m_repaintTimer.isActive()) {
+        m_repaintTimer.start();
+    }
+}
+
+/**
+ * @brief Apply buffered increments.
+ *
+ * New dates/configurations are inserted as rows/columns first; the counts
+ * are then updated and announced with a single dataChanged() over the
+ * bounding range of touched cells.
+ */
+void ChangeChartModel::flushPending() {
+    if (m_pending.isEmpty()) {
+        return;
+    }
+
+    dropExpiredDates();
+    const QString cutoff = windowStart();
+
+    // Pass 1: create missing rows/columns (may shift row indices)
+    for (auto it = m_pending.cbegin(); it != m_pending.cend(); ++it) {
+        if (it.key().first < cutoff) {
+            continue;
+        }
+        ensureDateRow(it.key().first);
+        ensureConfigColumn(it.key().second);
+    }
+
+    // Pass 2: apply increments with stable indices
+    int top = INT_MAX, left = INT_MAX, bottom = -1, right = -1;
+    for (auto it = m_pending.cbegin(); it != m_pending.cend(); ++it) {
+        if (it.key().first < cutoff) {
+            continue;
+        }
+        const int r = m_dateRow.value(it.key().first);
+        const int c = m_configColumn.value(it.key().second);
+        m_counts[r][c] += it.value();
+        m_rowTotals[r] += it.value();
+        top = std::min(top, r);
+        bottom = std::max(bottom, r);
+        left = std::min(left, c);
+        right = std::max(right, c);
+    }
+    m_pending.clear();
+
+    if (bottom >= 0) {
+        emit dataChanged(index(top, left), index(bottom, right), {Qt::DisplayRole});
+    }
+    updateMaxStacked();
+}
+
+int ChangeChartModel::ensureDateRow(const QString &date) {
+    auto found = m_dateRow.constFind(date);
+    if (found != m_dateRow.constEnd()) {
+        return found.value();
+    }
+
+    const int row = int(std::lower_bound(m_dates.begin(), m_dates.end(), date) - m_dates.begin());
+    beginInsertRows(QModelIndex(), row, row);
+    m_dates.insert(row, date);
+    m_counts.insert(m_counts.begin() + row, std::vector<int>(m_configs.size(), 0));
+    m_rowTotals.insert(m_rowTotals.begin() + row, 0);
+    for (int i = row; i < m_dates.size(); ++i) {
+        m_dateRow[m_dates[i]] = i;
+    }
+    endInsertRows();
+
+    emit categoriesChanged();
+    emit shapeChanged();
+    return row;
+}
+
+int ChangeChartModel::ensureConfigColumn(const QString &configName) {
+    auto found = m_configColumn.constFind(configName);
+    if (found != m_configColumn.constEnd()) {
+        return found.value();
+    }
+
+    const int column = m_configs.size();
+    beginInsertColumns(QModelIndex(), column, column);
+    m_configs.append(configName);
+    m_configColumn.insert(configName, column);
+    for (std::vector<int> &row : m_counts) {
+        row.push_back(0);
+    }
+    endInsertColumns();
+
+    emit shapeChanged();
+    return column;
+}
+
+/**
+ * @brief Drop leading rows older than the window (after midnight rollover).
+ */
+void ChangeChartModel::dropExpiredDates() {
+    const QString cutoff = windowStart();
+    int expired = 0;
+    while (expired < m_dates.size() && m_dates[expired] < cutoff) {
+        ++expired;
+    }
+    if (expired == 0) {
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), 0, expired - 1);
+    for (int i = 0; i < expired; ++i) {
+        m_dateRow.remove(m_dates[i]);
+    }
+    m_dates.erase(m_dates.begin(), m_dates.begin() + expired);
+    m_counts.erase(m_counts.begin(), m_counts.begin() + expired);
+    m_rowTotals.erase(m_rowTotals.begin(), m_rowTotals.begin() + expired);
+    for (int i = 0; i < m_dates.size(); ++i) {
+        m_dateRow[m_dates[i]] = i;
+    }
+    endRemoveRows();
+
+    emit categoriesChanged();
+    emit shapeChanged();
+}
+
+QString ChangeChartModel::windowStart() const {
+    return Clock::instance()->now().date().addDays(-(m_days - 1)).toString(Qt::ISODate);
+}
+
+void ChangeChartModel::updateMaxStacked() {
+    const int maxValue = m_rowTotals.empty()
+        ? 0 : *std::max_element(m_rowTotals.begin(), m_rowTotals.end());
+    if (maxValue != m_maxStacked) {
+        m_maxStacked = maxValue;
+        emit maxStackedValueChanged();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// QAbstractTableModel Overrides
+////////////////////////////////////////////////////////////////////////////////
+
+int ChangeChartModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : m_dates.size();
+}
+
+int ChangeChartModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : m_configs.size();
+}
+
+/**
+ * @brief Change count for (date row, config column).
+ */
+QVariant ChangeChartModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole ||
+        index.row() >= m_dates.size() || index.column() >= m_configs.size()) {
+        return QVariant();
+    }
+    return m_counts[index.row()][index.column()];
+}
+
+/**
+ * @brief Config name for columns (bar set labels), date for rows.
+ */
+QVariant ChangeChartModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole || section < 0) {
+        return QVariant();
+    }
+    if (orientation == Qt::Horizontal) {
+        return section < m_configs.size() ? QVariant(m_configs[section]) : QVariant();
+    }
+    return section < m_dates.size() ? QVariant(m_dates[section]) : QVariant();
+}
@@ -0,0 +1,350 @@
+/**
+ * @file changeDispatcher.cpp
+ * @brief Implements the priority lanes that order rollback, alert and
+ *        persistence work produced by the monitoring loop.
+ */
+
+#include "changeDispatcher.h"
+#include "Database.h"
+#include "logger.h"
+#include "trace.h"
+#include <QDebug>
+#include <QMutexLocker>
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////
+// LaneStats
+////////////////////////////////////////////////////////////////////////////////
+
+LaneStats::LaneStats(int capacity)
+    : m_samples(std::max(1, capacity), 0)
+{
+}
+
+/**
+ * @brief Store one latency sample, overwriting the oldest when full.
+ * @param latencyUs Latency in microseconds.
+ */
+void LaneStats::record(qint64 latencyUs) {
+    m_samples[m_next] = latencyUs;
+    m_next = (m_next + 1) % int(m_samples.size());
+    if (m_next == 0) {
+        m_full = true;
+    }
+    ++m_completed;
+    m_max = std::max(m_max, latencyUs);
+}
+
+/**
+ * @brief Compute a percentile over the retained samples.
+ * @param p Percentile in the range [0, 100].
+ * @return Latency in microseconds (nearest-rank method).
+ */
+qint64 LaneStats::percentile(double p) const {
+    const int count = m_full ? int(m_samples.size()) : m_next;
+    if (count == 0) {
+        return 0;
+    }
+    std::vector<qint64> sorted(m_samples.begin(), m_samples.begin() + count);
+    const int rank = std::clamp(int(p / 100.0 * count + 0.5) - 1, 0, count - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// LaneWorker
+////////////////////////////////////////////////////////////////////////////////
+
+LaneWorker::LaneWorker(const QList<ChangeLane> &lanes, QObject *parent)
+    : QThread(parent)
+    , m_lanes(lanes)
+{
+    std::sort(m_lanes.begin(), m_lanes.end());
+}
+
+LaneWorker::~LaneWorker() {
+    shutdown();
+    wait();
+}
+
+/**
+ * @brief Queue a job and wake the worker.
+ * @param lane Lane the job belongs to; must be one of this worker's lanes.
+ * @param job  Work to run on the worker thread.
+ */
+void LaneWorker::post(ChangeLane lane, std::function<void()> job) {
+    Job entry{std::move(job), QElapsedTimer()};
+    entry.queued.start();
+
+    QMutexLocker locker(&m_mutex);
+    m_queues[int(lane)].push_back(std::move(entry));
+    m_wake.wakeOne();
+}
+
+/**
+ * @brief Request a graceful stop; queued jobs are still drained.
+ */
+void LaneWorker::shutdown() {
+    QMutexLocker locker(&m_mutex);
+    m_stopping = true;
+    m_wake.wakeAll();
+}
+
+int LaneWorker::pending(ChangeLane lane) const {
+    QMutexLocker locker(&m_mutex);
+    return int(m_queues[int(lane)].size());
+}
+
+LaneStats LaneWorker::stats(ChangeLane lane) const {
+    QMutexLocker locker(&m_mutex);
+    return m_stats[int(lane)];
+}
+
+/**
+ * @brief Worker loop: pop from the highest-priority non-empty lane, run, repeat.
+ *
+ * Releases this thread's database connection before exiting.
+ */
+void LaneWorker::run() {
+    for (;;) {
+        Job job;
+        ChangeLane lane = ChangeLane::Count;
+        {
+            QMutexLocker locker(&m_mutex);
+            for (;;) {
+                for (ChangeLane candidate : m_lanes) {
+                    if (!m_queues[int(candidate)].empty()) {
+                        lane = candidate;
+                        break;
+                    }
+                }
+                if (lane != ChangeLane::Count || m_stopping) {
+                    break;
+                }
+                m_wake.wait(&m_mutex);
+            }
+            if (lane == ChangeLane::Count) {
+                break;  // stopping and fully drained
+            }
+            job = std::move(m_queues[int(lane)].front());
+            m_queues[int(lane)].pop_front();
+        }
+
+        job.fn();
+
+        QMutexLocker locker(&m_mutex);
+        m_stats[int(lane)].record(job.queued.nsecsElapsed() / 1000);
+    }
+
+    Database::releaseThreadConnection();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ChangeDispatcher
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Start the critical alert, bulk alert and persistence workers.
+ * @param parent Optional parent QObject.
+ *
+ * Both persistence lanes share the persistence worker's single FIFO, so
+ * batches commit in the order the check cycles staged them: a newer
+ * configuration upsert can never be overwritten by an older one.
+ */
+ChangeDispatcher::ChangeDispatcher(QObject *parent)
+    : QObject(parent)
+    , m_criticalWorker(new LaneWorker({ChangeLane::CriticalAlert}, this))
+    , m_bulkWorker(new LaneWorker({ChangeLane::Alert}, this))
+    , m_persistWorker(new LaneWorker({ChangeLane::Persist}, this))
+{
+    m_criticalWorker->setObjectName("CriticalLaneWorker");
+    m_bulkWorker->setObjectName("BulkLaneWorker");
+    m_persistWorker->setObjectName("PersistLaneWorker");
+    m_criticalWorker->start(QThread::HighPriority);
+    m_bulkWorker->start(QThread::LowPriority);
+    m_persistWorker->start(QThread::NormalPriority);
+}
+
+/**
+ * @brief Drain both workers before destruction so no change is lost.
+ */
+ChangeDispatcher::~ChangeDispatcher() {
+    shutdown();
+}
+
+/**
+ * @brief Run pending rollbacks, commit the open cycle and join both workers.
+ *
+ * Safe to call more than once; jobs posted afterwards are dropped.
+ */
+void ChangeDispatcher::shutdown() {
+    if (m_shutDown) {
+        return;
+    }
+    serviceRollbacks();
+    commitTick();
+    m_shutDown = true;
+    m_criticalWorker->shutdown();
+    m_bulkWorker->shutdown();
+    m_persistWorker->shutdown();
+    m_criticalWorker->wait();
+    m_bulkWorker->wait();
+    m_persistWorker->wait();
+}
+
+/**
+ * @brief Queue a job on the worker that owns the lane.
+ */
+void ChangeDispatcher::post(ChangeLane lane, std::function<void()> job) {
+    if (m_shutDown && lane != ChangeLane::Rollback) {
+        MON_WARN(LogCategory::Dispatcher) << "[DISPATCHER] Shut down; job for" << laneName(lane) << "dropped.";
+        return;
+    }
+    switch (lane) {
+    case ChangeLane::Rollback: {
+        QElapsedTimer queued;
+        queued.start();
+        m_rollbacks.emplace_back(std::move(job), queued);
+        break;
+    }
+    case ChangeLane::CriticalAlert:
+        m_criticalWorker->post(lane, std::move(job));
+        break;
+    case ChangeLane::CriticalPersist:
+    case ChangeLane::Persist:
+        // One ordered queue for every write, critical or not
+        m_persistWorker->post(ChangeLane::Persist, std::move(job));
+        break;
+    case ChangeLane::Alert:
+        m_bulkWorker->post(lane, std::move(job));
+        break;
+    case ChangeLane::Count:
+        MON_WARN(LogCategory::Dispatcher) << "[DISPATCHER] Invalid lane; job dropped.";
+        break;
+    }
+}
+
+/**
+ * @brief Open a unit of work for the current check cycle.
+ */
+void ChangeDispatcher::beginTick() {
+    m_inTick = true;
+}
+
+/**
+ * @brief Stage a database write for the current cycle.
+ */
+void ChangeDispatcher::stage(ChangeLane lane, Database::Write write) {
+    if (!m_inTick) {
+        post(lane, [write = std::move(write)]() {
+            Database db;
+            write(db);
+        });
+        return;
+    }
+    m_staged.push_back(std::move(write));
+}
+
+/**
+ * @brief Close the cycle and post its writes as one transactional job.
+ *
+ * Every cycle's job goes to the same persistence queue, behind the jobs
+ * of earlier cycles, whichever lanes were staged.
+ */
+void ChangeDispatcher::commitTick() {
+    m_inTick = false;
+    if (m_staged.empty()) {
+        return;
+    }
+
+    std::vector<Database::Write> writes;
+    writes.swap(m_staged);
+    post(ChangeLane::Persist, [writes = std::move(writes)]() {
+        Database db;
+        db.applyBatch(writes);
+    });
+}
+
+/**
+ * @brief Execute queued rollbacks on the calling (monitoring) thread.
+ */
+void ChangeDispatcher::serviceRollbacks() {
+    MON_SPAN(LogCategory::Dispatcher, "dispatcher.serviceRollbacks");
+    while (!m_rollbacks.empty()) {
+        auto entry = std::move(m_rollbacks.front());
+        m_rollbacks.pop_front();
+        entry.first();
+        m_rollbackStats.record(entry.second.nsecsElapsed() / 1000);
+    }
+}
+
+LaneStats ChangeDispatcher::statsFor(ChangeLane lane) const {
+    switch (lane) {
+    case ChangeLane::Rollback:
+        return m_rollbackStats;
+    case ChangeLane::CriticalAlert:
+        return m_criticalWorker->stats(lane);
+    case ChangeLane::CriticalPersist:
+    case ChangeLane::Persist:
+        return m_persistWorker->stats(ChangeLane::Persist);
+    default:
+        return m_bulkWorker->stats(lane);
+    }
+}
+
+/**
+ * @brief p99 latency (queue wait + service) for a lane.
+ * @param lane Integer value of a ChangeLane.
+ * @return Latency in milliseconds.
+ */
+double ChangeDispatcher::laneP99Ms(int lane) const {
+    if (lane < 0 || lane >= int(ChangeLane::Count)) {
+        return 0.0;
+    }
+    return statsFor(ChangeLane(lane)).percentile(99.0) / 1000.0;
+}
+
+/**
+ * @brief Snapshot of every lane's queue depth and latency distribution.
+ * @return Map of lane name → { pending, completed, p50Ms, p99Ms, maxMs };
+ *         criticalPersist and persist both report the shared persistence queue.
+ */
+QVariantMap ChangeDispatcher::laneStats() const {
+    QVariantMap result;
+    for (int i = 0; i < int(ChangeLane::Count); ++i) {
+        const ChangeLane lane = ChangeLane(i);
+        const LaneStats stats = statsFor(lane);
+
+        int pending = 0;
+        if (lane == ChangeLane::Rollback) {
+            pending = int(m_rollbacks.size());
+        } else if (lane == ChangeLane::CriticalAlert) {
+            pending = m_criticalWorker->pending(lane);
+        } else if (lane == ChangeLane::CriticalPersist || lane == ChangeLane::Persist) {
+            pending = m_persistWorker->pending(ChangeLane::Persist);
+        } else {
+            pending = m_bulkWorker->pending(lane);
+        }
+
+        QVariantMap entry;
+        entry["pending"]   = pending;
+        entry["completed"] = stats.completed();
+        entry["p50Ms"]     = stats.percentile(50.0) / 1000.0;
+        entry["p99Ms"]     = stats.percentile(99.0) / 1000.0;
+        entry["maxMs"]     = stats.maximum() / 1000.0;
+        result[laneName(lane)] = entry;
+    }
+    return result;
+}
+
+QString ChangeDispatcher::laneName(ChangeLane lane) {
+    switch (lane) {
+    case ChangeLane::Rollback:        return "rollback";
+    case ChangeLane::CriticalAlert:   return "criticalAlert";
+    case ChangeLane::CriticalPersist: return "criticalPersist";
+    case ChangeLane::Persist:         return "persist";
+    case ChangeLane::Alert:           return "alert";
+    case ChangeLane::Count:           break;
+    }
+    return "unknown";
+}
@@ -0,0 +1,470 @@
+#include "changeExport.h"
+#include "Database.h"
+#include "databaseRows.h"
+#include "logger.h"
+#include "resourceGovernor.h"
+#include <QElapsedTimer>
+#include <QMetaObject>
+#include <QPointer>
+#include <QSaveFile>
+#include <QThread>
+#include <QUrl>
+#include <algorithm>
+#include <memory>
+#include <zlib.h>
+#ifdef MONITOR_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+/**
+ * @file changeExport.cpp
+ * @brief Implements the streaming CSV / JSON Lines change-history export.
+ */
+
+namespace {
+constexpr int    kBatchRows        = 4096;        // Rows decrypted per batch
+constexpr int    kBufferBytes      = 1 << 20;     // Formatted bytes handed to the sink at once
+constexpr int    kSinkChunkBytes   = 256 * 1024;  // Compressor output chunk
+constexpr qint64 kProgressEveryMs  = 250;
+
+////////////////////////////////////////////////////////////////////////////////
+// Output sinks
+////////////////////////////////////////////////////////////////////////////////
+
+/// Destination for formatted bytes: the file itself or a compressor in front of it.
+class OutputSink {
+public:
+    explicit OutputSink(QIODevice *device) : m_device(device) {}
+    virtual ~OutputSink() = default;
+
+    virtual bool write(const char *data, qint64 size) {
+        return m_device->write(data, size) == size;
+    }
+
+    /// Flush any trailer; called once after the last write().
+    virtual bool finish() { return true; }
+
+protected:
+    QIODevice *m_device;
+};
+
+/// gzip (RFC 1952) stream via zlib, readable by gunzip and most tools.
+class GzipSink : public OutputSink {
+public:
+    explicit GzipSink(QIODevice *device)
+        : OutputSink(device)
+        , m_out(kSinkChunkBytes, Qt::Uninitialized)
+    {
+        // windowBits 15 + 16 selects the gzip wrapper
+        m_ok = deflateInit2(&m_stream, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+
+    ~GzipSink() override {
+        if (m_ok) {
+            deflateEnd(&m_stream);
+        }
+    }
+
+    bool write(const char *data, qint64 size) override {
+        m_stream.next_in  = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+        m_stream.avail_in = uInt(size);
+        return m_ok && pump(Z_NO_FLUSH);
+    }
+
+    bool finish() override {
+        m_stream.next_in  = nullptr;
+        m_stream.avail_in = 0;
+        return m_ok && pump(Z_FINISH);
+    }
+
+private:
+    bool pump(int flush) {
+        for (;;) {
+            m_stream.next_out  = reinterpret_cast<Bytef *>(m_out.data());
+            m_stream.avail_out = uInt(m_out.size());
+            const int rc = deflate(&m_stream, flush);
+            if (rc == Z_STREAM_ERROR) {
+                return false;
+            }
+            const qint64 produced = m_out.size() - m_stream.avail_out;
+            if (produced > 0 && m_device->write(m_out.constData(), produced) != produced) {
+                return false;
+            }
+            if (flush == Z_FINISH ? rc == Z_STREAM_END : m_stream.avail_out != 0) {
+                return true;
+            }
+        }
+    }
+
+    z_stream   m_stream{};
+    QByteArray m_out;
+    bool       m_ok = false;
+};
+
+#ifdef MONITOR_HAVE_ZSTD
+/// zstd frame stream; faster than gzip at a similar ratio.
+class ZstdSink : public OutputSink {
+public:
+    explicit ZstdSink(QIODevice *device)
+        : OutputSink(device)
+        , m_context(ZSTD_createCCtx())
+        , m_out(int(ZSTD_CStreamOutSize()), Qt::Uninitialized)
+    {
+        ZSTD_CCtx_setParameter(m_context, ZSTD_c_compressionLevel, 3);
+    }
+
+    ~ZstdSink() override { ZSTD_freeCCtx(m_context); }
+
+    bool write(const char *data, qint64 size) override {
+        ZSTD_inBuffer in{data, size_t(size), 0};
+        return pump(in, ZSTD_e_continue);
+    }
+
+    bool finish() override {
+        ZSTD_inBuffer in{nullptr, 0, 0};
+        return pump(in, ZSTD_e_end);
+    }
+
+private:
+    bool pump(ZSTD_inBuffer &in, ZSTD_EndDirective mode) {
+        for (;;) {
+            ZSTD_outBuffer out{m_out.data(), size_t(m_out.size()), 0};
+            const size_t remaining = ZSTD_compressStream2(m_context, &out, &in, mode);
+            if (ZSTD_isError(remaining)) {
+                return false;
+            }
+            if (out.pos > 0 && m_device->write(m_out.constData(), qint64(out.pos)) != qint64(out.pos)) {
+                return false;
+            }
+            if (mode == ZSTD_e_end ? remaining == 0 : in.pos == in.size) {
+                return true;
+            }
+        }
+    }
+
+    ZSTD_CCtx *m_context;
+    QByteArray m_out;
+};
+#endif
+
+std::unique_ptr<OutputSink> makeSink(const QString &compression, QIODevice *device) {
+    if (compression.isEmpty() || compression == "none") {
+        return std::make_unique<OutputSink>(device);
+    }
+    if (compression == "gzip") {
+        return std::make_unique<GzipSink>(device);
+    }
+#ifdef MONITOR_HAVE_ZSTD
+    if (compression == "zstd") {
+        return std::make_unique<ZstdSink>(device);
+    }
+#endif
+    return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Row formatting
+////////////////////////////////////////////////////////////////////////////////
+
+const char kCsvHeader[] = "id,config_name,old_value,new_value,acknowledged,critical,timestamp\n";
+
+/// Append a CSV field, quoting it only when it contains a separator, quote or newline.
+void appendCsvField(QByteArray &out, const QString &value) {
+    const QByteArray utf8 = value.toUtf8();
+    if (utf8.indexOf(',') < 0 && utf8.indexOf('"') < 0
+        && utf8.indexOf('\n') < 0 && utf8.indexOf('\r') < 0) {
+        out.append(utf8);
+        return;
+    }
+    out.append('"');
+    for (char c : utf8) {
+        if (c == '"') {
+            out.append('"');
+        }
+        out.append(c);
+    }
+    out.append('"');
+}
+
+/// Append a JSON string literal (quotes included).
+void appendJsonString(QByteArray &out, const QString &value) {
+    static const char kHex[] = "0123456789abcdef";
+    out.append('"');
+    for (char c : value.toUtf8()) {
+        switch (c) {
+        case '"':  out.append("\\\""); break;
+        case '\\': out.append("\\\\"); break;
+        case '\n': out.append("\\n");  break;
+        case '\r': out.append("\\r");  break;
+        case '\t': out.append("\\t");  break;
+        default:
+            if (uchar(c) < 0x20) {
+                out.append("\\u00");
+                out.append(kHex[uchar(c) >> 4]);
+                out.append(kHex[uchar(c) & 0xf]);
+            } else {
+                out.append(c);
+            }
+        }
+    }
+    out.append('"');
+}
+
+void appendCsvRow(QByteArray &out, const ChangeRow &row) {
+    out.append(QByteArray::number(row.id));
+    out.append(',');
+    appendCsvField(out, row.configName);
+    out.append(',');
+    appendCsvField(out, row.oldValue);
+    out.append(',');
+    appendCsvField(out, row.newValue);
+    out.append(row.acknowledged ? ",1," : ",0,");
+    out.append(row.critical ? "1," : "0,");
+    out.append(row.timestamp.toString(Qt::ISODate).toLatin1());
+    out.append('\n');
+}
+
+void appendJsonRow(QByteArray &out, const ChangeRow &row) {
+    out.append("{\"id\":");
+    out.append(QByteArray::number(row.id));
+    out.append(",\"config_name\":");
+    appendJsonString(out, row.configName);
+    out.append(",\"old_value\":");
+    appendJsonString(out, row.oldValue);
+    out.append(",\"new_value\":");
+    appendJsonString(out, row.newValue);
+    out.append(row.acknowledged ? ",\"acknowledged\":true" : ",\"acknowledged\":false");
+    out.append(row.critical ? ",\"critical\":true" : ",\"critical\":false");
+    out.append(",\"timestamp\":\"");
+    out.append(row.timestamp.toString(Qt::ISODate).toLatin1());
+    out.append("\"}\n");
+}
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Construct the exporter and its worker pools.
+ * @param parent Optional QObject parent for ownership.
+ */
+ChangeExport::ChangeExport(QObject *parent)
+    : QObject(parent)
+{
+    m_queryPool.setMaxThreadCount(1);
+    m_queryPool.setExpiryTimeout(-1);
+    m_decryptPool.setMaxThreadCount(std::max(1, QThread::idealThreadCount()));
+}
+
+ChangeExport::~ChangeExport() {
+    shutdown();
+}
+
+/**
+ * @brief Cancel any running export and release the worker's connection.
+ *
+ * main() calls this before stopping the logger the workers write to.
+ */
+void ChangeExport::shutdown() {
+    ++m_generation;
+    m_queryPool.start([]() { Database::releaseThreadConnection(); });
+    m_queryPool.waitForDone();
+    m_decryptPool.waitForDone();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Public API
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Start a new export, superseding any export still running.
+ */
+int ChangeExport::exportChanges(const QString &filePath,
+                                const QString &format,
+                                const QString &compression,
+                                const QString &start,
+                                const QString &end,
+                                const QString &configName,
+                                const QVariant &ackFilter,
+                                const QVariant &criticalFilter)
+{
+    Job job;
+    job.generation     = ++m_generation;
+    const QUrl url(filePath);
+    job.filePath       = url.isLocalFile() ? url.toLocalFile() : filePath;
+    job.format         = format.toLower();
+    job.compression    = compression.toLower();
+    job.start          = start;
+    job.end            = end;
+    job.configName     = configName;
+    job.ackFilter      = ackFilter;
+    job.criticalFilter = criticalFilter;
+
+    m_activeId = int(job.generation);
+    setBusy(true);
+    emit exportStarted(m_activeId);
+
+    m_queryPool.start([this, job]() { run(job); });
+    return m_activeId;
+}
+
+/**
+ * @brief Abandon the running export; its partial file is discarded.
+ */
+void ChangeExport::cancel() {
+    ++m_generation;
+    if (m_busy) {
+        setBusy(false);
+        emit exportFinished(m_activeId, 0, true, QString());
+    }
+}
+
+QStringList ChangeExport::compressions() const {
+    QStringList names{"none", "gzip"};
+#ifdef MONITOR_HAVE_ZSTD
+    names << "zstd";
+#endif
+    return names;
+}
+
+void ChangeExport::setBusy(bool busy) {
+    if (m_busy != busy) {
+        m_busy = busy;
+        emit busyChanged();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Worker side
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Stream, decrypt, format and write one export.
+ *
+ * Memory is bounded by one batch of rows plus one output buffer; the
+ * database side reads in keyset pages (see Database::forEachChangeInRange()).
+ */
+void ChangeExport::run(const Job &job) {
+    QPointer<ChangeExport> self(this);
+    const quint64 generation = job.generation;
+    auto finish = [self, generation](qint64 rows, const QString &error) {
+        QMetaObject::invokeMethod(self, [self, generation, rows, error]() {
+            if (self && self->isCurrent(generation)) {
+                self->setBusy(false);
+                emit self->exportFinished(int(generation), rows, false, error);
+            }
+        }, Qt::QueuedConnection);
+    };
+
+    if (!isCurrent(generation)) {
+        return;
+    }
+    const bool csv = job.format == "csv";
+    if (!csv && job.format != "jsonl") {
+        finish(0, tr("Unknown export format: %1").arg(job.format));
+        return;
+    }
+
+    QSaveFile file(job.filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        finish(0, tr("Cannot open %1: %2").arg(job.filePath, file.errorString()));
+        return;
+    }
+    std::unique_ptr<OutputSink> sink = makeSink(job.compression, &file);
+    if (!sink) {
+        file.cancelWriting();
+        finish(0, tr("Compression not available: %1").arg(job.compression));
+        return;
+    }
+
+    QByteArray buffer;
+    buffer.reserve(kBufferBytes + 64 * 1024);
+    if (csv) {
+        buffer.append(kCsvHeader);
+    }
+
+    QVector<ChangeRow> batch;
+    batch.reserve(kBatchRows);
+    qint64 written = 0;
+    bool writeOk = true;
+    QElapsedTimer sinceProgress;
+    sinceProgress.start();
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    auto flushBatch = [&]() {
+        ChangeRow *first = batch.data();
+        DatabaseRows::decryptValuesParallel(m_decryptPool, first, first + batch.size());
+        for (const ChangeRow &row : batch) {
+            if (csv) {
+                appendCsvRow(buffer, row);
+            } else {
+                appendJsonRow(buffer, row);
+            }
+            if (buffer.size() >= kBufferBytes) {
+                writeOk = writeOk && sink->write(buffer.constData(), buffer.size());
+                buffer.resize(0);   // keeps capacity
+            }
+        }
+        written += batch.size();
+        batch.resize(0);
+
+        if (sinceProgress.elapsed() >= kProgressEveryMs) {
+            sinceProgress.restart();
+            QMetaObject::invokeMethod(self, [self, generation, written]() {
+                if (self && self->isCurrent(generation)) {
+                    emit self->exportProgress(int(generation), written);
+                }
+            }, Qt::QueuedConnection);
+        }
+    };
+
+    bool readOk = false;
+    {
+        Database db;
+        readOk = db.forEachChangeInRange(job.start, job.end, job.configName,
+                                         job.ackFilter, job.criticalFilter,
+                                         [&](ChangeRow &&row) {
+            if (!isCurrent(generation) || !writeOk) {
+                return false;
+            }
+            batch.append(std::move(row));
+            if (batch.size() >= ResourceGovernor::batchSize(kBatchRows)) {
+                flushBatch();
+            }
+            return true;
+        });
+    }
+
+    if (!isCurrent(generation)) {
+        file.cancelWriting();
+        MON_INFO(LogCategory::Database) << "[EXPORT] Export" << generation << "cancelled after" << written << "rows.";
+        return;
+    }
+    if (!batch.isEmpty()) {
+        flushBatch();
+    }
+    if (writeOk && !buffer.isEmpty()) {
+        writeOk = sink->write(buffer.constData(), buffer.size());
+    }
+    writeOk = writeOk && sink->finish();
+
+    QString error;
+    if (!readOk) {
+        error = tr("Reading change history failed");
+    } else if (!writeOk) {
+        error = tr("Writing %1 failed: %2").arg(job.filePath, file.errorString());
+    }
+    if (!error.isEmpty()) {
+        file.cancelWriting();
+        MON_WARN(LogCategory::Database) << "[EXPORT] Export" << generation << "failed:" << error;
+    } else if (!file.commit()) {
+        error = tr("Saving %1 failed: %2").arg(job.filePath, file.errorString());
+        MON_WARN(LogCategory::Database) << "[EXPORT] Export" << generation << "failed:" << error;
+    } else {
+        MON_INFO(LogCategory::Database) << "[EXPORT] Wrote" << written << "rows to" << job.filePath
+                                        << "in" << elapsed.elapsed() << "ms.";
+    }
+    finish(written, error);
+}
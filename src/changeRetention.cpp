@@ -0,0 +1,371 @@
+#include "changeRetention.h"
+#include "changeArchive.h"
+#include "Database.h"
+#include "logger.h"
+#include "resourceGovernor.h"
+#include "valueHistory.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QThread>
+#include <algorithm>
+
+/**
+ * @file changeRetention.cpp
+ * @brief Implements retention policies and the background Changes purge.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// RetentionPolicy
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Longest age any rule keeps; whole months older than this can be dropped.
+ */
+int RetentionPolicy::longestDays() const {
+    if (maxAgeDays <= 0 || criticalMaxAgeDays <= 0) {
+        return 0;
+    }
+    int longest = std::max(maxAgeDays, criticalMaxAgeDays);
+    for (int days : perConfigDays) {
+        if (days <= 0) {
+            return 0;
+        }
+        longest = std::max(longest, days);
+    }
+    return longest;
+}
+
+/**
+ * @brief The per-config rule if there is one, else the critical or default rule.
+ *
+ * Leaf rows follow the rule of their entry.
+ */
+int RetentionPolicy::daysFor(const QString &configName, bool critical) const {
+    const auto it = perConfigDays.constFind(ChangeRow::entryOf(configName));
+    if (it != perConfigDays.cend()) {
+        return std::max(0, it.value());
+    }
+    return std::max(0, critical ? criticalMaxAgeDays : maxAgeDays);
+}
+
+/**
+ * @brief Read a policy file; a missing or invalid file yields the defaults.
+ *
+ * Expected shape:
+ * {
+ *   "maxAgeDays": 90, "criticalMaxAgeDays": 365,
+ *   "perConfig": { "SomeKey": 30 },
+ *   "chunkSize": 1000, "chunkPauseMs": 50, "intervalMinutes": 60,
+ *   "partitionByMonth": false, "partitionsAhead": 3,
+ *   "archiveAfterDays": 0, "archiveSegmentRows": 50000
+ * }
+ */
+RetentionPolicy RetentionPolicy::fromJson(const QString &filePath) {
+    RetentionPolicy policy;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        MON_DEBUG(LogCategory::Database) << "[RETENTION] No policy file at" << filePath << "; using defaults.";
+        return policy;
+    }
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (!doc.isObject()) {
+        MON_WARN(LogCategory::Database) << "[RETENTION] Policy file is not a JSON object:" << filePath;
+        return policy;
+    }
+
+    const QJsonObject obj = doc.object();
+    policy.maxAgeDays         = obj.value("maxAgeDays").toInt(policy.maxAgeDays);
+    policy.criticalMaxAgeDays = obj.value("criticalMaxAgeDays").toInt(policy.criticalMaxAgeDays);
+    policy.chunkSize          = std::max(1, obj.value("chunkSize").toInt(policy.chunkSize));
+    policy.chunkPauseMs       = std::max(0, obj.value("chunkPauseMs").toInt(policy.chunkPauseMs));
+    policy.intervalMinutes    = std::max(1, obj.value("intervalMinutes").toInt(policy.intervalMinutes));
+    policy.partitionByMonth   = obj.value("partitionByMonth").toBool(policy.partitionByMonth);
+    policy.partitionsAhead    = std::max(1, obj.value("partitionsAhead").toInt(policy.partitionsAhead));
+    policy.archiveAfterDays   = std::max(0, obj.value("archiveAfterDays").toInt(policy.archiveAfterDays));
+    policy.archiveSegmentRows = std::max(1, obj.value("archiveSegmentRows").toInt(policy.archiveSegmentRows));
+
+    const QJsonObject perConfig = obj.value("perConfig").toObject();
+    for (auto it = perConfig.begin(); it != perConfig.end(); ++it) {
+        policy.perConfigDays.insert(it.key(), it.value().toInt());
+    }
+    return policy;
+}
+
+/**
+ * @brief Path of resources/retentionPolicy.json next to the other resources.
+ */
+QString RetentionPolicy::defaultPath() {
+#ifdef Q_OS_MAC
+    return QDir::cleanPath(QCoreApplication::applicationDirPath() +
+                           "/../../../../../resources/retentionPolicy.json");
+#else
+    return QDir::cleanPath(QCoreApplication::applicationDirPath() +
+                           "/../../resources/retentionPolicy.json");
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Construct the job with its single-thread pool.
+ */
+ChangeRetention::ChangeRetention(const RetentionPolicy &policy,
+                                 ChangeArchive *archive,
+                                 QObject *parent)
+    : QObject(parent)
+    , m_policy(policy)
+    , m_archive(archive)
+{
+    // Keep the thread (and its DB connection) between passes
+    m_pool.setMaxThreadCount(1);
+    m_pool.setExpiryTimeout(-1);
+
+    m_timer.setInterval(m_policy.intervalMinutes * 60 * 1000);
+    connect(&m_timer, &ClockTimer::timeout, this, &ChangeRetention::runNow);
+}
+
+ChangeRetention::~ChangeRetention() {
+    shutdown();
+}
+
+/**
+ * @brief Stop between chunks and release the worker's connection.
+ *
+ * main() calls this before stopping the logger the pass writes to.
+ */
+void ChangeRetention::shutdown() {
+    m_stopping = true;
+    m_timer.stop();
+    m_pool.start([]() { Database::releaseThreadConnection(); });
+    m_pool.waitForDone();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Scheduling
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Start the periodic timer; the first pass runs a minute after startup.
+ */
+void ChangeRetention::start() {
+    m_timer.start();
+    Clock::instance()->singleShot(60 * 1000, this, [this]() { runNow(); });
+}
+
+/**
+ * @brief Queue a purge pass unless one is already running.
+ */
+void ChangeRetention::runNow() {
+    if (m_stopping) {
+        return;
+    }
+    bool expected = false;
+    if (!m_running.compare_exchange_strong(expected, true)) {
+        return;
+    }
+    emit runningChanged();
+    m_pool.start([this]() { purge(); });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Purge
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief One pass: maintain partitions, delete expired rows rule by rule,
+ *        then archive aged rows and expire archive segments.
+ *
+ * Per-config rules run first. The default and critical rules exclude those
+ * configs, so each row is governed by exactly one rule. Rules run before
+ * archiving so an expired row never reaches a segment.
+ */
+void ChangeRetention::purge() {
+    Database db;
+    const QDateTime now = Clock::instance()->now();
+    int partitionsDropped = 0;
+
+    if (m_policy.partitionByMonth && db.partitionChangesByMonth(m_policy.partitionsAhead)) {
+        db.ensureChangePartitions(m_policy.partitionsAhead);
+        // Only months no rule still needs can go wholesale
+        const int longest = m_policy.longestDays();
+        if (longest > 0) {
+            partitionsDropped = std::max(0, db.dropChangePartitionsBefore(now.date().addDays(-longest)));
+        }
+    }
+
+    int deleted = 0;
+    QStringList overridden;
+    for (auto it = m_policy.perConfigDays.cbegin(); it != m_policy.perConfigDays.cend(); ++it) {
+        overridden << it.key();
+        if (it.value() > 0) {
+            ChangePurgeRule rule;
+            rule.cutoff     = now.addDays(-it.value());
+            rule.configName = it.key();
+            deleted += purgeRule(db, rule);
+        }
+    }
+
+    if (m_policy.maxAgeDays > 0) {
+        ChangePurgeRule rule;
+        rule.cutoff         = now.addDays(-m_policy.maxAgeDays);
+        rule.critical       = false;
+        rule.excludeConfigs = overridden;
+        deleted += purgeRule(db, rule);
+    }
+    if (m_policy.criticalMaxAgeDays > 0) {
+        ChangePurgeRule rule;
+        rule.cutoff         = now.addDays(-m_policy.criticalMaxAgeDays);
+        rule.critical       = true;
+        rule.excludeConfigs = overridden;
+        deleted += purgeRule(db, rule);
+    }
+
+    const int archived = archive(db, now);
+    const int segmentsDropped = expireSegments(now);
+
+    const int keyframes = purgeKeyframes(db, now);
+
+    MON_INFO(LogCategory::Database) << "[RETENTION] Purged" << deleted << "rows,"
+                                    << partitionsDropped << "partitions dropped,"
+                                    << archived << "rows archived,"
+                                    << segmentsDropped << "archive segments dropped,"
+                                    << keyframes << "keyframes released.";
+
+    QMetaObject::invokeMethod(this, [this, deleted, partitionsDropped, archived]() {
+        m_running = false;
+        emit runningChanged();
+        emit purgeFinished(deleted, partitionsDropped, archived);
+    }, Qt::QueuedConnection);
+}
+
+/**
+ * @brief Delete one rule's rows in chunks, pausing between them.
+ *
+ * Stops when a chunk comes back short, on error, or when shutting down.
+ */
+int ChangeRetention::purgeRule(Database &db, const ChangePurgeRule &rule) {
+    int total = 0;
+    while (!m_stopping) {
+        // Re-read per chunk so a long purge follows the resource governor
+        const int chunkSize = ResourceGovernor::batchSize(m_policy.chunkSize);
+        const int n = db.purgeChangesChunk(rule, chunkSize);
+        if (n <= 0) {
+            break;
+        }
+        total += n;
+        if (n < chunkSize) {
+            break;
+        }
+        QThread::msleep(ResourceGovernor::pauseMs(m_policy.chunkPauseMs));
+    }
+    return total;
+}
+
+/**
+ * @brief Delete value keyframes no remaining row refers to, in chunks.
+ *
+ * Keyframes younger than ValueHistory::kKeyframeGraceSecs are kept: a
+ * batch transaction may have written one and not yet committed the rows
+ * referring to it, and chains may still encode new rows against it.
+ */
+int ChangeRetention::purgeKeyframes(Database &db, const QDateTime &now) {
+    int total = 0;
+    while (!m_stopping) {
+        const int chunkSize = ResourceGovernor::batchSize(m_policy.chunkSize);
+        const int n = db.purgeOrphanKeyframes(now.addSecs(-ValueHistory::kKeyframeGraceSecs), chunkSize);
+        if (n <= 0) {
+            break;
+        }
+        total += n;
+        if (n < chunkSize) {
+            break;
+        }
+        QThread::msleep(ResourceGovernor::pauseMs(m_policy.chunkPauseMs));
+    }
+    return total;
+}
+
+/**
+ * @brief Move rows older than archiveAfterDays into archive segments.
+ *
+ * Rows are grouped by the rule that governs them, one segment per group,
+ * so each segment expires with its own rule. Each segment is written as
+ * pending, its rows are deleted from the table and only then is it
+ * committed. Pending segments found at the start of a pass were
+ * interrupted between those steps; deleting their ids again is harmless,
+ * so they are finished the same way.
+ */
+int ChangeRetention::archive(Database &db, const QDateTime &now) {
+    if (!m_archive || m_policy.archiveAfterDays <= 0) {
+        return 0;
+    }
+
+    for (const QString &pending : m_archive->pendingSegments()) {
+        const auto segment = ArchiveSegment::open(pending);
+        if (segment && db.deleteChangesById(segment->ids()) >= 0) {
+            m_archive->commit(pending);
+            MON_INFO(LogCategory::Database) << "[RETENTION] Recovered pending archive segment" << pending;
+        }
+    }
+
+    const QDateTime cutoff = now.addDays(-m_policy.archiveAfterDays);
+    int total = 0;
+    while (!m_stopping) {
+        const QVector<ChangeRow> rows = db.archiveCandidates(cutoff, m_policy.archiveSegmentRows);
+        if (rows.isEmpty()) {
+            break;
+        }
+
+        // Per-config rule by name, otherwise the critical or default rule
+        QMap<QString, QVector<ChangeRow>> byRule;
+        for (const ChangeRow &row : rows) {
+            const QString entry = ChangeRow::entryOf(row.configName);
+            const QString rule = m_policy.perConfigDays.contains(entry)
+                                     ? QStringLiteral("config:") + entry
+                                     : QString::fromLatin1(row.critical ? "critical" : "default");
+            byRule[rule].append(row);
+        }
+
+        for (const QVector<ChangeRow> &group : std::as_const(byRule)) {
+            const QString pending = m_archive->stage(group);
+            if (pending.isEmpty()) {
+                return total;
+            }
+            QVector<qint64> ids;
+            ids.reserve(group.size());
+            for (const ChangeRow &row : group) {
+                ids.append(row.id);
+            }
+            // Leave the pending file for the next pass if the delete fails
+            if (db.deleteChangesById(ids) < 0 || !m_archive->commit(pending)) {
+                return total;
+            }
+            total += group.size();
+        }
+        if (rows.size() < m_policy.archiveSegmentRows) {
+            break;
+        }
+        QThread::msleep(ResourceGovernor::pauseMs(m_policy.chunkPauseMs));
+    }
+    return total;
+}
+
+/**
+ * @brief Drop segments in which every row is past the rule governing it.
+ */
+int ChangeRetention::expireSegments(const QDateTime &now) {
+    if (!m_archive) {
+        return 0;
+    }
+    return m_archive->dropExpiredSegments([this, &now](const QString &configName, bool critical) {
+        const int days = m_policy.daysFor(configName, critical);
+        return days > 0 ? now.addDays(-days) : QDateTime();
+    });
+}
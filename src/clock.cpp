@@ -0,0 +1,256 @@
+#include "clock.h"
+#include <QMutexLocker>
+#include <algorithm>
+
+/**
+ * @file clock.cpp
+ * @brief SystemClock, VirtualClock and ClockTimer.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// Clock
+////////////////////////////////////////////////////////////////////////////////
+
+std::atomic<Clock *> Clock::s_instance{nullptr};
+
+Clock *Clock::instance() {
+    static SystemClock systemClock;
+    Clock *clock = s_instance.load(std::memory_order_acquire);
+    return clock ? clock : &systemClock;
+}
+
+void Clock::setInstance(Clock *clock) {
+    s_instance.store(clock, std::memory_order_release);
+}
+
+void Clock::fire(ClockTimer *timer) {
+    timer->expire();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// SystemClock
+////////////////////////////////////////////////////////////////////////////////
+
+QDateTime SystemClock::now() const {
+    return QDateTime::currentDateTime();
+}
+
+void SystemClock::singleShot(int ms, QObject *context, std::function<void()> fn) {
+    if (context) {
+        QTimer::singleShot(ms, context, std::move(fn));
+    } else {
+        QTimer::singleShot(ms, std::move(fn));
+    }
+}
+
+void SystemClock::arm(ClockTimer *timer, int ms, bool repeat) {
+    timer->m_systemTimer.setSingleShot(!repeat);
+    timer->m_systemTimer.start(ms);
+}
+
+void SystemClock::disarm(ClockTimer *timer) {
+    timer->m_systemTimer.stop();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// VirtualClock
+////////////////////////////////////////////////////////////////////////////////
+
+VirtualClock::VirtualClock(const QDateTime &start)
+    : m_nowMs(start.toMSecsSinceEpoch())
+{
+}
+
+QDateTime VirtualClock::now() const {
+    return QDateTime::fromMSecsSinceEpoch(m_nowMs.load(std::memory_order_acquire));
+}
+
+/**
+ * @brief Queue @p entry at @p dueMs; caller holds m_mutex.
+ */
+void VirtualClock::schedule(qint64 dueMs, Entry entry) {
+    const Key key{dueMs, m_sequence++};
+    if (entry.timer) {
+        m_timerKeys.insert(entry.timer, key);
+    }
+    m_queue.emplace(key, std::move(entry));
+}
+
+void VirtualClock::singleShot(int ms, QObject *context, std::function<void()> fn) {
+    Entry entry;
+    entry.hasContext = context != nullptr;
+    entry.context = context;
+    entry.fn = std::move(fn);
+
+    QMutexLocker locker(&m_mutex);
+    schedule(m_nowMs.load() + std::max(0, ms), std::move(entry));
+}
+
+void VirtualClock::arm(ClockTimer *timer, int ms, bool repeat) {
+    Entry entry;
+    entry.timer = timer;
+    entry.intervalMs = std::max(0, ms);
+    entry.repeat = repeat;
+
+    QMutexLocker locker(&m_mutex);
+    const auto existing = m_timerKeys.constFind(timer);
+    if (existing != m_timerKeys.cend()) {
+        m_queue.erase(*existing);
+        m_timerKeys.erase(existing);
+    }
+    schedule(m_nowMs.load() + entry.intervalMs, std::move(entry));
+}
+
+void VirtualClock::disarm(ClockTimer *timer) {
+    QMutexLocker locker(&m_mutex);
+    const auto existing = m_timerKeys.constFind(timer);
+    if (existing != m_timerKeys.cend()) {
+        m_queue.erase(*existing);
+        m_timerKeys.erase(existing);
+    }
+}
+
+/**
+ * @brief Run every expiry due within @p ms, earliest first.
+ *
+ * Each callback sees now() equal to its due time. Callbacks may schedule
+ * more work; anything that falls inside the step runs in the same call.
+ */
+void VirtualClock::advance(qint64 ms) {
+    const qint64 target = m_nowMs.load() + std::max<qint64>(0, ms);
+    for (;;) {
+        Entry entry;
+        {
+            QMutexLocker locker(&m_mutex);
+            const auto first = m_queue.begin();
+            if (first == m_queue.end() || first->first.first > target) {
+                break;
+            }
+            const qint64 due = first->first.first;
+            entry = std::move(first->second);
+            m_queue.erase(first);
+            m_nowMs.store(std::max(m_nowMs.load(), due), std::memory_order_release);
+
+            if (entry.timer) {
+                m_timerKeys.remove(entry.timer);
+                // Re-queue before firing so a stop() in the slot cancels it;
+                // a zero interval still advances so the loop terminates
+                if (entry.repeat) {
+                    Entry next;
+                    next.timer = entry.timer;
+                    next.intervalMs = entry.intervalMs;
+                    next.repeat = true;
+                    schedule(due + std::max(1, entry.intervalMs), std::move(next));
+                }
+            }
+        }
+
+        if (entry.timer) {
+            fire(entry.timer);
+        } else if (!entry.hasContext || entry.context) {
+            entry.fn();
+        }
+    }
+    m_nowMs.store(std::max(m_nowMs.load(), target), std::memory_order_release);
+}
+
+void VirtualClock::advanceTo(const QDateTime &time) {
+    advance(time.toMSecsSinceEpoch() - m_nowMs.load());
+}
+
+int VirtualClock::pendingCount() const {
+    QMutexLocker locker(&m_mutex);
+    return int(m_queue.size());
+}
+
+QDateTime VirtualClock::nextDue() const {
+    QMutexLocker locker(&m_mutex);
+    if (m_queue.empty()) {
+        return QDateTime();
+    }
+    return QDateTime::fromMSecsSinceEpoch(m_queue.begin()->first.first);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ClockTimer
+////////////////////////////////////////////////////////////////////////////////
+
+ClockTimer::ClockTimer(QObject *parent)
+    : QObject(parent)
+{
+    connect(&m_systemTimer, &QTimer::timeout, this, &ClockTimer::expire);
+}
+
+ClockTimer::~ClockTimer() {
+    if (m_clock) {
+        m_clock->disarm(this);
+    }
+}
+
+void ClockTimer::setInterval(int ms) {
+    if (m_interval == ms) {
+        return;
+    }
+    m_interval = ms;
+    emit intervalChanged();
+    // Like QTimer, a running timer restarts with the new interval
+    if (m_clock) {
+        start();
+    }
+}
+
+void ClockTimer::setSingleShot(bool singleShot) {
+    if (m_singleShot == singleShot) {
+        return;
+    }
+    m_singleShot = singleShot;
+    emit repeatChanged();
+    if (m_clock) {
+        start();
+    }
+}
+
+void ClockTimer::setRunning(bool running) {
+    if (running) {
+        start();
+    } else {
+        stop();
+    }
+}
+
+void ClockTimer::start(int ms) {
+    m_interval = ms;
+    start();
+}
+
+void ClockTimer::start() {
+    const bool wasActive = m_clock != nullptr;
+    if (m_clock) {
+        m_clock->disarm(this);
+    }
+    m_clock = Clock::instance();
+    m_clock->arm(this, m_interval, !m_singleShot);
+    if (!wasActive) {
+        emit runningChanged();
+    }
+}
+
+void ClockTimer::stop() {
+    if (!m_clock) {
+        return;
+    }
+    m_clock->disarm(this);
+    m_clock = nullptr;
+    emit runningChanged();
+}
+
+/**
+ * @brief One expiry from the clock: single shots stop first, then timeout().
+ */
+void ClockTimer::expire() {
+    if (m_singleShot && m_clock) {
+        m_clock = nullptr;
+        emit runningChanged();
+    }
+    emit timeout();
+}
@@ -0,0 +1,84 @@
+#include "configSource.h"
+#include "logger.h"
+
+#include <QBuffer>
+#include <QFile>
+
+/**
+ * @file configSource.cpp
+ * @brief File-backed and in-memory sources for the monitored-items list.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// ConfigSource
+////////////////////////////////////////////////////////////////////////////////
+
+std::unique_ptr<QIODevice> ConfigSource::open() const {
+    auto buffer = std::make_unique<QBuffer>();
+    buffer->setData(read());
+    buffer->open(QIODevice::ReadOnly);
+    return buffer;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// FileConfigSource
+////////////////////////////////////////////////////////////////////////////////
+
+FileConfigSource::FileConfigSource(const QString &path, QObject *parent)
+    : ConfigSource(parent)
+    , m_path(path)
+{
+    if (QFile::exists(m_path)) {
+        m_watcher.addPath(m_path);
+        MON_DEBUG(LogCategory::Monitoring) << "[CONFIG SOURCE] Watching JSON config:" << m_path;
+    } else {
+        MON_WARN(LogCategory::Monitoring) << "[CONFIG SOURCE] JSON file not found:" << m_path;
+    }
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged,
+            this, &FileConfigSource::onFileChanged);
+}
+
+bool FileConfigSource::isAvailable() const {
+    return QFile::exists(m_path);
+}
+
+QByteArray FileConfigSource::read() const {
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        MON_WARN(LogCategory::Monitoring) << "[CONFIG SOURCE] Could not open JSON file:" << m_path;
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+std::unique_ptr<QIODevice> FileConfigSource::open() const {
+    auto file = std::make_unique<QFile>(m_path);
+    if (!file->open(QIODevice::ReadOnly)) {
+        MON_WARN(LogCategory::Monitoring) << "[CONFIG SOURCE] Could not open JSON file:" << m_path;
+        return nullptr;
+    }
+    return file;
+}
+
+void FileConfigSource::onFileChanged(const QString &path) {
+    MON_DEBUG(LogCategory::Monitoring) << "[FILE WATCHER] JSON changed:" << path;
+    emit changed();
+    if (!m_watcher.files().contains(path) && QFile::exists(path)) {
+        m_watcher.addPath(path);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MemoryConfigSource
+////////////////////////////////////////////////////////////////////////////////
+
+MemoryConfigSource::MemoryConfigSource(const QByteArray &content, QObject *parent)
+    : ConfigSource(parent)
+    , m_content(content)
+{
+}
+
+void MemoryConfigSource::setContent(const QByteArray &content) {
+    m_content = content;
+    emit changed();
+}
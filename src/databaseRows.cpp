@@ -0,0 +1,229 @@
+#include "databaseRows.h"
+#include "encryptionUtils.h"
+#include "resourceGovernor.h"
+#include "valueHistory.h"
+#include <QSemaphore>
+#include <QSqlQuery>
+#include <QThreadPool>
+#include <algorithm>
+#include <vector>
+
+/**
+ * @file databaseRows.cpp
+ * @brief Positional decoders and QML conversions for Database result rows.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// ChangeRow
+////////////////////////////////////////////////////////////////////////////////
+
+ChangeRow ChangeRow::decode(const QSqlQuery &query) {
+    ChangeRow row;
+    row.id           = query.value(Id).toLongLong();
+    row.configName   = query.value(ConfigName).toString();
+    // Stored as base64(encrypt()); undo the outer layer only
+    row.oldCipher    = QByteArray::fromBase64(query.value(OldValue).toByteArray());
+    row.newCipher    = QByteArray::fromBase64(query.value(NewValue).toByteArray());
+    row.acknowledged = query.value(Acknowledged).toBool();
+    row.critical     = query.value(Critical).toBool();
+    row.timestamp    = query.value(Timestamp).toDateTime();
+    return row;
+}
+
+QVariantMap ChangeRow::toVariantMap() const {
+    QVariantMap map;
+    map.insert(QStringLiteral("id"),           id);
+    map.insert(QStringLiteral("config_name"),  configName);
+    map.insert(QStringLiteral("old_value"),    oldValue);
+    map.insert(QStringLiteral("new_value"),    newValue);
+    map.insert(QStringLiteral("acknowledged"), acknowledged);
+    map.insert(QStringLiteral("critical"),     critical);
+    map.insert(QStringLiteral("timestamp"),    timestamp);
+    return map;
+}
+
+QString ChangeRow::leafConfigName(const QString &entryName, const QString &filePath,
+                                  const QString &keyPath) {
+    return entryName + kLeafSeparator + filePath + kLeafSeparator + keyPath;
+}
+
+QString ChangeRow::entryOf(const QString &configName) {
+    const int separator = configName.indexOf(kLeafSeparator);
+    return separator < 0 ? configName : configName.left(separator);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ConfigRow
+////////////////////////////////////////////////////////////////////////////////
+
+ConfigRow ConfigRow::decode(const QSqlQuery &query) {
+    ConfigRow row;
+    row.id          = query.value(Id).toLongLong();
+    row.configName  = query.value(ConfigName).toString();
+    row.configPath  = query.value(ConfigPath).toString();
+    row.configValue = query.value(ConfigValue).toByteArray();
+    row.isCritical  = query.value(IsCritical).toBool();
+    row.timestamp   = query.value(Timestamp).toDateTime();
+    return row;
+}
+
+QVariantMap ConfigRow::toVariantMap() const {
+    QVariantMap map;
+    map.insert(QStringLiteral("id"),           id);
+    map.insert(QStringLiteral("config_name"),  configName);
+    map.insert(QStringLiteral("config_path"),  configPath);
+    map.insert(QStringLiteral("config_value"), QString::fromLatin1(configValue));   // Stored base64 text
+    map.insert(QStringLiteral("is_critical"),  isCritical);
+    map.insert(QStringLiteral("timestamp"),    timestamp);
+    return map;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// UserRow
+////////////////////////////////////////////////////////////////////////////////
+
+UserRow UserRow::decode(const QSqlQuery &query) {
+    UserRow row;
+    row.id        = query.value(Id).toLongLong();
+    row.email     = EncryptionUtils::decrypt(QByteArray::fromBase64(query.value(Email).toByteArray()));
+    row.phone     = EncryptionUtils::decrypt(QByteArray::fromBase64(query.value(Phone).toByteArray()));
+    row.threshold = query.value(Threshold).toInt();
+    row.timestamp = query.value(Timestamp).toDateTime();
+    return row;
+}
+
+QVariantMap UserRow::toVariantMap() const {
+    QVariantMap map;
+    map.insert(QStringLiteral("id"),        id);
+    map.insert(QStringLiteral("email"),     email);
+    map.insert(QStringLiteral("phone"),     phone);
+    map.insert(QStringLiteral("threshold"), threshold);
+    map.insert(QStringLiteral("timestamp"), timestamp);
+    return map;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ChangeCountRow
+////////////////////////////////////////////////////////////////////////////////
+
+ChangeCountRow ChangeCountRow::decode(const QSqlQuery &query) {
+    ChangeCountRow row;
+    row.date       = query.value(Date).toString();
+    row.configName = query.value(ConfigName).toString();
+    row.count      = query.value(Count).toInt();
+    return row;
+}
+
+QVariantMap ChangeCountRow::toVariantMap() const {
+    QVariantMap map;
+    map.insert(QStringLiteral("date"),        date);
+    map.insert(QStringLiteral("config_name"), configName);
+    map.insert(QStringLiteral("count"),       count);
+    return map;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decryption
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/// Stored ciphers of [begin, end), old and new value per row.
+QList<QByteArray> ciphersOf(const ChangeRow *begin, const ChangeRow *end) {
+    QList<QByteArray> cipher;
+    cipher.reserve(2 * int(end - begin));
+    for (const ChangeRow *row = begin; row != end; ++row) {
+        cipher.append(row->oldCipher);
+        cipher.append(row->newCipher);
+    }
+    return cipher;
+}
+
+void assignValues(ChangeRow *begin, ChangeRow *end, const QStringList &values) {
+    int i = 0;
+    for (ChangeRow *row = begin; row != end; ++row) {
+        row->oldValue = values.value(i++);
+        row->newValue = values.value(i++);
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Decrypt the old/new values of [begin, end) with one batch call.
+ */
+void DatabaseRows::decryptValues(ChangeRow *begin, ChangeRow *end) {
+    const QList<QByteArray> plain = EncryptionUtils::decryptBatchBytes(ciphersOf(begin, end));
+    assignValues(begin, end, ValueHistory::decode(plain));
+}
+
+/**
+ * @brief Split [begin, end) into one chunk per pool thread and decrypt them concurrently.
+ *
+ * Chunks write to disjoint rows, so no locking is needed. The resource
+ * governor may cap the number of chunks below the pool's thread count.
+ *
+ * Pool threads hold no database connection, so keyframes for delta-encoded
+ * values are fetched on the calling thread: chunks without deltas finish in
+ * the first round, the others are rebuilt in a second one.
+ */
+void DatabaseRows::decryptValuesParallel(QThreadPool &pool, ChangeRow *begin, ChangeRow *end, int minChunk) {
+    const int n = int(end - begin);
+    if (n <= 0) {
+        return;
+    }
+
+    const int workers = ResourceGovernor::workers(std::max(1, pool.maxThreadCount()));
+    const int chunks = std::min(workers, (n + minChunk - 1) / std::max(1, minChunk));
+    if (chunks <= 1) {
+        decryptValues(begin, end);
+        return;
+    }
+
+    struct Chunk {
+        int               from = 0;
+        int               to = 0;
+        QList<QByteArray> plain;      ///< Kept only while deltas await their keyframes
+    };
+    const int step = (n + chunks - 1) / chunks;
+    std::vector<Chunk> parts;
+    for (int from = 0; from < n; from += step) {
+        parts.push_back(Chunk{from, std::min(n, from + step), {}});
+    }
+
+    QSemaphore done;
+    for (Chunk &part : parts) {
+        pool.start([begin, &done, &part]() {
+            QList<QByteArray> plain = EncryptionUtils::decryptBatchBytes(
+                ciphersOf(begin + part.from, begin + part.to));
+            if (std::any_of(plain.cbegin(), plain.cend(), &ValueHistory::isDelta)) {
+                part.plain = std::move(plain);
+            } else {
+                assignValues(begin + part.from, begin + part.to, ValueHistory::decode(plain, {}));
+            }
+            done.release();
+        });
+    }
+    done.acquire(int(parts.size()));
+
+    QList<QByteArray> deltas;
+    for (const Chunk &part : parts) {
+        deltas.append(part.plain);
+    }
+    if (deltas.isEmpty()) {
+        return;
+    }
+    const QHash<qint64, QByteArray> keyframes = ValueHistory::keyframesFor(deltas);
+    int launched = 0;
+    for (Chunk &part : parts) {
+        if (part.plain.isEmpty()) {
+            continue;
+        }
+        pool.start([begin, &done, &part, &keyframes]() {
+            assignValues(begin + part.from, begin + part.to, ValueHistory::decode(part.plain, keyframes));
+            done.release();
+        });
+        ++launched;
+    }
+    done.acquire(launched);
+}
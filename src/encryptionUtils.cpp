@@ -1,4 +1,6 @@
 #include "EncryptionUtils.h"
+#include "logger.h"
+#include "trace.h"
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -6,6 +8,7 @@
 #include <QDir>
 #include <QCoreApplication>
 #include <QDebug>
+#include <QMutexLocker>
 #include <openssl/evp.h>
 #include <openssl/rand.h>
 
@@ -25,6 +28,9 @@ QDateTime EncryptionUtils::lastKeyFileModified;
 /** QFileSystemWatcher to monitor key-file changes at runtime */
 QFileSystemWatcher* EncryptionUtils::keyFileWatcher = nullptr;
 
+/** Guards key, IV and timestamp; encrypt/decrypt also run on lane workers */
+QMutex EncryptionUtils::keyMutex;
+
 //------------------------------------------------------------------------------
 // Helper: Determine JSON key-file path
 //------------------------------------------------------------------------------
@@ -33,12 +39,18 @@ QFileSystemWatcher* EncryptionUtils::keyFileWatcher = nullptr;
  * @brief Determine the absolute path to encryptionKeys.json.
  *
  * Uses a relative path under the app bundle’s resources directory,
- * with a special prefix on macOS vs. other platforms.
+ * with a special prefix on macOS vs. other platforms, unless
+ * MONITOR_ENCRYPTION_KEYS names a file.
  *
  * @return Cleaned absolute file path as QString.
  */
 QString EncryptionUtils::resolveEncryptionKeysPath()
 {
+    // Bench and soak runs bring their own throwaway keys
+    const QString overridePath = qEnvironmentVariable("MONITOR_ENCRYPTION_KEYS");
+    if (!overridePath.isEmpty()) {
+        return overridePath;
+    }
 #ifdef Q_OS_MAC
     return QDir::cleanPath(
         QCoreApplication::applicationDirPath() +
@@ -67,11 +79,17 @@ void EncryptionUtils::maybeReloadKeys()
     QString filePath = resolveEncryptionKeysPath();
     QFileInfo fileInfo(filePath);
 
+    QDateTime loadedAt;
+    {
+        QMutexLocker locker(&keyMutex);
+        loadedAt = lastKeyFileModified;
+    }
+
     // If we've never loaded keys or the file has been modified, reload.
-    if (!lastKeyFileModified.isValid() ||
-        fileInfo.lastModified() > lastKeyFileModified)
+    if (!loadedAt.isValid() ||
+        fileInfo.lastModified() > loadedAt)
     {
-        qDebug() << "[EncryptionUtils] Key file changed; reloading...";
+        MON_DEBUG(LogCategory::Crypto) << "[EncryptionUtils] Key file changed; reloading...";
         loadEncryptionKeys(filePath);
     }
 }
@@ -92,11 +110,11 @@ void EncryptionUtils::loadEncryptionKeys(const QString &filePath)
 {
     QFile file(filePath);
     if (!file.exists()) {
-        qWarning() << "[EncryptionUtils] Key file not found:" << filePath;
+        MON_WARN(LogCategory::Crypto) << "[EncryptionUtils] Key file not found:" << filePath;
         return;
     }
     if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "[EncryptionUtils] Cannot open key file:" << filePath;
+        MON_WARN(LogCategory::Crypto) << "[EncryptionUtils] Cannot open key file:" << filePath;
         return;
     }
 
@@ -107,7 +125,7 @@ void EncryptionUtils::loadEncryptionKeys(const QString &filePath)
 
     // Validate fields
     if (!obj.contains("key") || !obj.contains("iv")) {
-        qWarning() << "[EncryptionUtils] JSON missing 'key' or 'iv':" << filePath;
+        MON_WARN(LogCategory::Crypto) << "[EncryptionUtils] JSON missing 'key' or 'iv':" << filePath;
         return;
     }
 
@@ -119,22 +137,23 @@ void EncryptionUtils::loadEncryptionKeys(const QString &filePath)
 
     // Validate lengths
     if (newKey.size() != 32) {
-        qWarning() << "[EncryptionUtils] AES-256 key must be 32 bytes, got"
+        MON_WARN(LogCategory::Crypto) << "[EncryptionUtils] AES-256 key must be 32 bytes, got"
                    << newKey.size();
         return;
     }
     if (newIv.size() != 16) {
-        qWarning() << "[EncryptionUtils] AES-CBC IV must be 16 bytes, got"
+        MON_WARN(LogCategory::Crypto) << "[EncryptionUtils] AES-CBC IV must be 16 bytes, got"
                    << newIv.size();
         return;
     }
 
     // Assign and record timestamp
+    QMutexLocker locker(&keyMutex);
     encryptionKey       = newKey;
     encryptionIv        = newIv;
     lastKeyFileModified = QFileInfo(filePath).lastModified();
 
-    qDebug() << "[EncryptionUtils] Loaded key & IV from:" << filePath;
+    MON_DEBUG(LogCategory::Crypto) << "[EncryptionUtils] Loaded key & IV from:" << filePath;
 }
 
 //------------------------------------------------------------------------------
@@ -160,7 +179,7 @@ void EncryptionUtils::initialize()
         QObject::connect(keyFileWatcher,
                          &QFileSystemWatcher::fileChanged,
                          [=](const QString &changedPath) {
-                             qDebug() << "[EncryptionUtils] Watcher detected change, reloading keys...";
+                             MON_DEBUG(LogCategory::Crypto) << "[EncryptionUtils] Watcher detected change, reloading keys...";
                              loadEncryptionKeys(changedPath);
                              // Re-add path if watcher dropped it
                              if (!keyFileWatcher->files().contains(changedPath)) {
@@ -184,28 +203,48 @@ void EncryptionUtils::initialize()
  */
 QByteArray EncryptionUtils::encrypt(const QString &data)
 {
+    return encryptBytes(data.toUtf8());
+}
+
+/**
+ * @brief AES-256-CBC encrypt raw bytes, output as base64.
+ *
+ * @param data Plaintext bytes to encrypt.
+ * @return Base64-encoded ciphertext QByteArray, or empty on failure.
+ */
+QByteArray EncryptionUtils::encryptBytes(const QByteArray &data)
+{
+    MON_SPAN(LogCategory::Crypto, "crypto.encrypt");
     if (data.isEmpty()) {
-        qWarning() << "[EncryptionUtils] Empty input; nothing to encrypt.";
+        MON_DEBUG_EVERY(LogCategory::Crypto, 60000) << "[EncryptionUtils] Empty input; nothing to encrypt.";
         return {};
     }
 
     // Reload keys if needed
     maybeReloadKeys();
 
+    // Take a consistent snapshot of key/IV
+    QByteArray key, iv;
+    {
+        QMutexLocker locker(&keyMutex);
+        key = encryptionKey;
+        iv  = encryptionIv;
+    }
+
     // Ensure key/IV are loaded
-    if (encryptionKey.isEmpty() || encryptionIv.isEmpty()) {
-        qWarning() << "[EncryptionUtils] Key/IV not set; abort encrypt.";
+    if (key.isEmpty() || iv.isEmpty()) {
+        MON_WARN(LogCategory::Crypto) << "[EncryptionUtils] Key/IV not set; abort encrypt.";
         return {};
     }
 
-    QByteArray input  = data.toUtf8();
+    const QByteArray &input = data;
     // Allocate output buffer: input + one block for padding
     QByteArray output(input.size() + EVP_CIPHER_block_size(EVP_aes_256_cbc()), 0);
 
     // Create OpenSSL context
     EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
     if (!ctx) {
-        qWarning() << "[EncryptionUtils] Failed to create EVP context.";
+        MON_WARN(LogCategory::Crypto) << "[EncryptionUtils] Failed to create EVP context.";
         return {};
     }
 
@@ -213,10 +252,10 @@ QByteArray EncryptionUtils::encrypt(const QString &data)
     if (!EVP_EncryptInit_ex(ctx,
                             EVP_aes_256_cbc(),
                             nullptr,
-                            reinterpret_cast<const unsigned char*>(encryptionKey.data()),
-                            reinterpret_cast<const unsigned char*>(encryptionIv.data())))
+                            reinterpret_cast<const unsigned char*>(key.data()),
+                            reinterpret_cast<const unsigned char*>(iv.data())))
     {
-        qWarning() << "[EncryptionUtils] EVP_EncryptInit_ex failed.";
+        MON_WARN(LogCategory::Crypto) << "[EncryptionUtils] EVP_EncryptInit_ex failed.";
         EVP_CIPHER_CTX_free(ctx);
         return {};
     }
@@ -230,7 +269,7 @@ QByteArray EncryptionUtils::encrypt(const QString &data)
                            reinterpret_cast<const unsigned char*>(input.data()),
                            input.size()))
     {
-        qWarning() << "[EncryptionUtils] EVP_EncryptUpdate failed.";
+        MON_WARN(LogCategory::Crypto) << "[EncryptionUtils] EVP_EncryptUpdate failed.";
         EVP_CIPHER_CTX_free(ctx);
         return {};
     }
@@ -241,7 +280,7 @@ QByteArray EncryptionUtils::encrypt(const QString &data)
                              reinterpret_cast<unsigned char*>(output.data()) + totalLen,
                              &len))
     {
-        qWarning() << "[EncryptionUtils] EVP_EncryptFinal_ex failed.";
+        MON_WARN(LogCategory::Crypto) << "[EncryptionUtils] EVP_EncryptFinal_ex failed.";
         EVP_CIPHER_CTX_free(ctx);
         return {};
     }
@@ -255,51 +294,35 @@ QByteArray EncryptionUtils::encrypt(const QString &data)
 }
 
 //------------------------------------------------------------------------------
-// Public: Decrypt base64-encoded ciphertext to plaintext QString
+// Helper: Decrypt one value with a caller-owned context
 //------------------------------------------------------------------------------
 
+namespace {
+
 /**
- * @brief AES-256-CBC decrypt base64-encoded data to QString.
+ * @brief AES-256-CBC decrypt one base64 value using an existing EVP context.
  *
- * Automatically reloads keys if the file has changed.
+ * The context is re-initialised here, so a batch can reuse one context
+ * instead of allocating per value.
  *
- * @param encryptedData Base64-encoded ciphertext QByteArray.
- * @return Decrypted UTF-8 QString, or empty on failure.
+ * @return Decrypted bytes, or empty on failure.
  */
-QString EncryptionUtils::decrypt(const QByteArray &encryptedData)
+QByteArray decryptWithContext(EVP_CIPHER_CTX *ctx,
+                              const QByteArray &key,
+                              const QByteArray &iv,
+                              const QByteArray &encryptedData)
 {
-    if (encryptedData.isEmpty()) {
-        qWarning() << "[EncryptionUtils] Empty input; cannot decrypt.";
-        return {};
-    }
-
-    // Reload keys if needed
-    maybeReloadKeys();
-
-    // Ensure key/IV are loaded
-    if (encryptionKey.isEmpty() || encryptionIv.isEmpty()) {
-        qWarning() << "[EncryptionUtils] Key/IV not set; abort decrypt.";
-        return {};
-    }
-
     // Decode from base64
     QByteArray cipher = QByteArray::fromBase64(encryptedData);
     QByteArray output(cipher.size() + EVP_CIPHER_block_size(EVP_aes_256_cbc()), 0);
 
-    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
-    if (!ctx) {
-        qWarning() << "[EncryptionUtils] Failed to create EVP context.";
-        return {};
-    }
-
     if (!EVP_DecryptInit_ex(ctx,
                             EVP_aes_256_cbc(),
                             nullptr,
-                            reinterpret_cast<const unsigned char*>(encryptionKey.data()),
-                            reinterpret_cast<const unsigned char*>(encryptionIv.data())))
+                            reinterpret_cast<const unsigned char*>(key.data()),
+                            reinterpret_cast<const unsigned char*>(iv.data())))
     {
-        qWarning() << "[EncryptionUtils] EVP_DecryptInit_ex failed.";
-        EVP_CIPHER_CTX_free(ctx);
+        MON_WARN(LogCategory::Crypto) << "[EncryptionUtils] EVP_DecryptInit_ex failed.";
         return {};
     }
 
@@ -312,8 +335,7 @@ QString EncryptionUtils::decrypt(const QByteArray &encryptedData)
                            reinterpret_cast<const unsigned char*>(cipher.data()),
                            cipher.size()))
     {
-        qWarning() << "[EncryptionUtils] EVP_DecryptUpdate failed.";
-        EVP_CIPHER_CTX_free(ctx);
+        MON_WARN(LogCategory::Crypto) << "[EncryptionUtils] EVP_DecryptUpdate failed.";
         return {};
     }
     totalLen += len;
@@ -323,15 +345,124 @@ QString EncryptionUtils::decrypt(const QByteArray &encryptedData)
                              reinterpret_cast<unsigned char*>(output.data()) + totalLen,
                              &len))
     {
-        qWarning() << "[EncryptionUtils] EVP_DecryptFinal_ex failed: possible bad key/data.";
-        EVP_CIPHER_CTX_free(ctx);
+        MON_WARN(LogCategory::Crypto) << "[EncryptionUtils] EVP_DecryptFinal_ex failed: possible bad key/data.";
         return {};
     }
     totalLen += len;
     output.resize(totalLen);
+    return output;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+// Public: Decrypt base64-encoded ciphertext to plaintext QString
+//------------------------------------------------------------------------------
 
+/**
+ * @brief AES-256-CBC decrypt base64-encoded data to QString.
+ *
+ * Automatically reloads keys if the file has changed.
+ *
+ * @param encryptedData Base64-encoded ciphertext QByteArray.
+ * @return Decrypted UTF-8 QString, or empty on failure.
+ */
+QString EncryptionUtils::decrypt(const QByteArray &encryptedData)
+{
+    MON_SPAN(LogCategory::Crypto, "crypto.decrypt");
+    if (encryptedData.isEmpty()) {
+        MON_DEBUG_EVERY(LogCategory::Crypto, 60000) << "[EncryptionUtils] Empty input; cannot decrypt.";
+        return {};
+    }
+
+    // Reload keys if needed
+    maybeReloadKeys();
+
+    // Take a consistent snapshot of key/IV
+    QByteArray key, iv;
+    {
+        QMutexLocker locker(&keyMutex);
+        key = encryptionKey;
+        iv  = encryptionIv;
+    }
+
+    // Ensure key/IV are loaded
+    if (key.isEmpty() || iv.isEmpty()) {
+        MON_WARN(LogCategory::Crypto) << "[EncryptionUtils] Key/IV not set; abort decrypt.";
+        return {};
+    }
+
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    if (!ctx) {
+        MON_WARN(LogCategory::Crypto) << "[EncryptionUtils] Failed to create EVP context.";
+        return {};
+    }
+
+    const QString plaintext = QString::fromUtf8(decryptWithContext(ctx, key, iv, encryptedData));
     EVP_CIPHER_CTX_free(ctx);
+    return plaintext;
+}
+
+//------------------------------------------------------------------------------
+// Public: Decrypt many values with one key snapshot and one context
+//------------------------------------------------------------------------------
+
+/**
+ * @brief AES-256-CBC decrypt a batch of base64-encoded values.
+ *
+ * Checks for a key reload and snapshots key/IV once, then reuses a single
+ * EVP context for every value. Safe to call concurrently from several
+ * threads on disjoint batches.
+ *
+ * @param encryptedData Base64-encoded ciphertexts.
+ * @return Plaintexts in the same order; empty entries for empty or undecryptable input.
+ */
+QStringList EncryptionUtils::decryptBatch(const QList<QByteArray> &encryptedData)
+{
+    QStringList plaintexts;
+    plaintexts.reserve(encryptedData.size());
+    for (const QByteArray &bytes : decryptBatchBytes(encryptedData)) {
+        plaintexts.append(QString::fromUtf8(bytes));
+    }
+    return plaintexts;
+}
+
+/**
+ * @brief decryptBatch() returning the plaintext bytes as they were encrypted.
+ */
+QList<QByteArray> EncryptionUtils::decryptBatchBytes(const QList<QByteArray> &encryptedData)
+{
+    MON_SPAN(LogCategory::Crypto, "crypto.decryptBatch");
+    QList<QByteArray> plaintexts;
+    plaintexts.reserve(encryptedData.size());
+    if (encryptedData.isEmpty()) {
+        return plaintexts;
+    }
+
+    maybeReloadKeys();
+
+    QByteArray key, iv;
+    {
+        QMutexLocker locker(&keyMutex);
+        key = encryptionKey;
+        iv  = encryptionIv;
+    }
 
-    // Convert decrypted bytes to QString
-    return QString::fromUtf8(output);
+    EVP_CIPHER_CTX *ctx = nullptr;
+    if (key.isEmpty() || iv.isEmpty()) {
+        MON_WARN(LogCategory::Crypto) << "[EncryptionUtils] Key/IV not set; abort batch decrypt.";
+    } else if (!(ctx = EVP_CIPHER_CTX_new())) {
+        MON_WARN(LogCategory::Crypto) << "[EncryptionUtils] Failed to create EVP context.";
+    }
+
+    for (const QByteArray &value : encryptedData) {
+        plaintexts.append(ctx && !value.isEmpty()
+                              ? decryptWithContext(ctx, key, iv, value)
+                              : QByteArray());
+    }
+
+    if (ctx) {
+        EVP_CIPHER_CTX_free(ctx);
+    }
+    return plaintexts;
 }
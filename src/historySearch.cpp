@@ -0,0 +1,203 @@
+#include "historySearch.h"
+#include "Database.h"
+#include "logger.h"
+#include <QElapsedTimer>
+#include <QMetaObject>
+#include <QPointer>
+#include <QThread>
+#include <algorithm>
+
+/**
+ * @file historySearch.cpp
+ * @brief Implements off-thread, paged, batch-decrypted change-history search.
+ */
+
+namespace {
+// Target wall time for fetching + decrypting one page
+constexpr qint64 kPageBudgetMs = 50;
+constexpr int    kMinPageSize  = 32;
+constexpr int    kMaxPageSize  = 4096;
+constexpr int    kFirstPage    = 128;
+// Below this many rows a page is decrypted on the query thread
+constexpr int    kMinChunk     = 64;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Constructor / Destructor
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Construct the search service and its worker pools.
+ * @param parent Optional QObject parent for ownership.
+ */
+HistorySearch::HistorySearch(QObject *parent)
+    : QObject(parent)
+{
+    // Keep the query thread alive so its DB connection is reused across searches
+    m_queryPool.setMaxThreadCount(1);
+    m_queryPool.setExpiryTimeout(-1);
+    m_decryptPool.setMaxThreadCount(std::max(1, QThread::idealThreadCount()));
+}
+
+HistorySearch::~HistorySearch() {
+    shutdown();
+}
+
+/**
+ * @brief Cancel any running search, drop the query thread's connection and
+ * wait for the workers to drain.
+ *
+ * main() calls this before stopping the logger the workers write to.
+ */
+void HistorySearch::shutdown() {
+    ++m_generation;
+    m_queryPool.start([]() { Database::releaseThreadConnection(); });
+    m_queryPool.waitForDone();
+    m_decryptPool.waitForDone();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Public API
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Start a new search, superseding any search still running.
+ * @return Identifier of this search, echoed by the signals.
+ */
+int HistorySearch::search(const QString &start,
+                          const QString &end,
+                          const QString &configName,
+                          const QVariant &ackFilter,
+                          const QVariant &criticalFilter)
+{
+    const quint64 generation = ++m_generation;
+    m_activeId = int(generation);
+    setBusy(true);
+    emit searchStarted(int(generation));
+
+    m_queryPool.start([this, generation, start, end, configName, ackFilter, criticalFilter]() {
+        runQuery(generation, start, end, configName, ackFilter, criticalFilter);
+    });
+    return int(generation);
+}
+
+/**
+ * @brief Abandon the running search; already-queued pages are dropped.
+ */
+void HistorySearch::cancel() {
+    ++m_generation;
+    if (m_busy) {
+        setBusy(false);
+        emit searchFinished(m_activeId, 0, true);
+    }
+}
+
+void HistorySearch::setBusy(bool busy) {
+    if (m_busy != busy) {
+        m_busy = busy;
+        emit busyChanged();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Worker side
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Stream rows, decrypt them page by page and hand pages to the GUI thread.
+ *
+ * Page size is halved when a page overruns the latency budget and doubled
+ * when it finishes well inside it.
+ */
+void HistorySearch::runQuery(quint64 generation,
+                             const QString &start,
+                             const QString &end,
+                             const QString &configName,
+                             const QVariant &ackFilter,
+                             const QVariant &criticalFilter)
+{
+    if (!isCurrent(generation)) {
+        return;
+    }
+
+    QPointer<HistorySearch> self(this);
+    auto deliver = [self, generation](QVariantList rows) {
+        QMetaObject::invokeMethod(self, [self, generation, rows = std::move(rows)]() {
+            if (self && self->isCurrent(generation)) {
+                emit self->pageReady(int(generation), rows);
+            }
+        }, Qt::QueuedConnection);
+    };
+
+    int pageSize = kFirstPage;
+    int total = 0;
+    QVector<ChangeRow> page;
+    page.reserve(pageSize);
+    QElapsedTimer pageTimer;
+    pageTimer.start();
+
+    auto flushPage = [&]() {
+        decryptPage(page);
+        total += page.size();
+        // Rows become QVariantMaps only here, on their way to QML
+        deliver(DatabaseRows::toVariantList(page));
+        page.clear();
+
+        const qint64 spent = pageTimer.elapsed();
+        if (spent > kPageBudgetMs) {
+            pageSize = std::max(kMinPageSize, pageSize / 2);
+        } else if (spent < kPageBudgetMs / 2) {
+            pageSize = std::min(kMaxPageSize, pageSize * 2);
+        }
+        page.reserve(pageSize);
+        pageTimer.restart();
+    };
+
+    bool ok = false;
+    {
+        Database db;
+        ok = db.forEachChangeInRange(start, end, configName, ackFilter, criticalFilter,
+                                     [&](ChangeRow &&row) {
+            if (!isCurrent(generation)) {
+                return false;
+            }
+            page.append(std::move(row));
+            if (page.size() >= pageSize) {
+                flushPage();
+            }
+            return true;
+        });
+    }
+
+    const bool cancelled = !isCurrent(generation);
+    if (!cancelled && !page.isEmpty()) {
+        flushPage();
+    }
+    if (!ok) {
+        MON_WARN(LogCategory::Database) << "[HISTORY] Search" << generation << "failed.";
+    }
+    MON_DEBUG(LogCategory::Database) << "[HISTORY] Search" << generation
+                                     << "rows:" << total << "cancelled:" << cancelled;
+
+    QMetaObject::invokeMethod(self, [self, generation, total]() {
+        if (self && self->isCurrent(generation)) {
+            self->setBusy(false);
+            emit self->searchFinished(int(generation), total, false);
+        }
+    }, Qt::QueuedConnection);
+}
+
+/**
+ * @brief Decrypt a page's old/new values in parallel chunks.
+ *
+ * Each chunk is one DatabaseRows::decryptValues() call, so the key is
+ * checked and the cipher context set up once per chunk rather than per
+ * value. Small pages are decrypted inline.
+ *
+ * @param rows Rows from Database::forEachChangeInRange(); updated in place.
+ */
+void HistorySearch::decryptPage(QVector<ChangeRow> &rows) {
+    // data() detaches once, so chunks write to disjoint elements of one buffer
+    ChangeRow *first = rows.data();
+    DatabaseRows::decryptValuesParallel(m_decryptPool, first, first + rows.size(), kMinChunk);
+}
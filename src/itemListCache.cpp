@@ -0,0 +1,618 @@
+#include "itemListCache.h"
+#include "configSource.h"
+#include "logger.h"
+#include "trace.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtEndian>
+#include <cstring>
+
+/**
+ * @file itemListCache.cpp
+ * @brief Streaming JSON reader and binary cache for monitored-item lists.
+ */
+
+namespace {
+
+const char    kMagic[4]    = {'M', 'I', 'L', '1'};
+const quint32 kVersion     = 1;
+// magic, version, entryCount, reserved, key, fileSize
+const int     kKeySize     = 32;
+const int     kHeaderSize  = 4 + 4 * 3 + kKeySize + 8;
+const quint8  kFlagCritical = 0x01;
+
+const int     kChunkSize   = 64 * 1024;
+const int     kMaxDepth    = 1024;     ///< Nesting limit, as QJsonDocument
+
+template <typename T>
+void putFixed(QByteArray &out, T value) {
+    const T le = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char *>(&le), sizeof(T));
+}
+
+template <typename T>
+T getFixed(const uchar *p) {
+    return qFromLittleEndian<T>(p);
+}
+
+void putString(QByteArray &out, const QString &text) {
+    const QByteArray utf8 = text.toUtf8();
+    putFixed<quint32>(out, quint32(utf8.size()));
+    out.append(utf8);
+}
+
+bool getString(const uchar *&p, const uchar *end, QString &text) {
+    if (end - p < 4) {
+        return false;
+    }
+    const quint32 length = getFixed<quint32>(p);
+    p += 4;
+    if (quint64(end - p) < length) {
+        return false;
+    }
+    text = QString::fromUtf8(reinterpret_cast<const char *>(p), qsizetype(length));
+    p += length;
+    return true;
+}
+
+void appendUtf8(QByteArray &out, char32_t code) {
+    if (code < 0x80) {
+        out.append(char(code));
+    } else if (code < 0x800) {
+        out.append(char(0xC0 | (code >> 6)));
+        out.append(char(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+        out.append(char(0xE0 | (code >> 12)));
+        out.append(char(0x80 | ((code >> 6) & 0x3F)));
+        out.append(char(0x80 | (code & 0x3F)));
+    } else {
+        out.append(char(0xF0 | (code >> 18)));
+        out.append(char(0x80 | ((code >> 12) & 0x3F)));
+        out.append(char(0x80 | ((code >> 6) & 0x3F)));
+        out.append(char(0x80 | (code & 0x3F)));
+    }
+}
+
+int hexValue(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool isValid(const ItemSpec &spec, const ItemListFormat &format) {
+    return !spec.path.isEmpty() && !spec.valueName.isEmpty()
+        && (!format.withHive || !spec.hive.isEmpty());
+}
+
+/// Hash seeded with the format, so a list is never read back with another layout.
+void seedKey(QCryptographicHash &hash, const ItemListFormat &format) {
+    hash.addData(QByteArrayView(kMagic, 4));
+    hash.addData(QByteArrayView(format.pathKey));
+    hash.addData(QByteArrayView(format.withHive ? "+hive" : "-hive"));
+}
+
+QString cacheDirectory() {
+    const QString configured = qEnvironmentVariable("MONITOR_ITEM_CACHE");
+    if (configured == QLatin1String("off")) {
+        return QString();
+    }
+    if (!configured.isEmpty()) {
+        return configured;
+    }
+    const QString base = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    return base.isEmpty() ? QString() : base + "/items";
+}
+
+bool readCache(const QString &filePath, const QByteArray &key, QVector<ItemSpec> &items) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const qint64 size = file.size();
+    if (size < kHeaderSize) {
+        return false;
+    }
+    const uchar *p = file.map(0, size);
+    if (!p) {
+        return false;
+    }
+    if (memcmp(p, kMagic, 4) != 0 || getFixed<quint32>(p + 4) != kVersion
+        || getFixed<quint64>(p + 16 + kKeySize) != quint64(size)) {
+        MON_WARN(LogCategory::Monitoring) << "[ITEM CACHE] Ignoring unknown or truncated cache" << filePath;
+        return false;
+    }
+    if (memcmp(p + 16, key.constData(), kKeySize) != 0) {
+        return false;   // The JSON changed since the cache was written
+    }
+
+    const quint32 count = getFixed<quint32>(p + 8);
+    const uchar *cursor = p + kHeaderSize;
+    const uchar *end = p + size;
+    items.clear();
+    items.reserve(int(qMin<quint64>(count, quint64(size - kHeaderSize))));
+    for (quint32 i = 0; i < count; ++i) {
+        ItemSpec spec;
+        if (cursor >= end) {
+            break;
+        }
+        spec.isCritical = (*cursor++ & kFlagCritical) != 0;
+        if (!getString(cursor, end, spec.hive) || !getString(cursor, end, spec.path)
+            || !getString(cursor, end, spec.valueName)) {
+            break;
+        }
+        items.append(std::move(spec));
+    }
+    if (quint32(items.size()) != count || cursor != end) {
+        MON_WARN(LogCategory::Monitoring) << "[ITEM CACHE] Corrupt cache" << filePath;
+        items.clear();
+        return false;
+    }
+    return true;
+}
+
+void writeCache(const QString &filePath, const QByteArray &key, const QVector<ItemSpec> &items) {
+    QByteArray out;
+    out.reserve(kHeaderSize + items.size() * 64);
+    out.append(kMagic, 4);
+    putFixed<quint32>(out, kVersion);
+    putFixed<quint32>(out, quint32(items.size()));
+    putFixed<quint32>(out, 0);
+    out.append(key);
+    putFixed<quint64>(out, 0);   // fileSize, patched below
+    for (const ItemSpec &spec : items) {
+        out.append(char(spec.isCritical ? kFlagCritical : 0));
+        putString(out, spec.hive);
+        putString(out, spec.path);
+        putString(out, spec.valueName);
+    }
+    const quint64 fileSize = qToLittleEndian(quint64(out.size()));
+    memcpy(out.data() + 16 + kKeySize, &fileSize, sizeof(fileSize));
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        MON_WARN(LogCategory::Monitoring) << "[ITEM CACHE] Cannot write" << filePath << ":" << file.errorString();
+        return;
+    }
+    file.write(out);
+    if (!file.commit()) {
+        MON_WARN(LogCategory::Monitoring) << "[ITEM CACHE] Failed to commit" << filePath << ":" << file.errorString();
+    }
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// ItemListReader
+////////////////////////////////////////////////////////////////////////////////
+
+ItemListReader::ItemListReader(QIODevice *device, const ItemListFormat &format,
+                               QCryptographicHash *hash)
+    : m_device(device)
+    , m_format(format)
+    , m_hash(hash)
+{
+}
+
+/// Refill the buffer once it is used up; false at end of input.
+bool ItemListReader::fill() {
+    if (m_pos < m_buffer.size()) {
+        return true;
+    }
+    m_offset += m_buffer.size();
+    m_buffer = m_device->read(kChunkSize);
+    m_pos = 0;
+    if (m_hash && !m_buffer.isEmpty()) {
+        m_hash->addData(m_buffer);
+    }
+    return !m_buffer.isEmpty();
+}
+
+int ItemListReader::peek() {
+    if (m_pos >= m_buffer.size() && !fill()) {
+        return -1;
+    }
+    return uchar(m_buffer.at(m_pos));
+}
+
+int ItemListReader::get() {
+    const int c = peek();
+    if (c >= 0) {
+        ++m_pos;
+    }
+    return c;
+}
+
+void ItemListReader::skipWhitespace() {
+    for (int c = peek(); c == ' ' || c == '\t' || c == '\n' || c == '\r'; c = peek()) {
+        ++m_pos;
+    }
+}
+
+bool ItemListReader::fail(const char *what) {
+    if (m_error.isEmpty()) {
+        m_error = QStringLiteral("%1 at offset %2").arg(QLatin1String(what)).arg(m_offset + m_pos);
+    }
+    return false;
+}
+
+/**
+ * @brief Read a string body; the opening quote has been consumed.
+ * @param utf8 Receives the decoded UTF-8 (appended), or nullptr to discard.
+ */
+bool ItemListReader::readString(QByteArray *utf8) {
+    for (;;) {
+        if (!fill()) {
+            return fail("unterminated string");
+        }
+        // Copy the run up to the next quote, escape or control character at once
+        const char *data = m_buffer.constData();
+        const int end = int(m_buffer.size());
+        int i = m_pos;
+        while (i < end) {
+            const uchar ch = uchar(data[i]);
+            if (ch == '"' || ch == '\\' || ch < 0x20) {
+                break;
+            }
+            ++i;
+        }
+        if (utf8) {
+            utf8->append(data + m_pos, i - m_pos);
+        }
+        m_pos = i;
+        if (i == end) {
+            continue;
+        }
+
+        const int ch = get();
+        if (ch == '"') {
+            return true;
+        }
+        if (ch != '\\') {
+            return fail("control character in string");
+        }
+        const int escape = get();
+        char32_t code = 0;
+        switch (escape) {
+        case '"': case '\\': case '/': code = char32_t(escape); break;
+        case 'b': code = '\b'; break;
+        case 'f': code = '\f'; break;
+        case 'n': code = '\n'; break;
+        case 'r': code = '\r'; break;
+        case 't': code = '\t'; break;
+        case 'u': {
+            auto readHex4 = [this](char32_t &out) {
+                out = 0;
+                for (int k = 0; k < 4; ++k) {
+                    const int digit = hexValue(get());
+                    if (digit < 0) {
+                        return false;
+                    }
+                    out = (out << 4) | char32_t(digit);
+                }
+                return true;
+            };
+            if (!readHex4(code)) {
+                return fail("invalid \\u escape");
+            }
+            if (code >= 0xD800 && code < 0xDC00 && peek() == '\\') {
+                // Surrogate pair
+                ++m_pos;
+                char32_t low = 0;
+                if (get() != 'u' || !readHex4(low)) {
+                    return fail("invalid \\u escape");
+                }
+                code = (low >= 0xDC00 && low < 0xE000)
+                           ? 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00)
+                           : 0xFFFD;
+            } else if (code >= 0xD800 && code < 0xE000) {
+                code = 0xFFFD;   // Lone surrogate
+            }
+            break;
+        }
+        default:
+            return fail("invalid escape");
+        }
+        if (utf8) {
+            appendUtf8(*utf8, code);
+        }
+    }
+}
+
+bool ItemListReader::readLiteral(const char *word) {
+    for (const char *c = word; *c; ++c) {
+        if (get() != uchar(*c)) {
+            return fail("invalid literal");
+        }
+    }
+    return true;
+}
+
+bool ItemListReader::readNumber() {
+    auto digits = [this]() {
+        int count = 0;
+        for (int c = peek(); c >= '0' && c <= '9'; c = peek()) {
+            ++m_pos;
+            ++count;
+        }
+        return count;
+    };
+    if (peek() == '-') {
+        ++m_pos;
+    }
+    if (peek() == '0') {
+        ++m_pos;
+    } else if (digits() == 0) {
+        return fail("invalid number");
+    }
+    if (peek() == '.') {
+        ++m_pos;
+        if (digits() == 0) {
+            return fail("invalid number");
+        }
+    }
+    if (peek() == 'e' || peek() == 'E') {
+        ++m_pos;
+        if (peek() == '+' || peek() == '-') {
+            ++m_pos;
+        }
+        if (digits() == 0) {
+            return fail("invalid number");
+        }
+    }
+    return true;
+}
+
+/// Validate and discard one value of any type.
+bool ItemListReader::skipValue(int depth) {
+    if (depth > kMaxDepth) {
+        return fail("document too deeply nested");
+    }
+    skipWhitespace();
+    switch (peek()) {
+    case '{': ++m_pos; return skipContainer('}', depth);
+    case '[': ++m_pos; return skipContainer(']', depth);
+    case '"': ++m_pos; return readString(nullptr);
+    case 't': return readLiteral("true");
+    case 'f': return readLiteral("false");
+    case 'n': return readLiteral("null");
+    case -1:  return fail("unexpected end of document");
+    default:  return readNumber();
+    }
+}
+
+/// Object or array body after its opening bracket.
+bool ItemListReader::skipContainer(int close, int depth) {
+    skipWhitespace();
+    if (peek() == close) {
+        ++m_pos;
+        return true;
+    }
+    for (;;) {
+        skipWhitespace();
+        if (close == '}') {
+            if (get() != '"' || !readString(nullptr)) {
+                return fail("expected member name");
+            }
+            skipWhitespace();
+            if (get() != ':') {
+                return fail("expected ':'");
+            }
+        }
+        if (!skipValue(depth + 1)) {
+            return false;
+        }
+        skipWhitespace();
+        const int c = get();
+        if (c == close) {
+            return true;
+        }
+        if (c != ',') {
+            return fail("expected ',' or closing bracket");
+        }
+    }
+}
+
+/**
+ * @brief Read one entry object after its '{'.
+ *
+ * Members keep QJsonObject::value() semantics: a required member that is
+ * not a string reads as empty, "isCritical" is true only for JSON true, and
+ * a repeated member overrides the earlier one.
+ */
+bool ItemListReader::readEntry(ItemSpec &spec) {
+    skipWhitespace();
+    if (peek() == '}') {
+        ++m_pos;
+        return true;
+    }
+    for (;;) {
+        skipWhitespace();
+        m_key.clear();
+        if (get() != '"' || !readString(&m_key)) {
+            return fail("expected member name");
+        }
+        skipWhitespace();
+        if (get() != ':') {
+            return fail("expected ':'");
+        }
+        skipWhitespace();
+
+        QString *target = nullptr;
+        if (m_key == m_format.pathKey) {
+            target = &spec.path;
+        } else if (m_key == "valueName") {
+            target = &spec.valueName;
+        } else if (m_format.withHive && m_key == "hive") {
+            target = &spec.hive;
+        }
+
+        if (target) {
+            if (peek() == '"') {
+                ++m_pos;
+                m_value.clear();
+                if (!readString(&m_value)) {
+                    return false;
+                }
+                *target = QString::fromUtf8(m_value);
+            } else {
+                target->clear();
+                if (!skipValue(2)) {
+                    return false;
+                }
+            }
+        } else if (m_key == "isCritical") {
+            spec.isCritical = peek() == 't';
+            if (!skipValue(2)) {
+                return false;
+            }
+        } else if (!skipValue(2)) {
+            return false;
+        }
+
+        skipWhitespace();
+        const int c = get();
+        if (c == '}') {
+            return true;
+        }
+        if (c != ',') {
+            return fail("expected ',' or '}'");
+        }
+    }
+}
+
+ItemListResult ItemListReader::read() {
+    MON_SPAN(LogCategory::Monitoring, "itemList.parse");
+    ItemListResult result;
+
+    // UTF-8 byte order mark, as QJsonDocument accepts it
+    if (peek() == 0xEF) {
+        if (!readLiteral("\xEF\xBB\xBF")) {
+            result.error = m_error;
+            return result;
+        }
+    }
+    skipWhitespace();
+    bool ok = get() == '[' || fail("expected a JSON array");
+    if (ok) {
+        skipWhitespace();
+        if (peek() == ']') {
+            ++m_pos;
+        } else {
+            while (ok) {
+                skipWhitespace();
+                if (peek() == '{') {
+                    ++m_pos;
+                    ItemSpec spec;
+                    ok = readEntry(spec);
+                    if (ok && isValid(spec, m_format)) {
+                        result.items.append(std::move(spec));
+                    } else {
+                        ++result.skipped;
+                    }
+                } else {
+                    ok = skipValue(1);
+                    ++result.skipped;
+                }
+                if (!ok) {
+                    break;
+                }
+                skipWhitespace();
+                const int c = get();
+                if (c == ']') {
+                    break;
+                }
+                ok = c == ',' || fail("expected ',' or ']'");
+            }
+        }
+    }
+    if (ok) {
+        skipWhitespace();
+        ok = peek() < 0 || fail("unexpected data after the array");
+    }
+
+    if (!ok) {
+        result.items.clear();
+        result.skipped = 0;
+        result.error = m_error;
+        return result;
+    }
+    result.ok = true;
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ItemListCache
+////////////////////////////////////////////////////////////////////////////////
+
+namespace ItemListCache {
+
+ItemListResult parse(QIODevice *device, const ItemListFormat &format) {
+    return ItemListReader(device, format).read();
+}
+
+QString cacheFileFor(const QString &sourcePath) {
+    const QString directory = cacheDirectory();
+    if (directory.isEmpty()) {
+        return QString();
+    }
+    const QByteArray id = QCryptographicHash::hash(QFileInfo(sourcePath).absoluteFilePath().toUtf8(),
+                                                   QCryptographicHash::Sha1);
+    return directory + "/" + QString::fromLatin1(id.toHex().left(16)) + ".mil";
+}
+
+ItemListResult load(const ConfigSource &source, const ItemListFormat &format) {
+    std::unique_ptr<QIODevice> device = source.open();
+    if (!device) {
+        ItemListResult result;
+        result.error = QStringLiteral("cannot open %1").arg(source.description());
+        return result;
+    }
+    const QString cacheFile = source.isCacheable() ? cacheFileFor(source.description()) : QString();
+    if (cacheFile.isEmpty()) {
+        return parse(device.get(), format);
+    }
+
+    // Hit: hash the JSON and map the cache; no parsing
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    seedKey(hash, format);
+    {
+        MON_SPAN(LogCategory::Monitoring, "itemList.hash");
+        hash.addData(device.get());
+    }
+    ItemListResult result;
+    {
+        MON_SPAN(LogCategory::Monitoring, "itemList.cacheRead");
+        result.ok = readCache(cacheFile, hash.result(), result.items);
+    }
+    if (result.ok) {
+        result.fromCache = true;
+        MON_DEBUG(LogCategory::Monitoring) << "[ITEM CACHE] Loaded" << result.items.size()
+                                           << "entries for" << source.description() << "from" << cacheFile;
+        return result;
+    }
+
+    // Miss: parse and key the cache by the bytes actually parsed, in case
+    // the file changed between the two reads
+    if (!device->seek(0)) {
+        device = source.open();
+        if (!device) {
+            result.error = QStringLiteral("cannot reopen %1").arg(source.description());
+            return result;
+        }
+    }
+    hash.reset();
+    seedKey(hash, format);
+    result = ItemListReader(device.get(), format, &hash).read();
+    if (result.ok) {
+        writeCache(cacheFile, hash.result(), result.items);
+    }
+    return result;
+}
+
+} // namespace ItemListCache
@@ -0,0 +1,335 @@
+#include "itemPatternExpander.h"
+#include "logger.h"
+#include "trace.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QSettings>
+
+/**
+ * @file itemPatternExpander.cpp
+ * @brief Glob expansion of patterned plist entries over cached, watched directories.
+ */
+
+namespace {
+
+const int kRescanDelayMs     = 250;     ///< Coalesces bursts of directory events
+const int kMaxDepth          = 32;      ///< Deepest directory a "**" walk descends to
+const int kMaxWatchedDirs    = 4096;    ///< Past this, directories are expanded but not watched
+
+bool hasWildcard(const QString &text) {
+    for (const QChar c : text) {
+        if (c == '*' || c == '?' || c == '[') {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// "*" → any run, "?" → one character, "[...]" / "[!...]" → character class.
+QRegularExpression globMatcher(const QString &glob) {
+    QString rx;
+    rx.reserve(glob.size() * 2);
+    for (int i = 0; i < glob.size(); ++i) {
+        const QChar c = glob.at(i);
+        if (c == '*') {
+            rx += QLatin1String(".*");
+        } else if (c == '?') {
+            rx += QLatin1Char('.');
+        } else if (c == '[' && glob.indexOf(']', i + 2) > i) {
+            const int close = glob.indexOf(']', i + 2);
+            QString set = glob.mid(i + 1, close - i - 1);
+            set.replace(QLatin1String("\\"), QLatin1String("\\\\"));
+            if (set.startsWith('!')) {
+                set[0] = '^';
+            }
+            rx += '[' + set + ']';
+            i = close;
+        } else {
+            rx += QRegularExpression::escape(QString(c));
+        }
+    }
+    return QRegularExpression(QRegularExpression::anchoredPattern(rx),
+                              QRegularExpression::DotMatchesEverythingOption);
+}
+
+QString joinPath(const QString &directory, const QString &name) {
+    return directory.endsWith('/') ? directory + name : directory + '/' + name;
+}
+
+} // namespace
+
+ItemPatternExpander::ItemPatternExpander(QObject *parent)
+    : QObject(parent)
+{
+    m_rescanTimer.setSingleShot(true);
+    m_rescanTimer.setInterval(kRescanDelayMs);
+    connect(&m_rescanTimer, &QTimer::timeout, this, &ItemPatternExpander::rescan);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged,
+            this, &ItemPatternExpander::onDirectoryChanged);
+}
+
+bool ItemPatternExpander::isPattern(const ItemSpec &spec) {
+    return hasWildcard(spec.path) || hasWildcard(spec.valueName);
+}
+
+QString ItemPatternExpander::keyOf(const QString &path, const QString &valueName) {
+    return path + '\n' + valueName;
+}
+
+QVector<ItemSpec> ItemPatternExpander::setPatterns(const QVector<ItemSpec> &patterns,
+                                                   const QSet<QString> &exclude) {
+    m_patterns.clear();
+    m_exclude = exclude;
+    for (const ItemSpec &spec : patterns) {
+        Pattern pattern;
+        pattern.spec = spec;
+
+        // Literal directories become the root; at least the file name is matched
+        const QStringList parts = QDir::fromNativeSeparators(spec.path).split('/', Qt::SkipEmptyParts);
+        if (parts.isEmpty() || !spec.path.startsWith('/')) {
+            MON_WARN(LogCategory::Monitoring) << "[PATTERNS] Ignoring pattern without an absolute path:"
+                                              << spec.path;
+            continue;
+        }
+        int literal = 0;
+        while (literal < parts.size() - 1 && !hasWildcard(parts.at(literal))) {
+            ++literal;
+        }
+        pattern.root = '/' + parts.mid(0, literal).join('/');
+        pattern.segments = parts.mid(literal);
+        for (const QString &segment : std::as_const(pattern.segments)) {
+            pattern.matchers.append(segment == QLatin1String("**") ? QRegularExpression()
+                                                                    : globMatcher(segment));
+        }
+        pattern.keyWildcard = hasWildcard(spec.valueName);
+        if (pattern.keyWildcard) {
+            pattern.keyMatcher = globMatcher(spec.valueName);
+        }
+        m_patterns.append(pattern);
+    }
+
+    m_expansion = expandAll();
+    MON_INFO(LogCategory::Monitoring) << "[PATTERNS]" << m_patterns.size() << "patterns expanded to"
+                                      << m_expansion.size() << "entries over"
+                                      << m_usedDirectories.size() << "directories.";
+    return m_expansion;
+}
+
+/**
+ * @brief Cached listing of @p directory; read from disk on first use or
+ *        after a change marked it dirty.
+ */
+ItemPatternExpander::Listing ItemPatternExpander::listing(const QString &directory) {
+    const auto cached = m_listings.constFind(directory);
+    if (cached != m_listings.cend()) {
+        return *cached;
+    }
+
+    Listing result;
+    ++m_directoryScans;
+    const QFileInfoList entries =
+        QDir(directory).entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    for (const QFileInfo &entry : entries) {
+        if (entry.isDir()) {
+            if (!entry.isSymLink()) {
+                result.directories.append(entry.fileName());
+            }
+        } else {
+            result.files.append(entry.fileName());
+        }
+    }
+    m_listings.insert(directory, result);
+    return result;
+}
+
+/**
+ * @brief Match @p pattern's segments from @p segment on below @p directory.
+ * @param files Receives the matching file paths.
+ */
+void ItemPatternExpander::walk(const Pattern &pattern, const QString &directory, int segment,
+                               int depth, QStringList &files) {
+    if (depth > kMaxDepth) {
+        return;
+    }
+    m_usedDirectories.insert(directory);
+    const Listing entries = listing(directory);
+    const bool last = segment == pattern.segments.size() - 1;
+
+    if (pattern.segments.at(segment) == QLatin1String("**")) {
+        if (last) {
+            // Trailing "**": every file at any depth
+            for (const QString &file : entries.files) {
+                files.append(joinPath(directory, file));
+            }
+        } else {
+            walk(pattern, directory, segment + 1, depth, files);
+        }
+        for (const QString &sub : entries.directories) {
+            walk(pattern, joinPath(directory, sub), segment, depth + 1, files);
+        }
+        return;
+    }
+
+    const QRegularExpression &matcher = pattern.matchers.at(segment);
+    if (last) {
+        for (const QString &file : entries.files) {
+            if (matcher.match(file).hasMatch()) {
+                files.append(joinPath(directory, file));
+            }
+        }
+        return;
+    }
+    for (const QString &sub : entries.directories) {
+        if (matcher.match(sub).hasMatch()) {
+            walk(pattern, joinPath(directory, sub), segment + 1, depth + 1, files);
+        }
+    }
+}
+
+/// Keys of @p file, re-read only when its modification time changed.
+QStringList ItemPatternExpander::keysOf(const QString &file) {
+    const QDateTime modified = QFileInfo(file).lastModified();
+    const auto cached = m_keys.constFind(file);
+    if (cached != m_keys.cend() && cached->modified == modified) {
+        return cached->keys;
+    }
+    const QStringList keys = QSettings(file, QSettings::NativeFormat).allKeys();
+    m_keys.insert(file, PlistKeys{modified, keys});
+    return keys;
+}
+
+/**
+ * @brief Expand every pattern against the listing cache and bring the
+ *        watched directories in line with the ones walked.
+ */
+QVector<ItemSpec> ItemPatternExpander::expandAll() {
+    MON_SPAN(LogCategory::Monitoring, "patterns.expand");
+    m_usedDirectories.clear();
+
+    QVector<ItemSpec> result;
+    QSet<QString> seen = m_exclude;
+    QSet<QString> keyFiles;
+    for (const Pattern &pattern : std::as_const(m_patterns)) {
+        QStringList files;
+        if (QFileInfo(pattern.root).isDir()) {
+            walk(pattern, pattern.root, 0, 0, files);
+        }
+        for (const QString &file : std::as_const(files)) {
+            QStringList names;
+            if (pattern.keyWildcard) {
+                keyFiles.insert(file);
+                for (const QString &key : keysOf(file)) {
+                    if (pattern.keyMatcher.match(key).hasMatch()) {
+                        names.append(key);
+                    }
+                }
+            } else {
+                names.append(pattern.spec.valueName);
+            }
+            for (const QString &name : std::as_const(names)) {
+                const QString key = keyOf(file, name);
+                if (seen.contains(key)) {
+                    continue;
+                }
+                seen.insert(key);
+                result.append(ItemSpec{QString(), file, name, pattern.spec.isCritical});
+            }
+        }
+    }
+
+    // Forget what no pattern reaches any more
+    for (auto it = m_listings.begin(); it != m_listings.end();) {
+        it = m_usedDirectories.contains(it.key()) ? std::next(it) : m_listings.erase(it);
+    }
+    for (auto it = m_keys.begin(); it != m_keys.end();) {
+        it = keyFiles.contains(it.key()) ? std::next(it) : m_keys.erase(it);
+    }
+
+    // Watch the walked directories, up to the limit
+    const QStringList watchedList = m_watcher.directories();
+    const QSet<QString> watched(watchedList.cbegin(), watchedList.cend());
+    QStringList stale;
+    for (const QString &directory : watched) {
+        if (!m_usedDirectories.contains(directory)) {
+            stale.append(directory);
+        }
+    }
+    if (!stale.isEmpty()) {
+        m_watcher.removePaths(stale);
+    }
+    int room = kMaxWatchedDirs - (watched.size() - stale.size());
+    QStringList fresh;
+    for (const QString &directory : std::as_const(m_usedDirectories)) {
+        if (!watched.contains(directory)) {
+            if (room-- <= 0) {
+                if (!m_watchLimitLogged) {
+                    m_watchLimitLogged = true;
+                    MON_WARN(LogCategory::Monitoring) << "[PATTERNS] More than" << kMaxWatchedDirs
+                                                      << "directories; the rest are not watched.";
+                }
+                break;
+            }
+            fresh.append(directory);
+        }
+    }
+    if (!fresh.isEmpty()) {
+        m_watcher.addPaths(fresh);
+    }
+    return result;
+}
+
+void ItemPatternExpander::onDirectoryChanged(const QString &directory) {
+    m_dirty.insert(directory);
+    m_rescanTimer.start();
+}
+
+/**
+ * @brief Re-read the changed directories, re-match and report the difference.
+ */
+void ItemPatternExpander::rescan() {
+    ++m_rescans;
+    for (const QString &directory : std::as_const(m_dirty)) {
+        m_listings.remove(directory);
+    }
+    m_dirty.clear();
+
+    const QVector<ItemSpec> previous = m_expansion;
+    m_expansion = expandAll();
+
+    QSet<QString> before, after;
+    for (const ItemSpec &spec : previous) {
+        before.insert(keyOf(spec.path, spec.valueName));
+    }
+    for (const ItemSpec &spec : std::as_const(m_expansion)) {
+        after.insert(keyOf(spec.path, spec.valueName));
+    }
+    QVector<ItemSpec> added, removed;
+    for (const ItemSpec &spec : std::as_const(m_expansion)) {
+        if (!before.contains(keyOf(spec.path, spec.valueName))) {
+            added.append(spec);
+        }
+    }
+    for (const ItemSpec &spec : previous) {
+        if (!after.contains(keyOf(spec.path, spec.valueName))) {
+            removed.append(spec);
+        }
+    }
+    if (added.isEmpty() && removed.isEmpty()) {
+        return;
+    }
+    MON_INFO(LogCategory::Monitoring) << "[PATTERNS] Rescan:" << added.size() << "new and"
+                                      << removed.size() << "removed entries.";
+    emit expansionChanged(added, removed);
+}
+
+QVariantMap ItemPatternExpander::stats() const {
+    QVariantMap result;
+    result["patterns"]           = m_patterns.size();
+    result["matches"]            = m_expansion.size();
+    result["watchedDirectories"] = m_watcher.directories().size();
+    result["cachedDirectories"]  = m_listings.size();
+    result["directoryScans"]     = m_directoryScans;
+    result["rescans"]            = m_rescans;
+    return result;
+}
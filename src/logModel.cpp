@@ -0,0 +1,145 @@
+#include "logModel.h"
+#include <algorithm>
+
+/**
+ * @file logModel.cpp
+ * @brief Implements a capped, frame-coalesced list model for UI log lines.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// Constructor
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Construct an empty LogModel.
+ * @param capacity Maximum number of lines retained (at least 1).
+ * @param parent   Optional QObject parent for ownership.
+ */
+LogModel::LogModel(int capacity, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_lines(std::max(1, capacity))
+{
+    // ~60 Hz: everything appended within one frame is published together
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(16);
+    connect(&m_flushTimer, &ClockTimer::timeout, this, &LogModel::flushPending);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Appending
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Buffer a line and schedule a flush for the end of the frame.
+ * @param message Log text.
+ */
+void LogModel::append(const QString &message) {
+    m_pending.push_back({message, Clock::instance()->now()});
+
+    // Never buffer more than the ring can show
+    if (int(m_pending.size()) > capacity() * 2) {
+        m_pending.erase(m_pending.begin(), m_pending.end() - capacity());
+    }
+    if (!m_flushTimer.isActive()) {
+        m_flushTimer.start();
+    }
+}
+
+/**
+ * @brief Move buffered lines into the ring, evicting the oldest rows first.
+ *
+ * Emits at most one rowsRemoved and one rowsInserted per flush.
+ */
+void LogModel::flushPending() {
+    if (m_pending.empty()) {
+        return;
+    }
+
+    const int cap = capacity();
+    int incoming = int(m_pending.size());
+    auto begin = m_pending.begin();
+    if (incoming > cap) {
+        begin += incoming - cap;
+        incoming = cap;
+    }
+
+    const int overflow = m_count + incoming - cap;
+    if (overflow > 0) {
+        beginRemoveRows(QModelIndex(), 0, overflow - 1);
+        m_first = (m_first + overflow) % cap;
+        m_count -= overflow;
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), m_count, m_count + incoming - 1);
+    for (auto it = begin; it != m_pending.end(); ++it) {
+        m_lines[slotForRow(m_count)] = std::move(*it);
+        ++m_count;
+    }
+    endInsertRows();
+
+    m_pending.clear();
+    emit countChanged();
+}
+
+/**
+ * @brief Drop all lines and reset attached views.
+ */
+void LogModel::clear() {
+    m_flushTimer.stop();
+    m_pending.clear();
+
+    beginResetModel();
+    std::fill(m_lines.begin(), m_lines.end(), Line());
+    m_first = 0;
+    m_count = 0;
+    endResetModel();
+    emit countChanged();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// QAbstractListModel Overrides
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Return the number of published lines.
+ * @param parent Unused; included for interface compatibility.
+ */
+int LogModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_count;
+}
+
+/**
+ * @brief Retrieve data for a given row and role.
+ * @param index Index identifying the row (0 = oldest retained line).
+ * @param role  MessageRole/Qt::DisplayRole or TimestampRole.
+ */
+QVariant LogModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_count) {
+        return QVariant();
+    }
+
+    const Line &line = m_lines[slotForRow(index.row())];
+    switch (role) {
+    case Qt::DisplayRole:
+    case MessageRole:
+        return line.message;
+    case TimestampRole:
+        return line.timestamp.toString("hh:mm:ss");
+    default:
+        return QVariant();
+    }
+}
+
+/**
+ * @brief Map role enums to names usable from QML delegates.
+ */
+QHash<int, QByteArray> LogModel::roleNames() const {
+    return {
+        { MessageRole,   "message"   },
+        { TimestampRole, "timestamp" }
+    };
+}
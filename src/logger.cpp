@@ -0,0 +1,420 @@
+/**
+ * @file logger.cpp
+ * @brief Implements the asynchronous structured logger: a lock-free
+ *        multi-producer ring buffer drained by a background writer thread
+ *        into a rotating JSON-lines file.
+ */
+
+#include "logger.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace {
+
+#ifdef QT_NO_DEBUG
+constexpr int kDefaultLevel = int(LogLevel::Info);
+#else
+constexpr int kDefaultLevel = int(LogLevel::Debug);
+#endif
+
+/// One queued log record.
+struct LogRecord {
+    qint64      timestampMs = 0;
+    LogLevel    level = LogLevel::Info;
+    LogCategory category = LogCategory::General;
+    quintptr    threadId = 0;
+    quint32     suppressed = 0;
+    QString     message;
+};
+
+/**
+ * @brief Bounded multi-producer ring (Vyukov sequence-per-slot design).
+ *
+ * push() never blocks: when the ring is full it fails and the caller counts
+ * the drop. Only the writer thread calls pop().
+ */
+class LogRing {
+public:
+    explicit LogRing(int capacity) {
+        int size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        m_mask = size_t(size - 1);
+        m_slots = std::make_unique<Slot[]>(size_t(size));
+        for (size_t i = 0; i < size_t(size); ++i) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(LogRecord &&record) {
+        size_t pos = m_head.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot &slot = m_slots[pos & m_mask];
+            const size_t seq = slot.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = intptr_t(seq) - intptr_t(pos);
+            if (diff == 0) {
+                if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.record = std::move(record);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // full
+            } else {
+                pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(LogRecord &out) {
+        Slot &slot = m_slots[m_tail & m_mask];
+        const size_t seq = slot.sequence.load(std::memory_order_acquire);
+        if (intptr_t(seq) - intptr_t(m_tail + 1) < 0) {
+            return false;  // empty
+        }
+        out = std::move(slot.record);
+        slot.record = LogRecord();
+        slot.sequence.store(m_tail + m_mask + 1, std::memory_order_release);
+        ++m_tail;
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        LogRecord           record;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t                  m_mask = 0;
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) size_t              m_tail = 0;
+};
+
+QByteArray formatRecord(const LogRecord &record) {
+    QJsonObject obj;
+    obj["ts"]    = QDateTime::fromMSecsSinceEpoch(record.timestampMs, Qt::UTC)
+                    .toString(Qt::ISODateWithMs);
+    obj["level"] = Logger::levelName(record.level);
+    obj["cat"]   = Logger::categoryName(record.category);
+    obj["tid"]   = QString::number(record.threadId, 16);
+    obj["msg"]   = record.message;
+    if (record.suppressed > 0) {
+        obj["suppressed"] = qint64(record.suppressed);
+    }
+    return QJsonDocument(obj).toJson(QJsonDocument::Compact) + '\n';
+}
+
+/**
+ * @brief Background thread that drains the ring into a rotating file.
+ */
+class LogWriter : public QThread {
+public:
+    explicit LogWriter(const LoggerConfig &config)
+        : m_config(config)
+        , m_ring(config.ringCapacity)
+    {}
+
+    bool enqueue(LogRecord &&record) {
+        return m_ring.push(std::move(record));
+    }
+
+    void requestStop() {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wake.wakeAll();
+    }
+
+protected:
+    void run() override {
+        openFile();
+        for (;;) {
+            const bool wroteAny = drain();
+            QMutexLocker locker(&m_mutex);
+            if (m_stopping) {
+                locker.unlock();
+                drain();
+                break;
+            }
+            if (!wroteAny) {
+                // Producers never signal (that would need a lock); poll instead.
+                m_wake.wait(&m_mutex, 50);
+            }
+        }
+        m_file.close();
+    }
+
+private:
+    bool drain() {
+        LogRecord record;
+        bool wroteAny = false;
+        while (m_ring.pop(record)) {
+            const QByteArray line = formatRecord(record);
+            if (m_file.isOpen()) {
+                m_file.write(line);
+                m_written += line.size();
+            }
+            if (int(record.level) >= int(m_config.consoleLevel)) {
+                std::fwrite(line.constData(), 1, size_t(line.size()), stderr);
+            }
+            wroteAny = true;
+            if (m_written >= m_config.maxFileBytes) {
+                rotate();
+            }
+        }
+        if (wroteAny && m_file.isOpen()) {
+            m_file.flush();
+        }
+        return wroteAny;
+    }
+
+    void openFile() {
+        if (m_config.filePath.isEmpty()) {
+            return;
+        }
+        QDir().mkpath(QFileInfo(m_config.filePath).absolutePath());
+        m_file.setFileName(m_config.filePath);
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            std::fprintf(stderr, "[LOGGER] Cannot open log file %s\n",
+                         qPrintable(m_config.filePath));
+            return;
+        }
+        m_written = m_file.size();
+    }
+
+    void rotate() {
+        m_file.close();
+        const QString base = m_config.filePath;
+        QFile::remove(QString("%1.%2").arg(base).arg(m_config.maxFiles));
+        for (int i = m_config.maxFiles - 1; i >= 1; --i) {
+            QFile::rename(QString("%1.%2").arg(base).arg(i),
+                          QString("%1.%2").arg(base).arg(i + 1));
+        }
+        QFile::rename(base, base + ".1");
+        m_written = 0;
+        openFile();
+    }
+
+    LoggerConfig   m_config;
+    LogRing        m_ring;
+    QFile          m_file;
+    qint64         m_written = 0;
+    QMutex         m_mutex;
+    QWaitCondition m_wake;
+    bool           m_stopping = false;
+};
+
+std::atomic<LogWriter *> s_writer{nullptr};
+std::atomic<int>         s_activeWrites{0};   ///< write() calls that may hold s_writer
+std::atomic<quint64>     s_dropped{0};
+QtMessageHandler         s_previousHandler = nullptr;
+
+/**
+ * @brief Route qDebug()/qWarning() from Qt and third-party code into the logger.
+ */
+void qtMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg) {
+    LogLevel level = LogLevel::Debug;
+    switch (type) {
+    case QtDebugMsg:    level = LogLevel::Debug;   break;
+    case QtInfoMsg:     level = LogLevel::Info;    break;
+    case QtWarningMsg:  level = LogLevel::Warning; break;
+    case QtCriticalMsg: level = LogLevel::Error;   break;
+    case QtFatalMsg:
+        if (s_previousHandler) {
+            s_previousHandler(type, context, msg);
+        }
+        std::abort();
+    }
+    if (Logger::isEnabled(LogCategory::General, level)) {
+        Logger::write(level, LogCategory::General, msg);
+    }
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// Logger
+////////////////////////////////////////////////////////////////////////////////
+
+std::atomic<int> Logger::s_levels[int(LogCategory::Count)] = {
+    kDefaultLevel, kDefaultLevel, kDefaultLevel, kDefaultLevel,
+    kDefaultLevel, kDefaultLevel, kDefaultLevel, kDefaultLevel
+};
+
+/**
+ * @brief Start the writer thread and take over Qt's message output.
+ * @param config File, rotation, console and level settings.
+ */
+void Logger::start(const LoggerConfig &config) {
+    if (s_writer.load()) {
+        return;
+    }
+    applyLevelSpec(config.levelSpec);
+
+    auto *writer = new LogWriter(config);
+    writer->setObjectName("LogWriter");
+    writer->start(QThread::LowPriority);
+    s_writer.store(writer);
+    s_previousHandler = qInstallMessageHandler(qtMessageHandler);
+}
+
+/**
+ * @brief Flush everything queued and stop the writer.
+ *
+ * Threads still logging fall back to stderr; the writer is only freed
+ * once no write() can still be using it.
+ */
+void Logger::stop() {
+    LogWriter *writer = s_writer.exchange(nullptr);
+    if (!writer) {
+        return;
+    }
+    qInstallMessageHandler(s_previousHandler);
+    while (s_activeWrites.load() > 0) {
+        QThread::yieldCurrentThread();
+    }
+    writer->requestStop();
+    writer->wait();
+    delete writer;
+}
+
+void Logger::setLevel(LogCategory category, LogLevel level) {
+    s_levels[int(category)].store(int(level), std::memory_order_relaxed);
+}
+
+/**
+ * @brief Parse "name=level" pairs separated by commas.
+ * @param spec e.g. "database=warning,alert=info" or "*=error".
+ */
+void Logger::applyLevelSpec(const QString &spec) {
+    const QStringList entries = spec.split(',', Qt::SkipEmptyParts);
+    for (const QString &entry : entries) {
+        const QStringList parts = entry.trimmed().split('=');
+        if (parts.size() != 2) {
+            continue;
+        }
+        const QString name = parts[0].trimmed().toLower();
+        const QString levelText = parts[1].trimmed().toLower();
+
+        int level = -1;
+        for (int l = 0; l <= int(LogLevel::Off); ++l) {
+            if (levelText == QLatin1String(levelName(LogLevel(l)))) {
+                level = l;
+            }
+        }
+        if (level < 0) {
+            continue;
+        }
+        for (int c = 0; c < int(LogCategory::Count); ++c) {
+            if (name == "*" || name == QLatin1String(categoryName(LogCategory(c)))) {
+                setLevel(LogCategory(c), LogLevel(level));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Queue a record; falls back to stderr if the writer is not running.
+ */
+void Logger::write(LogLevel level, LogCategory category, const QString &message,
+                   quint32 suppressed) {
+    LogRecord record;
+    record.timestampMs = QDateTime::currentMSecsSinceEpoch();
+    record.level       = level;
+    record.category    = category;
+    record.threadId    = reinterpret_cast<quintptr>(QThread::currentThreadId());
+    record.suppressed  = suppressed;
+    record.message     = message;
+
+    // Counted before the load (both sequentially consistent), so stop()
+    // either sees this call or this call sees the cleared pointer
+    s_activeWrites.fetch_add(1);
+    LogWriter *writer = s_writer.load();
+    if (!writer) {
+        s_activeWrites.fetch_sub(1);
+        const QByteArray line = formatRecord(record);
+        std::fwrite(line.constData(), 1, size_t(line.size()), stderr);
+        return;
+    }
+    if (!writer->enqueue(std::move(record))) {
+        s_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    s_activeWrites.fetch_sub(1);
+}
+
+quint64 Logger::droppedCount() {
+    return s_dropped.load(std::memory_order_relaxed);
+}
+
+const char *Logger::categoryName(LogCategory category) {
+    switch (category) {
+    case LogCategory::General:    return "general";
+    case LogCategory::Monitoring: return "monitoring";
+    case LogCategory::Database:   return "database";
+    case LogCategory::Crypto:     return "crypto";
+    case LogCategory::Alert:      return "alert";
+    case LogCategory::Item:       return "item";
+    case LogCategory::Rollback:   return "rollback";
+    case LogCategory::Dispatcher: return "dispatcher";
+    case LogCategory::Count:      break;
+    }
+    return "unknown";
+}
+
+const char *Logger::levelName(LogLevel level) {
+    switch (level) {
+    case LogLevel::Trace:   return "trace";
+    case LogLevel::Debug:   return "debug";
+    case LogLevel::Info:    return "info";
+    case LogLevel::Warning: return "warning";
+    case LogLevel::Error:   return "error";
+    case LogLevel::Off:     return "off";
+    }
+    return "unknown";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// LogRateGate / LogStream
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Allow one record per interval from the owning call site.
+ * @param intervalMs Minimum spacing between emitted records.
+ * @return True if this record should be emitted.
+ */
+bool LogRateGate::allow(qint64 intervalMs) {
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64 next = m_nextAllowedMs.load(std::memory_order_relaxed);
+    if (now >= next &&
+        m_nextAllowedMs.compare_exchange_strong(next, now + intervalMs,
+                                                std::memory_order_relaxed)) {
+        return true;
+    }
+    m_suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+LogStream::LogStream(LogLevel level, LogCategory category, quint32 suppressed)
+    : m_level(level)
+    , m_category(category)
+    , m_suppressed(suppressed)
+{
+    m_debug.emplace(&m_text);
+}
+
+LogStream::~LogStream() {
+    m_debug.reset();  // flushes into m_text
+    Logger::write(m_level, m_category, m_text, m_suppressed);
+}
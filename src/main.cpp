@@ -4,6 +4,19 @@
 #include <QQmlContext>                      // Access to expose C++ objects to QML
 #include "settings.h"                       // Application-wide Settings interface
 #include "Database.h"                       // Database access and schema management
+#include "logger.h"                         // Asynchronous structured logger
+#include "logModel.h"                       // Capped list model backing the Logs page
+#include "changeChartModel.h"               // Per-day change counts for the stacked bar chart
+#include "historySearch.h"                  // Off-thread, paged change-history search
+#include "changeRetention.h"                // Background purge of expired change history
+#include "changeArchive.h"                  // Compressed segment files for cold change history
+#include "changeExport.h"                   // Streaming CSV / JSON Lines export of change history
+#include "clock.h"                          // Clock-driven timers shared with QML
+#include "trace.h"                          // Scoped spans exported as Chrome trace JSON
+#include "resourceGovernor.h"               // CPU / I/O budget for background work
+#include "valueHistory.h"                   // Delta-encoded change values
+#include "startupOrchestrator.h"            // Concurrent startup tasks and milestones
+#include <QStandardPaths>                   // Per-user location for log files
 #include <QtCharts/QAbstractSeries>         // Register Qt Charts QML module
 
 #ifdef Q_OS_MAC
@@ -15,14 +28,65 @@
 #endif
 
 int main(int argc, char *argv[]) {
-    // ---------- AWS SDK Initialization ----------
-    Aws::SDKOptions options;
-    Aws::InitAPI(options);
-    qDebug() << "[AWS] AWS SDK initialized.";
-
     // ---------- Qt Application Setup ----------
     QApplication app(argc, argv);
+
+    // ---------- Logging ----------
+    // Rotating JSON-lines file; per-category levels via MONITOR_LOG, e.g. "database=warning,*=info"
+    LoggerConfig logConfig;
+    logConfig.filePath  = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)
+                         + "/logs/monitor.log";
+    logConfig.levelSpec = qEnvironmentVariable("MONITOR_LOG");
+    Logger::start(logConfig);
+
+    // ---------- Startup Tasks ----------
+    // Independent initializers run in the background while the window loads;
+    // their users wait for them by name (the first alert waits for "aws")
+    StartupOrchestrator startup;
+    StartupOrchestrator::setInstance(&startup);
+
+    Aws::SDKOptions options;
+    StartupOrchestrator::submit("aws", [&options]() {
+        Aws::InitAPI(options);
+        qDebug() << "[AWS] AWS SDK initialized.";
+    });
+
+    // Creates the database, schema and encryption keys ahead of the monitor's first write
+    StartupOrchestrator::submit("database", []() {
+        Database db;
+    });
+
+    // ---------- Tracing ----------
+    // MONITOR_TRACE=<file> records spans from startup and writes them on exit;
+    // QML can also toggle recording at runtime through the Trace object
+    const QString traceFile = qEnvironmentVariable("MONITOR_TRACE");
+    TraceControl traceControl;
+    if (!traceFile.isEmpty()) {
+        traceControl.setEnabled(true);
+    }
+
+    // Cold change history; declared before its users so it is destroyed after them
+    ChangeArchive archive(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)
+                          + "/archive");
+    ChangeArchive::setInstance(&archive);
+
+    // Caps from MONITOR_CPU_CAP_PERCENT / MONITOR_IOPS_CAP; usage is sampled either way
+    ResourceGovernor governor(ResourceBudget::fromEnvironment());
+    ResourceGovernor::setInstance(&governor);
+    governor.start();
+
+    // Delta-encoded change values, keyframe every MONITOR_VALUE_DELTA rows (unset = off)
+    ValueHistory valueHistory(DeltaPolicy::fromEnvironment());
+    if (valueHistory.policy().isEnabled()) {
+        ValueHistory::setInstance(&valueHistory);
+    }
+
     Settings settings;                        // Holds user email/phone/threshold settings
+    LogModel logModel;                        // Ring buffer of UI log lines (Logs page)
+    ChangeChartModel changeChart;             // Last 7 days of change counts (Charts page)
+    HistorySearch historySearch;              // Off-thread change-history search (Search page)
+    ChangeExport changeExport;                // Streaming change-history export
+    ChangeRetention retention(RetentionPolicy::fromJson(RetentionPolicy::defaultPath()), &archive);
     QQmlApplicationEngine engine;             // Loads and runs the QML UI
 
 // ---------- Platform-Specific Monitoring ----------
@@ -36,6 +100,13 @@ int main(int argc, char *argv[]) {
     // Expose C++ objects to QML under known property names
     engine.rootContext()->setContextProperty("Settings", &settings);
     engine.rootContext()->setContextProperty("Monitoring", &monitoring);
+    engine.rootContext()->setContextProperty("LogModel", &logModel);
+    engine.rootContext()->setContextProperty("ChangeChart", &changeChart);
+    engine.rootContext()->setContextProperty("HistorySearch", &historySearch);
+    engine.rootContext()->setContextProperty("ChangeExport", &changeExport);
+    engine.rootContext()->setContextProperty("Trace", &traceControl);
+    engine.rootContext()->setContextProperty("Governor", &governor);
+    engine.rootContext()->setContextProperty("Startup", &startup);
 
     // ---------- Database Singleton Registration ----------
     // Makes Database available in QML as Monitor.Database singleton
@@ -49,6 +120,9 @@ int main(int argc, char *argv[]) {
         }
         );
 
+    // Timers that follow Clock::instance(), so UI delays replay with the engine
+    qmlRegisterType<ClockTimer>("Monitor.Time", 1, 0, "ClockTimer");
+
     // Register the QtCharts QML module (for chart types in QML)
     qmlRegisterModule("QtCharts", 2, 15);
 
@@ -56,28 +130,62 @@ int main(int argc, char *argv[]) {
     engine.load(QUrl(QStringLiteral("qrc:/qt/qml/Monitor/qml/Main.qml")));
     if (engine.rootObjects().isEmpty()) {
         // If loading failed, shut down AWS and exit with error
+        monitoring.shutdown();
+        historySearch.shutdown();
+        changeExport.shutdown();
+        retention.shutdown();
+        governor.stop();
+        ChangeArchive::setInstance(nullptr);
+        ResourceGovernor::setInstance(nullptr);
+        ValueHistory::setInstance(nullptr);
+        startup.waitForAll();
+        StartupOrchestrator::setInstance(nullptr);
+        Logger::stop();
         Aws::ShutdownAPI(options);
         return -1;
     }
+    StartupOrchestrator::milestone("windowShown");
 
     // ---------- Connect Monitoring Logs to QML ----------
-    // When MonitoringBase emits logMessage, call addLog(message) in the root QML object
-    QObject::connect(
-        &monitoring, &MonitoringBase::logMessage,
-        &engine, [&engine](const QString &message) {
-            QObject *root = engine.rootObjects().first();
-            if (root) {
-                QMetaObject::invokeMethod(
-                    root, "addLog",
-                    Q_ARG(QVariant, message)
-                    );
-            }
-        }
-        );
+    // Monitoring log lines go straight into the model; it publishes them once per frame
+    QObject::connect(&monitoring, &MonitoringBase::logMessage,
+                     &logModel, &LogModel::append);
+
+    // Each recorded change bumps its chart bucket; repaints are throttled by the model
+    QObject::connect(&monitoring, &MonitoringBase::changeRecorded,
+                     &changeChart, &ChangeChartModel::recordChange);
+
+    // Expire old change history in the background
+    retention.start();
 
     // Run the Qt event loop
     int result = app.exec();
 
+    // Queued alerts and writes still need the SDK, the logger and the services below
+    monitoring.shutdown();
+
+    // Background services log until their workers are joined
+    historySearch.shutdown();
+    changeExport.shutdown();
+    retention.shutdown();
+    governor.stop();
+
+    // Nothing reads the archive, the governor or the history any more
+    ChangeArchive::setInstance(nullptr);
+    ResourceGovernor::setInstance(nullptr);
+    ValueHistory::setInstance(nullptr);
+
+    // The SDK must be up before it is shut down
+    startup.waitForAll();
+    StartupOrchestrator::setInstance(nullptr);
+
+    if (!traceFile.isEmpty()) {
+        traceControl.exportTo(traceFile);
+    }
+
+    // Flush queued log records before tearing down
+    Logger::stop();
+
     // Cleanly shut down the AWS SDK before exiting
     Aws::ShutdownAPI(options);
     return result;
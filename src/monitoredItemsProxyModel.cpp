@@ -0,0 +1,99 @@
+#include "monitoredItemsProxyModel.h"
+
+/**
+ * @file monitoredItemsProxyModel.cpp
+ * @brief Implements the sort/filter proxy behind the monitored-items list.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+// Constructor
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Construct an empty proxy.
+ * @param parent Optional QObject parent for ownership.
+ *
+ * Keeps sorting/filtering live so source inserts, removes and dataChanged
+ * are mapped incrementally rather than re-sorting everything.
+ */
+MonitoredItemsProxyModel::MonitoredItemsProxyModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+{
+    setDynamicSortFilter(true);
+    setSortCaseSensitivity(Qt::CaseInsensitive);
+
+    connect(this, &QAbstractItemModel::rowsInserted, this, &MonitoredItemsProxyModel::countChanged);
+    connect(this, &QAbstractItemModel::rowsRemoved,  this, &MonitoredItemsProxyModel::countChanged);
+    connect(this, &QAbstractItemModel::modelReset,   this, &MonitoredItemsProxyModel::countChanged);
+    connect(this, &QAbstractItemModel::layoutChanged, this, &MonitoredItemsProxyModel::countChanged);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Configuration
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Attach a source model and sort it by its name role.
+ * @param sourceModel PlistFileModel or RegistryKeyModel.
+ */
+void MonitoredItemsProxyModel::setSourceModel(QAbstractItemModel *sourceModel) {
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+
+    m_nameRole = -1;
+    m_criticalRole = -1;
+    if (sourceModel) {
+        const QHash<int, QByteArray> roles = sourceModel->roleNames();
+        for (auto it = roles.cbegin(); it != roles.cend(); ++it) {
+            if (it.value() == "valueName" || it.value() == "name") {
+                m_nameRole = it.key();
+            } else if (it.value() == "isCritical") {
+                m_criticalRole = it.key();
+            }
+        }
+    }
+
+    if (m_nameRole >= 0) {
+        setSortRole(m_nameRole);
+        sort(0, Qt::AscendingOrder);
+    }
+    emit countChanged();
+}
+
+void MonitoredItemsProxyModel::setFilterText(const QString &text) {
+    if (text == m_filterText) {
+        return;
+    }
+    m_filterText = text;
+    invalidateFilter();
+    emit filterTextChanged();
+    emit countChanged();
+}
+
+void MonitoredItemsProxyModel::setCriticalOnly(bool criticalOnly) {
+    if (criticalOnly == m_criticalOnly) {
+        return;
+    }
+    m_criticalOnly = criticalOnly;
+    invalidateFilter();
+    emit criticalOnlyChanged();
+    emit countChanged();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Filtering
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Accept rows matching the critical flag and name substring.
+ */
+bool MonitoredItemsProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const {
+    const QModelIndex idx = sourceModel()->index(sourceRow, 0, sourceParent);
+
+    if (m_criticalOnly && m_criticalRole >= 0 && !idx.data(m_criticalRole).toBool()) {
+        return false;
+    }
+    if (!m_filterText.isEmpty() && m_nameRole >= 0) {
+        return idx.data(m_nameRole).toString().contains(m_filterText, Qt::CaseInsensitive);
+    }
+    return true;
+}
@@ -1,18 +1,31 @@
 #include "plistFile.h"
+#include "logger.h"
+#include "trace.h"
+#include "valueStore.h"
 #include <QDebug>
 #include <QFile>
 #include <QDir>
+#include <QMutexLocker>
+
+namespace {
+
+/// Container renderings kept for change detection, diffs and rollbacks.
+const int kMaxSnapshots = 6;
+
+/// Hashes of evicted renderings remembered to explain a missing diff.
+const int kMaxEvicted = 64;
+
+} // namespace
 
 /**
  * @brief Construct a PlistFile monitor for a given plist path and key.
  *
- * - Expands a leading "~" to the user’s home directory.
- * - Verifies the file exists and initializes QSettings for native plist I/O.
- * - Reads and caches the initial value for change detection.
- * - Emits displayTextChanged and logs the initial state.
+ * No file I/O happens here; loadBaseline() opens the plist and reads the
+ * initial value, so a long list can be created before the UI appears and
+ * read in the background.
  *
  * @param plistPath   Filesystem path to the .plist (may begin with "~").
- * @param valueName   The key inside the plist to monitor.
+ * @param valueName   The key, key path or "/" inside the plist to monitor.
  * @param isCritical  If true, changes are treated as critical (rollback + alert).
  * @param parent      Optional parent QObject for Qt ownership.
  */
@@ -24,36 +37,53 @@ PlistFile::PlistFile(const QString &plistPath,
     , m_plistPath(plistPath)
     , m_valueName(valueName)
     , m_isCritical(isCritical)
+    , m_wholeDocument(valueName == QLatin1String("/"))
 {
-    // Expand "~" to home directory if present
-    QString expandedPath = m_plistPath;
-    if (expandedPath.startsWith("~")) {
-        expandedPath.replace(0, 1, QDir::homePath());
+    bool parsed = false;
+    if (!m_wholeDocument) {
+        m_keyPath = PlistKeyPath::parse(valueName, &parsed);
+    }
+    if (!parsed) {
+        m_keyPath = {PlistKeyPath::Step{valueName, -1}};
     }
 
+    // Prepare the display text; the value follows in loadBaseline()
+    updateDisplayText();
+}
+
+/**
+ * @brief Open the plist and cache its current value as the baseline.
+ *
+ * - Expands a leading "~" to the user’s home directory.
+ * - Verifies the file exists and initializes QSettings for native plist I/O.
+ * - Reads and caches the initial value for change detection.
+ *
+ * May run on a worker thread while no other thread touches this entry;
+ * baselineReady() publishes the result.
+ */
+void PlistFile::loadBaseline() {
+    // Expand "~" to home directory if present
+    const QString expandedPath = this->expandedPath();
+
     // Warn if the file is missing
-    if (!QFile::exists(expandedPath)) {
-        qWarning() << "[PLISTFILE] File does not exist:" << expandedPath;
+    ValueStore *store = ValueStore::instance();
+    if (store ? !store->exists(expandedPath) : !QFile::exists(expandedPath)) {
+        MON_WARN(LogCategory::Item) << "[PLISTFILE] File does not exist:" << expandedPath;
     } else {
-        qDebug() << "[PLISTFILE] File found at path:" << expandedPath;
+        MON_DEBUG(LogCategory::Item) << "[PLISTFILE] File found at path:" << expandedPath;
     }
 
-    // Initialize QSettings to read/write the plist in native format
+    // Initialize QSettings to read/write the plist in native format. It is
+    // used from this entry's thread afterwards, so hand it over.
     m_settings = new QSettings(expandedPath, QSettings::NativeFormat);
-
-    if (!m_settings) {
-        qWarning() << "[PLISTFILE] QSettings initialization failed for:" << expandedPath;
-    } else {
-        qDebug() << "[PLISTFILE] QSettings initialized for file:" << expandedPath;
-    }
+    m_settings->moveToThread(thread());
+    MON_DEBUG(LogCategory::Item) << "[PLISTFILE] QSettings initialized for file:" << expandedPath;
 
     // Cache the current and previous values for change detection
     m_value = readCurrentValue();
     m_previousValue = m_value;
-
-    // Prepare the display text and log initial state
-    updateDisplayText();
-    qDebug() << "[INIT] Plist key:" << m_valueName << ", Initial Value:" << m_value;
+    m_baselineReady.store(true, std::memory_order_release);
+    MON_DEBUG(LogCategory::Item) << "[INIT] Plist key:" << m_valueName << ", Initial Value:" << m_value;
 }
 
 /**
@@ -88,7 +118,7 @@ void PlistFile::updateDisplayText() {
  * @return True if critical.
  */
 bool PlistFile::isCritical() const {
-    qDebug() << "[DEBUG] isCritical for" << m_valueName << ":" << m_isCritical;
+    MON_TRACE(LogCategory::Item) << "[DEBUG] isCritical for" << m_valueName << ":" << m_isCritical;
     return m_isCritical;
 }
 
@@ -101,7 +131,7 @@ bool PlistFile::isCritical() const {
 void PlistFile::setCritical(bool critical) {
     if (m_isCritical != critical) {
         m_isCritical = critical;
-        qDebug() << "[DEBUG] Critical status for" << m_valueName
+        MON_DEBUG(LogCategory::Item) << "[DEBUG] Critical status for" << m_valueName
                  << "updated to" << m_isCritical;
         updateDisplayText();
         emit isCriticalChanged();
@@ -145,34 +175,26 @@ QString PlistFile::value() const {
  *
  * - Expands "~" to home path.
  * - Warns if the file or key is missing.
+ * - Renders dictionaries and arrays; an unchanged one is recognised by
+ *   its tree hash and returns the text it had before.
  *
  * @return The value as a QString, or empty if missing/invalid.
  */
 QString PlistFile::getCurrentValue() const {
-    QString expandedPath = m_plistPath;
-    if (expandedPath.startsWith("~")) {
-        expandedPath.replace(0, 1, QDir::homePath());
+    MON_SPAN(LogCategory::Item, "plist.read");
+    const QString expandedPath = this->expandedPath();
+
+    if (ValueStore::instance()) {
+        return textOf(readAddressed(nullptr));
     }
 
     if (!QFile::exists(expandedPath)) {
-        qWarning() << "[PLISTFILE] File does not exist:" << expandedPath;
+        MON_WARN_EVERY(LogCategory::Item, 60000) << "[PLISTFILE] File does not exist:" << expandedPath;
         return QString();
     }
 
     QSettings settings(expandedPath, QSettings::NativeFormat);
-
-    if (!settings.contains(m_valueName)) {
-        qWarning() << "[PLISTFILE] Key not found in plist:" << m_valueName;
-        return QString();
-    }
-
-    QVariant val = settings.value(m_valueName);
-    if (!val.isValid()) {
-        qWarning() << "[PLISTFILE] Invalid value retrieved for key:" << m_valueName;
-        return QString();
-    }
-
-    return val.toString();
+    return textOf(readAddressed(&settings));
 }
 
 /**
@@ -228,17 +250,75 @@ void PlistFile::setValue(const QString &value) {
                             .arg(m_valueName, m_previousValue, m_value));
 
         // Write to file
-        m_settings->setValue(m_valueName, m_value);
-        m_settings->sync();
+        if (!writeStoredValue(m_value)) {
+            MON_WARN(LogCategory::Item) << "[WARNING] Mismatch after set for file:" << m_plistPath;
+        }
+    }
+}
 
-        // Confirm the write
-        QString confirmed = m_settings->value(m_valueName).toString();
-        qDebug() << "[SET] Key:" << m_valueName
-                 << "Confirmed after write:" << confirmed;
-        if (confirmed != m_value) {
-            qWarning() << "[WARNING] Mismatch after set for file:" << m_plistPath;
+/**
+ * @brief Write a value to the plist and read it back.
+ *
+ * Container texts are written from their snapshot with the original types;
+ * a scalar under a key path keeps the type of the value it replaces when
+ * the text converts to it.
+ *
+ * @param value Value to store under valueName().
+ * @return True if the stored value matches afterwards.
+ */
+bool PlistFile::writeStoredValue(const QString &value) {
+    MON_SPAN(LogCategory::Item, "plist.write");
+    QVariant snapshot;
+    {
+        QMutexLocker locker(&m_snapshotMutex);
+        if (const Snapshot *found = findSnapshot(value)) {
+            snapshot = found->value;
         }
     }
+    if (snapshot.isValid() || m_wholeDocument || m_keyPath.size() > 1) {
+        if (!snapshot.isValid() && m_wholeDocument) {
+            MON_WARN(LogCategory::Item) << "[PLISTFILE] No parsed copy of the document to write back:"
+                                        << m_plistPath;
+            return false;
+        }
+        if (!ValueStore::instance() && !m_settings) {
+            MON_WARN(LogCategory::Item) << "[PLISTFILE] Write before the baseline was loaded:" << m_valueName;
+            return false;
+        }
+        const bool written = snapshot.isValid() ? writeAddressed(snapshot, false)
+                                                : writeAddressed(value, true);
+        const QString confirmed = written ? readCurrentValue() : QString();
+        MON_DEBUG(LogCategory::Item) << "[SET] Key path:" << m_valueName
+                 << "Confirmed after write:" << confirmed;
+        return written && confirmed == value;
+    }
+
+    QString confirmed;
+    if (ValueStore *store = ValueStore::instance()) {
+        store->setValue(expandedPath(), m_valueName, value);
+        confirmed = store->value(expandedPath(), m_valueName).toString();
+    } else if (!m_settings) {
+        MON_WARN(LogCategory::Item) << "[PLISTFILE] Write before the baseline was loaded:" << m_valueName;
+        return false;
+    } else {
+        m_settings->setValue(m_valueName, value);
+        m_settings->sync();
+        confirmed = m_settings->value(m_valueName).toString();
+    }
+    MON_DEBUG(LogCategory::Item) << "[SET] Key:" << m_valueName
+             << "Confirmed after write:" << confirmed;
+    return confirmed == value;
+}
+
+/**
+ * @brief The plist path with a leading "~" replaced by the home directory.
+ */
+QString PlistFile::expandedPath() const {
+    QString path = m_plistPath;
+    if (path.startsWith("~")) {
+        path.replace(0, 1, QDir::homePath());
+    }
+    return path;
 }
 
 /**
@@ -249,22 +329,202 @@ void PlistFile::setValue(const QString &value) {
  * @return The current value from QSettings, or empty if invalid.
  */
 QString PlistFile::readCurrentValue() const {
+    MON_SPAN(LogCategory::Item, "plist.readCached");
+    if (ValueStore::instance()) {
+        return textOf(readAddressed(nullptr));
+    }
     if (!m_settings) {
-        qWarning() << "[PLISTFILE] QSettings not initialized for:" << m_valueName;
+        MON_WARN_EVERY(LogCategory::Item, 60000) << "[PLISTFILE] QSettings not initialized for:" << m_valueName;
         return QString();
     }
 
     // We assume m_settings is already pointed at the correct file
-    if (!m_settings->contains(m_valueName)) {
-        qWarning() << "[PLISTFILE] Key not found in plist:" << m_valueName;
-        return QString();
+    return textOf(readAddressed(m_settings));
+}
+
+/**
+ * @brief Read the value valueName() addresses.
+ *
+ * The whole document is read key by key into one dictionary; a key path
+ * reads its top-level key and descends into it.
+ *
+ * @param settings Settings to read from; nullptr reads the ValueStore.
+ * @return The value, or an invalid QVariant if missing.
+ */
+QVariant PlistFile::readAddressed(QSettings *settings) const {
+    ValueStore *store = settings ? nullptr : ValueStore::instance();
+    const QString location = expandedPath();
+
+    if (m_wholeDocument) {
+        const QStringList keys = store ? store->keys(location)
+                                       : settings->childKeys() + settings->childGroups();
+        QVariantMap document;
+        for (const QString &key : keys) {
+            document.insert(key, store ? store->value(location, key) : settings->value(key));
+        }
+        return document;
     }
 
-    QVariant val = m_settings->value(m_valueName);
-    if (!val.isValid()) {
-        qWarning() << "[PLISTFILE] Invalid value retrieved for key:" << m_valueName;
-        return QString();
+    const QString &topKey = m_keyPath.first().key;
+    QVariant val;
+    if (store) {
+        val = store->value(location, topKey);
+    } else {
+        if (!settings->contains(topKey)) {
+            MON_WARN_EVERY(LogCategory::Item, 60000) << "[PLISTFILE] Key not found in plist:" << m_valueName;
+            return QVariant();
+        }
+        val = settings->value(topKey);
+        if (!val.isValid()) {
+            MON_WARN_EVERY(LogCategory::Item, 60000) << "[PLISTFILE] Invalid value retrieved for key:" << m_valueName;
+            return QVariant();
+        }
     }
 
-    return val.toString();
+    if (m_keyPath.size() > 1 && val.isValid()) {
+        bool found = false;
+        val = PlistKeyPath::resolve(val, m_keyPath, 1, &found);
+        if (!found && !store) {
+            MON_WARN_EVERY(LogCategory::Item, 60000) << "[PLISTFILE] Key path not found in plist:" << m_valueName;
+        }
+    }
+    return val;
+}
+
+/**
+ * @brief Store @p value at valueName() through the ValueStore or m_settings.
+ *
+ * The whole document is written key by key, touching only keys whose value
+ * differs and removing keys @p value does not have. A key path rewrites its
+ * top-level key with the nested value replaced.
+ *
+ * @param convertLeaf Convert @p value to the type of the value it replaces.
+ * @return False if the key path cannot be followed.
+ */
+bool PlistFile::writeAddressed(const QVariant &value, bool convertLeaf) {
+    ValueStore *store = ValueStore::instance();
+    const QString location = expandedPath();
+    auto get = [&](const QString &key) {
+        return store ? store->value(location, key) : m_settings->value(key);
+    };
+    auto put = [&](const QString &key, const QVariant &v) {
+        if (store) {
+            store->setValue(location, key, v);
+        } else if (v.isValid()) {
+            m_settings->setValue(key, v);
+        } else {
+            m_settings->remove(key);
+        }
+    };
+
+    if (m_wholeDocument) {
+        const QVariantMap document = value.toMap();
+        const QStringList keys = store ? store->keys(location)
+                                       : m_settings->childKeys() + m_settings->childGroups();
+        for (const QString &key : keys) {
+            if (!document.contains(key)) {
+                put(key, QVariant());
+            }
+        }
+        for (auto it = document.cbegin(); it != document.cend(); ++it) {
+            if (get(it.key()) != it.value()) {
+                put(it.key(), it.value());
+            }
+        }
+    } else {
+        const QString &topKey = m_keyPath.first().key;
+        QVariant root = get(topKey);
+        QVariant leaf = value;
+        if (convertLeaf) {
+            const QVariant old = PlistKeyPath::resolve(root, m_keyPath, 1);
+            QVariant converted = leaf;
+            if (old.isValid() && old.typeId() != QMetaType::QString && converted.convert(old.metaType())) {
+                leaf = converted;
+            }
+        }
+        if (!PlistKeyPath::assign(root, m_keyPath, 1, leaf)) {
+            MON_WARN(LogCategory::Item) << "[PLISTFILE] Key path cannot be written:" << m_valueName;
+            return false;
+        }
+        put(topKey, root);
+    }
+
+    if (!store) {
+        m_settings->sync();
+    }
+    return true;
+}
+
+/**
+ * @brief Text of a value read from the plist.
+ *
+ * Scalars use QVariant::toString(). Containers are hashed into a PlistTree;
+ * if a retained snapshot has the same root hash its text is returned
+ * without rendering again, otherwise the new rendering is retained,
+ * dropping the oldest one that is not the current, previous or new value.
+ */
+QString PlistFile::textOf(const QVariant &value) const {
+    if (!PlistTree::isContainer(value)) {
+        return value.toString();
+    }
+    PlistTree tree(value);
+
+    QMutexLocker locker(&m_snapshotMutex);
+    for (int i = m_snapshots.size() - 1; i >= 0; --i) {
+        if (m_snapshots.at(i).tree.hash() == tree.hash()) {
+            const Snapshot hit = m_snapshots.takeAt(i);
+            m_snapshots.append(hit);
+            return hit.text;
+        }
+    }
+
+    if (m_snapshots.size() >= kMaxSnapshots) {
+        int evict = 0;
+        for (int i = 0; i < m_snapshots.size(); ++i) {
+            const QString &text = m_snapshots.at(i).text;
+            if (text != m_value && text != m_previousValue && text != m_newValue) {
+                evict = i;
+                break;
+            }
+        }
+        if (m_evicted.size() >= kMaxEvicted) {
+            m_evicted.clear();
+        }
+        m_evicted.insert(qHash(m_snapshots.at(evict).text));
+        m_snapshots.removeAt(evict);
+    }
+    const QString text = tree.render();
+    m_snapshots.append(Snapshot{text, value, tree});
+    return text;
+}
+
+/// Caller holds m_snapshotMutex.
+const PlistFile::Snapshot *PlistFile::findSnapshot(const QString &text) const {
+    for (const Snapshot &snapshot : m_snapshots) {
+        if (snapshot.text == text) {
+            return &snapshot;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Changed leaves between two retained renderings.
+ * @return Key paths within the plist with their old and new text; empty if
+ *         either text has no snapshot. A warning names the entry when a
+ *         snapshot was evicted rather than never taken (a scalar).
+ */
+QVector<PlistLeafChange> PlistFile::changedLeaves(const QString &from, const QString &to) const {
+    QMutexLocker locker(&m_snapshotMutex);
+    const Snapshot *before = findSnapshot(from);
+    const Snapshot *after  = findSnapshot(to);
+    if (!before || !after) {
+        if ((!before && m_evicted.contains(qHash(from))) || (!after && m_evicted.contains(qHash(to)))) {
+            MON_WARN_EVERY(LogCategory::Item, 60000) << "[PLISTFILE] More than" << kMaxSnapshots
+                                                     << "distinct values of" << m_valueName
+                                                     << "in flight; logging the change as one row.";
+        }
+        return {};
+    }
+    return PlistTree::diff(before->tree, after->tree, m_wholeDocument ? QString() : m_valueName);
 }
@@ -1,5 +1,8 @@
 #include "plistFileModel.h"
+#include "rowReorderIndex.h"
 #include <QDebug>
+#include <QSet>
+#include <utility>
 
 /**
  * @file PlistFileModel.cpp
@@ -25,17 +28,175 @@ PlistFileModel::PlistFileModel(QObject *parent)
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
- * @brief Replace the model’s contents with a new list of PlistFile pointers.
+ * @brief Apply a new list of PlistFile pointers as row-level edits.
  * @param files List of PlistFile* to expose via this model.
  *
- * Emits beginResetModel()/endResetModel() to notify attached views.
+ * 1. Remove rows whose entry is gone (contiguous ranges, bottom-up).
+ * 2. Walk the new order: insert missing entries, move displaced ones into
+ *    place, and swap replaced objects with a per-role dataChanged().
+ * Unchanged rows produce no signals at all.
  */
 void PlistFileModel::setPlistFiles(const QList<PlistFile*> &files) {
+    QSet<QString> incoming;
+    incoming.reserve(files.size());
+    for (const PlistFile *file : files) {
+        incoming.insert(identity(file));
+    }
+
+    // 1) Removals
+    for (int row = m_plistFiles.size() - 1; row >= 0; --row) {
+        if (incoming.contains(identity(m_plistFiles[row]))) {
+            continue;
+        }
+        const int last = row;
+        while (row > 0 && !incoming.contains(identity(m_plistFiles[row - 1]))) {
+            --row;
+        }
+        beginRemoveRows(QModelIndex(), row, last);
+        for (int i = row; i <= last; ++i) {
+            unwatch(m_plistFiles[i]);
+        }
+        m_plistFiles.erase(m_plistFiles.begin() + row, m_plistFiles.begin() + last + 1);
+        endRemoveRows();
+    }
+
+    // 2) Inserts, moves and in-place replacements
+    // Identities are computed once; each lookup is then O(log n)
+    QStringList ids;
+    ids.reserve(m_plistFiles.size());
+    for (const PlistFile *file : std::as_const(m_plistFiles)) {
+        ids.append(identity(file));
+    }
+    RowReorderIndex order(ids);
+
+    for (int i = 0; i < files.size(); ++i) {
+        PlistFile *target = files[i];
+        const int from = order.take(identity(target), i);
+
+        if (from < 0) {
+            beginInsertRows(QModelIndex(), i, i);
+            m_plistFiles.insert(i, target);
+            watch(target);
+            endInsertRows();
+            continue;
+        }
+        if (from != i) {
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), i);
+            m_plistFiles.move(from, i);
+            endMoveRows();
+        }
+
+        PlistFile *current = m_plistFiles[i];
+        if (current != target) {
+            const QList<int> roles = changedRoles(current, target);
+            unwatch(current);
+            m_plistFiles[i] = target;
+            watch(target);
+            if (!roles.isEmpty()) {
+                emit dataChanged(index(i), index(i), roles);
+            }
+        }
+    }
+
+    // Leftover duplicates from the old list
+    if (m_plistFiles.size() > files.size()) {
+        beginRemoveRows(QModelIndex(), files.size(), m_plistFiles.size() - 1);
+        for (int i = files.size(); i < m_plistFiles.size(); ++i) {
+            unwatch(m_plistFiles[i]);
+        }
+        m_plistFiles.erase(m_plistFiles.begin() + files.size(), m_plistFiles.end());
+        endRemoveRows();
+    }
+
+    rebuildIndex();
+}
+
+/**
+ * @brief Clear all items and reset attached views.
+ */
+void PlistFileModel::resetModel() {
     beginResetModel();
-    m_plistFiles = files;
+    for (PlistFile *file : std::as_const(m_plistFiles)) {
+        unwatch(file);
+    }
+    m_plistFiles.clear();
+    rebuildIndex();
     endResetModel();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Lookup & Change Tracking
+////////////////////////////////////////////////////////////////////////////////
+
+int PlistFileModel::rowFor(const QString &plistPath, const QString &valueName) const {
+    return m_rowById.value(identity(plistPath, valueName), -1);
+}
+
+PlistFile *PlistFileModel::fileFor(const QString &plistPath, const QString &valueName) const {
+    const int row = rowFor(plistPath, valueName);
+    return row >= 0 ? m_plistFiles.at(row) : nullptr;
+}
+
+QString PlistFileModel::identity(const PlistFile *file) {
+    return identity(file->plistPath(), file->valueName());
+}
+
+QString PlistFileModel::identity(const QString &plistPath, const QString &valueName) {
+    return plistPath + QLatin1Char('|') + valueName;
+}
+
+QList<int> PlistFileModel::changedRoles(const PlistFile *before, const PlistFile *after) {
+    QList<int> roles;
+    if (before->valueName() != after->valueName()) {
+        roles << ValueNameRole;
+    }
+    if (before->isCritical() != after->isCritical()) {
+        roles << IsCriticalRole;
+    }
+    if (before->displayText() != after->displayText()) {
+        roles << DisplayTextRole;
+    }
+    return roles;
+}
+
+/**
+ * @brief Forward an entry's own change signals to views.
+ *
+ * Toggling criticality on an entry updates its delegate without the
+ * caller having to know the row.
+ */
+void PlistFileModel::watch(PlistFile *file) {
+    connect(file, &PlistFile::isCriticalChanged, this, [this, file]() {
+        notifyRoles(file, { IsCriticalRole });
+    });
+    connect(file, &PlistFile::displayTextChanged, this, [this, file]() {
+        notifyRoles(file, { DisplayTextRole });
+    });
+}
+
+void PlistFileModel::unwatch(PlistFile *file) {
+    disconnect(file, nullptr, this, nullptr);
+}
+
+void PlistFileModel::notifyRoles(const PlistFile *file, const QList<int> &roles) {
+    const int row = m_rowByFile.value(file, -1);
+    if (row >= 0) {
+        emit dataChanged(index(row), index(row), roles);
+    }
+}
+
+void PlistFileModel::rebuildIndex() {
+    m_rowById.clear();
+    m_rowByFile.clear();
+    m_rowById.reserve(m_plistFiles.size());
+    m_rowByFile.reserve(m_plistFiles.size());
+    for (int row = 0; row < m_plistFiles.size(); ++row) {
+        const PlistFile *file = m_plistFiles[row];
+        m_rowById.insert(identity(file), row);
+        m_rowByFile.insert(file, row);
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // QAbstractListModel Overrides
 ////////////////////////////////////////////////////////////////////////////////
@@ -59,7 +220,7 @@ int PlistFileModel::rowCount(const QModelIndex &parent) const {
  * @return A QVariant containing the requested data, or invalid if out-of-bounds.
  */
 QVariant PlistFileModel::data(const QModelIndex &index, int role) const {
-    if (!index.isValid()) {
+    if (!index.isValid() || index.row() >= m_plistFiles.size()) {
         return QVariant();
     }
 
@@ -75,6 +236,9 @@ QVariant PlistFileModel::data(const QModelIndex &index, int role) const {
     case DisplayTextRole:
         // Return the formatted display text (e.g., "KeyName - Critical")
         return file->displayText();
+    case PlistPathRole:
+        // Return the plist file holding the key
+        return file->plistPath();
     default:
         return QVariant();
     }
@@ -91,5 +255,6 @@ QHash<int, QByteArray> PlistFileModel::roleNames() const {
     roles[ValueNameRole]   = "valueName";
     roles[IsCriticalRole]  = "isCritical";
     roles[DisplayTextRole] = "displayText";
+    roles[PlistPathRole]   = "plistPath";
     return roles;
 }
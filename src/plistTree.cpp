@@ -0,0 +1,419 @@
+#include "plistTree.h"
+
+#include <QDateTime>
+#include <QHashFunctions>
+#include <QStringList>
+#include <QVariantMap>
+
+/**
+ * @file plistTree.cpp
+ * @brief Key paths into plist values and hashed trees for structural diffs.
+ */
+
+namespace {
+
+const int kMaxDepth = 128;     ///< Deeper containers are reported as one leaf
+
+bool isMap(const QVariant &value) {
+    const int type = value.typeId();
+    return type == QMetaType::QVariantMap || type == QMetaType::QVariantHash;
+}
+
+bool isList(const QVariant &value) {
+    const int type = value.typeId();
+    return type == QMetaType::QVariantList || type == QMetaType::QStringList;
+}
+
+/// QSettings hands out dictionaries as QVariantHash on some platforms.
+QVariantMap asMap(const QVariant &value) {
+    if (value.typeId() != QMetaType::QVariantHash) {
+        return value.toMap();
+    }
+    const QVariantHash hash = value.toHash();
+    QVariantMap map;
+    for (auto it = hash.cbegin(); it != hash.cend(); ++it) {
+        map.insert(it.key(), it.value());
+    }
+    return map;
+}
+
+QString childPath(const QString &path, const QString &key) {
+    return path.isEmpty() ? key : path + '/' + key;
+}
+
+QString indexPath(const QString &path, int index) {
+    return path + '[' + QString::number(index) + ']';
+}
+
+quint64 mix(quint64 h, quint64 v) {
+    return h ^ (v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+}
+
+/// splitmix64 finaliser, so sibling hashes differ in every bit.
+quint64 finish(quint64 x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+void appendQuoted(QString &out, const QString &text) {
+    out += '"';
+    for (const QChar c : text) {
+        switch (c.unicode()) {
+        case '"':  out += QLatin1String("\\\""); break;
+        case '\\': out += QLatin1String("\\\\"); break;
+        case '\n': out += QLatin1String("\\n");  break;
+        case '\r': out += QLatin1String("\\r");  break;
+        case '\t': out += QLatin1String("\\t");  break;
+        default:
+            if (c.unicode() < 0x20) {
+                out += QStringLiteral("\\u%1").arg(c.unicode(), 4, 16, QLatin1Char('0'));
+            } else {
+                out += c;
+            }
+        }
+    }
+    out += '"';
+}
+
+bool assignAt(QVariant &node, const QVector<PlistKeyPath::Step> &steps, int i, const QVariant &value) {
+    if (i == steps.size()) {
+        node = value;
+        return true;
+    }
+    const PlistKeyPath::Step &step = steps.at(i);
+    if (step.index < 0) {
+        if (node.isValid() && !isMap(node)) {
+            return false;
+        }
+        QVariantMap map = asMap(node);
+        QVariant child = map.value(step.key);
+        if (!assignAt(child, steps, i + 1, value)) {
+            return false;
+        }
+        map.insert(step.key, child);
+        node = map;
+        return true;
+    }
+    if (!isList(node)) {
+        return false;
+    }
+    QVariantList list = node.toList();
+    if (step.index >= list.size()) {
+        return false;
+    }
+    QVariant child = list.at(step.index);
+    if (!assignAt(child, steps, i + 1, value)) {
+        return false;
+    }
+    list[step.index] = child;
+    node = list;
+    return true;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// Key Paths
+////////////////////////////////////////////////////////////////////////////////
+
+QVector<PlistKeyPath::Step> PlistKeyPath::parse(const QString &keyPath, bool *ok) {
+    QVector<Step> steps;
+    bool valid = !keyPath.isEmpty();
+    const QStringList segments = keyPath.split('/');
+    for (const QString &segment : segments) {
+        if (!valid) {
+            break;
+        }
+        int bracket = segment.indexOf('[');
+        const QString name = bracket < 0 ? segment : segment.left(bracket);
+        if (name.isEmpty()) {
+            valid = false;
+            break;
+        }
+        steps.append(Step{name, -1});
+        while (bracket >= 0) {
+            const int close = segment.indexOf(']', bracket);
+            bool numeric = false;
+            const int index = close < 0 ? -1 : segment.mid(bracket + 1, close - bracket - 1).toInt(&numeric);
+            if (!numeric || index < 0) {
+                valid = false;
+                break;
+            }
+            steps.append(Step{QString(), index});
+            if (close + 1 == segment.size()) {
+                bracket = -1;
+            } else if (segment.at(close + 1) == '[') {
+                bracket = close + 1;
+            } else {
+                valid = false;
+                break;
+            }
+        }
+    }
+    if (ok) {
+        *ok = valid;
+    }
+    return valid ? steps : QVector<Step>();
+}
+
+QVariant PlistKeyPath::resolve(const QVariant &value, const QVector<Step> &steps, int from, bool *found) {
+    QVariant current = value;
+    for (int i = from; i < steps.size(); ++i) {
+        const Step &step = steps.at(i);
+        bool present = false;
+        if (step.index < 0 && isMap(current)) {
+            const QVariantMap map = asMap(current);
+            const auto it = map.constFind(step.key);
+            present = it != map.cend();
+            current = present ? *it : QVariant();
+        } else if (step.index >= 0 && isList(current)) {
+            const QVariantList list = current.toList();
+            present = step.index < list.size();
+            current = present ? list.at(step.index) : QVariant();
+        }
+        if (!present) {
+            if (found) {
+                *found = false;
+            }
+            return QVariant();
+        }
+    }
+    if (found) {
+        *found = true;
+    }
+    return current;
+}
+
+bool PlistKeyPath::assign(QVariant &root, const QVector<Step> &steps, int from, const QVariant &value) {
+    return assignAt(root, steps, from, value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Hashed Trees
+////////////////////////////////////////////////////////////////////////////////
+
+PlistTree::PlistTree(const QVariant &root) {
+    build(root, 0);
+}
+
+bool PlistTree::isContainer(const QVariant &value) {
+    return isMap(value) || isList(value);
+}
+
+/**
+ * @brief Append the node for @p value and, depth first, its children.
+ * @return Index of the node.
+ */
+int PlistTree::build(const QVariant &value, int depth) {
+    const int index = m_nodes.size();
+    m_nodes.append(Node());
+    const size_t seed = QHashSeed::globalSeed();
+
+    Node node;
+    if (isContainer(value) && depth >= kMaxDepth) {
+        node.kind = Kind::String;
+        node.text = QStringLiteral("[nested too deep]");
+    } else if (isMap(value)) {
+        // QVariantMap iterates in key order, so children end up sorted
+        const QVariantMap map = asMap(value);
+        node.kind  = Kind::Dictionary;
+        node.first = m_children.size();
+        node.count = map.size();
+        m_children.resize(node.first + node.count);
+        quint64 h = mix(quint64(Kind::Dictionary), quint64(node.count));
+        int i = 0;
+        for (auto it = map.cbegin(); it != map.cend(); ++it, ++i) {
+            const int child = build(it.value(), depth + 1);
+            m_children[node.first + i] = Child{it.key(), child};
+            h = mix(h, qHash(it.key(), seed));
+            h = mix(h, m_nodes.at(child).hash);
+        }
+        node.hash = finish(h);
+    } else if (isList(value)) {
+        const QVariantList list = value.toList();
+        node.kind  = Kind::Array;
+        node.first = m_children.size();
+        node.count = list.size();
+        m_children.resize(node.first + node.count);
+        quint64 h = mix(quint64(Kind::Array), quint64(node.count));
+        for (int i = 0; i < list.size(); ++i) {
+            const int child = build(list.at(i), depth + 1);
+            m_children[node.first + i] = Child{QString(), child};
+            h = mix(h, m_nodes.at(child).hash);
+        }
+        node.hash = finish(h);
+    } else {
+        switch (value.typeId()) {
+        case QMetaType::UnknownType:
+            node.kind = Kind::Null;
+            break;
+        case QMetaType::Bool:
+            node.kind = Kind::Bool;
+            node.text = value.toString();
+            break;
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::LongLong:
+        case QMetaType::ULongLong:
+        case QMetaType::Double:
+        case QMetaType::Float:
+            node.kind = Kind::Number;
+            node.text = value.toString();
+            break;
+        case QMetaType::QDateTime:
+            node.kind = Kind::Date;
+            node.text = value.toDateTime().toString(Qt::ISODateWithMs);
+            break;
+        case QMetaType::QByteArray:
+            node.kind = Kind::Data;
+            node.text = QString::fromLatin1(value.toByteArray().toHex());
+            break;
+        default:
+            node.kind = Kind::String;
+            node.text = value.toString();
+        }
+        node.hash = finish(mix(quint64(node.kind), qHash(node.text, seed)));
+    }
+    m_nodes[index] = node;
+    return index;
+}
+
+QString PlistTree::render() const {
+    QString out;
+    if (!m_nodes.isEmpty()) {
+        renderNode(0, out);
+    }
+    return out;
+}
+
+/// Leaves as their plain text, containers rendered.
+QString PlistTree::textOf(int node) const {
+    const Node &n = m_nodes.at(node);
+    if (n.kind != Kind::Dictionary && n.kind != Kind::Array) {
+        return n.text;
+    }
+    QString out;
+    renderNode(node, out);
+    return out;
+}
+
+void PlistTree::renderNode(int node, QString &out) const {
+    const Node &n = m_nodes.at(node);
+    switch (n.kind) {
+    case Kind::Null:
+        out += QLatin1String("null");
+        break;
+    case Kind::Bool:
+    case Kind::Number:
+        out += n.text;
+        break;
+    case Kind::String:
+    case Kind::Date:
+    case Kind::Data:
+        appendQuoted(out, n.text);
+        break;
+    case Kind::Dictionary:
+    case Kind::Array: {
+        const bool dictionary = n.kind == Kind::Dictionary;
+        out += dictionary ? '{' : '[';
+        for (int i = 0; i < n.count; ++i) {
+            const Child &child = m_children.at(n.first + i);
+            if (i > 0) {
+                out += ',';
+            }
+            if (dictionary) {
+                appendQuoted(out, child.key);
+                out += ':';
+            }
+            renderNode(child.node, out);
+        }
+        out += dictionary ? '}' : ']';
+        break;
+    }
+    }
+}
+
+QVector<PlistLeafChange> PlistTree::diff(const PlistTree &before, const PlistTree &after,
+                                         const QString &basePath) {
+    QVector<PlistLeafChange> out;
+    const QString path = basePath.isEmpty() ? QStringLiteral("/") : basePath;
+    if (before.isNull() || after.isNull()) {
+        if (before.isNull() != after.isNull()) {
+            out.append(PlistLeafChange{path,
+                                       before.isNull() ? QString() : before.textOf(0),
+                                       after.isNull() ? QString() : after.textOf(0)});
+        }
+        return out;
+    }
+    diffNodes(before, 0, after, 0, basePath, out);
+    return out;
+}
+
+void PlistTree::diffNodes(const PlistTree &before, int a, const PlistTree &after, int b,
+                          const QString &path, QVector<PlistLeafChange> &out) {
+    const Node &x = before.m_nodes.at(a);
+    const Node &y = after.m_nodes.at(b);
+    if (x.hash == y.hash) {
+        return;     // Identical subtree
+    }
+    if (x.kind != y.kind || (x.kind != Kind::Dictionary && x.kind != Kind::Array)) {
+        out.append(PlistLeafChange{path.isEmpty() ? QStringLiteral("/") : path,
+                                   before.textOf(a), after.textOf(b)});
+        return;
+    }
+
+    if (x.kind == Kind::Dictionary) {
+        // Both child ranges are sorted by key: merge them
+        int i = 0;
+        int j = 0;
+        while (i < x.count || j < y.count) {
+            const Child *left  = i < x.count ? &before.m_children.at(x.first + i) : nullptr;
+            const Child *right = j < y.count ? &after.m_children.at(y.first + j) : nullptr;
+            if (right == nullptr || (left != nullptr && left->key < right->key)) {
+                out.append(PlistLeafChange{childPath(path, left->key), before.textOf(left->node), QString()});
+                ++i;
+            } else if (left == nullptr || right->key < left->key) {
+                out.append(PlistLeafChange{childPath(path, right->key), QString(), after.textOf(right->node)});
+                ++j;
+            } else {
+                diffNodes(before, left->node, after, right->node, childPath(path, left->key), out);
+                ++i;
+                ++j;
+            }
+        }
+        return;
+    }
+
+    // Arrays: skip the common prefix and suffix, pair up what remains
+    auto hashAt = [](const PlistTree &tree, const Node &node, int i) {
+        return tree.m_nodes.at(tree.m_children.at(node.first + i).node).hash;
+    };
+    int prefix = 0;
+    while (prefix < x.count && prefix < y.count && hashAt(before, x, prefix) == hashAt(after, y, prefix)) {
+        ++prefix;
+    }
+    int suffix = 0;
+    while (suffix < x.count - prefix && suffix < y.count - prefix
+           && hashAt(before, x, x.count - 1 - suffix) == hashAt(after, y, y.count - 1 - suffix)) {
+        ++suffix;
+    }
+    const int oldEnd = x.count - suffix;
+    const int newEnd = y.count - suffix;
+    const int paired = qMin(oldEnd, newEnd) - prefix;
+    for (int k = 0; k < paired; ++k) {
+        const int i = prefix + k;
+        diffNodes(before, before.m_children.at(x.first + i).node,
+                  after, after.m_children.at(y.first + i).node, indexPath(path, i), out);
+    }
+    for (int i = prefix + paired; i < oldEnd; ++i) {
+        out.append(PlistLeafChange{indexPath(path, i),
+                                   before.textOf(before.m_children.at(x.first + i).node), QString()});
+    }
+    for (int i = prefix + paired; i < newEnd; ++i) {
+        out.append(PlistLeafChange{indexPath(path, i),
+                                   QString(), after.textOf(after.m_children.at(y.first + i).node)});
+    }
+}
@@ -1,5 +1,8 @@
 #include "registryKey.h"   // Definition of RegistryKey class
-#include <QDebug>          // qDebug / qWarning for logging
+#include "logger.h"      // MON_* structured logging
+#include "trace.h"       // MON_SPAN scoped spans
+#include "valueStore.h"  // Optional in-memory stand-in for the registry
+#include <QDebug>          // QDebug stream operators
 #include <QSettings>       // QSettings for registry I/O
 
 /**
@@ -7,8 +10,8 @@
  *
  * - Builds the full registry path (hive + keyPath).
  * - Initializes QSettings in NativeFormat to read/write that key.
- * - Reads and caches the initial value for change detection.
- * - Updates the displayText and logs the initial state.
+ * - Updates the displayText.
+ * The value itself is read by loadBaseline(), off the startup path.
  *
  * @param hive         Registry hive (e.g., "HKEY_CURRENT_USER" or "HKEY_LOCAL_MACHINE").
  * @param keyPath      Path under the hive (e.g., "Software\\MyApp\\Settings").
@@ -27,22 +30,24 @@ RegistryKey::RegistryKey(const QString &hive,
     , m_valueName(valueName)
     , m_isCritical(isCritical)
 {
-    // Compose the full registry path for QSettings
-    QString fullKey = (m_hive == "HKEY_CURRENT_USER"
-                           ? "HKEY_CURRENT_USER\\"
-                           : "HKEY_LOCAL_MACHINE\\")
-                      + m_keyPath;
-
     // Initialize QSettings for native Windows registry I/O
-    m_settings = new QSettings(fullKey, QSettings::NativeFormat);
+    m_settings = new QSettings(fullKey(), QSettings::NativeFormat);
+
+    // Prepare display text; the value follows in loadBaseline()
+    updateDisplayText();
+}
 
-    // Read and cache the current on-disk value
+/**
+ * @brief Read and cache the current registry value as the baseline.
+ *
+ * May run on a worker thread while no other thread touches this key;
+ * baselineReady() publishes the result.
+ */
+void RegistryKey::loadBaseline() {
     m_value = readCurrentValue();
     m_previousValue = m_value;
-
-    // Prepare display text and log initialization
-    updateDisplayText();
-    qDebug() << "[INIT] RegistryKey:" << m_valueName
+    m_baselineReady.store(true, std::memory_order_release);
+    MON_DEBUG(LogCategory::Item) << "[INIT] RegistryKey:" << m_valueName
              << "Initial Value:" << m_value;
 }
 
@@ -92,7 +97,7 @@ bool RegistryKey::isCritical() const {
 void RegistryKey::setCritical(bool critical) {
     if (m_isCritical != critical) {
         m_isCritical = critical;
-        qDebug() << "[INFO] RegistryKey" << m_valueName
+        MON_DEBUG(LogCategory::Item) << "[INFO] RegistryKey" << m_valueName
                  << "critical set to" << m_isCritical;
         updateDisplayText();
         emit isCriticalChanged();
@@ -115,6 +120,56 @@ QString RegistryKey::name() const {
     return m_valueName;
 }
 
+/**
+ * @brief Return the registry hive of this entry.
+ * @return Hive identifier, e.g. "HKEY_CURRENT_USER".
+ */
+QString RegistryKey::hive() const {
+    return m_hive;
+}
+
+/**
+ * @brief Return the key path within the hive.
+ * @return Registry key path.
+ */
+QString RegistryKey::keyPath() const {
+    return m_keyPath;
+}
+
+/**
+ * @brief Return the monitored value name.
+ * @return Same as name().
+ */
+QString RegistryKey::valueName() const {
+    return m_valueName;
+}
+
+/**
+ * @brief Number of changes since the counter was last reset.
+ */
+int RegistryKey::changeCount() const {
+    return m_changeCount;
+}
+
+void RegistryKey::incrementChangeCount() {
+    ++m_changeCount;
+}
+
+void RegistryKey::resetChangeCount() {
+    m_changeCount = 0;
+}
+
+/**
+ * @brief QSettings instance used for registry I/O.
+ */
+QSettings* RegistryKey::settings() const {
+    return m_settings;
+}
+
+void RegistryKey::setSettings(QSettings* settings) {
+    m_settings = settings;
+}
+
 /**
  * @brief Get the last-known in-memory value.
  * @return Cached m_value.
@@ -184,25 +239,48 @@ void RegistryKey::setValue(const QString &value) {
         m_value = value;
 
         // Write to registry
-        m_settings->setValue(m_valueName, m_value);
+        if (!writeStoredValue(m_value)) {
+            MON_WARN(LogCategory::Item) << "[WARNING] Mismatch after set for key:" << m_keyPath;
+        }
+    }
+}
+
+/**
+ * @brief Write a value to the registry and read it back.
+ *
+ * QSettings is re-created after the write to drop any cached state.
+ *
+ * @param value Value to store under valueName().
+ * @return True if the stored value matches afterwards.
+ */
+bool RegistryKey::writeStoredValue(const QString &value) {
+    MON_SPAN(LogCategory::Item, "registry.write");
+    QString confirmedValue;
+    if (ValueStore *store = ValueStore::instance()) {
+        store->setValue(fullKey(), m_valueName, value);
+        confirmedValue = store->value(fullKey(), m_valueName).toString();
+    } else {
+        m_settings->setValue(m_valueName, value);
         m_settings->sync();
 
         // Reinitialize QSettings to reload any internal state
         delete m_settings;
-        QString fullKey = (m_hive == "HKEY_CURRENT_USER"
-                               ? "HKEY_CURRENT_USER\\"
-                               : "HKEY_LOCAL_MACHINE\\")
-                          + m_keyPath;
-        m_settings = new QSettings(fullKey, QSettings::NativeFormat);
-
-        // Confirm the write
-        QString confirmedValue = m_settings->value(m_valueName).toString();
-        qDebug() << "[SET] RegistryKey:" << m_valueName
-                 << "Confirmed Value:" << confirmedValue;
-        if (confirmedValue != m_value) {
-            qWarning() << "[WARNING] Mismatch after set for key:" << m_keyPath;
-        }
+        m_settings = new QSettings(fullKey(), QSettings::NativeFormat);
+        confirmedValue = m_settings->value(m_valueName).toString();
     }
+    MON_DEBUG(LogCategory::Item) << "[SET] RegistryKey:" << m_valueName
+             << "Confirmed Value:" << confirmedValue;
+    return confirmedValue == value;
+}
+
+/**
+ * @brief Compose the full registry path for QSettings.
+ */
+QString RegistryKey::fullKey() const {
+    return (m_hive == "HKEY_CURRENT_USER"
+                ? "HKEY_CURRENT_USER\\"
+                : "HKEY_LOCAL_MACHINE\\")
+           + m_keyPath;
 }
 
 /**
@@ -210,5 +288,9 @@ void RegistryKey::setValue(const QString &value) {
  * @return The on-disk value, or an empty QString if unavailable.
  */
 QString RegistryKey::readCurrentValue() const {
+    MON_SPAN(LogCategory::Item, "registry.read");
+    if (ValueStore *store = ValueStore::instance()) {
+        return store->value(fullKey(), m_valueName).toString();
+    }
     return m_settings->value(m_valueName).toString();
 }
@@ -8,7 +8,10 @@
  */
 
 #include "registryKeyModel.h"
+#include "rowReorderIndex.h"
 #include <QDebug>
+#include <QSet>
+#include <utility>
 
 ////////////////////////////////////////////////////////////////////////////////
 // Constructor
@@ -31,18 +34,173 @@ RegistryKeyModel::RegistryKeyModel(QObject *parent)
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
- * @brief Replace the model’s contents with a new list of RegistryKey pointers.
- * @param keys List of RegistryKey* to expose via this model
+ * @brief Apply a new list of RegistryKey pointers as row-level edits.
+ * @param keys List of RegistryKey* to expose via this model.
  *
- * Emits beginResetModel()/endResetModel() to notify any attached views
- * that the underlying data has changed completely.
+ * 1. Remove rows whose entry is gone (contiguous ranges, bottom-up).
+ * 2. Walk the new order: insert missing entries, move displaced ones into
+ *    place, and swap replaced objects with a per-role dataChanged().
+ * Unchanged rows produce no signals at all.
  */
 void RegistryKeyModel::setRegistryKeys(const QList<RegistryKey*> &keys) {
+    QSet<QString> incoming;
+    incoming.reserve(keys.size());
+    for (const RegistryKey *key : keys) {
+        incoming.insert(identity(key));
+    }
+
+    // 1) Removals
+    for (int row = m_registryKeys.size() - 1; row >= 0; --row) {
+        if (incoming.contains(identity(m_registryKeys[row]))) {
+            continue;
+        }
+        const int last = row;
+        while (row > 0 && !incoming.contains(identity(m_registryKeys[row - 1]))) {
+            --row;
+        }
+        beginRemoveRows(QModelIndex(), row, last);
+        for (int i = row; i <= last; ++i) {
+            unwatch(m_registryKeys[i]);
+        }
+        m_registryKeys.erase(m_registryKeys.begin() + row, m_registryKeys.begin() + last + 1);
+        endRemoveRows();
+    }
+
+    // 2) Inserts, moves and in-place replacements
+    // Identities are computed once; each lookup is then O(log n)
+    QStringList ids;
+    ids.reserve(m_registryKeys.size());
+    for (const RegistryKey *key : std::as_const(m_registryKeys)) {
+        ids.append(identity(key));
+    }
+    RowReorderIndex order(ids);
+
+    for (int i = 0; i < keys.size(); ++i) {
+        RegistryKey *target = keys[i];
+        const int from = order.take(identity(target), i);
+
+        if (from < 0) {
+            beginInsertRows(QModelIndex(), i, i);
+            m_registryKeys.insert(i, target);
+            watch(target);
+            endInsertRows();
+            continue;
+        }
+        if (from != i) {
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), i);
+            m_registryKeys.move(from, i);
+            endMoveRows();
+        }
+
+        RegistryKey *current = m_registryKeys[i];
+        if (current != target) {
+            const QList<int> roles = changedRoles(current, target);
+            unwatch(current);
+            m_registryKeys[i] = target;
+            watch(target);
+            if (!roles.isEmpty()) {
+                emit dataChanged(index(i), index(i), roles);
+            }
+        }
+    }
+
+    // Leftover duplicates from the old list
+    if (m_registryKeys.size() > keys.size()) {
+        beginRemoveRows(QModelIndex(), keys.size(), m_registryKeys.size() - 1);
+        for (int i = keys.size(); i < m_registryKeys.size(); ++i) {
+            unwatch(m_registryKeys[i]);
+        }
+        m_registryKeys.erase(m_registryKeys.begin() + keys.size(), m_registryKeys.end());
+        endRemoveRows();
+    }
+
+    rebuildIndex();
+}
+
+/**
+ * @brief Clear all items and reset attached views.
+ */
+void RegistryKeyModel::resetModel() {
     beginResetModel();
-    m_registryKeys = keys;
+    for (RegistryKey *key : std::as_const(m_registryKeys)) {
+        unwatch(key);
+    }
+    m_registryKeys.clear();
+    rebuildIndex();
     endResetModel();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Lookup & Change Tracking
+////////////////////////////////////////////////////////////////////////////////
+
+int RegistryKeyModel::rowForName(const QString &name) const {
+    return m_rowByName.value(name, -1);
+}
+
+RegistryKey *RegistryKeyModel::keyForName(const QString &name) const {
+    const int row = rowForName(name);
+    return row >= 0 ? m_registryKeys.at(row) : nullptr;
+}
+
+QString RegistryKeyModel::identity(const RegistryKey *key) {
+    return key->hive() + QLatin1Char('|') + key->keyPath() + QLatin1Char('|') + key->name();
+}
+
+QList<int> RegistryKeyModel::changedRoles(const RegistryKey *before, const RegistryKey *after) {
+    QList<int> roles;
+    if (before->name() != after->name()) {
+        roles << NameRole;
+    }
+    if (before->isCritical() != after->isCritical()) {
+        roles << IsCriticalRole;
+    }
+    if (before->displayText() != after->displayText()) {
+        roles << DisplayTextRole;
+    }
+    return roles;
+}
+
+/**
+ * @brief Forward an entry's own change signals to views.
+ *
+ * Toggling criticality on an entry updates its delegate without the
+ * caller having to know the row.
+ */
+void RegistryKeyModel::watch(RegistryKey *key) {
+    connect(key, &RegistryKey::isCriticalChanged, this, [this, key]() {
+        notifyRoles(key, { IsCriticalRole });
+    });
+    connect(key, &RegistryKey::displayTextChanged, this, [this, key]() {
+        notifyRoles(key, { DisplayTextRole });
+    });
+}
+
+void RegistryKeyModel::unwatch(RegistryKey *key) {
+    disconnect(key, nullptr, this, nullptr);
+}
+
+void RegistryKeyModel::notifyRoles(const RegistryKey *key, const QList<int> &roles) {
+    const int row = m_rowByKey.value(key, -1);
+    if (row >= 0) {
+        emit dataChanged(index(row), index(row), roles);
+    }
+}
+
+void RegistryKeyModel::rebuildIndex() {
+    m_rowByName.clear();
+    m_rowByKey.clear();
+    m_rowByName.reserve(m_registryKeys.size());
+    m_rowByKey.reserve(m_registryKeys.size());
+    for (int row = 0; row < m_registryKeys.size(); ++row) {
+        const RegistryKey *key = m_registryKeys[row];
+        if (!m_rowByName.contains(key->name())) {
+            m_rowByName.insert(key->name(), row);
+        }
+        m_rowByKey.insert(key, row);
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // QAbstractListModel Overrides
 ////////////////////////////////////////////////////////////////////////////////
@@ -71,7 +229,7 @@ int RegistryKeyModel::rowCount(const QModelIndex &parent) const {
  *  - DisplayTextRole  : returns key->displayText()
  */
 QVariant RegistryKeyModel::data(const QModelIndex &index, int role) const {
-    if (!index.isValid()) {
+    if (!index.isValid() || index.row() >= m_registryKeys.size()) {
         return QVariant();
     }
 
@@ -0,0 +1,211 @@
+/**
+ * @file resourceGovernor.cpp
+ * @brief Per-platform CPU/I/O sampling and the throttle level it drives.
+ */
+
+#include "resourceGovernor.h"
+#include "logger.h"
+
+#include <QThread>
+
+#if defined(Q_OS_WIN)
+#  include <windows.h>
+#elif defined(Q_OS_MAC)
+#  include <libproc.h>
+#  include <sys/resource.h>
+#  include <unistd.h>
+#else
+#  include <QFile>
+#  include <sys/resource.h>
+#endif
+
+namespace {
+
+constexpr int    kOverSamplesToRaise  = 2;
+constexpr int    kUnderSamplesToLower = 10;
+constexpr double kLowerBelow          = 0.6;   ///< Fraction of a cap that counts as comfortably under
+
+} // namespace
+
+std::atomic<ResourceGovernor *> ResourceGovernor::s_instance{nullptr};
+
+ResourceBudget ResourceBudget::fromEnvironment() {
+    ResourceBudget budget;
+    budget.cpuPercent = qEnvironmentVariable("MONITOR_CPU_CAP_PERCENT").toDouble();
+    budget.iops       = qEnvironmentVariable("MONITOR_IOPS_CAP").toDouble();
+    return budget;
+}
+
+ResourceGovernor::ResourceGovernor(const ResourceBudget &budget, QObject *parent)
+    : QObject(parent)
+    , m_budget(budget)
+    , m_cores(qMax(1, QThread::idealThreadCount()))
+{
+    connect(&m_timer, &QTimer::timeout, this, &ResourceGovernor::sample);
+}
+
+void ResourceGovernor::start(int intervalMs) {
+    m_last = readUsage();
+    m_sinceSample.start();
+    m_timer.start(intervalMs);
+    if (m_budget.isCapped()) {
+        MON_INFO(LogCategory::General) << "[GOVERNOR] Budget: cpu" << m_budget.cpuPercent
+                                       << "% of" << m_cores << "cores, iops" << m_budget.iops
+                                       << "(0 = uncapped).";
+    }
+}
+
+void ResourceGovernor::stop() {
+    m_timer.stop();
+}
+
+int ResourceGovernor::level() {
+    const ResourceGovernor *governor = instance();
+    return governor ? governor->currentLevel() : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Sampling
+////////////////////////////////////////////////////////////////////////////////
+
+#if defined(Q_OS_WIN)
+
+ResourceGovernor::Usage ResourceGovernor::readUsage() {
+    Usage usage;
+    FILETIME created, exited, kernel, user;
+    if (GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) {
+        auto ticks = [](const FILETIME &t) {
+            return (qint64(t.dwHighDateTime) << 32) | t.dwLowDateTime;
+        };
+        usage.cpuNs = (ticks(kernel) + ticks(user)) * 100;   // 100 ns units
+    }
+    IO_COUNTERS io;
+    if (GetProcessIoCounters(GetCurrentProcess(), &io)) {
+        usage.readOps    = qint64(io.ReadOperationCount);
+        usage.writeOps   = qint64(io.WriteOperationCount);
+        usage.readBytes  = qint64(io.ReadTransferCount);
+        usage.writeBytes = qint64(io.WriteTransferCount);
+    }
+    return usage;
+}
+
+#else
+
+ResourceGovernor::Usage ResourceGovernor::readUsage() {
+    Usage usage;
+    rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0) {
+        usage.cpuNs = (qint64(ru.ru_utime.tv_sec) + ru.ru_stime.tv_sec) * 1000000000LL
+                    + (qint64(ru.ru_utime.tv_usec) + ru.ru_stime.tv_usec) * 1000LL;
+        // Block operations; replaced by syscall counts below where available
+        usage.readOps  = ru.ru_inblock;
+        usage.writeOps = ru.ru_oublock;
+    }
+#  if defined(Q_OS_MAC)
+    rusage_info_v2 info;
+    if (proc_pid_rusage(getpid(), RUSAGE_INFO_V2, reinterpret_cast<rusage_info_t *>(&info)) == 0) {
+        usage.readBytes  = qint64(info.ri_diskio_bytesread);
+        usage.writeBytes = qint64(info.ri_diskio_byteswritten);
+    }
+#  else
+    QFile io("/proc/self/io");
+    if (io.open(QIODevice::ReadOnly)) {
+        for (const QByteArray &line : io.readAll().split('\n')) {
+            const int colon = line.indexOf(':');
+            const QByteArray key = line.left(colon);
+            const qint64 value = line.mid(colon + 1).trimmed().toLongLong();
+            if (key == "syscr") {
+                usage.readOps = value;
+            } else if (key == "syscw") {
+                usage.writeOps = value;
+            } else if (key == "read_bytes") {
+                usage.readBytes = value;
+            } else if (key == "write_bytes") {
+                usage.writeBytes = value;
+            }
+        }
+    }
+#  endif
+    return usage;
+}
+
+#endif
+
+/**
+ * @brief Turn the counter deltas since the last sample into rates and
+ *        adjust the throttle level.
+ */
+void ResourceGovernor::sample() {
+    const double seconds = m_sinceSample.restart() / 1000.0;
+    const Usage now = readUsage();
+    if (seconds <= 0) {
+        m_last = now;
+        return;
+    }
+
+    m_cpuPercent       = (now.cpuNs - m_last.cpuNs) / 1e9 / seconds / m_cores * 100.0;
+    m_iops             = ((now.readOps - m_last.readOps) + (now.writeOps - m_last.writeOps)) / seconds;
+    m_readBytesPerSec  = (now.readBytes - m_last.readBytes) / seconds;
+    m_writeBytesPerSec = (now.writeBytes - m_last.writeBytes) / seconds;
+    m_last = now;
+
+    const bool cpuCapped  = m_budget.cpuPercent > 0;
+    const bool iopsCapped = m_budget.iops > 0;
+    const bool overCpu  = cpuCapped && m_cpuPercent > m_budget.cpuPercent;
+    const bool overIops = iopsCapped && m_iops > m_budget.iops;
+    ++m_samples;
+    m_overCpu  += overCpu;
+    m_overIops += overIops;
+    m_compliant += !overCpu && !overIops;
+
+    if (overCpu || overIops) {
+        m_underStreak = 0;
+        if (++m_overStreak >= kOverSamplesToRaise) {
+            m_overStreak = 0;
+            setLevel(currentLevel() + 1);
+        }
+        return;
+    }
+
+    m_overStreak = 0;
+    const bool comfortable = (!cpuCapped || m_cpuPercent < m_budget.cpuPercent * kLowerBelow)
+                          && (!iopsCapped || m_iops < m_budget.iops * kLowerBelow);
+    if (comfortable && ++m_underStreak >= kUnderSamplesToLower) {
+        m_underStreak = 0;
+        setLevel(currentLevel() - 1);
+    } else if (!comfortable) {
+        m_underStreak = 0;
+    }
+}
+
+void ResourceGovernor::setLevel(int level) {
+    level = qBound(0, level, kMaxLevel);
+    if (level == currentLevel()) {
+        return;
+    }
+    const bool raised = level > currentLevel();
+    m_level.store(level, std::memory_order_relaxed);
+    if (raised) {
+        MON_WARN(LogCategory::General) << "[GOVERNOR] Over budget (cpu" << m_cpuPercent << "% iops"
+                                       << m_iops << "); throttle level" << level;
+    } else {
+        MON_INFO(LogCategory::General) << "[GOVERNOR] Back within budget; throttle level" << level;
+    }
+    emit levelChanged(level);
+}
+
+QVariantMap ResourceGovernor::stats() const {
+    QVariantMap result;
+    result["cpuPercent"]        = m_cpuPercent;
+    result["iops"]              = m_iops;
+    result["readBytesPerSec"]   = m_readBytesPerSec;
+    result["writeBytesPerSec"]  = m_writeBytesPerSec;
+    result["cpuCapPercent"]     = m_budget.cpuPercent;
+    result["iopsCap"]           = m_budget.iops;
+    result["level"]             = currentLevel();
+    result["samples"]           = m_samples;
+    result["samplesOverCpu"]    = m_overCpu;
+    result["samplesOverIops"]   = m_overIops;
+    result["compliancePercent"] = m_samples ? 100.0 * m_compliant / m_samples : 100.0;
+    return result;
+}
@@ -0,0 +1,40 @@
+#include "rowReorderIndex.h"
+
+/**
+ * @file rowReorderIndex.cpp
+ * @brief Implements the row lookup used when the list models reorder rows.
+ */
+
+RowReorderIndex::RowReorderIndex(const QStringList &ids)
+    : m_tree(ids.size() + 1, 0)
+{
+    m_rows.reserve(ids.size());
+    for (int row = 0; row < ids.size(); ++row) {
+        m_rows[ids[row]].original.append(row);
+    }
+    // Every row starts unplaced: node i covers (i - lowbit(i), i]
+    for (int i = 1; i < m_tree.size(); ++i) {
+        m_tree[i] = i & -i;
+    }
+}
+
+int RowReorderIndex::take(const QString &id, int placed) {
+    auto it = m_rows.find(id);
+    if (it == m_rows.end() || it->next >= it->original.size()) {
+        return -1;
+    }
+    const int original = it->original[it->next++];
+    const int row = placed + unplacedBefore(original);
+    for (int i = original + 1; i < m_tree.size(); i += i & -i) {
+        --m_tree[i];
+    }
+    return row;
+}
+
+int RowReorderIndex::unplacedBefore(int row) const {
+    int count = 0;
+    for (int i = row; i > 0; i -= i & -i) {
+        count += m_tree[i];
+    }
+    return count;
+}
@@ -0,0 +1,131 @@
+/**
+ * @file startupOrchestrator.cpp
+ * @brief Concurrent startup tasks and startup milestones.
+ */
+
+#include "startupOrchestrator.h"
+#include "Database.h"
+#include "logger.h"
+
+#include <QMutexLocker>
+#include <QStringList>
+#include <algorithm>
+
+std::atomic<StartupOrchestrator *> StartupOrchestrator::s_instance{nullptr};
+
+StartupOrchestrator::StartupOrchestrator(QObject *parent)
+    : QObject(parent)
+{
+    m_sinceStart.start();
+    m_pool.setMaxThreadCount(4);
+}
+
+StartupOrchestrator::~StartupOrchestrator() {
+    m_pool.waitForDone();
+}
+
+void StartupOrchestrator::run(const QString &name, std::function<void()> task) {
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_tasks.contains(name)) {
+            MON_WARN(LogCategory::General) << "[STARTUP] Task submitted twice:" << name;
+            return;
+        }
+        m_tasks.insert(name, Task{m_sinceStart.elapsed(), -1});
+    }
+
+    m_pool.start([this, name, task = std::move(task)]() {
+        QElapsedTimer timer;
+        timer.start();
+        task();
+        // Startup threads are not reused for database work
+        Database::releaseThreadConnection();
+
+        QMutexLocker locker(&m_mutex);
+        m_tasks[name].durationMs = timer.elapsed();
+        m_finished.wakeAll();
+        MON_DEBUG(LogCategory::General) << "[STARTUP] Task" << name << "took" << timer.elapsed() << "ms.";
+    });
+}
+
+bool StartupOrchestrator::waitFor(const QString &name) {
+    QMutexLocker locker(&m_mutex);
+    if (!m_tasks.contains(name)) {
+        return false;
+    }
+    while (m_tasks.value(name).durationMs < 0) {
+        m_finished.wait(&m_mutex);
+    }
+    return true;
+}
+
+void StartupOrchestrator::waitForAll() {
+    m_pool.waitForDone();
+}
+
+void StartupOrchestrator::mark(const QString &name) {
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_milestones.contains(name)) {
+            return;
+        }
+        m_milestones.insert(name, m_sinceStart.elapsed());
+    }
+    MON_INFO(LogCategory::General) << "[STARTUP]" << name << "after" << m_sinceStart.elapsed() << "ms.";
+    if (name == QLatin1String("firstCheck")) {
+        logSummary();
+    }
+}
+
+/// One line with every task and milestone, slowest task first.
+void StartupOrchestrator::logSummary() const {
+    QMutexLocker locker(&m_mutex);
+    QStringList parts;
+    QList<QString> names = m_tasks.keys();
+    std::sort(names.begin(), names.end(), [this](const QString &a, const QString &b) {
+        return m_tasks.value(a).durationMs > m_tasks.value(b).durationMs;
+    });
+    for (const QString &name : names) {
+        parts << QStringLiteral("%1=%2ms").arg(name).arg(m_tasks.value(name).durationMs);
+    }
+    for (auto it = m_milestones.cbegin(); it != m_milestones.cend(); ++it) {
+        parts << QStringLiteral("@%1=%2ms").arg(it.key()).arg(it.value());
+    }
+    MON_INFO(LogCategory::General) << "[STARTUP] Summary:" << parts.join(' ');
+}
+
+QVariantMap StartupOrchestrator::stats() const {
+    QMutexLocker locker(&m_mutex);
+    QVariantMap tasks;
+    for (auto it = m_tasks.cbegin(); it != m_tasks.cend(); ++it) {
+        tasks[it.key()] = QVariantMap{
+            {"startMs",    it->startMs},
+            {"durationMs", it->durationMs},
+        };
+    }
+    QVariantMap milestones;
+    for (auto it = m_milestones.cbegin(); it != m_milestones.cend(); ++it) {
+        milestones[it.key()] = it.value();
+    }
+    return QVariantMap{{"tasks", tasks}, {"milestones", milestones}};
+}
+
+void StartupOrchestrator::submit(const QString &name, std::function<void()> task) {
+    if (StartupOrchestrator *orchestrator = instance()) {
+        orchestrator->run(name, std::move(task));
+    } else {
+        task();
+    }
+}
+
+void StartupOrchestrator::await(const QString &name) {
+    if (StartupOrchestrator *orchestrator = instance()) {
+        orchestrator->waitFor(name);
+    }
+}
+
+void StartupOrchestrator::milestone(const QString &name) {
+    if (StartupOrchestrator *orchestrator = instance()) {
+        orchestrator->mark(name);
+    }
+}
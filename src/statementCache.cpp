@@ -0,0 +1,96 @@
+#include "statementCache.h"
+#include "logger.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSqlError>
+
+/**
+ * @file statementCache.cpp
+ * @brief Implements the per-connection prepared-statement cache.
+ */
+
+namespace {
+// Connection name → cache. Entries are created and released by the thread
+// owning the connection; the mutex only protects the map itself. The GUI
+// thread's cache lives for the whole process.
+QMutex s_registryMutex;
+QHash<QString, StatementCache *> s_registry;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Registry
+////////////////////////////////////////////////////////////////////////////////
+
+StatementCache::StatementCache(const QSqlDatabase &db)
+    : m_db(db)
+{
+}
+
+/**
+ * @brief Cache belonging to @p db's connection, created on first use.
+ */
+StatementCache &StatementCache::forConnection(const QSqlDatabase &db) {
+    QMutexLocker locker(&s_registryMutex);
+    StatementCache *&cache = s_registry[db.connectionName()];
+    if (!cache) {
+        cache = new StatementCache(db);
+    }
+    return *cache;
+}
+
+/**
+ * @brief Destroy a connection's cache before the connection is removed.
+ *
+ * Prepared handles must be released while their driver still exists.
+ */
+void StatementCache::release(const QString &connectionName) {
+    StatementCache *cache = nullptr;
+    {
+        QMutexLocker locker(&s_registryMutex);
+        cache = s_registry.take(connectionName);
+    }
+    delete cache;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Statements
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Prepared statement for @p id / @p variant, preparing @p sql on a miss.
+ *
+ * Statements are forward-only: every caller reads results once, front to back.
+ */
+std::shared_ptr<QSqlQuery> StatementCache::acquire(Statement id, quint16 variant, const QString &sql) {
+    const quint32 k = key(id, variant);
+    auto it = m_statements.constFind(k);
+    if (it != m_statements.constEnd()) {
+        return *it;
+    }
+
+    auto query = std::make_shared<QSqlQuery>(m_db);
+    query->setForwardOnly(true);
+    if (!query->prepare(sql)) {
+        MON_WARN(LogCategory::Database) << "[DATABASE] Failed to prepare statement" << id
+                                        << "variant" << variant << ":" << query->lastError().text();
+        return nullptr;
+    }
+    MON_TRACE(LogCategory::Database) << "[DATABASE] Prepared statement" << id << "variant" << variant
+                                     << "on" << m_db.connectionName();
+    m_statements.insert(k, query);
+    return query;
+}
+
+/**
+ * @brief Forget one statement so the next acquire() prepares it again.
+ */
+void StatementCache::discard(Statement id, quint16 variant) {
+    m_statements.remove(key(id, variant));
+}
+
+/**
+ * @brief Forget every statement; used after the connection was reopened.
+ */
+void StatementCache::clear() {
+    m_statements.clear();
+}
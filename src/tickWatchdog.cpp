@@ -0,0 +1,155 @@
+/**
+ * @file tickWatchdog.cpp
+ * @brief Check-cycle budget accounting and non-critical throttling.
+ */
+
+#include "tickWatchdog.h"
+#include "clock.h"
+#include "logger.h"
+#include "resourceGovernor.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr int kOverrunsToEscalate = 3;     ///< Consecutive overruns before throttling more
+constexpr int kCalmCyclesToRelax  = 30;    ///< Consecutive quiet cycles before throttling less
+constexpr int kMaxSpread          = 8;
+
+} // namespace
+
+TickWatchdog::TickWatchdog(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void TickWatchdog::restart() {
+    m_lastStart = QDateTime();
+    m_overrunStreak = 0;
+    m_calmStreak = 0;
+}
+
+/**
+ * @brief Count the intervals skipped since the previous cycle and pick
+ *        this cycle's group of non-critical items.
+ */
+void TickWatchdog::beginCycle() {
+    const QDateTime now = Clock::instance()->now();
+    if (m_lastStart.isValid() && m_budgetMs > 0) {
+        // Rounded, so ordinary timer jitter is not a missed cycle
+        const qint64 gapMs = m_lastStart.msecsTo(now);
+        const qint64 intervals = (gapMs + m_budgetMs / 2) / m_budgetMs;
+        if (intervals > 1) {
+            m_missed += quint64(intervals - 1);
+        }
+    }
+    m_lastStart = now;
+    // The resource governor may ask for a wider spread than overruns alone
+    const int spread = std::max(m_spread, ResourceGovernor::scanSpread());
+    if (spread != m_cycleSpread) {
+        m_cycleSpread = spread;
+        m_phase = 0;
+    } else {
+        m_phase = (m_phase + 1) % m_cycleSpread;
+    }
+    m_cycleTimer.start();
+}
+
+bool TickWatchdog::admit(int index, bool critical) {
+    if (critical) {
+        return true;
+    }
+    if (m_shedding || index % m_cycleSpread != m_phase) {
+        ++m_deferred;
+        return false;
+    }
+    return true;
+}
+
+void TickWatchdog::endCycle() {
+    if (!m_cycleTimer.isValid()) {
+        return;
+    }
+    const qint64 elapsedUs = m_cycleTimer.nsecsElapsed() / 1000;
+    const qint64 elapsedMs = elapsedUs / 1000;
+    m_cycleTimer.invalidate();
+    m_durations.record(elapsedUs);
+    m_lastUs = elapsedUs;
+    ++m_cycles;
+
+    if (elapsedMs > m_budgetMs) {
+        ++m_overruns;
+        ++m_overrunStreak;
+        m_calmStreak = 0;
+        if (m_overrunStreak >= kOverrunsToEscalate || elapsedMs >= 2 * qint64(m_budgetMs)) {
+            m_overrunStreak = 0;
+            escalate(elapsedMs);
+        }
+        return;
+    }
+
+    m_overrunStreak = 0;
+    if (elapsedMs * 4 < m_budgetMs && overloaded()) {
+        if (++m_calmStreak >= kCalmCyclesToRelax) {
+            m_calmStreak = 0;
+            relax();
+        }
+    } else {
+        m_calmStreak = 0;
+    }
+}
+
+void TickWatchdog::escalate(qint64 elapsedMs) {
+    if (m_shedding) {
+        MON_WARN(LogCategory::Monitoring) << "[WATCHDOG] Cycle took" << elapsedMs << "ms of"
+                                          << m_budgetMs << "ms while shedding; host is over capacity.";
+        return;
+    }
+    if (m_spread < kMaxSpread) {
+        m_spread *= 2;
+        MON_WARN(LogCategory::Monitoring) << "[WATCHDOG] Cycle took" << elapsedMs << "ms of"
+                                          << m_budgetMs << "ms; checking non-critical items every"
+                                          << m_spread << "cycles.";
+    } else {
+        m_shedding = true;
+        MON_WARN(LogCategory::Monitoring) << "[WATCHDOG] Cycle took" << elapsedMs << "ms of"
+                                          << m_budgetMs << "ms; shedding non-critical items.";
+    }
+    emit stateChanged();
+}
+
+void TickWatchdog::relax() {
+    if (m_shedding) {
+        m_shedding = false;
+    } else if (m_spread > 1) {
+        m_spread /= 2;
+    } else {
+        return;
+    }
+    MON_INFO(LogCategory::Monitoring) << "[WATCHDOG] Load dropped; state is now" << stateName()
+                                      << "(spread" << m_spread << ").";
+    emit stateChanged();
+}
+
+QString TickWatchdog::stateName() const {
+    if (m_shedding) {
+        return QStringLiteral("shedding");
+    }
+    return m_spread > 1 ? QStringLiteral("spreading") : QStringLiteral("normal");
+}
+
+QVariantMap TickWatchdog::stats() const {
+    QVariantMap result;
+    result["cycles"]        = m_cycles;
+    result["overruns"]      = m_overruns;
+    result["missedCycles"]  = m_missed;
+    result["deferredItems"] = m_deferred;
+    result["budgetMs"]      = m_budgetMs;
+    result["lastMs"]        = m_lastUs / 1000.0;
+    result["p50Ms"]         = m_durations.percentile(50.0) / 1000.0;
+    result["p99Ms"]         = m_durations.percentile(99.0) / 1000.0;
+    result["maxMs"]         = m_durations.maximum() / 1000.0;
+    result["spread"]        = m_cycleSpread;
+    result["state"]         = stateName();
+    return result;
+}
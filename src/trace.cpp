@@ -0,0 +1,307 @@
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+#include <QUrl>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+/**
+ * @file trace.cpp
+ * @brief Per-thread span buffers and the Chrome trace writer.
+ */
+
+namespace {
+
+constexpr quint32 kSpansPerThread = 1u << 15;   ///< 1 MiB of spans per thread
+constexpr int     kMaxThreadBuffers = 256;
+
+struct Span {
+    const char  *name;
+    qint64       startNs;
+    qint64       durationNs;
+    LogCategory  category;
+};
+
+/**
+ * @brief Spans of one thread. Only the owning thread writes; export reads
+ *        the first @c count entries after an acquire load.
+ */
+struct ThreadBuffer {
+    int                       tid = 0;
+    QString                   threadName;
+    std::unique_ptr<Span[]>   spans{new Span[kSpansPerThread]};
+    std::atomic<quint32>      count{0};
+    std::atomic<quint64>      dropped{0};
+    std::atomic<quint64>      epoch{0};      ///< Recording the spans belong to
+    std::atomic<bool>         inUse{true};   ///< False once the owning thread exited
+};
+
+struct Registry {
+    QMutex                                      mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>>  buffers;
+    int                                         nextTid = 1;
+};
+
+// Leaked on purpose: thread_local slots may release buffers during exit
+Registry &registry() {
+    static Registry *instance = new Registry;
+    return *instance;
+}
+
+std::atomic<quint64> s_epoch{0};
+std::atomic<quint64> s_unbuffered{0};   ///< Spans from threads beyond kMaxThreadBuffers
+
+/// The calling thread's buffer; returned to the registry when the thread exits.
+struct ThreadSlot {
+    ThreadBuffer *buffer = nullptr;
+    bool          rejected = false;
+
+    ~ThreadSlot() {
+        if (buffer) {
+            buffer->inUse.store(false, std::memory_order_release);
+        }
+    }
+};
+thread_local ThreadSlot t_slot;
+
+QString currentThreadName(int tid) {
+    QThread *thread = QThread::currentThread();
+    QCoreApplication *app = QCoreApplication::instance();
+    if (app && thread == app->thread()) {
+        return QStringLiteral("main");
+    }
+    const QString name = thread ? thread->objectName() : QString();
+    return name.isEmpty() ? QStringLiteral("thread %1").arg(tid) : name;
+}
+
+/**
+ * @brief Give the calling thread a buffer.
+ *
+ * A buffer left by an exited thread is reused once its spans belong to an
+ * older recording, so pools that recycle threads do not grow the registry.
+ */
+ThreadBuffer *acquireBuffer() {
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    const quint64 epoch = s_epoch.load(std::memory_order_acquire);
+
+    ThreadBuffer *buffer = nullptr;
+    for (const auto &candidate : reg.buffers) {
+        if (!candidate->inUse.load(std::memory_order_acquire)
+            && (candidate->epoch.load(std::memory_order_relaxed) != epoch
+                || candidate->count.load(std::memory_order_relaxed) == 0)) {
+            buffer = candidate.get();
+            break;
+        }
+    }
+    if (!buffer) {
+        if (int(reg.buffers.size()) >= kMaxThreadBuffers) {
+            return nullptr;
+        }
+        reg.buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = reg.buffers.back().get();
+    }
+
+    buffer->tid = reg.nextTid++;
+    buffer->threadName = currentThreadName(buffer->tid);
+    buffer->count.store(0, std::memory_order_relaxed);
+    buffer->dropped.store(0, std::memory_order_relaxed);
+    buffer->epoch.store(epoch, std::memory_order_relaxed);
+    buffer->inUse.store(true, std::memory_order_release);
+    return buffer;
+}
+
+/// @p text as a JSON string literal.
+QByteArray jsonString(const QString &text) {
+    const QByteArray array = QJsonDocument(QJsonArray{text}).toJson(QJsonDocument::Compact);
+    return array.mid(1, array.size() - 2);
+}
+
+QString localPath(const QString &path) {
+    const QUrl url(path);
+    return url.isLocalFile() ? url.toLocalFile() : path;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// Tracer
+////////////////////////////////////////////////////////////////////////////////
+
+std::atomic<bool> Tracer::s_enabled{false};
+
+void Tracer::setEnabled(bool enabled) {
+    if (enabled) {
+        // Threads notice the new epoch on their next span and start over
+        s_epoch.fetch_add(1, std::memory_order_acq_rel);
+        s_unbuffered.store(0, std::memory_order_relaxed);
+    }
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+qint64 Tracer::nowNs() {
+    using Clock = std::chrono::steady_clock;
+    static const Clock::time_point origin = Clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - origin).count();
+}
+
+void Tracer::record(LogCategory category, const char *name, qint64 startNs, qint64 endNs) {
+    ThreadSlot &slot = t_slot;
+    if (!slot.buffer) {
+        if (slot.rejected || !(slot.buffer = acquireBuffer())) {
+            slot.rejected = true;
+            s_unbuffered.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    ThreadBuffer *buffer = slot.buffer;
+
+    const quint64 epoch = s_epoch.load(std::memory_order_acquire);
+    if (buffer->epoch.load(std::memory_order_relaxed) != epoch) {
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+        buffer->epoch.store(epoch, std::memory_order_release);
+    }
+
+    const quint32 n = buffer->count.load(std::memory_order_relaxed);
+    if (n >= kSpansPerThread) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->spans[n] = Span{name, startNs, endNs - startNs, category};
+    buffer->count.store(n + 1, std::memory_order_release);
+}
+
+quint64 Tracer::recordedCount() {
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    const quint64 epoch = s_epoch.load(std::memory_order_acquire);
+    quint64 total = 0;
+    for (const auto &buffer : reg.buffers) {
+        if (buffer->epoch.load(std::memory_order_relaxed) == epoch) {
+            total += buffer->count.load(std::memory_order_acquire);
+        }
+    }
+    return total;
+}
+
+quint64 Tracer::droppedCount() {
+    Registry &reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    const quint64 epoch = s_epoch.load(std::memory_order_acquire);
+    quint64 total = s_unbuffered.load(std::memory_order_relaxed);
+    for (const auto &buffer : reg.buffers) {
+        if (buffer->epoch.load(std::memory_order_relaxed) == epoch) {
+            total += buffer->dropped.load(std::memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+/**
+ * @brief Write complete ("X") events per span plus thread-name metadata.
+ *
+ * Timestamps are microseconds since the tracer's origin; categories are
+ * the logger's category names, so the Perfetto filter matches MONITOR_LOG.
+ */
+bool Tracer::exportChromeTrace(const QString &path, QString *error) {
+    QSaveFile file(localPath(path));
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    QByteArray out;
+    out.reserve(1 << 20);
+    out.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    auto separator = [&]() {
+        if (!first) {
+            out.append(",\n");
+        }
+        first = false;
+    };
+
+    Registry &reg = registry();
+    {
+        QMutexLocker locker(&reg.mutex);
+        const quint64 epoch = s_epoch.load(std::memory_order_acquire);
+        for (const auto &buffer : reg.buffers) {
+            if (buffer->epoch.load(std::memory_order_acquire) != epoch) {
+                continue;
+            }
+            const quint32 n = buffer->count.load(std::memory_order_acquire);
+            if (n == 0) {
+                continue;
+            }
+            const QByteArray tid = QByteArray::number(buffer->tid);
+
+            separator();
+            out.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":").append(pid)
+               .append(",\"tid\":").append(tid)
+               .append(",\"args\":{\"name\":").append(jsonString(buffer->threadName)).append("}}");
+
+            for (quint32 i = 0; i < n; ++i) {
+                const Span &span = buffer->spans[i];
+                separator();
+                out.append("{\"name\":\"").append(span.name)
+                   .append("\",\"cat\":\"").append(Logger::categoryName(span.category))
+                   .append("\",\"ph\":\"X\",\"ts\":").append(QByteArray::number(span.startNs / 1000.0, 'f', 3))
+                   .append(",\"dur\":").append(QByteArray::number(span.durationNs / 1000.0, 'f', 3))
+                   .append(",\"pid\":").append(pid)
+                   .append(",\"tid\":").append(tid).append('}');
+
+                if (out.size() > (1 << 20)) {
+                    file.write(out);
+                    out.clear();
+                }
+            }
+        }
+    }
+    out.append("\n],\"otherData\":{\"droppedSpans\":")
+       .append(QByteArray::number(droppedCount()))
+       .append("}}\n");
+    file.write(out);
+
+    if (!file.commit()) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// TraceControl
+////////////////////////////////////////////////////////////////////////////////
+
+void TraceControl::setEnabled(bool enabled) {
+    if (enabled == Tracer::isEnabled()) {
+        return;
+    }
+    Tracer::setEnabled(enabled);
+    MON_INFO(LogCategory::General) << "[TRACE]" << (enabled ? "Recording spans." : "Recording paused.");
+    emit enabledChanged();
+}
+
+QString TraceControl::exportTo(const QString &path) {
+    QString error;
+    if (!Tracer::exportChromeTrace(path, &error)) {
+        MON_WARN(LogCategory::General) << "[TRACE] Export failed:" << error;
+        return error.isEmpty() ? QStringLiteral("Export failed") : error;
+    }
+    MON_INFO(LogCategory::General) << "[TRACE] Exported" << Tracer::recordedCount()
+                                   << "spans to" << localPath(path);
+    return QString();
+}
@@ -0,0 +1,155 @@
+#include "valueDelta.h"
+
+#include <QHash>
+#include <cstring>
+
+/**
+ * @file valueDelta.cpp
+ * @brief Block-matching copy/insert deltas.
+ */
+
+namespace {
+
+const int     kBlock     = 16;              ///< Bytes per indexed base block
+const quint32 kMultiplier = 257;             ///< Rolling hash base
+const quint64 kMaxTarget = 256u << 20;      ///< Larger sizes mean a corrupt delta
+
+quint32 blockHash(const char *p) {
+    quint32 h = 0;
+    for (int i = 0; i < kBlock; ++i) {
+        h = h * kMultiplier + quint8(p[i]);
+    }
+    return h;
+}
+
+/// kMultiplier^(kBlock - 1), to drop the outgoing byte of a rolling hash.
+quint32 leadingFactor() {
+    quint32 f = 1;
+    for (int i = 1; i < kBlock; ++i) {
+        f *= kMultiplier;
+    }
+    return f;
+}
+
+void putInsert(QByteArray &out, const char *p, int length) {
+    if (length > 0) {
+        ValueDelta::putVarint(out, quint64(length) << 1);
+        out.append(p, length);
+    }
+}
+
+} // namespace
+
+void ValueDelta::putVarint(QByteArray &out, quint64 value) {
+    while (value >= 0x80) {
+        out.append(char(value | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+bool ValueDelta::getVarint(const char *&p, const char *end, quint64 &value) {
+    value = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        const quint8 byte = quint8(*p++);
+        value |= quint64(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QByteArray ValueDelta::encode(const QByteArray &base, const QByteArray &target) {
+    QByteArray out;
+    putVarint(out, quint64(target.size()));
+
+    const char *b = base.constData();
+    const char *t = target.constData();
+    const int baseSize = base.size();
+    const int n = target.size();
+
+    // Offset of each aligned base block, by hash (the last one wins)
+    QHash<quint32, int> index;
+    index.reserve(baseSize / kBlock);
+    for (int offset = 0; offset + kBlock <= baseSize; offset += kBlock) {
+        index.insert(blockHash(b + offset), offset);
+    }
+
+    const quint32 leading = leadingFactor();
+    int pending = 0;                // Start of the literal run not yet written
+    int i = 0;
+    quint32 h = n >= kBlock ? blockHash(t) : 0;
+    while (i + kBlock <= n) {
+        const auto hit = index.constFind(h);
+        if (hit != index.cend() && std::memcmp(t + i, b + *hit, kBlock) == 0) {
+            int start = i;
+            int offset = *hit;
+            // Grow the match backwards into the literal run, then forwards
+            while (start > pending && offset > 0 && t[start - 1] == b[offset - 1]) {
+                --start;
+                --offset;
+            }
+            int end = i + kBlock;
+            int baseEnd = *hit + kBlock;
+            while (end < n && baseEnd < baseSize && t[end] == b[baseEnd]) {
+                ++end;
+                ++baseEnd;
+            }
+            putInsert(out, t + pending, start - pending);
+            putVarint(out, (quint64(end - start) << 1) | 1);
+            putVarint(out, quint64(offset));
+            i = pending = end;
+            if (i + kBlock <= n) {
+                h = blockHash(t + i);
+            }
+            continue;
+        }
+        if (i + kBlock < n) {
+            h = (h - quint8(t[i]) * leading) * kMultiplier + quint8(t[i + kBlock]);
+        }
+        ++i;
+    }
+    putInsert(out, t + pending, n - pending);
+    return out;
+}
+
+bool ValueDelta::apply(const QByteArray &base, const QByteArray &delta, QByteArray *target) {
+    const char *p = delta.constData();
+    const char *end = p + delta.size();
+    quint64 size = 0;
+    if (!getVarint(p, end, size) || size > kMaxTarget) {
+        return false;
+    }
+
+    QByteArray out;
+    out.reserve(int(size));
+    while (p < end) {
+        quint64 tag = 0;
+        if (!getVarint(p, end, tag)) {
+            return false;
+        }
+        const quint64 length = tag >> 1;
+        if (quint64(out.size()) + length > size) {
+            return false;
+        }
+        if (tag & 1) {
+            quint64 offset = 0;
+            if (!getVarint(p, end, offset) || offset + length > quint64(base.size())) {
+                return false;
+            }
+            out.append(base.constData() + offset, int(length));
+        } else {
+            if (length > quint64(end - p)) {
+                return false;
+            }
+            out.append(p, int(length));
+            p += length;
+        }
+    }
+    if (quint64(out.size()) != size) {
+        return false;
+    }
+    *target = out;
+    return true;
+}
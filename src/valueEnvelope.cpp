@@ -0,0 +1,197 @@
+#include "valueEnvelope.h"
+#include "logger.h"
+#include "trace.h"
+#include "valueDelta.h"
+
+#include <atomic>
+#include <memory>
+
+#ifdef MONITOR_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+/**
+ * @file valueEnvelope.cpp
+ * @brief Flagged, optionally compressed plaintext of stored values.
+ */
+
+namespace {
+
+const char    kMarker          = char(0xFF);   ///< Never part of UTF-8
+const int     kDefaultThreshold = 512;
+const quint64 kMaxValueBytes   = 256u << 20;   ///< Larger frames mean a corrupt envelope
+
+std::atomic<int> s_threshold{-1};              ///< -1 until read from the environment
+
+#ifdef MONITOR_HAVE_ZSTD
+const int kZstdLevel = 3;
+
+/// Per-thread contexts; creating one per value costs more than compressing it.
+ZSTD_CCtx *compressContext() {
+    thread_local std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> context(ZSTD_createCCtx(),
+                                                                              &ZSTD_freeCCtx);
+    return context.get();
+}
+
+ZSTD_DCtx *decompressContext() {
+    thread_local std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> context(ZSTD_createDCtx(),
+                                                                              &ZSTD_freeDCtx);
+    return context.get();
+}
+#endif
+
+/**
+ * @brief Compress @p body with the build's codec.
+ * @param flag Receives the codec's flag.
+ * @return Compressed bytes, or null on failure.
+ */
+QByteArray compress(const QByteArray &body, quint8 *flag) {
+    MON_SPAN(LogCategory::Database, "value.compress");
+#ifdef MONITOR_HAVE_ZSTD
+    QByteArray out(int(ZSTD_compressBound(size_t(body.size()))), Qt::Uninitialized);
+    const size_t n = ZSTD_compressCCtx(compressContext(), out.data(), size_t(out.size()),
+                                       body.constData(), size_t(body.size()), kZstdLevel);
+    if (ZSTD_isError(n)) {
+        return QByteArray();
+    }
+    out.truncate(int(n));
+    *flag = ValueEnvelope::Zstd;
+    return out;
+#else
+    *flag = ValueEnvelope::Compressed;
+    return qCompress(body);
+#endif
+}
+
+/// @return Decompressed @p payload, or null if it is corrupt or the codec is missing.
+QByteArray decompress(const QByteArray &payload, quint8 flags) {
+    MON_SPAN(LogCategory::Database, "value.decompress");
+    if (flags & ValueEnvelope::Compressed) {
+        return qUncompress(payload);
+    }
+#ifdef MONITOR_HAVE_ZSTD
+    const unsigned long long size = ZSTD_getFrameContentSize(payload.constData(), size_t(payload.size()));
+    if (size == ZSTD_CONTENTSIZE_ERROR || size == ZSTD_CONTENTSIZE_UNKNOWN || size > kMaxValueBytes) {
+        return QByteArray();
+    }
+    QByteArray out(int(size), Qt::Uninitialized);
+    const size_t n = ZSTD_decompressDCtx(decompressContext(), out.data(), size_t(out.size()),
+                                         payload.constData(), size_t(payload.size()));
+    if (ZSTD_isError(n) || n != size) {
+        return QByteArray();
+    }
+    return out;
+#else
+    return QByteArray();
+#endif
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// Threshold
+////////////////////////////////////////////////////////////////////////////////
+
+int ValueEnvelope::compressThreshold() {
+    int threshold = s_threshold.load(std::memory_order_relaxed);
+    if (threshold < 0) {
+        bool ok = false;
+        const int fromEnv = qEnvironmentVariableIntValue("MONITOR_VALUE_COMPRESS_MIN", &ok);
+        threshold = ok ? qMax(0, fromEnv) : kDefaultThreshold;
+        s_threshold.store(threshold, std::memory_order_relaxed);
+    }
+    return threshold;
+}
+
+void ValueEnvelope::setCompressThreshold(int bytes) {
+    s_threshold.store(qMax(0, bytes), std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Layout
+////////////////////////////////////////////////////////////////////////////////
+
+QByteArray ValueEnvelope::wrap(const QByteArray &body, quint8 flags, qint64 keyframeId) {
+    QByteArray payload = body;
+    const int threshold = compressThreshold();
+    if (threshold > 0 && body.size() >= threshold) {
+        quint8 codec = 0;
+        const QByteArray packed = compress(body, &codec);
+        if (!packed.isNull() && packed.size() < body.size()) {
+            payload = packed;
+            flags |= codec;
+        }
+    }
+
+    QByteArray out;
+    out.reserve(payload.size() + 12);
+    out.append(kMarker);
+    out.append(char(flags));
+    if (flags & Delta) {
+        ValueDelta::putVarint(out, quint64(keyframeId));
+    }
+    out.append(payload);
+    return out;
+}
+
+bool ValueEnvelope::unwrap(const QByteArray &plain, quint8 *flags, qint64 *keyframeId, QByteArray *body) {
+    if (!isEnvelope(plain)) {
+        return false;
+    }
+    *flags = quint8(plain.at(1));
+    const char *p = plain.constData() + 2;
+    const char *end = plain.constData() + plain.size();
+    quint64 id = 0;
+    if ((*flags & Delta) && !ValueDelta::getVarint(p, end, id)) {
+        return false;
+    }
+    *keyframeId = qint64(id);
+
+    const QByteArray payload(p, int(end - p));
+    if (*flags & (Compressed | Zstd)) {
+        *body = decompress(payload, *flags);
+        return !body->isEmpty();
+    }
+    *body = payload;
+    return true;
+}
+
+bool ValueEnvelope::isEnvelope(const QByteArray &plain) {
+    return plain.size() >= 2 && plain.at(0) == kMarker;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Whole Values
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Legacy UTF-8 unless compression saves more than the envelope costs.
+ */
+QByteArray ValueEnvelope::encode(const QString &value) {
+    const QByteArray utf8 = value.toUtf8();
+    const int threshold = compressThreshold();
+    if (threshold <= 0 || utf8.size() < threshold) {
+        return utf8;
+    }
+    const QByteArray wrapped = wrap(utf8, 0);
+    return wrapped.size() < utf8.size() ? wrapped : utf8;
+}
+
+QString ValueEnvelope::decode(const QByteArray &plain, bool *ok) {
+    if (ok) {
+        *ok = true;
+    }
+    if (plain.isEmpty() || plain.at(0) != kMarker) {
+        return QString::fromUtf8(plain);
+    }
+    quint8 flags = 0;
+    qint64 keyframeId = 0;
+    QByteArray body;
+    if (!unwrap(plain, &flags, &keyframeId, &body) || (flags & Delta)) {
+        if (ok) {
+            *ok = false;
+        }
+        return QString();
+    }
+    return QString::fromUtf8(body);
+}
@@ -0,0 +1,296 @@
+#include "valueHistory.h"
+#include "clock.h"
+#include "Database.h"
+#include "databaseRows.h"
+#include "encryptionUtils.h"
+#include "logger.h"
+#include "trace.h"
+#include "valueDelta.h"
+
+#include <QCache>
+#include <QMutexLocker>
+#include <QSet>
+#include <QVector>
+#include <algorithm>
+
+/**
+ * @file valueHistory.cpp
+ * @brief Keyframe chains for delta-encoded Changes values.
+ */
+
+std::atomic<ValueHistory *> ValueHistory::s_instance{nullptr};
+
+namespace {
+
+const int kKeyframeCacheBytes = 16 << 20;
+
+QMutex                     s_cacheMutex;
+QCache<qint64, QByteArray> s_keyframes(kKeyframeCacheBytes);   ///< Plaintext by id, cost = size
+
+/**
+ * @brief Fetch, decrypt and cache the keyframes @p ids.
+ * @param into Receives the plaintext of every keyframe found.
+ */
+void loadKeyframes(const QVector<qint64> &ids, QHash<qint64, QByteArray> &into) {
+    MON_SPAN(LogCategory::Database, "history.loadKeyframes");
+    Database db;
+    const QHash<qint64, QByteArray> ciphers = db.keyframeCiphers(ids);
+
+    QVector<qint64> order;
+    QList<QByteArray> batch;
+    order.reserve(ciphers.size());
+    batch.reserve(ciphers.size());
+    for (auto it = ciphers.cbegin(); it != ciphers.cend(); ++it) {
+        order.append(it.key());
+        batch.append(it.value());
+    }
+    const QList<QByteArray> plain = EncryptionUtils::decryptBatchBytes(batch);
+
+    QMutexLocker locker(&s_cacheMutex);
+    for (int i = 0; i < order.size(); ++i) {
+        quint8 flags = 0;
+        qint64 unused = 0;
+        QByteArray body;
+        if (ValueEnvelope::unwrap(plain.value(i), &flags, &unused, &body) && !(flags & ValueEnvelope::Delta)) {
+            into.insert(order.at(i), body);
+            s_keyframes.insert(order.at(i), new QByteArray(body), qMax(1, int(body.size())));
+        }
+    }
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// Policy
+////////////////////////////////////////////////////////////////////////////////
+
+DeltaPolicy DeltaPolicy::fromEnvironment() {
+    DeltaPolicy policy;
+    policy.keyframeInterval = qMax(0, qEnvironmentVariableIntValue("MONITOR_VALUE_DELTA"));
+    return policy;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Encoding
+////////////////////////////////////////////////////////////////////////////////
+
+ValueHistory::ValueHistory(const DeltaPolicy &policy)
+    : m_policy(policy)
+{
+}
+
+/// @return Delta of @p value against the chain's keyframe, or null if storing it whole is better.
+QByteArray ValueHistory::deltaOf(const Chain &chain, const QByteArray &value) const {
+    if (value.size() < m_policy.minValueBytes) {
+        return QByteArray();
+    }
+    const QByteArray delta = ValueDelta::encode(chain.keyframe, value);
+    return qint64(delta.size()) * 100 <= qint64(value.size()) * m_policy.maxDeltaPercent
+               ? delta : QByteArray();
+}
+
+/**
+ * @brief Encode one row against its configuration's chain.
+ *
+ * A keyframe is started when the chain has none, is full, is old enough
+ * for the orphan purge to be near, or neither value deltas well against it
+ * any more; it is taken from the old value, which is usually the previous
+ * row's new value. A value that still does not delta well is stored whole.
+ */
+ValueHistory::Encoded ValueHistory::encode(Database &db, const QString &configName,
+                                           const QString &oldValue, const QString &newValue) {
+    MON_SPAN(LogCategory::Database, "history.encode");
+    Encoded out;
+    out.oldValue = oldValue.toUtf8();
+    out.newValue = newValue.toUtf8();
+
+    QMutexLocker locker(&m_mutex);
+    ++m_rows;
+    m_valueBytes += quint64(out.oldValue.size() + out.newValue.size());
+    auto storeWhole = [&]() {
+        out.oldValue = ValueEnvelope::encode(oldValue);
+        out.newValue = ValueEnvelope::encode(newValue);
+        m_fullValues += 2;
+        m_storedBytes += quint64(out.oldValue.size() + out.newValue.size());
+        return out;
+    };
+    if (qMax(out.oldValue.size(), out.newValue.size()) < m_policy.minValueBytes) {
+        return storeWhole();
+    }
+
+    const QString key = Database::connectionNameForCurrentThread() + '\n' + configName;
+    Chain &chain = m_chains[key];
+    const QDateTime now = Clock::instance()->now();
+    const bool reusable = chain.keyframeId > 0 && chain.rows < m_policy.keyframeInterval
+                          && chain.created.secsTo(now) < kKeyframeGraceSecs / 2;
+    QByteArray oldDelta;
+    QByteArray newDelta;
+    if (reusable) {
+        oldDelta = deltaOf(chain, out.oldValue);
+        newDelta = deltaOf(chain, out.newValue);
+    }
+
+    if (!reusable || (oldDelta.isEmpty() && newDelta.isEmpty())) {
+        const QByteArray keyframe = out.oldValue.size() >= m_policy.minValueBytes ? out.oldValue
+                                                                                  : out.newValue;
+        const qint64 id = db.insertKeyframe(configName,
+                                            EncryptionUtils::encryptBytes(ValueEnvelope::wrap(keyframe, 0)));
+        if (id <= 0) {
+            m_chains.remove(key);
+            return storeWhole();
+        }
+        chain = Chain{id, keyframe, 0, now};
+        ++m_keyframes;
+        oldDelta = deltaOf(chain, out.oldValue);
+        newDelta = deltaOf(chain, out.newValue);
+    }
+
+    ++chain.rows;
+    auto place = [&](const QByteArray &delta, const QString &value, QByteArray &slot) {
+        if (delta.isEmpty()) {
+            slot = ValueEnvelope::encode(value);
+            ++m_fullValues;
+        } else {
+            slot = ValueEnvelope::wrap(delta, ValueEnvelope::Delta, chain.keyframeId);
+            out.keyframeId = chain.keyframeId;
+            ++m_deltaValues;
+        }
+        m_storedBytes += quint64(slot.size());
+    };
+    place(oldDelta, oldValue, out.oldValue);
+    place(newDelta, newValue, out.newValue);
+    return out;
+}
+
+void ValueHistory::reset() {
+    QMutexLocker locker(&m_mutex);
+    if (!m_chains.isEmpty()) {
+        MON_INFO(LogCategory::Database) << "[HISTORY] Resetting" << m_chains.size() << "keyframe chains.";
+    }
+    m_chains.clear();
+}
+
+void ValueHistory::forgetConnection(const QString &connectionName) {
+    const QString prefix = connectionName + '\n';
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_chains.begin(); it != m_chains.end();) {
+        it = it.key().startsWith(prefix) ? m_chains.erase(it) : std::next(it);
+    }
+}
+
+QVariantMap ValueHistory::stats() const {
+    QMutexLocker locker(&m_mutex);
+    QVariantMap result;
+    result["rows"]        = m_rows;
+    result["deltaValues"] = m_deltaValues;
+    result["fullValues"]  = m_fullValues;
+    result["keyframes"]   = m_keyframes;
+    result["valueBytes"]  = m_valueBytes;
+    result["storedBytes"] = m_storedBytes;
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Decoding
+////////////////////////////////////////////////////////////////////////////////
+
+bool ValueHistory::isDelta(const QByteArray &plaintext) {
+    return ValueEnvelope::isEnvelope(plaintext) && (quint8(plaintext.at(1)) & ValueEnvelope::Delta);
+}
+
+/**
+ * @brief Collect cached keyframes and load the missing ones.
+ */
+QHash<qint64, QByteArray> ValueHistory::keyframesFor(const QList<QByteArray> &plaintexts) {
+    QHash<qint64, QByteArray> keyframes;
+    QSet<qint64> missing;
+    {
+        QMutexLocker locker(&s_cacheMutex);
+        for (const QByteArray &plain : plaintexts) {
+            if (!isDelta(plain)) {
+                continue;
+            }
+            const char *p = plain.constData() + 2;
+            quint64 id = 0;
+            if (!ValueDelta::getVarint(p, plain.constData() + plain.size(), id)
+                || keyframes.contains(qint64(id))) {
+                continue;
+            }
+            if (const QByteArray *cached = s_keyframes.object(qint64(id))) {
+                keyframes.insert(qint64(id), *cached);
+            } else {
+                missing.insert(qint64(id));
+            }
+        }
+    }
+    if (!missing.isEmpty()) {
+        loadKeyframes(QVector<qint64>(missing.cbegin(), missing.cend()), keyframes);
+    }
+    return keyframes;
+}
+
+QStringList ValueHistory::decode(const QList<QByteArray> &plaintexts) {
+    return decode(plaintexts, keyframesFor(plaintexts));
+}
+
+/**
+ * @brief Rebuild values: legacy ones as UTF-8, envelopes unwrapped, deltas
+ *        applied to their keyframe.
+ */
+QStringList ValueHistory::decode(const QList<QByteArray> &plaintexts,
+                                 const QHash<qint64, QByteArray> &keyframes) {
+    QStringList values;
+    values.reserve(plaintexts.size());
+    for (const QByteArray &plain : plaintexts) {
+        quint8 flags = 0;
+        qint64 keyframeId = 0;
+        QByteArray body;
+        if (!ValueEnvelope::unwrap(plain, &flags, &keyframeId, &body)) {
+            if (ValueEnvelope::isEnvelope(plain)) {
+                MON_WARN_EVERY(LogCategory::Database, 60000) << "[HISTORY] Corrupt stored value envelope.";
+                values.append(QString());
+            } else {
+                values.append(QString::fromUtf8(plain));
+            }
+            continue;
+        }
+        if (!(flags & ValueEnvelope::Delta)) {
+            values.append(QString::fromUtf8(body));
+            continue;
+        }
+        const auto keyframe = keyframes.constFind(keyframeId);
+        QByteArray value;
+        if (keyframe == keyframes.cend() || !ValueDelta::apply(*keyframe, body, &value)) {
+            MON_WARN_EVERY(LogCategory::Database, 60000) << "[HISTORY] Cannot rebuild value from keyframe"
+                                                         << keyframeId;
+            values.append(QString());
+            continue;
+        }
+        values.append(QString::fromUtf8(value));
+    }
+    return values;
+}
+
+void ValueHistory::materialize(ChangeRow *begin, ChangeRow *end) {
+    QList<QByteArray> cipher;
+    cipher.reserve(2 * int(end - begin));
+    for (const ChangeRow *row = begin; row != end; ++row) {
+        cipher.append(row->oldCipher);
+        cipher.append(row->newCipher);
+    }
+    const QList<QByteArray> plain = EncryptionUtils::decryptBatchBytes(cipher);
+    if (std::none_of(plain.cbegin(), plain.cend(), &ValueHistory::isDelta)) {
+        return;
+    }
+
+    const QStringList values = decode(plain);
+    int i = 0;
+    for (ChangeRow *row = begin; row != end; ++row, i += 2) {
+        if (isDelta(plain.at(i))) {
+            row->oldCipher = EncryptionUtils::encryptBytes(ValueEnvelope::encode(values.at(i)));
+        }
+        if (isDelta(plain.at(i + 1))) {
+            row->newCipher = EncryptionUtils::encryptBytes(ValueEnvelope::encode(values.at(i + 1)));
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#include "valueStore.h"
+#include <QMutexLocker>
+
+/**
+ * @file valueStore.cpp
+ * @brief The ValueStore override hook and MemoryValueStore.
+ */
+
+std::atomic<ValueStore *> ValueStore::s_instance{nullptr};
+
+QVariant MemoryValueStore::value(const QString &location, const QString &key) const {
+    QMutexLocker locker(&m_mutex);
+    const auto it = m_locations.constFind(location);
+    return it == m_locations.cend() ? QVariant() : it->value(key);
+}
+
+bool MemoryValueStore::setValue(const QString &location, const QString &key, const QVariant &value) {
+    QMutexLocker locker(&m_mutex);
+    m_locations[location].insert(key, value);
+    ++m_engineWrites;
+    return true;
+}
+
+bool MemoryValueStore::exists(const QString &location) const {
+    QMutexLocker locker(&m_mutex);
+    return m_locations.contains(location);
+}
+
+QStringList MemoryValueStore::keys(const QString &location) const {
+    QMutexLocker locker(&m_mutex);
+    QStringList result;
+    const QVariantMap values = m_locations.value(location);
+    for (auto it = values.cbegin(); it != values.cend(); ++it) {
+        if (it.value().isValid()) {
+            result.append(it.key());
+        }
+    }
+    return result;
+}
+
+void MemoryValueStore::put(const QString &location, const QString &key, const QVariant &value) {
+    QMutexLocker locker(&m_mutex);
+    m_locations[location].insert(key, value);
+}
+
+void MemoryValueStore::remove(const QString &location, const QString &key) {
+    QMutexLocker locker(&m_mutex);
+    if (key.isEmpty()) {
+        m_locations.remove(location);
+    } else if (m_locations.contains(location)) {
+        m_locations[location].remove(key);
+    }
+}
+
+qint64 MemoryValueStore::engineWrites() const {
+    QMutexLocker locker(&m_mutex);
+    return m_engineWrites;
+}
+
+void MemoryValueStore::clear() {
+    QMutexLocker locker(&m_mutex);
+    m_locations.clear();
+    m_engineWrites = 0;
+}
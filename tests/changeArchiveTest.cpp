@@ -0,0 +1,354 @@
+#include "changeArchive.h"
+#include "databaseRows.h"
+
+#include <QDir>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <QtTest>
+#include <algorithm>
+#include <limits>
+
+/**
+ * @brief Archive segment format: round trip, filters, pushdown and corruption.
+ */
+class ChangeArchiveTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void roundTrip();
+    void filters_data();
+    void filters();
+    void visitorStops();
+    void segmentPushdown();
+    void corruptColumn_data();
+    void corruptColumn();
+    void archiveSpansSegments();
+
+private:
+    /// Rows written by the tests, sorted by timestamp as a segment stores them.
+    QVector<ChangeRow> m_rows;
+    QTemporaryDir      m_dir;
+};
+
+namespace {
+
+const qint64 kBaseMs = 1700000000000;
+const int    kRows   = ArchiveSegment::kValueBlockRows * 2 + 37;  // three value blocks
+
+const QStringList kConfigs = {
+    QStringLiteral("com.apple.dock"),
+    QStringLiteral("HKLM\\Software\\Monitor"),
+    QStringLiteral("réglages|/Library/Preferences/x.plist|Recents[0]"),
+};
+
+// Column order of the segment header (see ArchiveSegment::Column)
+enum HeaderColumn { Ids, Timestamps, Configs, Flags, Values };
+
+const qint64 kNoStart = std::numeric_limits<qint64>::min();
+const qint64 kNoEnd   = std::numeric_limits<qint64>::max();
+
+QByteArray randomBytes(QRandomGenerator &rng, int size) {
+    QByteArray bytes(size, Qt::Uninitialized);
+    for (char &c : bytes) {
+        c = char(rng.bounded(256));
+    }
+    return bytes;
+}
+
+/// Zero a column in place, leaving the header intact so the segment still opens.
+bool corrupt(const QString &path, int column) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+    const QByteArray header = file.read(56 + 5 * 16);
+    const uchar *p = reinterpret_cast<const uchar *>(header.constData());
+    const quint64 offset = qFromLittleEndian<quint64>(p + 56 + column * 16);
+    const quint64 length = qFromLittleEndian<quint64>(p + 64 + column * 16);
+    return file.seek(qint64(offset)) && file.write(QByteArray(int(length), '\0')) == qint64(length);
+}
+
+/// Every row @p segment yields for the filters.
+QVector<ChangeRow> scanAll(const ArchiveSegment &segment, qint64 startMs, qint64 endMs,
+                           const QString &configName = QString(),
+                           const QVariant &ackFilter = QVariant(),
+                           const QVariant &criticalFilter = QVariant(),
+                           ScanResult *result = nullptr) {
+    QVector<ChangeRow> rows;
+    const ScanResult r = segment.scan(startMs, endMs, configName, ackFilter, criticalFilter,
+                                      [&rows](ChangeRow &&row) {
+        rows.append(std::move(row));
+        return true;
+    });
+    if (result) {
+        *result = r;
+    }
+    return rows;
+}
+
+bool sameRow(const ChangeRow &a, const ChangeRow &b) {
+    return a.id == b.id
+        && a.configName == b.configName
+        && a.oldCipher == b.oldCipher
+        && a.newCipher == b.newCipher
+        && a.acknowledged == b.acknowledged
+        && a.critical == b.critical
+        && a.timestamp.toMSecsSinceEpoch() == b.timestamp.toMSecsSinceEpoch();
+}
+
+} // namespace
+
+/**
+ * Rows with irregular timestamps (repeats and gaps), ids going backwards,
+ * a small config dictionary and values of every size, empty included.
+ */
+void ChangeArchiveTest::init() {
+    QVERIFY(m_dir.isValid());
+    QRandomGenerator rng(42);
+    m_rows.clear();
+    qint64 ts = kBaseMs;
+    for (int i = 0; i < kRows; ++i) {
+        ts += rng.bounded(3) == 0 ? 0 : rng.bounded(1, 5000);
+        ChangeRow row;
+        row.id           = 1000 + i * 7 - (i % 2) * 10;
+        row.configName   = kConfigs.at(rng.bounded(int(kConfigs.size())));
+        row.oldCipher    = randomBytes(rng, rng.bounded(0, 300));
+        row.newCipher    = randomBytes(rng, rng.bounded(1, 300));
+        row.acknowledged = rng.bounded(2) == 0;
+        row.critical     = rng.bounded(4) == 0;
+        row.timestamp    = QDateTime::fromMSecsSinceEpoch(ts);
+        m_rows.append(row);
+    }
+}
+
+/**
+ * A segment reopened from disk yields every row unchanged, oldest first,
+ * even when written out of order.
+ */
+void ChangeArchiveTest::roundTrip() {
+    // Runs of equal timestamps in reverse order; rows within a run keep
+    // theirs, as the writer's sort is stable
+    QVector<ChangeRow> shuffled;
+    for (int end = m_rows.size(); end > 0;) {
+        int begin = end - 1;
+        while (begin > 0 && m_rows[begin - 1].timestamp == m_rows[end - 1].timestamp) {
+            --begin;
+        }
+        shuffled += m_rows.mid(begin, end - begin);
+        end = begin;
+    }
+    const QString path = m_dir.filePath("roundTrip.seg");
+    QVERIFY(ArchiveSegment::write(path, shuffled));
+
+    auto segment = ArchiveSegment::open(path);
+    QVERIFY(segment);
+    QCOMPARE(segment->rowCount(), kRows);
+    QCOMPARE(segment->minTimestampMs(), m_rows.first().timestamp.toMSecsSinceEpoch());
+    QCOMPARE(segment->maxTimestampMs(), m_rows.last().timestamp.toMSecsSinceEpoch());
+
+    QVector<qint64> ids;
+    for (const ChangeRow &row : std::as_const(m_rows)) {
+        ids.append(row.id);
+    }
+    QCOMPARE(segment->ids(), ids);
+
+    ScanResult result = ScanResult::Failed;
+    const QVector<ChangeRow> rows = scanAll(*segment, kNoStart, kNoEnd, QString(), QVariant(), QVariant(), &result);
+    QCOMPARE(int(result), int(ScanResult::Completed));
+    QCOMPARE(rows.size(), m_rows.size());
+    for (int i = 0; i < rows.size(); ++i) {
+        QVERIFY2(sameRow(rows[i], m_rows[i]), qPrintable(QStringLiteral("row %1").arg(i)));
+    }
+}
+
+void ChangeArchiveTest::filters_data() {
+    QTest::addColumn<int>("firstRow");
+    QTest::addColumn<int>("lastRow");
+    QTest::addColumn<QString>("configName");
+    QTest::addColumn<QVariant>("ackFilter");
+    QTest::addColumn<QVariant>("criticalFilter");
+
+    QTest::newRow("range") << 100 << 400 << QString() << QVariant() << QVariant();
+    QTest::newRow("single row") << 300 << 300 << QString() << QVariant() << QVariant();
+    QTest::newRow("config") << 0 << kRows - 1 << kConfigs.at(2) << QVariant() << QVariant();
+    QTest::newRow("acknowledged") << 0 << kRows - 1 << QString() << QVariant(true) << QVariant();
+    QTest::newRow("unacknowledged") << 0 << kRows - 1 << QString() << QVariant(false) << QVariant();
+    QTest::newRow("critical") << 0 << kRows - 1 << QString() << QVariant() << QVariant(true);
+    QTest::newRow("combined") << 250 << 520 << kConfigs.at(1) << QVariant(false) << QVariant(true);
+}
+
+/**
+ * Each filter yields exactly the rows a plain scan of the input would,
+ * including time bounds falling inside runs of equal timestamps.
+ */
+void ChangeArchiveTest::filters() {
+    QFETCH(int, firstRow);
+    QFETCH(int, lastRow);
+    QFETCH(QString, configName);
+    QFETCH(QVariant, ackFilter);
+    QFETCH(QVariant, criticalFilter);
+
+    const QString path = m_dir.filePath("filters.seg");
+    QVERIFY(ArchiveSegment::write(path, m_rows));
+    auto segment = ArchiveSegment::open(path);
+    QVERIFY(segment);
+
+    const qint64 startMs = m_rows[firstRow].timestamp.toMSecsSinceEpoch();
+    const qint64 endMs   = m_rows[lastRow].timestamp.toMSecsSinceEpoch();
+    QVector<ChangeRow> expected;
+    for (const ChangeRow &row : std::as_const(m_rows)) {
+        const qint64 ts = row.timestamp.toMSecsSinceEpoch();
+        if (ts < startMs || ts > endMs) continue;
+        if (!configName.isEmpty() && row.configName != configName) continue;
+        if (!ackFilter.isNull() && row.acknowledged != ackFilter.toBool()) continue;
+        if (!criticalFilter.isNull() && row.critical != criticalFilter.toBool()) continue;
+        expected.append(row);
+    }
+    QVERIFY(!expected.isEmpty());
+
+    ScanResult result = ScanResult::Failed;
+    const QVector<ChangeRow> rows = scanAll(*segment, startMs, endMs, configName, ackFilter, criticalFilter, &result);
+    QCOMPARE(int(result), int(ScanResult::Completed));
+    QCOMPARE(rows.size(), expected.size());
+    for (int i = 0; i < rows.size(); ++i) {
+        QVERIFY2(sameRow(rows[i], expected[i]), qPrintable(QStringLiteral("row %1").arg(i)));
+    }
+}
+
+void ChangeArchiveTest::visitorStops() {
+    const QString path = m_dir.filePath("stops.seg");
+    QVERIFY(ArchiveSegment::write(path, m_rows));
+    auto segment = ArchiveSegment::open(path);
+    QVERIFY(segment);
+
+    int visited = 0;
+    const ScanResult result = segment->scan(kNoStart, kNoEnd, QString(), QVariant(), QVariant(),
+                                            [&visited](ChangeRow &&) {
+        return ++visited < 10;
+    });
+    QCOMPARE(int(result), int(ScanResult::Stopped));
+    QCOMPARE(visited, 10);
+}
+
+/**
+ * Filters the header and dictionary rule out skip the segment without
+ * decoding a column: with the timestamp column destroyed, they still
+ * complete, while a scan that must read it fails.
+ */
+void ChangeArchiveTest::segmentPushdown() {
+    QVector<ChangeRow> rows = m_rows;
+    for (ChangeRow &row : rows) {
+        row.critical = false;
+        row.acknowledged = true;
+    }
+    const QString path = m_dir.filePath("pushdown.seg");
+    QVERIFY(ArchiveSegment::write(path, rows));
+    QVERIFY(corrupt(path, Timestamps));
+    auto segment = ArchiveSegment::open(path);
+    QVERIFY(segment);
+
+    const qint64 minMs = segment->minTimestampMs();
+    const qint64 maxMs = segment->maxTimestampMs();
+    ScanResult result = ScanResult::Failed;
+
+    QVERIFY(scanAll(*segment, kNoStart, minMs - 1, QString(), QVariant(), QVariant(), &result).isEmpty());
+    QCOMPARE(int(result), int(ScanResult::Completed));
+    QVERIFY(scanAll(*segment, maxMs + 1, kNoEnd, QString(), QVariant(), QVariant(), &result).isEmpty());
+    QCOMPARE(int(result), int(ScanResult::Completed));
+    QVERIFY(scanAll(*segment, kNoStart, kNoEnd, "not.archived", QVariant(), QVariant(), &result).isEmpty());
+    QCOMPARE(int(result), int(ScanResult::Completed));
+    QVERIFY(scanAll(*segment, kNoStart, kNoEnd, QString(), QVariant(), QVariant(true), &result).isEmpty());
+    QCOMPARE(int(result), int(ScanResult::Completed));
+    QVERIFY(scanAll(*segment, kNoStart, kNoEnd, QString(), QVariant(false), QVariant(), &result).isEmpty());
+    QCOMPARE(int(result), int(ScanResult::Completed));
+
+    QVERIFY(scanAll(*segment, kNoStart, kNoEnd, kConfigs.at(0), QVariant(), QVariant(), &result).isEmpty());
+    QCOMPARE(int(result), int(ScanResult::Failed));
+}
+
+void ChangeArchiveTest::corruptColumn_data() {
+    QTest::addColumn<int>("column");
+    QTest::newRow("ids") << int(Ids);
+    QTest::newRow("timestamps") << int(Timestamps);
+    QTest::newRow("configs") << int(Configs);
+    QTest::newRow("flags") << int(Flags);
+    QTest::newRow("values") << int(Values);
+}
+
+/**
+ * A column that cannot be decoded fails the scan; it must not look like a
+ * segment without matches.
+ */
+void ChangeArchiveTest::corruptColumn() {
+    QFETCH(int, column);
+    const QString path = m_dir.filePath(QStringLiteral("corrupt%1.seg").arg(column));
+    QVERIFY(ArchiveSegment::write(path, m_rows));
+    QVERIFY(corrupt(path, column));
+    auto segment = ArchiveSegment::open(path);
+    QVERIFY(segment);
+
+    ScanResult result = ScanResult::Completed;
+    scanAll(*segment, kNoStart, kNoEnd, QString(), QVariant(), QVariant(), &result);
+    QCOMPARE(int(result), int(ScanResult::Failed));
+}
+
+/**
+ * The archive scans its segments oldest first and reports a corrupt one
+ * instead of skipping it.
+ */
+void ChangeArchiveTest::archiveSpansSegments() {
+    const QString directory = m_dir.filePath("archive");
+    const int half = kRows / 2;
+    {
+        ChangeArchive archive(directory);
+        // Newer rows first, so the archive has to order the segments itself
+        const QString newer = archive.stage(m_rows.mid(half));
+        const QString older = archive.stage(m_rows.mid(0, half));
+        QVERIFY(!newer.isEmpty() && !older.isEmpty());
+        QCOMPARE(archive.pendingSegments().size(), 2);
+        QVERIFY(archive.commit(newer));
+        QVERIFY(archive.commit(older));
+        QCOMPARE(archive.segmentCount(), 2);
+        QCOMPARE(archive.rowCount(), qint64(kRows));
+
+        QVector<qint64> ids;
+        const ScanResult result = archive.scan(QString(), QString(), QString(), QVariant(), QVariant(),
+                                               [&ids](ChangeRow &&row) {
+            ids.append(row.id);
+            return true;
+        });
+        QCOMPARE(int(result), int(ScanResult::Completed));
+        QCOMPARE(ids.size(), kRows);
+        for (int i = 0; i < kRows; ++i) {
+            QCOMPARE(ids[i], m_rows[i].id);
+        }
+    }
+
+    // Damage the newer segment while no archive has it mapped
+    const QStringList files = QDir(directory).entryList({"*.seg"}, QDir::Files, QDir::Name);
+    QCOMPARE(files.size(), 2);
+    const QString newest = QStringLiteral("changes-%1-").arg(m_rows[half].timestamp.toMSecsSinceEpoch());
+    const auto it = std::find_if(files.cbegin(), files.cend(), [&newest](const QString &name) {
+        return name.startsWith(newest);
+    });
+    QVERIFY(it != files.cend());
+    QVERIFY(corrupt(QDir(directory).filePath(*it), Configs));
+
+    ChangeArchive archive(directory);
+    QCOMPARE(archive.segmentCount(), 2);
+    int visited = 0;
+    const ScanResult result = archive.scan(QString(), QString(), QString(), QVariant(), QVariant(),
+                                           [&visited](ChangeRow &&) {
+        ++visited;
+        return true;
+    });
+    QCOMPARE(int(result), int(ScanResult::Failed));
+    QCOMPARE(visited, half);
+}
+
+QTEST_GUILESS_MAIN(ChangeArchiveTest)
+#include "changeArchiveTest.moc"
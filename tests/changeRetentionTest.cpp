@@ -0,0 +1,87 @@
+#include "testDatabase.h"
+
+#include "changeRetention.h"
+#include "clock.h"
+#include "Database.h"
+#include "monitoringBase.h"
+
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest>
+
+/**
+ * @brief Retention rules applied to rows logged the way the monitors log them.
+ */
+class ChangeRetentionTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void criticalRowsOutliveNonCritical();
+
+private:
+    /// Names of the config of every remaining Changes row.
+    QStringList remainingConfigs();
+
+    QTemporaryDir m_keyDir;
+};
+
+void ChangeRetentionTest::initTestCase() {
+    QString why;
+    if (!TestDatabase::open(m_keyDir, &why)) {
+        QSKIP(qPrintable(why));
+    }
+}
+
+void ChangeRetentionTest::init() {
+    TestDatabase::clear();
+}
+
+void ChangeRetentionTest::cleanup() {
+    Clock::setInstance(nullptr);
+}
+
+QStringList ChangeRetentionTest::remainingConfigs() {
+    Database db;
+    QStringList names;
+    for (const ChangeRow &row : db.changeRows()) {
+        names << row.configName;
+    }
+    names.sort();
+    return names;
+}
+
+/**
+ * Rows staged by the monitors carry the entry's criticality, so a row of a
+ * critical entry is kept by criticalMaxAgeDays after maxAgeDays has
+ * removed its non-critical neighbour.
+ */
+void ChangeRetentionTest::criticalRowsOutliveNonCritical() {
+    VirtualClock clock(QDateTime::currentDateTime().addDays(-100));
+    Clock::setInstance(&clock);
+
+    Database db;
+    QVERIFY(MonitoringBase::changeLogWrite("critical_entry", "old", "new", true)(db));
+    QVERIFY(MonitoringBase::changeLogWrite("normal_entry", "old", "new", false)(db));
+    QCOMPARE(remainingConfigs(), QStringList({"critical_entry", "normal_entry"}));
+
+    clock.advanceTo(QDateTime::currentDateTime());
+
+    RetentionPolicy policy;
+    policy.maxAgeDays         = 30;
+    policy.criticalMaxAgeDays = 365;
+    policy.chunkPauseMs       = 0;
+    ChangeRetention retention(policy);
+    QSignalSpy finished(&retention, &ChangeRetention::purgeFinished);
+    retention.runNow();
+    QVERIFY(finished.wait(30000));
+
+    QCOMPARE(finished.first().at(0).toInt(), 1);
+    QCOMPARE(remainingConfigs(), QStringList({"critical_entry"}));
+}
+
+QTEST_GUILESS_MAIN(ChangeRetentionTest)
+#include "changeRetentionTest.moc"
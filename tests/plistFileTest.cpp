@@ -0,0 +1,140 @@
+#include "plistFile.h"
+#include "valueStore.h"
+
+#include <QTemporaryDir>
+#include <QtTest>
+
+/**
+ * @brief Leaf-level changes of container entries through the snapshot cache.
+ */
+class PlistFileTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void changedLeavesOfKeyPath();
+    void changedLeavesOfWholeDocument();
+    void changedLeavesAfterEviction();
+
+private:
+    QString location() const { return m_dir.filePath("com.example.test.plist"); }
+
+    QTemporaryDir    m_dir;
+    MemoryValueStore m_store;
+};
+
+namespace {
+
+/// A dictionary whose "Recents" array ends with @p last.
+QVariantMap panel(const QString &last) {
+    QVariantMap map;
+    map.insert("Recents", QVariantList{"/Users/me/a.txt", last});
+    map.insert("ShowHidden", false);
+    return map;
+}
+
+} // namespace
+
+void PlistFileTest::init() {
+    QVERIFY(m_dir.isValid());
+    m_store.clear();
+    ValueStore::setInstance(&m_store);
+}
+
+void PlistFileTest::cleanup() {
+    ValueStore::setInstance(nullptr);
+}
+
+/**
+ * Key paths of the leaves are absolute within the plist, so they can be
+ * named and rolled back independently of the entry's own path.
+ */
+void PlistFileTest::changedLeavesOfKeyPath() {
+    m_store.put(location(), "NSNavPanel", panel("/Users/me/b.txt"));
+    PlistFile file(location(), "NSNavPanel", false);
+    file.loadBaseline();
+    const QString before = file.value();
+
+    m_store.put(location(), "NSNavPanel", panel("/Users/me/c.txt"));
+    const QString after = file.getCurrentValue();
+    QVERIFY(after != before);
+
+    const QVector<PlistLeafChange> leaves = file.changedLeaves(before, after);
+    QCOMPARE(leaves.size(), 1);
+    QCOMPARE(leaves.first().keyPath, QStringLiteral("NSNavPanel/Recents[1]"));
+    QCOMPARE(leaves.first().before, QStringLiteral("/Users/me/b.txt"));
+    QCOMPARE(leaves.first().after, QStringLiteral("/Users/me/c.txt"));
+
+    // Unchanged content is recognised by hash and keeps its text
+    m_store.put(location(), "NSNavPanel", panel("/Users/me/c.txt"));
+    QCOMPARE(file.getCurrentValue(), after);
+
+    // Scalars have no snapshot, so their change is only known as a whole
+    PlistFile scalar(location(), "Scalar", false);
+    m_store.put(location(), "Scalar", 1);
+    scalar.loadBaseline();
+    m_store.put(location(), "Scalar", 2);
+    QVERIFY(scalar.changedLeaves(scalar.value(), scalar.getCurrentValue()).isEmpty());
+}
+
+void PlistFileTest::changedLeavesOfWholeDocument() {
+    m_store.put(location(), "NSNavPanel", panel("/Users/me/b.txt"));
+    m_store.put(location(), "Volume", 3);
+    PlistFile file(location(), "/", false);
+    QVERIFY(file.isWholeDocument());
+    file.loadBaseline();
+    const QString before = file.value();
+
+    m_store.put(location(), "Volume", 4);
+    m_store.put(location(), "Added", "yes");
+    const QVector<PlistLeafChange> leaves = file.changedLeaves(before, file.getCurrentValue());
+    QCOMPARE(leaves.size(), 2);
+    QCOMPARE(leaves.at(0).keyPath, QStringLiteral("Added"));
+    QCOMPARE(leaves.at(0).after, QStringLiteral("yes"));
+    QCOMPARE(leaves.at(1).keyPath, QStringLiteral("Volume"));
+    QCOMPARE(leaves.at(1).before, QStringLiteral("3"));
+    QCOMPARE(leaves.at(1).after, QStringLiteral("4"));
+}
+
+/**
+ * More distinct renderings than the cache holds evict the older ones:
+ * diffs against an evicted rendering are empty (the change is logged as
+ * one whole-value row), while the entry's current value is never evicted.
+ */
+void PlistFileTest::changedLeavesAfterEviction() {
+    m_store.put(location(), "NSNavPanel", panel("/Users/me/0.txt"));
+    PlistFile file(location(), "NSNavPanel", false);
+    file.loadBaseline();
+    const QString baseline = file.value();
+
+    QStringList seen;
+    for (int i = 1; i <= 8; ++i) {
+        m_store.put(location(), "NSNavPanel", panel(QStringLiteral("/Users/me/%1.txt").arg(i)));
+        seen.append(file.getCurrentValue());
+    }
+
+    // The oldest renderings other than the current value are gone
+    QVERIFY(file.changedLeaves(seen.first(), seen.last()).isEmpty());
+    QVERIFY(file.changedLeaves(seen.at(1), seen.last()).isEmpty());
+
+    // The current value and recent renderings still diff leaf by leaf
+    const QVector<PlistLeafChange> fromBaseline = file.changedLeaves(baseline, seen.last());
+    QCOMPARE(fromBaseline.size(), 1);
+    QCOMPARE(fromBaseline.first().keyPath, QStringLiteral("NSNavPanel/Recents[1]"));
+    QCOMPARE(fromBaseline.first().before, QStringLiteral("/Users/me/0.txt"));
+    QCOMPARE(fromBaseline.first().after, QStringLiteral("/Users/me/8.txt"));
+
+    const QVector<PlistLeafChange> recent = file.changedLeaves(seen.at(6), seen.last());
+    QCOMPARE(recent.size(), 1);
+    QCOMPARE(recent.first().before, QStringLiteral("/Users/me/7.txt"));
+
+    // A rendering read again after its eviction is retained anew
+    m_store.put(location(), "NSNavPanel", panel("/Users/me/1.txt"));
+    QCOMPARE(file.getCurrentValue(), seen.first());
+    QCOMPARE(file.changedLeaves(seen.first(), seen.last()).size(), 1);
+}
+
+QTEST_GUILESS_MAIN(PlistFileTest)
+#include "plistFileTest.moc"
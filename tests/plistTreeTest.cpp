@@ -0,0 +1,210 @@
+#include "plistTree.h"
+
+#include <QDateTime>
+#include <QtTest>
+
+/**
+ * @brief Structural diffs of nested plist values.
+ */
+class PlistTreeTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void equalTreesHaveNoChanges();
+    void unchangedSubtreesAreSkipped();
+    void dictionaryKeysAddedAndRemoved();
+    void arrayIndexPaths_data();
+    void arrayIndexPaths();
+    void kindChangeIsOneChange();
+    void wholeDocument();
+};
+
+bool operator==(const PlistLeafChange &a, const PlistLeafChange &b) {
+    return a.keyPath == b.keyPath && a.before == b.before && a.after == b.after;
+}
+
+Q_DECLARE_METATYPE(QVector<PlistLeafChange>)
+
+namespace {
+
+/// A preferences-like document: a few large sibling subtrees around a small one.
+QVariantMap document() {
+    QVariantList recents;
+    for (int i = 0; i < 3; ++i) {
+        recents.append(QStringLiteral("/Users/me/file%1.txt").arg(i));
+    }
+    QVariantMap panel;
+    panel.insert("Recents", recents);
+    panel.insert("ShowHidden", false);
+
+    QVariantMap big;
+    for (int i = 0; i < 200; ++i) {
+        QVariantMap item;
+        item.insert("id", i);
+        item.insert("tags", QVariantList{"a", "b", i});
+        big.insert(QStringLiteral("item%1").arg(i, 3, 10, QLatin1Char('0')), item);
+    }
+
+    QVariantMap doc;
+    doc.insert("NSNavPanel", panel);
+    doc.insert("Catalog", big);
+    doc.insert("LastOpened", QDateTime::fromMSecsSinceEpoch(1700000000000));
+    doc.insert("Blob", QByteArray("\x01\x02", 2));
+    return doc;
+}
+
+QString describe(const QVector<PlistLeafChange> &changes) {
+    QStringList parts;
+    for (const PlistLeafChange &c : changes) {
+        parts.append(c.keyPath + ": " + c.before + " -> " + c.after);
+    }
+    return parts.join("; ");
+}
+
+} // namespace
+
+/**
+ * Equal content gives equal hashes whatever the container type or build
+ * order, and no changes.
+ */
+void PlistTreeTest::equalTreesHaveNoChanges() {
+    const QVariantMap map = document();
+    QVariantHash hash;
+    for (auto it = map.cbegin(); it != map.cend(); ++it) {
+        hash.insert(it.key(), it.value());
+    }
+    const PlistTree a(map);
+    const PlistTree b(hash);
+    QCOMPARE(a.hash(), b.hash());
+    QCOMPARE(a.render(), b.render());
+    QVERIFY(PlistTree::diff(a, b, "prefs").isEmpty());
+
+    QVariantMap other = map;
+    other.insert("Blob", QByteArray("\x01\x03", 2));
+    QVERIFY(PlistTree(other).hash() != a.hash());
+}
+
+/**
+ * One edited leaf deep inside the document is the only change reported;
+ * the 200-item sibling subtree is matched by its hash.
+ */
+void PlistTreeTest::unchangedSubtreesAreSkipped() {
+    const QVariantMap before = document();
+    QVariantMap after = before;
+    QVariantMap panel = after.value("NSNavPanel").toMap();
+    QVariantList recents = panel.value("Recents").toList();
+    recents[1] = QStringLiteral("/Users/me/other.txt");
+    panel.insert("Recents", recents);
+    after.insert("NSNavPanel", panel);
+
+    const QVector<PlistLeafChange> changes = PlistTree::diff(PlistTree(before), PlistTree(after), "prefs");
+    QCOMPARE(changes.size(), 1);
+    QCOMPARE(changes.first().keyPath, QStringLiteral("prefs/NSNavPanel/Recents[1]"));
+    QCOMPARE(changes.first().before, QStringLiteral("/Users/me/file1.txt"));
+    QCOMPARE(changes.first().after, QStringLiteral("/Users/me/other.txt"));
+
+    // Two edits in separate subtrees, one of them inside the large catalog
+    QVariantMap catalog = after.value("Catalog").toMap();
+    QVariantMap item = catalog.value("item150").toMap();
+    item.insert("id", 1500);
+    catalog.insert("item150", item);
+    after.insert("Catalog", catalog);
+    const QVector<PlistLeafChange> both = PlistTree::diff(PlistTree(before), PlistTree(after), "prefs");
+    QCOMPARE(both.size(), 2);
+    QVERIFY2(both.contains(PlistLeafChange{"prefs/Catalog/item150/id", "150", "1500"}), qPrintable(describe(both)));
+}
+
+void PlistTreeTest::dictionaryKeysAddedAndRemoved() {
+    QVariantMap before;
+    before.insert("keep", 1);
+    before.insert("gone", QVariantMap{{"x", 1}});
+    QVariantMap after;
+    after.insert("keep", 1);
+    after.insert("new", "value");
+
+    const QVector<PlistLeafChange> changes = PlistTree::diff(PlistTree(before), PlistTree(after), "root");
+    QCOMPARE(changes.size(), 2);
+    QVERIFY2(changes.contains(PlistLeafChange{"root/gone", "{\"x\":1}", QString()}), qPrintable(describe(changes)));
+    QVERIFY2(changes.contains(PlistLeafChange{"root/new", QString(), "value"}), qPrintable(describe(changes)));
+}
+
+void PlistTreeTest::arrayIndexPaths_data() {
+    QTest::addColumn<QVariantList>("before");
+    QTest::addColumn<QVariantList>("after");
+    QTest::addColumn<QVector<PlistLeafChange>>("expected");
+
+    const QVariantList abcd{"a", "b", "c", "d"};
+    QTest::newRow("insert")
+        << abcd << QVariantList{"a", "x", "b", "c", "d"}
+        << QVector<PlistLeafChange>{{"list[1]", QString(), "x"}};
+    QTest::newRow("remove")
+        << abcd << QVariantList{"a", "c", "d"}
+        << QVector<PlistLeafChange>{{"list[1]", "b", QString()}};
+    QTest::newRow("replace")
+        << abcd << QVariantList{"a", "B", "c", "d"}
+        << QVector<PlistLeafChange>{{"list[1]", "b", "B"}};
+    QTest::newRow("append")
+        << abcd << QVariantList{"a", "b", "c", "d", "e", "f"}
+        << QVector<PlistLeafChange>{{"list[4]", QString(), "e"}, {"list[5]", QString(), "f"}};
+    QTest::newRow("nested")
+        << QVariantList{QVariantMap{{"k", 1}}, QVariantMap{{"k", 2}}}
+        << QVariantList{QVariantMap{{"k", 1}}, QVariantMap{{"k", 3}}}
+        << QVector<PlistLeafChange>{{"list[1]/k", "2", "3"}};
+}
+
+/**
+ * Array edits are reported at the index they affect, not as a shift of
+ * every later element.
+ */
+void PlistTreeTest::arrayIndexPaths() {
+    QFETCH(QVariantList, before);
+    QFETCH(QVariantList, after);
+    QFETCH(QVector<PlistLeafChange>, expected);
+
+    const QVector<PlistLeafChange> changes = PlistTree::diff(PlistTree(before), PlistTree(after), "list");
+    QVERIFY2(changes == expected, qPrintable(describe(changes)));
+}
+
+void PlistTreeTest::kindChangeIsOneChange() {
+    QVariantMap before;
+    before.insert("value", QVariantMap{{"a", 1}, {"b", 2}});
+    QVariantMap after;
+    after.insert("value", QVariantList{1, 2});
+
+    const QVector<PlistLeafChange> changes = PlistTree::diff(PlistTree(before), PlistTree(after), "prefs");
+    QCOMPARE(changes.size(), 1);
+    QCOMPARE(changes.first().keyPath, QStringLiteral("prefs/value"));
+    QCOMPARE(changes.first().before, QStringLiteral("{\"a\":1,\"b\":2}"));
+    QCOMPARE(changes.first().after, QStringLiteral("[1,2]"));
+}
+
+/**
+ * Without a base path (a "/" entry) top-level keys are the paths, and a
+ * change of the root itself is reported as "/".
+ */
+void PlistTreeTest::wholeDocument() {
+    QVariantMap before = document();
+    QVariantMap after = before;
+    after.insert("NewKey", 7);
+    const QVector<PlistLeafChange> added = PlistTree::diff(PlistTree(before), PlistTree(after));
+    QCOMPARE(added.size(), 1);
+    QCOMPARE(added.first().keyPath, QStringLiteral("NewKey"));
+
+    const QVector<PlistLeafChange> root = PlistTree::diff(PlistTree(QVariantList{1}), PlistTree(before));
+    QCOMPARE(root.size(), 1);
+    QCOMPARE(root.first().keyPath, QStringLiteral("/"));
+    QCOMPARE(root.first().after, PlistTree(before).render());
+
+    const QVector<PlistLeafChange> created = PlistTree::diff(PlistTree(), PlistTree(before));
+    QCOMPARE(created.size(), 1);
+    QCOMPARE(created.first().keyPath, QStringLiteral("/"));
+    QVERIFY(created.first().before.isEmpty());
+
+    const QVector<PlistLeafChange> rootArray = PlistTree::diff(PlistTree(QVariantList{1, 2}),
+                                                               PlistTree(QVariantList{1, 3}));
+    QCOMPARE(rootArray.size(), 1);
+    QCOMPARE(rootArray.first().keyPath, QStringLiteral("[1]"));
+}
+
+QTEST_GUILESS_MAIN(PlistTreeTest)
+#include "plistTreeTest.moc"
@@ -0,0 +1,61 @@
+#include "testDatabase.h"
+
+#include "Database.h"
+#include "encryptionUtils.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QSqlQuery>
+
+namespace {
+
+QByteArray randomBytes(int n) {
+    QByteArray bytes(n, Qt::Uninitialized);
+    for (int i = 0; i < n; ++i) {
+        bytes[i] = char(QRandomGenerator::global()->bounded(256));
+    }
+    return bytes;
+}
+
+} // namespace
+
+bool TestDatabase::open(const QTemporaryDir &keyDir, QString *why) {
+    if (!qEnvironmentVariableIsSet("MONITOR_DB_NAME")) {
+        qputenv("MONITOR_DB_NAME", "MonitorTest");
+    }
+    if (qEnvironmentVariable("MONITOR_DB_NAME") == "MonitorDB") {
+        *why = QStringLiteral("refusing to run against MonitorDB");
+        return false;
+    }
+
+    const QString path = keyDir.filePath("encryptionKeys.json");
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        *why = QStringLiteral("cannot write %1").arg(path);
+        return false;
+    }
+    file.write(QJsonDocument(QJsonObject{
+        {"key", QString::fromLatin1(randomBytes(32).toBase64())},
+        {"iv",  QString::fromLatin1(randomBytes(16).toBase64())},
+    }).toJson());
+    file.close();
+    qputenv("MONITOR_ENCRYPTION_KEYS", path.toUtf8());
+    EncryptionUtils::loadEncryptionKeys(path);
+
+    Database db;
+    if (!db.isOpen()) {
+        *why = QStringLiteral("database %1 is unreachable")
+                   .arg(qEnvironmentVariable("MONITOR_DB_NAME"));
+        return false;
+    }
+    clear();
+    return true;
+}
+
+void TestDatabase::clear() {
+    QSqlQuery query(QSqlDatabase::database(Database::connectionNameForCurrentThread()));
+    query.exec("DELETE FROM Changes");
+    query.exec("DELETE FROM ValueKeyframes");
+}
@@ -0,0 +1,30 @@
+#ifndef TESTDATABASE_H
+#define TESTDATABASE_H
+
+#include <QString>
+#include <QTemporaryDir>
+
+/**
+ * @brief Disposable schema for tests that need the database.
+ *
+ * Tests run against MONITOR_DB_NAME (default "MonitorTest") on the server
+ * named by MONITOR_DB_HOST/PORT/USER/PASSWORD, with a throwaway AES key.
+ * Each test empties the Changes and ValueKeyframes tables, so the
+ * production schema is refused.
+ */
+namespace TestDatabase {
+
+/**
+ * @brief Point the process at the test schema and load a fresh key.
+ * @param keyDir Directory that receives the key file; must outlive the test.
+ * @param why    Receives the reason when the database cannot be used.
+ * @return True if the schema is reachable and empty.
+ */
+bool open(const QTemporaryDir &keyDir, QString *why);
+
+/// Delete every row of Changes and ValueKeyframes.
+void clear();
+
+} // namespace TestDatabase
+
+#endif // TESTDATABASE_H
@@ -0,0 +1,110 @@
+#include "testDatabase.h"
+
+#include "clock.h"
+#include "Database.h"
+#include "databaseRows.h"
+#include "valueHistory.h"
+
+#include <QTemporaryDir>
+#include <QtTest>
+#include <algorithm>
+
+/**
+ * @brief Delta-encoded Changes values across retention passes.
+ */
+class ValueHistoryTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void encodeAfterKeyframePurge();
+
+private:
+    /// Decrypted rows of @p configName, oldest first.
+    QVector<ChangeRow> rowsOf(const QString &configName);
+
+    QTemporaryDir m_keyDir;
+};
+
+namespace {
+
+/// Large enough to be delta-encoded; @p version changes a small part of it.
+QString settingsText(int version) {
+    QString text;
+    for (int i = 0; i < 64; ++i) {
+        text += QStringLiteral("key%1 = value%1\n").arg(i);
+    }
+    return text + QStringLiteral("version = %1\n").arg(version);
+}
+
+} // namespace
+
+void ValueHistoryTest::initTestCase() {
+    QString why;
+    if (!TestDatabase::open(m_keyDir, &why)) {
+        QSKIP(qPrintable(why));
+    }
+}
+
+void ValueHistoryTest::init() {
+    TestDatabase::clear();
+}
+
+void ValueHistoryTest::cleanup() {
+    ValueHistory::setInstance(nullptr);
+    Clock::setInstance(nullptr);
+}
+
+QVector<ChangeRow> ValueHistoryTest::rowsOf(const QString &configName) {
+    Database db;
+    QVector<ChangeRow> rows;
+    const QVector<ChangeRow> all = db.changeRows();
+    for (const ChangeRow &row : all) {
+        if (row.configName == configName) {
+            rows.append(row);
+        }
+    }
+    std::sort(rows.begin(), rows.end(), [](const ChangeRow &a, const ChangeRow &b) {
+        return a.id < b.id;
+    });
+    DatabaseRows::decryptValues(rows.data(), rows.data() + rows.size());
+    return rows;
+}
+
+/**
+ * Once retention has removed a chain's rows and then its keyframe, the
+ * chain's next row must not refer to that keyframe.
+ */
+void ValueHistoryTest::encodeAfterKeyframePurge() {
+    VirtualClock clock(QDateTime::currentDateTime().addDays(-1));
+    Clock::setInstance(&clock);
+    DeltaPolicy policy;
+    policy.keyframeInterval = 16;
+    ValueHistory history(policy);
+    ValueHistory::setInstance(&history);
+
+    Database db;
+    QVERIFY(db.insertChange("history_entry", settingsText(1), settingsText(2), false));
+    QCOMPARE(history.stats().value("keyframes").toInt(), 1);
+
+    // Retention: the row expires, then its keyframe is an orphan past the grace period
+    clock.advance(qint64(ValueHistory::kKeyframeGraceSecs) * 2 * 1000);
+    ChangePurgeRule rule;
+    rule.cutoff = clock.now();
+    QCOMPARE(db.purgeChangesChunk(rule, 100), 1);
+    QCOMPARE(db.purgeOrphanKeyframes(clock.now().addSecs(-ValueHistory::kKeyframeGraceSecs), 100), 1);
+
+    QVERIFY(db.insertChange("history_entry", settingsText(2), settingsText(3), false));
+    QCOMPARE(history.stats().value("keyframes").toInt(), 2);
+
+    const QVector<ChangeRow> rows = rowsOf("history_entry");
+    QCOMPARE(rows.size(), 1);
+    QCOMPARE(rows.first().oldValue, settingsText(2));
+    QCOMPARE(rows.first().newValue, settingsText(3));
+}
+
+QTEST_GUILESS_MAIN(ValueHistoryTest)
+#include "valueHistoryTest.moc"